@@ -0,0 +1,135 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/aabb_tree.h>
+#include <vecmath/bbox.h>
+#include <vecmath/forward.h>
+#include <vecmath/intersection.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+#include <vecmath/vec.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("aabb_tree.benchmark") {
+  constexpr auto count = std::size_t(100000);
+  const auto mins = random_vecs<float, 3>(count, -1000.0f, 1000.0f, 1u);
+  const auto sizes = random_vecs<float, 3>(count, 1.0f, 10.0f, 2u);
+  auto boxes = std::vector<bbox3f>();
+  boxes.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    boxes.emplace_back(mins[i], mins[i] + sizes[i]);
+  }
+
+  using tree = aabb_tree<float, 3, std::size_t>;
+  report_throughput("insert", count, [&]() {
+    auto t = tree(0.5f);
+    for (std::size_t i = 0; i < count; ++i) {
+      t.insert(boxes[i], i);
+    }
+    return t.height();
+  });
+
+  auto t = tree(0.5f);
+  auto handles = std::vector<tree::handle>();
+  for (std::size_t i = 0; i < count; ++i) {
+    handles.push_back(t.insert(boxes[i], i));
+  }
+
+  const auto offsets = random_vecs<float, 3>(count, -0.1f, 0.1f, 3u);
+  report_throughput("move by up to the margin", count, [&]() {
+    auto reinserted = std::size_t(0);
+    for (std::size_t i = 0; i < count; ++i) {
+      boxes[i] = boxes[i].translate(offsets[i]);
+      if (t.move(handles[i], boxes[i])) {
+        ++reinserted;
+      }
+    }
+    return reinserted;
+  });
+
+  // one ray per item, through the center of the scene
+  constexpr auto rayCount = std::size_t(1000);
+  const auto origins = random_vecs<float, 3>(rayCount, -2000.0f, 2000.0f, 4u);
+  auto rays = std::vector<ray3f>();
+  for (const auto& origin : origins) {
+    rays.emplace_back(origin, normalize(-origin));
+  }
+
+  const auto first_hit = [&](const ray3f& r, traversal_stats* stats) {
+    const auto [h, distance] = t.find_first_hit(
+      r, [&](const tree::handle leaf) { return intersect_ray_bbox(r, boxes[t.data(leaf)]); },
+      stats);
+    return h != tree::null_handle ? distance : 0.0f;
+  };
+
+  auto stats = traversal_stats();
+  for (const auto& r : rays) {
+    first_hit(r, &stats);
+  }
+  std::cout << "first hit: "
+            << static_cast<double>(stats.visited_nodes) / static_cast<double>(rayCount)
+            << " nodes and "
+            << static_cast<double>(stats.visited_leaves) / static_cast<double>(rayCount)
+            << " leaves visited per ray\n";
+
+  report_throughput("first hit", rayCount, [&]() {
+    auto sum = 0.0f;
+    for (const auto& r : rays) {
+      sum += first_hit(r, nullptr);
+    }
+    return sum;
+  });
+  report_throughput("first hit linear", rayCount / 10u, [&]() {
+    auto sum = 0.0f;
+    for (std::size_t i = 0; i < rayCount / 10u; ++i) {
+      auto best = nan<float>();
+      for (const auto& b : boxes) {
+        const auto distance = intersect_ray_bbox(rays[i], b);
+        if (!is_nan(distance) && (is_nan(best) || distance < best)) {
+          best = distance;
+        }
+      }
+      if (!is_nan(best)) {
+        sum += best;
+      }
+    }
+    return sum;
+  });
+
+  report_throughput("box query", rayCount, [&]() {
+    auto found = std::size_t(0);
+    for (const auto& origin : origins) {
+      const auto center = origin * 0.5f;
+      t.find_intersectors(
+        bbox3f(center - vec3f::fill(20.0f), center + vec3f::fill(20.0f)),
+        [&](const tree::handle) { ++found; });
+    }
+    return found;
+  });
+}
+} // namespace vm
@@ -0,0 +1,101 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/affine.h>
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("affine.benchmark") {
+  constexpr auto count = std::size_t(10000);
+  const auto params = random_vecs<double, 3>(count * 2u, 0.5, 10.0);
+
+  std::vector<mat4x4d> mats;
+  std::vector<affine3d> affines;
+  mats.reserve(count);
+  affines.reserve(count);
+  for (std::size_t i = 0u; i < count; ++i) {
+    mats.push_back(
+      translation_matrix(params[i * 2u]) *
+      rotation_matrix(normalize(params[i * 2u + 1u]), params[i * 2u].x()));
+    affines.emplace_back(mats.back());
+  }
+
+  const auto parent = mats.front();
+  const auto parentAffine = affines.front();
+  const auto point = vec3d(1.0, 2.0, 3.0);
+
+  std::vector<mat4x4d> outMats(count);
+  std::vector<affine3d> outAffines(count);
+  std::vector<vec3d> outPoints(count);
+
+  BENCHMARK("compose mat") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outMats[i] = parent * mats[i];
+    }
+    return outMats.back();
+  };
+
+  BENCHMARK("compose affine") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outAffines[i] = parentAffine * affines[i];
+    }
+    return outAffines.back();
+  };
+
+  BENCHMARK("point mat") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outPoints[i] = mats[i] * point;
+    }
+    return outPoints.back();
+  };
+
+  BENCHMARK("point affine") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outPoints[i] = affines[i] * point;
+    }
+    return outPoints.back();
+  };
+
+  BENCHMARK("invert mat") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outMats[i] = std::get<1>(invert(mats[i]));
+    }
+    return outMats.back();
+  };
+
+  BENCHMARK("invert affine") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outAffines[i] = std::get<1>(invert(affines[i]));
+    }
+    return outAffines.back();
+  };
+}
+} // namespace vm
@@ -0,0 +1,134 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <vecmath/forward.h>
+#include <vecmath/ray.h>
+#include <vecmath/vec.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace vm {
+/**
+ * Returns the given number of vectors with components drawn uniformly from [min, max]. The same
+ * seed always yields the same vectors so that benchmark runs are comparable.
+ */
+template <typename T, std::size_t S>
+std::vector<vec<T, S>> random_vecs(
+  const std::size_t count, const T min, const T max, const unsigned int seed = 1u) {
+  auto rng = std::mt19937(seed);
+  auto dist = std::uniform_real_distribution<T>(min, max);
+
+  std::vector<vec<T, S>> result;
+  result.reserve(count);
+  for (std::size_t i = 0u; i < count; ++i) {
+    vec<T, S> v;
+    for (std::size_t j = 0u; j < S; ++j) {
+      v[j] = dist(rng);
+    }
+    result.push_back(v);
+  }
+  return result;
+}
+
+/**
+ * Returns the triangles of a height field with the given number of cells per side, two triangles
+ * per cell.
+ */
+inline std::vector<vec3f> terrain(const std::size_t cells) {
+  const auto height = [](const std::size_t x, const std::size_t y) {
+    const auto fx = static_cast<float>(x);
+    const auto fy = static_cast<float>(y);
+    return 20.0f * std::sin(fx * 0.05f) * std::cos(fy * 0.03f) + 5.0f * std::sin(fx * fy * 0.001f);
+  };
+  const auto point = [&](const std::size_t x, const std::size_t y) {
+    return vec3f(static_cast<float>(x), static_cast<float>(y), height(x, y));
+  };
+
+  auto result = std::vector<vec3f>();
+  result.reserve(cells * cells * 6u);
+  for (std::size_t y = 0; y < cells; ++y) {
+    for (std::size_t x = 0; x < cells; ++x) {
+      result.push_back(point(x, y));
+      result.push_back(point(x + 1u, y));
+      result.push_back(point(x + 1u, y + 1u));
+      result.push_back(point(x, y));
+      result.push_back(point(x + 1u, y + 1u));
+      result.push_back(point(x, y + 1u));
+    }
+  }
+  return result;
+}
+
+/**
+ * Returns the given number of normalized rays that point down from above a height field returned
+ * by terrain(cells) to random points in the plane below.
+ */
+inline std::vector<ray3f> terrain_rays(const std::size_t cells, const std::size_t count) {
+  const auto extent = static_cast<float>(cells);
+  const auto origins = random_vecs<float, 3>(count, 0.0f, extent, 1u);
+  const auto targets = random_vecs<float, 3>(count, 0.0f, extent, 2u);
+  auto result = std::vector<ray3f>();
+  for (std::size_t i = 0; i < origins.size(); ++i) {
+    const auto origin = vec3f(origins[i].x(), origins[i].y(), 100.0f);
+    const auto target = vec3f(targets[i].x(), targets[i].y(), 0.0f);
+    result.emplace_back(origin, normalize(target - origin));
+  }
+  return result;
+}
+
+/**
+ * Calls the given function repeatedly for at least the given duration and prints how many items
+ * per second it processes, assuming that each call processes the given number of items. Catch only
+ * reports the time per call, which is harder to compare between benchmarks of different sizes.
+ *
+ * The result of each call is accumulated into a volatile sink so that the calls are not optimized
+ * away.
+ */
+template <typename F>
+void report_throughput(
+  const std::string& name,
+  const std::size_t itemsPerCall,
+  F f,
+  const std::chrono::milliseconds duration = std::chrono::milliseconds(200)) {
+  using clock = std::chrono::steady_clock;
+
+  volatile double sink = 0.0;
+  auto calls = std::size_t(0);
+  const auto start = clock::now();
+  auto elapsed = clock::duration::zero();
+  do {
+    sink = sink + static_cast<double>(f());
+    ++calls;
+    elapsed = clock::now() - start;
+  } while (elapsed < duration);
+
+  const auto seconds = std::chrono::duration<double>(elapsed).count();
+  const auto itemsPerSecond = static_cast<double>(calls * itemsPerCall) / seconds;
+  std::cout << name << ": " << itemsPerSecond / 1.0e6 << " M/s\n";
+}
+} // namespace vm
@@ -0,0 +1,133 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/bvh.h>
+#include <vecmath/forward.h>
+#include <vecmath/intersection.h>
+#include <vecmath/parallel.h>
+#include <vecmath/ray.h>
+#include <vecmath/vec.h>
+
+#include "benchmark_utils.h"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("bvh.benchmark") {
+  // about one million triangles
+  constexpr auto cells = std::size_t(708);
+  const auto vertices = terrain(cells);
+  const auto triangleCount = vertices.size() / 3u;
+
+  const auto build = [&](const std::string& name, const auto& policy) {
+    auto tree = bvh<float, 3>();
+    report_throughput(
+      name, triangleCount,
+      [&]() {
+        tree = make_triangle_bvh(policy, vertices);
+        return tree.nodes().size();
+      },
+      std::chrono::milliseconds(1000));
+    std::cout << name << ": SAH cost " << tree.sah_cost() << ", " << tree.nodes().size()
+              << " nodes\n";
+    return tree;
+  };
+
+  const auto tree = build("build sequential", parallel_policy<sequential_executor>());
+  build(
+    "build with " + std::to_string(thread_executor().concurrency()) + " threads",
+    parallel_policy<>());
+
+  const auto rays = terrain_rays(cells, 1000u);
+
+  auto stats = traversal_stats();
+  for (const auto& r : rays) {
+    intersect_ray_triangles(r, tree, vertices, &stats);
+  }
+  std::cout << "first hit: "
+            << static_cast<double>(stats.visited_nodes) / static_cast<double>(rays.size())
+            << " nodes visited per ray\n";
+
+  report_throughput("first hit", rays.size(), [&]() {
+    auto sum = 0.0f;
+    for (const auto& r : rays) {
+      const auto [index, distance] = intersect_ray_triangles(r, tree, vertices);
+      if (index != bvh<float, 3>::null_index) {
+        sum += distance;
+      }
+    }
+    return sum;
+  });
+}
+
+TEST_CASE("bvh.benchmark_packets") {
+  constexpr auto cells = std::size_t(708);
+  const auto vertices = terrain(cells);
+  const auto tree = make_triangle_bvh(vertices);
+
+  // a 256x256 image of the terrain seen from above one of its corners, in scanline order
+  constexpr auto size = std::size_t(256);
+  const auto extent = static_cast<float>(cells);
+  const auto origin = vec3f(-0.2f * extent, -0.2f * extent, 200.0f);
+  auto rays = std::vector<ray3f>();
+  for (std::size_t y = 0; y < size; ++y) {
+    for (std::size_t x = 0; x < size; ++x) {
+      const auto target = vec3f(
+        extent * static_cast<float>(x) / static_cast<float>(size),
+        extent * static_cast<float>(y) / static_cast<float>(size), 0.0f);
+      rays.emplace_back(origin, normalize(target - origin));
+    }
+  }
+
+  const auto first_hits = [&](const std::string& name, const auto& f) {
+    auto stats = traversal_stats();
+    auto hits = std::vector<std::tuple<std::size_t, float>>();
+    f(hits, &stats);
+    std::cout << name << ": "
+              << static_cast<double>(stats.visited_nodes) / static_cast<double>(rays.size())
+              << " nodes visited per ray\n";
+
+    report_throughput(name, rays.size(), [&]() {
+      f(hits, nullptr);
+      return std::get<1>(hits[rays.size() / 2u]);
+    });
+  };
+
+  first_hits("first hit per ray", [&](auto& hits, traversal_stats* stats) {
+    hits.resize(rays.size());
+    for (std::size_t i = 0; i < rays.size(); ++i) {
+      hits[i] = intersect_ray_triangles(rays[i], tree, vertices, stats);
+    }
+  });
+  first_hits("first hit packets of 4", [&](auto& hits, traversal_stats* stats) {
+    intersect_ray_triangles<4u>(rays, tree, vertices, hits, stats);
+  });
+  first_hits("first hit packets of 8", [&](auto& hits, traversal_stats* stats) {
+    intersect_ray_triangles<8u>(rays, tree, vertices, hits, stats);
+  });
+}
+} // namespace vm
@@ -0,0 +1,130 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/bezier_surface.h>
+#include <vecmath/expr.h>
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+
+#include "benchmark_utils.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+// evaluate_quadratic_bezier_surface, with the interpolation written as a lazy expression
+template <typename T, size_t C>
+static vec<T, C> evaluate_quadratic_bezier_surface_lazy(
+  const std::array<std::array<vec<T, C>, 3>, 3>& controlPoints, const T u, const T v) {
+  const auto bernsteinPolynomial_0 = [](const auto x) {
+    return static_cast<T>(1) - static_cast<T>(2) * x + (x * x);
+  };
+
+  const auto bernsteinPolynomial_1 = [](const auto x) {
+    return static_cast<T>(2) * (x - (x * x));
+  };
+
+  const auto bernsteinPolynomial_2 = [](const auto x) {
+    return x * x;
+  };
+
+  const auto interpolate = [&](const auto x, const std::array<vec<T, C>, 3>& p) {
+    return eval(
+      bernsteinPolynomial_0(x) * lazy(p[0]) + bernsteinPolynomial_1(x) * lazy(p[1]) +
+      bernsteinPolynomial_2(x) * lazy(p[2]));
+  };
+
+  return interpolate(
+    v, {
+         interpolate(u, controlPoints[0]),
+         interpolate(u, controlPoints[1]),
+         interpolate(u, controlPoints[2]),
+       });
+}
+
+TEST_CASE("expr.benchmark_bezier") {
+  constexpr auto count = std::size_t(10000);
+  const auto points = random_vecs<double, 3>(9u, -100.0, 100.0);
+  const auto controlPoints = std::array<std::array<vec3d, 3>, 3>{{
+    {points[0], points[1], points[2]},
+    {points[3], points[4], points[5]},
+    {points[6], points[7], points[8]},
+  }};
+  const auto params = random_vecs<double, 2>(count, 0.0, 1.0);
+
+  std::vector<vec3d> out(count);
+
+  BENCHMARK("bezier eager") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out[i] = evaluate_quadratic_bezier_surface(controlPoints, params[i].x(), params[i].y());
+    }
+    return out.back();
+  };
+
+  BENCHMARK("bezier lazy") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out[i] = evaluate_quadratic_bezier_surface_lazy(controlPoints, params[i].x(), params[i].y());
+    }
+    return out.back();
+  };
+}
+
+TEST_CASE("expr.benchmark_mat_chain") {
+  constexpr auto count = std::size_t(10000);
+  const auto offsets = random_vecs<double, 3>(count, -100.0, 100.0);
+  const auto x = rotation_matrix(normalize(vec3d(1.0, 2.0, 3.0)), 0.5) *
+                 scaling_matrix(vec3d(2.0, 1.0, 0.5));
+
+  std::vector<mat4x4d> out(count);
+
+  BENCHMARK("mat chain eager") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out[i] = translation_matrix(offsets[i]) * x * translation_matrix(-offsets[i]);
+    }
+    return out.back();
+  };
+
+  BENCHMARK("mat chain lazy") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out[i] = lazy(translation_matrix(offsets[i])) * x * translation_matrix(-offsets[i]);
+    }
+    return out.back();
+  };
+
+  BENCHMARK("mat sum eager") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out[i] = x * offsets[i].x() + x * offsets[i].y() - x / offsets[i].z();
+    }
+    return out.back();
+  };
+
+  BENCHMARK("mat sum lazy") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out[i] = lazy(x) * offsets[i].x() + lazy(x) * offsets[i].y() - lazy(x) / offsets[i].z();
+    }
+    return out.back();
+  };
+}
+} // namespace vm
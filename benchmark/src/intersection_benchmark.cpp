@@ -0,0 +1,69 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/bbox.h>
+#include <vecmath/forward.h>
+#include <vecmath/intersection.h>
+#include <vecmath/ray.h>
+#include <vecmath/ray_query.h>
+#include <vecmath/vec.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("intersection.benchmark_ray_bbox") {
+  constexpr auto count = std::size_t(8192);
+  const auto mins = random_vecs<float, 3>(count, -1000.0f, 1000.0f, 1u);
+  const auto sizes = random_vecs<float, 3>(count, 1.0f, 200.0f, 2u);
+  auto boxes = std::vector<bbox3f>();
+  boxes.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    boxes.emplace_back(mins[i], mins[i] + sizes[i]);
+  }
+
+  const auto r = ray3f(vec3f(0.0f, 0.0f, -2000.0f), normalize(vec3f(0.1f, 0.2f, 1.0f)));
+  const auto q = ray_query3f(r);
+
+  report_throughput("ray", count, [&]() {
+    auto hits = std::size_t(0);
+    for (const auto& b : boxes) {
+      if (!is_nan(intersect_ray_bbox(r, b))) {
+        ++hits;
+      }
+    }
+    return hits;
+  });
+  report_throughput("ray query", count, [&]() {
+    auto hits = std::size_t(0);
+    for (const auto& b : boxes) {
+      if (!is_nan(std::get<0>(intersect_ray_bbox(q, b)))) {
+        ++hits;
+      }
+    }
+    return hits;
+  });
+}
+} // namespace vm
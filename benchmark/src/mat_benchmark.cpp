@@ -0,0 +1,390 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/uninitialized.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec3a.h>
+#include <vecmath/vec_ext.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+template <typename T, std::size_t S>
+static std::vector<mat<T, S, S>> random_mats(const std::size_t count) {
+  const auto columns = random_vecs<T, S>(count * S, static_cast<T>(-10), static_cast<T>(10));
+
+  std::vector<mat<T, S, S>> result(count);
+  for (std::size_t i = 0u; i < count; ++i) {
+    for (std::size_t c = 0u; c < S; ++c) {
+      result[i][c] = columns[i * S + c];
+    }
+  }
+  return result;
+}
+
+static std::vector<mat4x4d> random_affine_mats(const std::size_t count) {
+  const auto params = random_vecs<double, 3>(count * 3u, 0.5, 10.0);
+
+  std::vector<mat4x4d> result;
+  result.reserve(count);
+  for (std::size_t i = 0u; i < count; ++i) {
+    result.push_back(
+      translation_matrix(params[i * 3u]) *
+      rotation_matrix(normalize(params[i * 3u + 1u]), params[i * 3u].x()) *
+      scaling_matrix(params[i * 3u + 2u]));
+  }
+  return result;
+}
+
+// the generic matrix products, as computed without SIMD kernels
+template <typename T, std::size_t S>
+static mat<T, S, S> generic_multiply(const mat<T, S, S>& lhs, const mat<T, S, S>& rhs) {
+  auto result = mat<T, S, S>::zero();
+  for (std::size_t c = 0; c < S; c++) {
+    for (std::size_t r = 0; r < S; r++) {
+      for (std::size_t i = 0; i < S; ++i) {
+        result[c][r] += lhs[i][r] * rhs[c][i];
+      }
+    }
+  }
+  return result;
+}
+
+template <typename T, std::size_t S>
+static vec<T, S> generic_multiply(const mat<T, S, S>& lhs, const vec<T, S>& rhs) {
+  vec<T, S> result;
+  for (std::size_t r = 0; r < S; r++) {
+    for (std::size_t c = 0; c < S; ++c) {
+      result[r] += lhs[c][r] * rhs[c];
+    }
+  }
+  return result;
+}
+
+template <typename T> static void benchmark_multiply(const std::string& type) {
+  // small enough for the operands to stay in the L1 cache, so that the arithmetic is measured
+  constexpr auto count = std::size_t(64);
+  const auto lhs = random_mats<T, 4>(count);
+  const auto rhs = random_mats<T, 4>(count);
+  const auto points = random_vecs<T, 4>(count, static_cast<T>(-10), static_cast<T>(10));
+
+  std::vector<mat<T, 4, 4>> outMats(count);
+  std::vector<vec<T, 4>> outVecs(count);
+
+  const auto mulMat = [&]() {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outMats[i] = lhs[i] * rhs[i];
+    }
+    return outMats.back()[0][0];
+  };
+  const auto mulMatGeneric = [&]() {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outMats[i] = generic_multiply(lhs[i], rhs[i]);
+    }
+    return outMats.back()[0][0];
+  };
+  const auto mulVec = [&]() {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outVecs[i] = lhs[i] * points[i];
+    }
+    return outVecs.back()[0];
+  };
+  const auto mulVecGeneric = [&]() {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outVecs[i] = generic_multiply(lhs[i], points[i]);
+    }
+    return outVecs.back()[0];
+  };
+
+  report_throughput(type + " mat*mat", count, mulMat);
+  report_throughput(type + " mat*mat generic", count, mulMatGeneric);
+  report_throughput(type + " mat*vec", count, mulVec);
+  report_throughput(type + " mat*vec generic", count, mulVecGeneric);
+
+  BENCHMARK(type + " mat*mat") { return mulMat(); };
+  BENCHMARK(type + " mat*mat generic") { return mulMatGeneric(); };
+  BENCHMARK(type + " mat*vec") { return mulVec(); };
+  BENCHMARK(type + " mat*vec generic") { return mulVecGeneric(); };
+}
+
+TEST_CASE("mat.benchmark_multiply") {
+  benchmark_multiply<float>("mat4f");
+  benchmark_multiply<double>("mat4d");
+}
+
+TEST_CASE("mat.benchmark_multiply_vectors") {
+  constexpr auto count = std::size_t(8192);
+  const auto points = random_vecs<float, 3>(count, -1000.0f, 1000.0f);
+  const auto transform = translation_matrix(vec3f(12.0f, -4.0f, 128.0f)) *
+                         rotation_matrix(normalize(vec3f(1.0f, 2.0f, 3.0f)), 0.5f);
+
+  std::vector<vec3f> out(count);
+  report_throughput("point transform operator", count, [&]() {
+    const auto result = transform * points;
+    return result.back().x();
+  });
+  report_throughput("point transform loop", count, [&]() {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out[i] = transform * points[i];
+    }
+    return out.back().x();
+  });
+  report_throughput("point transform multiply", count, [&]() {
+    multiply(transform, points, out);
+    return out.back().x();
+  });
+
+  report_throughput("translate operator", count, [&]() {
+    const auto result = points + vec3f(1.0f, 2.0f, 3.0f);
+    return result.back().x();
+  });
+  report_throughput("translate add", count, [&]() {
+    add(points, vec3f(1.0f, 2.0f, 3.0f), out);
+    return out.back().x();
+  });
+}
+
+TEST_CASE("mat.benchmark_multiply_padded_vectors") {
+  constexpr auto count = std::size_t(8192);
+  const auto packed = random_vecs<float, 3>(count, -1000.0f, 1000.0f);
+  const auto padded = std::vector<vec3fa>(std::begin(packed), std::end(packed));
+  const auto transform = translation_matrix(vec3f(12.0f, -4.0f, 128.0f)) *
+                         rotation_matrix(normalize(vec3f(1.0f, 2.0f, 3.0f)), 0.5f);
+
+  std::vector<vec3f> packedOut(count);
+  std::vector<vec3fa> paddedOut(count);
+  report_throughput("point transform packed", count, [&]() {
+    multiply(transform, packed.data(), packed.data() + count, packedOut.data());
+    return packedOut.back().x();
+  });
+  report_throughput("point transform padded", count, [&]() {
+    multiply(transform, padded.data(), padded.data() + count, paddedOut.data());
+    return paddedOut.back().x();
+  });
+  report_throughput("translate packed", count, [&]() {
+    add(packed.data(), packed.data() + count, vec3f(1.0f, 2.0f, 3.0f), packedOut.data());
+    return packedOut.back().x();
+  });
+  report_throughput("translate padded", count, [&]() {
+    add(padded.data(), padded.data() + count, vec3f(1.0f, 2.0f, 3.0f), paddedOut.data());
+    return paddedOut.back().x();
+  });
+}
+
+TEST_CASE("mat.benchmark_allocate_output") {
+  constexpr auto count = std::size_t(8192);
+  const auto points = random_vecs<float, 3>(count, -1000.0f, 1000.0f);
+  const auto mats = std::vector<mat4x4d>(count, translation_matrix(vec3d(1.0, 2.0, 3.0)));
+  const auto transform = translation_matrix(vec3f(12.0f, -4.0f, 128.0f)) *
+                         rotation_matrix(normalize(vec3f(1.0f, 2.0f, 3.0f)), 0.5f);
+
+  report_throughput("point transform into initialized", count, [&]() {
+    auto out = std::vector<vec3f>(count);
+    multiply(transform, points.data(), points.data() + count, out.data());
+    return out.back().x();
+  });
+  report_throughput("point transform into uninitialized", count, [&]() {
+    auto out = std::vector<vec3f, uninitialized_allocator<vec3f>>(count);
+    multiply(transform, points.data(), points.data() + count, out.data());
+    return out.back().x();
+  });
+  report_throughput("mat copy into initialized", count, [&]() {
+    auto out = std::vector<mat4x4d>(count);
+    std::memcpy(out.data(), mats.data(), count * sizeof(mat4x4d));
+    return out.back()[3][0];
+  });
+  report_throughput("mat copy into uninitialized", count, [&]() {
+    auto out = std::vector<mat4x4d, uninitialized_allocator<mat4x4d>>(count);
+    std::memcpy(out.data(), mats.data(), count * sizeof(mat4x4d));
+    return out.back()[3][0];
+  });
+}
+
+// points_transformation_matrix as it was computed before, by solving a 9x9 system
+static mat4x4d points_transformation_matrix_lup(
+  const vec3d& onPlane0In, const vec3d& onPlane1In, const vec3d& onPlane2In,
+  const vec3d& offPlaneIn, const vec3d& onPlane0Out, const vec3d& onPlane1Out,
+  const vec3d& onPlane2Out, const vec3d& offPlaneOut) {
+  const auto i0 = onPlane1In - onPlane0In;
+  const auto i1 = onPlane2In - onPlane0In;
+  const auto i2 = offPlaneIn - onPlane0In;
+  const auto o0 = onPlane1Out - onPlane0Out;
+  const auto o1 = onPlane2Out - onPlane0Out;
+  const auto o2 = offPlaneOut - onPlane0Out;
+
+  const vec<double, 9> B{o0.x(), o0.y(), o0.z(), o1.x(), o1.y(), o1.z(), o2.x(), o2.y(), o2.z()};
+
+  mat<double, 9, 9> A = mat<double, 9, 9>::zero();
+  const vec3d in[3] = {i0, i1, i2};
+  for (std::size_t v = 0u; v < 3u; ++v) {
+    for (std::size_t r = 0u; r < 3u; ++r) {
+      for (std::size_t c = 0u; c < 3u; ++c) {
+        A[r * 3u + c][v * 3u + r] = in[v][c];
+      }
+    }
+  }
+
+  const auto [success, X] = lup_solve(A, B);
+  if (!success) {
+    return mat4x4d::fill(nan<double>());
+  }
+
+  const mat4x4d xformWithoutTranslation(
+    X[0], X[1], X[2], 0.0, X[3], X[4], X[5], 0.0, X[6], X[7], X[8], 0.0, 0.0, 0.0, 0.0, 1.0);
+  return translation_matrix(onPlane0Out) * xformWithoutTranslation *
+         translation_matrix(-onPlane0In);
+}
+
+TEST_CASE("mat.benchmark_points_transformation") {
+  constexpr auto count = std::size_t(1000);
+  const auto in = random_vecs<double, 3>(count * 4u, -100.0, 100.0);
+  const auto out = random_vecs<double, 3>(count * 4u, -100.0, 100.0, 2u);
+
+  std::vector<mat4x4d> result(count);
+
+  BENCHMARK("points transformation lup") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      const auto* p = &in[i * 4u];
+      const auto* q = &out[i * 4u];
+      result[i] =
+        points_transformation_matrix_lup(p[0], p[1], p[2], p[3], q[0], q[1], q[2], q[3]);
+    }
+    return result.back();
+  };
+
+  BENCHMARK("points transformation") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      const auto* p = &in[i * 4u];
+      const auto* q = &out[i * 4u];
+      result[i] = points_transformation_matrix(p[0], p[1], p[2], p[3], q[0], q[1], q[2], q[3]);
+    }
+    return result.back();
+  };
+}
+
+TEST_CASE("mat.benchmark_invert") {
+  constexpr auto count = std::size_t(10000);
+  const auto general = random_mats<double, 4>(count);
+  const auto affine = random_affine_mats(count);
+  const auto small = random_mats<double, 3>(count);
+
+  std::vector<mat4x4d> out4(count);
+  std::vector<mat3x3d> out3(count);
+
+  BENCHMARK("invert4 lup") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out4[i] = std::get<1>(detail::invert_lup(general[i]));
+    }
+    return out4.back();
+  };
+
+  BENCHMARK("invert4 closed") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out4[i] = std::get<1>(invert(general[i]));
+    }
+    return out4.back();
+  };
+
+  BENCHMARK("invert4 affine lup") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out4[i] = std::get<1>(detail::invert_lup(affine[i]));
+    }
+    return out4.back();
+  };
+
+  BENCHMARK("invert4 affine") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out4[i] = std::get<1>(invert(affine[i]));
+    }
+    return out4.back();
+  };
+
+  BENCHMARK("invert3 lup") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out3[i] = std::get<1>(detail::invert_lup(small[i]));
+    }
+    return out3.back();
+  };
+
+  BENCHMARK("invert3 closed") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      out3[i] = std::get<1>(invert(small[i]));
+    }
+    return out3.back();
+  };
+}
+
+// the recursive cofactor expansion that compute_determinant used for all S > 3
+template <typename T, std::size_t S> static T laplace_determinant(const mat<T, S, S>& m) {
+  if constexpr (S == 1u) {
+    return m[0][0];
+  } else {
+    auto result = static_cast<T>(0.0);
+    for (std::size_t r = 0; r < S; r++) {
+      const auto f = static_cast<T>(r % 2 == 0 ? 1.0 : -1.0);
+      result += f * m[0][r] * laplace_determinant(extract_minor(m, r, 0));
+    }
+    return result;
+  }
+}
+
+template <std::size_t S> static void benchmark_determinant(const bool withLaplace) {
+  constexpr auto count = std::size_t(1000);
+  const auto mats = random_mats<double, S>(count);
+
+  BENCHMARK("det" + std::to_string(S)) {
+    auto result = 0.0;
+    for (std::size_t i = 0u; i < count; ++i) {
+      result += compute_determinant(mats[i]);
+    }
+    return result;
+  };
+
+  if (withLaplace) {
+    BENCHMARK("det" + std::to_string(S) + " laplace") {
+      auto result = 0.0;
+      for (std::size_t i = 0u; i < count; ++i) {
+        result += laplace_determinant(mats[i]);
+      }
+      return result;
+    };
+  }
+}
+
+template <std::size_t... S> static void benchmark_determinants(std::index_sequence<S...>) {
+  (benchmark_determinant<S + 2u>(S + 2u >= 4u && S + 2u <= 7u), ...);
+}
+
+TEST_CASE("mat.benchmark_determinant") {
+  benchmark_determinants(std::make_index_sequence<11u>());
+}
+} // namespace vm
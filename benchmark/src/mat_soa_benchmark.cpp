@@ -0,0 +1,132 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/mat.h>
+#include <vecmath/mat_soa.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_soa.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+template <typename T, std::size_t S>
+static void benchmark_lup_solve(const std::string& name, const std::size_t count) {
+  // diagonally dominant, so that every system can be solved, but the off diagonal elements still
+  // make the pivots differ between the systems
+  const auto columns = random_vecs<T, S>(count * S, static_cast<T>(-1), static_cast<T>(1), 1u);
+  std::vector<mat<T, S, S>> mats(count);
+  for (std::size_t i = 0u; i < count; ++i) {
+    for (std::size_t c = 0u; c < S; ++c) {
+      for (std::size_t r = 0u; r < S; ++r) {
+        mats[i][c][r] = columns[i * S + c][r] + (c == r ? static_cast<T>(S) : static_cast<T>(0));
+      }
+    }
+  }
+  const auto rhs = random_vecs<T, S>(count, static_cast<T>(-10), static_cast<T>(10), 2u);
+  const auto matsSoa = mat_soa<T, S, S>(mats);
+  const auto rhsSoa = vec_soa<T, S>(rhs);
+
+  std::vector<vec<T, S>> out(count);
+  auto outSoa = vec_soa<T, S>(count);
+  std::vector<bool> success(count);
+
+  const auto loop = [&]() {
+    for (std::size_t i = 0u; i < count; ++i) {
+      const auto result = lup_solve(mats[i], rhs[i]);
+      success[i] = std::get<0>(result);
+      out[i] = std::get<1>(result);
+    }
+    return out.back()[0];
+  };
+  const auto batch = [&]() {
+    lup_solve(matsSoa, rhsSoa, outSoa, success);
+    return outSoa.data(0)[count - 1u];
+  };
+
+  report_throughput(name + " lup_solve loop", count, loop);
+  report_throughput(name + " lup_solve soa", count, batch);
+
+  BENCHMARK(name + " lup_solve loop") { return loop(); };
+  BENCHMARK(name + " lup_solve soa") { return batch(); };
+}
+
+TEST_CASE("mat_soa.benchmark_lup_solve") {
+  constexpr auto count = std::size_t(4096);
+  benchmark_lup_solve<float, 3>("mat3f", count);
+  benchmark_lup_solve<double, 3>("mat3d", count);
+  benchmark_lup_solve<float, 4>("mat4f", count);
+  benchmark_lup_solve<double, 4>("mat4d", count);
+}
+
+template <typename T>
+static void benchmark_invert(const std::string& name, const std::size_t count) {
+  const auto columns = random_vecs<T, 4>(count * 4u, static_cast<T>(-10), static_cast<T>(10));
+  std::vector<mat<T, 4, 4>> mats(count);
+  for (std::size_t i = 0u; i < count; ++i) {
+    for (std::size_t c = 0u; c < 4u; ++c) {
+      mats[i][c] = columns[i * 4u + c];
+    }
+  }
+  const auto matsSoa = mat_soa<T, 4, 4>(mats);
+
+  std::vector<mat<T, 4, 4>> out(count);
+  auto outSoa = mat_soa<T, 4, 4>(count);
+  std::vector<bool> invertible(count);
+
+  const auto loop = [&]() {
+    for (std::size_t i = 0u; i < count; ++i) {
+      const auto result = invert(mats[i]);
+      invertible[i] = std::get<0>(result);
+      out[i] = std::get<1>(result);
+    }
+    return out.back()[0][0];
+  };
+  const auto array = [&]() {
+    invert(mats, out, invertible);
+    return out.back()[0][0];
+  };
+  const auto soa = [&]() {
+    invert(matsSoa, outSoa, invertible);
+    return outSoa.data(0, 0)[count - 1u];
+  };
+
+  report_throughput(name + " invert loop", count, loop);
+  report_throughput(name + " invert array", count, array);
+  report_throughput(name + " invert soa", count, soa);
+
+  BENCHMARK(name + " invert loop") { return loop(); };
+  BENCHMARK(name + " invert array") { return array(); };
+  BENCHMARK(name + " invert soa") { return soa(); };
+}
+
+TEST_CASE("mat_soa.benchmark_invert") {
+  // the number of objects in a large selection
+  constexpr auto count = std::size_t(50000);
+  benchmark_invert<float>("mat4f", count);
+  benchmark_invert<double>("mat4d", count);
+}
+} // namespace vm
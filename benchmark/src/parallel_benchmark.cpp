@@ -0,0 +1,67 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/bbox.h>
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/parallel.h>
+#include <vecmath/vec.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("parallel.benchmark") {
+  constexpr auto count = std::size_t(1u << 20u);
+  const auto points = random_vecs<float, 3>(count, -1000.0f, 1000.0f);
+  const auto transform = translation_matrix(vec3f(12.0f, -4.0f, 128.0f)) *
+                         rotation_matrix(normalize(vec3f(1.0f, 2.0f, 3.0f)), 0.5f);
+  const auto policy = parallel_policy<>();
+  std::cout << "threads: " << policy.executor().concurrency() << "\n";
+
+  std::vector<vec3f> out(count);
+  report_throughput("average serial", count, [&]() {
+    return average(std::begin(points), std::end(points)).x();
+  });
+  report_throughput("average parallel", count, [&]() {
+    return average(policy, std::begin(points), std::end(points)).x();
+  });
+  report_throughput("merge_all serial", count, [&]() {
+    return bbox3f::merge_all(std::begin(points), std::end(points)).min.x();
+  });
+  report_throughput("merge_all parallel", count, [&]() {
+    return merge_all(policy, std::begin(points), std::end(points)).min.x();
+  });
+  report_throughput("point transform serial", count, [&]() {
+    multiply(transform, points, out);
+    return out.back().x();
+  });
+  report_throughput("point transform parallel", count, [&]() {
+    multiply(policy, transform, points, out);
+    return out.back().x();
+  });
+}
+} // namespace vm
@@ -0,0 +1,97 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/forward.h>
+#include <vecmath/intersection.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/ray.h>
+#include <vecmath/simd_dispatch.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_soa.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("simd_dispatch.benchmark") {
+  // small enough for all operands to stay in the L2 cache, so that this measures the kernels rather
+  // than the memory bandwidth
+  constexpr auto count = std::size_t(8192);
+  const auto lhs = vec_soa<float, 3>(random_vecs<float, 3>(count, -1000.0f, 1000.0f, 1u));
+  const auto rhs = vec_soa<float, 3>(random_vecs<float, 3>(count, -1000.0f, 1000.0f, 2u));
+  const auto transform = translation_matrix(vec3f(12.0f, -4.0f, 128.0f)) *
+                         rotation_matrix(normalize(vec3f(1.0f, 2.0f, 3.0f)), 0.5f);
+
+  const auto r = ray3f(vec3f(0.0f, 0.0f, -2000.0f), normalize(vec3f(0.1f, 0.2f, 1.0f)));
+  const auto mins = random_vecs<float, 3>(count, -1000.0f, 1000.0f, 3u);
+  auto maxs = mins;
+  for (auto& max : maxs) {
+    max = max + vec3f(200.0f, 200.0f, 200.0f);
+  }
+  const auto minsSoa = vec_soa<float, 3>(mins);
+  const auto maxsSoa = vec_soa<float, 3>(maxs);
+  const auto p1 = vec_soa<float, 3>(random_vecs<float, 3>(count, -1000.0f, 1000.0f, 4u));
+  const auto p2 = vec_soa<float, 3>(random_vecs<float, 3>(count, -1000.0f, 1000.0f, 5u));
+  const auto p3 = vec_soa<float, 3>(random_vecs<float, 3>(count, -1000.0f, 1000.0f, 6u));
+
+  std::vector<float> outf(count);
+  auto outSoa = vec_soa<float, 3>(count);
+
+  const std::pair<simd_isa, std::string> isas[] = {
+    {simd_isa::scalar, "scalar"},
+    {simd_isa::sse2, "sse2"},
+    {simd_isa::avx2, "avx2"},
+    {simd_isa::avx512, "avx512"}};
+  for (const auto& [isa, name] : isas) {
+    if (select_simd_isa(isa) != isa) {
+      continue;
+    }
+
+    report_throughput(name + " dot", count, [&]() {
+      dot(lhs, rhs, outf);
+      return outf.back();
+    });
+    report_throughput(name + " normalize", count, [&]() {
+      normalize(lhs, outSoa);
+      return outSoa[count - 1u].x();
+    });
+    report_throughput(name + " point transform", count, [&]() {
+      multiply(transform, lhs, outSoa);
+      return outSoa[count - 1u].x();
+    });
+    report_throughput(name + " ray bbox", count, [&]() {
+      intersect_ray_bbox(r, minsSoa, maxsSoa, outf);
+      return outf.back();
+    });
+    report_throughput(name + " ray triangle", count, [&]() {
+      intersect_ray_triangle(r, p1, p2, p3, outf);
+      return outf.back();
+    });
+  }
+  select_simd_isa(supported_simd_isa());
+}
+} // namespace vm
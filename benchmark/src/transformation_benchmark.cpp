@@ -0,0 +1,155 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/bbox.h>
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/plane.h>
+#include <vecmath/ray.h>
+#include <vecmath/transformation.h>
+#include <vecmath/vec.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+static void benchmark_transform(const std::string& name, const mat4x4d& m) {
+  constexpr auto count = std::size_t(10000);
+  const auto points = random_vecs<double, 3>(count * 2u, -100.0, 100.0);
+
+  std::vector<plane3d> planes;
+  std::vector<ray3d> rays;
+  std::vector<bbox3d> boxes;
+  for (std::size_t i = 0u; i < count; ++i) {
+    const auto& p = points[i * 2u];
+    const auto n = normalize(points[i * 2u + 1u]);
+    planes.emplace_back(p, n);
+    rays.emplace_back(p, n);
+    boxes.emplace_back(min(p, points[i * 2u + 1u]), max(p, points[i * 2u + 1u]));
+  }
+
+  const auto t = transformation3d(m);
+  std::vector<plane3d> outPlanes(count);
+  std::vector<ray3d> outRays(count);
+  std::vector<bbox3d> outBoxes(count);
+
+  BENCHMARK(name + " plane mat") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outPlanes[i] = planes[i].transform(m);
+    }
+    return outPlanes.back();
+  };
+
+  BENCHMARK(name + " plane transformation") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outPlanes[i] = planes[i].transform(t);
+    }
+    return outPlanes.back();
+  };
+
+  BENCHMARK(name + " ray mat") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outRays[i] = rays[i].transform(m);
+    }
+    return outRays.back();
+  };
+
+  BENCHMARK(name + " ray transformation") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outRays[i] = rays[i].transform(t);
+    }
+    return outRays.back();
+  };
+
+  BENCHMARK(name + " bbox mat") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outBoxes[i] = boxes[i].transform(m);
+    }
+    return outBoxes.back();
+  };
+
+  BENCHMARK(name + " bbox transformation") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outBoxes[i] = boxes[i].transform(t);
+    }
+    return outBoxes.back();
+  };
+}
+
+TEST_CASE("transformation.benchmark") {
+  benchmark_transform("translation", translation_matrix(vec3d(12.0, -4.0, 128.0)));
+  benchmark_transform(
+    "rigid",
+    translation_matrix(vec3d(12.0, -4.0, 128.0)) *
+      rotation_matrix(normalize(vec3d(1.0, 2.0, 3.0)), 0.5));
+  benchmark_transform(
+    "affine",
+    scaling_matrix(vec3d(2.0, 0.5, 3.0)) * rotation_matrix(normalize(vec3d(1.0, 2.0, 3.0)), 0.5));
+}
+
+TEST_CASE("transformation.benchmark_planes") {
+  // a selection of 20000 brushes with 6 faces each
+  constexpr auto count = std::size_t(120000);
+  const auto params = random_vecs<float, 3>(count * 2u, -100.0f, 100.0f);
+
+  std::vector<plane3f> planes;
+  planes.reserve(count);
+  for (std::size_t i = 0u; i < count; ++i) {
+    planes.emplace_back(params[i * 2u], normalize(params[i * 2u + 1u]));
+  }
+  std::vector<plane3f> out(count);
+
+  const auto rigid = translation_matrix(vec3f(12.0f, -4.0f, 128.0f)) *
+                     rotation_matrix(normalize(vec3f(1.0f, 2.0f, 3.0f)), 0.5f);
+  const auto affine = scaling_matrix(vec3f(2.0f, 0.5f, 3.0f)) * rigid;
+
+  for (const auto& [name, m] :
+       {std::make_tuple("rigid", rigid), std::make_tuple("affine", affine)}) {
+    const auto t = transformation3f(m);
+    const auto loopMat = [&]() {
+      for (std::size_t i = 0u; i < count; ++i) {
+        out[i] = planes[i].transform(m);
+      }
+      return out.back().distance;
+    };
+    const auto loopTransformation = [&]() {
+      for (std::size_t i = 0u; i < count; ++i) {
+        out[i] = planes[i].transform(t);
+      }
+      return out.back().distance;
+    };
+    const auto batch = [&]() {
+      transform(planes, t, out);
+      return out.back().distance;
+    };
+
+    report_throughput(std::string(name) + " planes mat", count, loopMat);
+    report_throughput(std::string(name) + " planes transformation", count, loopTransformation);
+    report_throughput(std::string(name) + " planes batch", count, batch);
+  }
+}
+} // namespace vm
@@ -0,0 +1,91 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/transformation.h>
+#include <vecmath/transformation_hierarchy.h>
+#include <vecmath/vec.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("transformation_hierarchy.benchmark") {
+  // 10 levels of groups with 2 to 3 children each, about 10000 nodes in total
+  constexpr auto count = std::size_t(10000);
+  const auto params = random_vecs<double, 3>(count * 2u, 0.5, 10.0);
+
+  std::vector<mat4x4d> locals;
+  std::vector<std::size_t> parents;
+  auto hierarchy = transformation_hierarchy<double, 3>();
+  for (std::size_t i = 0u; i < count; ++i) {
+    locals.push_back(
+      translation_matrix(params[i * 2u]) *
+      rotation_matrix(normalize(params[i * 2u + 1u]), params[i * 2u].x()));
+    parents.push_back(i == 0u ? hierarchy.no_parent : (i - 1u) * 2u / 5u);
+    hierarchy.add_node(locals.back(), parents.back());
+  }
+  hierarchy.update();
+
+  // a node at depth 6 with a subtree of about 10 nodes
+  const auto edited = std::size_t(1000);
+  const auto edit = translation_matrix(vec3d(1.0, 0.0, 0.0));
+
+  std::vector<mat4x4d> world(count);
+  std::vector<mat4x4d> inverse(count);
+
+  BENCHMARK("recompute all") {
+    locals[edited] = locals[edited] * edit;
+    for (std::size_t i = 0u; i < count; ++i) {
+      world[i] = parents[i] == hierarchy.no_parent ? locals[i] : world[parents[i]] * locals[i];
+      inverse[i] = std::get<1>(invert(world[i]));
+    }
+    return inverse.back();
+  };
+
+  BENCHMARK("hierarchy edit and query all") {
+    hierarchy.set_local(edited, hierarchy.local(edited).matrix() * edit);
+    auto sum = 0.0;
+    for (std::size_t i = 0u; i < count; ++i) {
+      sum += hierarchy.world(i).inverse()[3][0];
+    }
+    return sum;
+  };
+
+  BENCHMARK("hierarchy edit and update") {
+    hierarchy.set_local(edited, hierarchy.local(edited).matrix() * edit);
+    hierarchy.update();
+    return hierarchy.world(count - 1u).inverse();
+  };
+
+  BENCHMARK("hierarchy edit and query edited leaf") {
+    hierarchy.set_local(edited, hierarchy.local(edited).matrix() * edit);
+    return hierarchy.world(hierarchy.children(hierarchy.children(edited).front()).front())
+      .inverse();
+  };
+}
+} // namespace vm
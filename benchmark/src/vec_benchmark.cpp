@@ -0,0 +1,121 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/forward.h>
+#include <vecmath/intersection.h>
+#include <vecmath/ray.h>
+#include <vecmath/vec.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("vec.benchmark_transform") {
+  constexpr auto count = std::size_t(100000);
+  const auto points = random_vecs<float, 4>(count, -1000.0f, 1000.0f);
+  const auto pointsd = random_vecs<double, 4>(count, -1000.0, 1000.0);
+
+  // a column major affine transformation expressed as four column vectors
+  const auto c0 = vec4f(0.8f, 0.2f, -0.1f, 0.0f);
+  const auto c1 = vec4f(-0.2f, 0.9f, 0.3f, 0.0f);
+  const auto c2 = vec4f(0.1f, -0.3f, 0.95f, 0.0f);
+  const auto c3 = vec4f(12.0f, -4.0f, 128.0f, 1.0f);
+  const auto c0d = vec4d(c0);
+  const auto c1d = vec4d(c1);
+  const auto c2d = vec4d(c2);
+  const auto c3d = vec4d(c3);
+
+  std::vector<vec4f> out(count);
+  std::vector<vec4d> outd(count);
+
+  BENCHMARK("vec4f column transform") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      const auto& p = points[i];
+      out[i] = c0 * p[0] + c1 * p[1] + c2 * p[2] + c3 * p[3];
+    }
+    return out.back();
+  };
+
+  BENCHMARK("vec4d column transform") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      const auto& p = pointsd[i];
+      outd[i] = c0d * p[0] + c1d * p[1] + c2d * p[2] + c3d * p[3];
+    }
+    return outd.back();
+  };
+
+  std::vector<vec4f> outn(count);
+  BENCHMARK("vec4f normalize") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outn[i] = normalize(points[i]);
+    }
+    return outn.back();
+  };
+
+  BENCHMARK("vec4f min / max bounds") {
+    auto min = points.front();
+    auto max = points.front();
+    for (const auto& p : points) {
+      min = vm::min(min, p);
+      max = vm::max(max, p);
+    }
+    return min + max;
+  };
+
+  BENCHMARK("vec4d dot") {
+    auto sum = 0.0;
+    for (const auto& p : pointsd) {
+      sum += dot(p, c3d);
+    }
+    return sum;
+  };
+}
+
+TEST_CASE("vec.benchmark_pick") {
+  constexpr auto count = std::size_t(100000);
+  const auto vertices = random_vecs<float, 3>(3u * count, -1000.0f, 1000.0f);
+  const auto r = ray3f(vec3f(0.0f, 0.0f, 2000.0f), vec3f::neg_z());
+
+  BENCHMARK("ray / triangle picking") {
+    auto closest = std::numeric_limits<float>::max();
+    for (std::size_t i = 0u; i < vertices.size(); i += 3u) {
+      const auto d = intersect_ray_triangle(r, vertices[i], vertices[i + 1u], vertices[i + 2u]);
+      if (!is_nan(d) && d < closest) {
+        closest = d;
+      }
+    }
+    return closest;
+  };
+
+  const auto others = random_vecs<float, 3>(count, -1000.0f, 1000.0f);
+  BENCHMARK("vec3f squared distance") {
+    auto sum = 0.0f;
+    for (const auto& p : others) {
+      sum += squared_distance(p, r.origin);
+    }
+    return sum;
+  };
+}
+} // namespace vm
@@ -0,0 +1,123 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_soa.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("vec_soa.benchmark") {
+  // small enough for all operands to stay in the L2 cache, so that this measures the kernels rather
+  // than the memory bandwidth
+  constexpr auto count = std::size_t(8192);
+  const auto lhs = random_vecs<float, 3>(count, -1000.0f, 1000.0f, 1u);
+  const auto rhs = random_vecs<float, 3>(count, -1000.0f, 1000.0f, 2u);
+  const auto lhsSoa = vec_soa<float, 3>(lhs);
+  const auto rhsSoa = vec_soa<float, 3>(rhs);
+
+  const auto transform = translation_matrix(vec3f(12.0f, -4.0f, 128.0f)) *
+                         rotation_matrix(normalize(vec3f(1.0f, 2.0f, 3.0f)), 0.5f);
+
+  std::vector<float> outf(count);
+  std::vector<vec3f> outv(count);
+  auto outSoa = vec_soa<float, 3>(count);
+
+  BENCHMARK("aos dot") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outf[i] = dot(lhs[i], rhs[i]);
+    }
+    return outf.back();
+  };
+
+  BENCHMARK("soa dot") {
+    dot(lhsSoa, rhsSoa, outf);
+    return outf.back();
+  };
+
+  BENCHMARK("aos cross") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outv[i] = cross(lhs[i], rhs[i]);
+    }
+    return outv.back();
+  };
+
+  BENCHMARK("soa cross") {
+    cross(lhsSoa, rhsSoa, outSoa);
+    return outSoa[count - 1u];
+  };
+
+  BENCHMARK("aos normalize") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outv[i] = normalize(lhs[i]);
+    }
+    return outv.back();
+  };
+
+  BENCHMARK("soa normalize") {
+    normalize(lhsSoa, outSoa);
+    return outSoa[count - 1u];
+  };
+
+  BENCHMARK("aos squared_distance") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outf[i] = squared_distance(lhs[i], rhs[i]);
+    }
+    return outf.back();
+  };
+
+  BENCHMARK("soa squared_distance") {
+    squared_distance(lhsSoa, rhsSoa, outf);
+    return outf.back();
+  };
+
+  BENCHMARK("aos min") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outv[i] = min(lhs[i], rhs[i]);
+    }
+    return outv.back();
+  };
+
+  BENCHMARK("soa min") {
+    min(lhsSoa, rhsSoa, outSoa);
+    return outSoa[count - 1u];
+  };
+
+  BENCHMARK("aos point transform") {
+    for (std::size_t i = 0u; i < count; ++i) {
+      outv[i] = transform * lhs[i];
+    }
+    return outv.back();
+  };
+
+  BENCHMARK("soa point transform") {
+    multiply(transform, lhsSoa, outSoa);
+    return outSoa[count - 1u];
+  };
+}
+} // namespace vm
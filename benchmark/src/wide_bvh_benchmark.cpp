@@ -0,0 +1,69 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/bvh.h>
+#include <vecmath/forward.h>
+#include <vecmath/ray.h>
+#include <vecmath/traversal.h>
+#include <vecmath/vec.h>
+#include <vecmath/wide_bvh.h>
+
+#include "benchmark_utils.h"
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("wide_bvh.benchmark") {
+  // about one million triangles
+  constexpr auto cells = std::size_t(708);
+  const auto vertices = terrain(cells);
+  const auto rays = terrain_rays(cells, 1000u);
+
+  const auto binary = make_triangle_bvh(vertices);
+  const auto first_hit = [&](const std::string& name, const auto& tree) {
+    auto stats = traversal_stats();
+    for (const auto& r : rays) {
+      intersect_ray_triangles(r, tree, vertices, &stats);
+    }
+    std::cout << name << ": " << tree.nodes().size() << " nodes, "
+              << static_cast<double>(stats.visited_nodes) / static_cast<double>(rays.size())
+              << " nodes visited per ray\n";
+
+    report_throughput(name, rays.size(), [&]() {
+      auto sum = 0.0f;
+      for (const auto& r : rays) {
+        const auto [index, distance] = intersect_ray_triangles(r, tree, vertices);
+        if (index != bvh<float, 3>::null_index) {
+          sum += distance;
+        }
+      }
+      return sum;
+    });
+  };
+
+  first_hit("first hit binary", binary);
+  first_hit("first hit bvh4", bvh4f(binary));
+  first_hit("first hit bvh8", bvh8f(binary));
+}
+} // namespace vm
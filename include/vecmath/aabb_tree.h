@@ -0,0 +1,698 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "bbox.h"
+#include "intersection.h"
+#include "plane.h"
+#include "ray.h"
+#include "ray_query.h"
+#include "scalar.h"
+#include "traversal.h"
+#include "util.h"
+#include "vec.h"
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace vm {
+namespace detail {
+/**
+ * Determines the position of the given bounding box relative to the given plane.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param p the plane
+ * @param b the bounding box
+ * @return above if the box is entirely above the plane, below if it is entirely below, and inside
+ * if the plane intersects the box
+ */
+template <typename T, size_t S>
+constexpr plane_status bbox_plane_status(const plane<T, S>& p, const bbox<T, S>& b) {
+  auto minDistance = -p.distance;
+  auto maxDistance = -p.distance;
+  for (size_t i = 0; i < S; ++i) {
+    if (p.normal[i] >= static_cast<T>(0.0)) {
+      minDistance += p.normal[i] * b.min[i];
+      maxDistance += p.normal[i] * b.max[i];
+    } else {
+      minDistance += p.normal[i] * b.max[i];
+      maxDistance += p.normal[i] * b.min[i];
+    }
+  }
+
+  if (minDistance > static_cast<T>(0.0)) {
+    return plane_status::above;
+  } else if (maxDistance < static_cast<T>(0.0)) {
+    return plane_status::below;
+  } else {
+    return plane_status::inside;
+  }
+}
+} // namespace detail
+
+/**
+ * A dynamic bounding volume hierarchy of axis aligned bounding boxes. Every leaf stores a bounding
+ * box and a user value, and every inner node stores the union of the bounding boxes of its two
+ * children.
+ *
+ * Leaves can be inserted, removed and moved in logarithmic time. A new leaf is inserted as the
+ * sibling of the node that minimizes the surface area added to the tree, and the tree is kept
+ * balanced by rotating nodes on the path to the root. The bounding box of a leaf is enlarged by a
+ * margin so that small movements of an object can be handled without changing the tree, see
+ * move().
+ *
+ * Queries take a visitor that is called with the handle of every leaf whose bounding box matches
+ * the query. Since the leaf boxes are enlarged, the visitor must test the object itself if exact
+ * results are required. Queries do not modify the tree, so they can run concurrently.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @tparam U the type of the user values, must be default constructible
+ */
+template <typename T, size_t S, typename U> class aabb_tree {
+public:
+  using component_type = T;
+  static constexpr std::size_t size_value = S;
+  using box_type = bbox<T, S>;
+  using data_type = U;
+
+  /**
+   * Identifies a leaf of the tree. A handle remains valid until its leaf is removed.
+   */
+  using handle = std::size_t;
+
+  /**
+   * A handle that does not identify any leaf.
+   */
+  static constexpr handle null_handle = std::numeric_limits<handle>::max();
+
+private:
+  struct node {
+    box_type bounds;
+    // the parent of this node, or the next free node if this node is free
+    handle parent;
+    handle child1;
+    handle child2;
+    // 0 for leaves, -1 for free nodes
+    int height;
+    U data;
+
+    bool is_leaf() const { return child1 == null_handle; }
+  };
+
+  struct hit_candidate {
+    handle node;
+    T distance;
+  };
+
+  T m_margin;
+  std::vector<node> m_nodes;
+  handle m_root;
+  handle m_freeList;
+  std::size_t m_leafCount;
+
+public:
+  /**
+   * Creates a new empty tree.
+   *
+   * @param margin the value by which the bounding box of every leaf is enlarged on each side
+   */
+  explicit aabb_tree(const T margin = static_cast<T>(0.0))
+    : m_margin(margin)
+    , m_root(null_handle)
+    , m_freeList(null_handle)
+    , m_leafCount(0u) {
+    assert(margin >= static_cast<T>(0.0));
+  }
+
+  /**
+   * Returns the number of leaves in this tree.
+   */
+  std::size_t size() const { return m_leafCount; }
+
+  /**
+   * Indicates whether this tree has no leaves.
+   */
+  bool empty() const { return m_root == null_handle; }
+
+  /**
+   * Returns the height of this tree, which is 0 if the tree is empty or has a single leaf.
+   */
+  std::size_t height() const {
+    return empty() ? 0u : static_cast<std::size_t>(m_nodes[m_root].height);
+  }
+
+  /**
+   * Returns the bounding box of all leaves of this tree. The tree must not be empty.
+   */
+  const box_type& bounds() const {
+    assert(!empty());
+    return m_nodes[m_root].bounds;
+  }
+
+  /**
+   * Returns the enlarged bounding box of the leaf with the given handle.
+   *
+   * @param h the handle of the leaf
+   * @return the bounding box of the leaf, which contains the box passed to insert() or move()
+   */
+  const box_type& bounds(const handle h) const {
+    assert(is_leaf(h));
+    return m_nodes[h].bounds;
+  }
+
+  /**
+   * Returns the user value of the leaf with the given handle.
+   *
+   * @param h the handle of the leaf
+   */
+  const U& data(const handle h) const {
+    assert(is_leaf(h));
+    return m_nodes[h].data;
+  }
+
+  /**
+   * Returns the user value of the leaf with the given handle.
+   *
+   * @param h the handle of the leaf
+   */
+  U& data(const handle h) {
+    assert(is_leaf(h));
+    return m_nodes[h].data;
+  }
+
+  /**
+   * Removes all leaves from this tree.
+   */
+  void clear() {
+    m_nodes.clear();
+    m_root = null_handle;
+    m_freeList = null_handle;
+    m_leafCount = 0u;
+  }
+
+  /**
+   * Inserts a leaf with the given bounding box and user value.
+   *
+   * @param b the bounding box of the leaf
+   * @param value the user value of the leaf
+   * @return the handle of the new leaf
+   */
+  handle insert(const box_type& b, U value) {
+    const auto leaf = allocate_node();
+    m_nodes[leaf].bounds = b.expand(m_margin);
+    m_nodes[leaf].data = std::move(value);
+    m_nodes[leaf].height = 0;
+    insert_leaf(leaf);
+    ++m_leafCount;
+    return leaf;
+  }
+
+  /**
+   * Removes the leaf with the given handle.
+   *
+   * @param h the handle of the leaf
+   */
+  void remove(const handle h) {
+    assert(is_leaf(h));
+    remove_leaf(h);
+    free_node(h);
+    --m_leafCount;
+  }
+
+  /**
+   * Sets the bounding box of the leaf with the given handle. The tree is only changed if the
+   * enlarged bounding box of the leaf does not contain the given box, or if it is much larger than
+   * the given box, that is, if the given box shrank by more than the margin.
+   *
+   * @param h the handle of the leaf
+   * @param b the new bounding box of the leaf
+   * @return true if the leaf was reinserted into the tree and false otherwise
+   */
+  bool move(const handle h, const box_type& b) {
+    assert(is_leaf(h));
+    const auto& current = m_nodes[h].bounds;
+    if (
+      current.contains(b) &&
+      b.expand(static_cast<T>(2.0) * m_margin).contains(current)) {
+      return false;
+    }
+
+    remove_leaf(h);
+    m_nodes[h].bounds = b.expand(m_margin);
+    insert_leaf(h);
+    return true;
+  }
+
+  /**
+   * Calls the given visitor with the handle of every leaf whose bounding box intersects the given
+   * bounding box.
+   *
+   * @tparam F the type of the visitor
+   * @param b the bounding box
+   * @param f the visitor
+   * @param stats if not null, the visited nodes are added to this
+   */
+  template <typename F>
+  void find_intersectors(const box_type& b, F f, traversal_stats* stats = nullptr) const {
+    auto visitedNodes = std::size_t(0);
+    auto visitedLeaves = std::size_t(0);
+
+    auto stack = detail::traversal_stack<handle>();
+    if (!empty()) {
+      stack.push(m_root);
+    }
+    while (!stack.empty()) {
+      const auto h = stack.pop();
+      const auto& n = m_nodes[h];
+      ++visitedNodes;
+      if (n.bounds.intersects(b)) {
+        if (n.is_leaf()) {
+          ++visitedLeaves;
+          f(h);
+        } else {
+          stack.push(n.child2);
+          stack.push(n.child1);
+        }
+      } else if (n.is_leaf()) {
+        ++visitedLeaves;
+      }
+    }
+
+    detail::add_traversal_stats(stats, visitedNodes, visitedLeaves);
+  }
+
+  /**
+   * Calls the given visitor with the handle of every leaf whose bounding box is hit by the given
+   * ray. The leaves are visited in no particular order.
+   *
+   * @tparam F the type of the visitor
+   * @param r the ray
+   * @param f the visitor
+   * @param stats if not null, the visited nodes are added to this
+   */
+  template <typename F>
+  void find_hits(const ray<T, S>& r, F f, traversal_stats* stats = nullptr) const {
+    auto visitedNodes = std::size_t(0);
+    auto visitedLeaves = std::size_t(0);
+
+    const auto q = ray_query<T, S>(r);
+    auto stack = detail::traversal_stack<handle>();
+    if (!empty()) {
+      stack.push(m_root);
+    }
+    while (!stack.empty()) {
+      const auto h = stack.pop();
+      const auto& n = m_nodes[h];
+      ++visitedNodes;
+      if (n.is_leaf()) {
+        ++visitedLeaves;
+      }
+      if (!is_nan(std::get<0>(intersect_ray_bbox(q, n.bounds)))) {
+        if (n.is_leaf()) {
+          f(h);
+        } else {
+          stack.push(n.child2);
+          stack.push(n.child1);
+        }
+      }
+    }
+
+    detail::add_traversal_stats(stats, visitedNodes, visitedLeaves);
+  }
+
+  /**
+   * Finds the closest object hit by the given ray. The given function is called with the handle of
+   * a leaf whose bounding box is hit by the ray, and it returns the distance from the origin of the
+   * ray to the object of that leaf, or NaN if the object is not hit. The children of a node are
+   * visited in the order in which the ray enters their bounding boxes, and nodes that the ray
+   * enters beyond the closest hit found so far are skipped.
+   *
+   * @tparam F the type of the hit function
+   * @param r the ray
+   * @param hit the hit function
+   * @param stats if not null, the visited nodes are added to this
+   * @return the handle of the leaf whose object is hit first and the distance to the hit, or
+   * null_handle and NaN if no object is hit
+   */
+  template <typename F>
+  std::tuple<handle, T> find_first_hit(
+    const ray<T, S>& r, F hit, traversal_stats* stats = nullptr) const {
+    auto visitedNodes = std::size_t(0);
+    auto visitedLeaves = std::size_t(0);
+
+    auto bestHandle = null_handle;
+    auto bestDistance = std::numeric_limits<T>::infinity();
+
+    const auto q = ray_query<T, S>(r);
+    const auto entry_distance = [&](const handle h) {
+      const auto tNear = std::get<0>(intersect_ray_bbox(q, m_nodes[h].bounds));
+      // keeps NaN if the ray misses the box
+      return tNear < static_cast<T>(0.0) ? static_cast<T>(0.0) : tNear;
+    };
+
+    auto stack = detail::traversal_stack<hit_candidate>();
+    if (!empty()) {
+      const auto distance = entry_distance(m_root);
+      if (!is_nan(distance)) {
+        stack.push({m_root, distance});
+      }
+    }
+    while (!stack.empty()) {
+      const auto candidate = stack.pop();
+      if (candidate.distance > bestDistance) {
+        continue;
+      }
+
+      const auto& n = m_nodes[candidate.node];
+      ++visitedNodes;
+      if (n.is_leaf()) {
+        ++visitedLeaves;
+        const auto distance = hit(candidate.node);
+        if (!is_nan(distance) && distance < bestDistance) {
+          bestHandle = candidate.node;
+          bestDistance = distance;
+        }
+      } else {
+        const auto distance1 = entry_distance(n.child1);
+        const auto distance2 = entry_distance(n.child2);
+        const auto push = [&](const handle h, const T distance) {
+          if (!is_nan(distance) && distance <= bestDistance) {
+            stack.push({h, distance});
+          }
+        };
+        // the nearer child is pushed last so that it is visited first
+        if (distance1 <= distance2) {
+          push(n.child2, distance2);
+          push(n.child1, distance1);
+        } else {
+          push(n.child1, distance1);
+          push(n.child2, distance2);
+        }
+      }
+    }
+
+    detail::add_traversal_stats(stats, visitedNodes, visitedLeaves);
+    return bestHandle == null_handle ? std::make_tuple(null_handle, nan<T>())
+                                     : std::make_tuple(bestHandle, bestDistance);
+  }
+
+  /**
+   * Calls the given visitor with the handle of every leaf whose bounding box is not entirely above
+   * any of the given planes. For a view frustum, the planes are its side, near and far planes with
+   * their normals pointing out of the frustum. The test is conservative, so the visitor may be
+   * called for leaves whose bounding box is outside of the frustum, but close to one of its edges.
+   * If the bounding box of a node is entirely below all planes, the visitor is called for all
+   * leaves below that node without testing them.
+   *
+   * @tparam I the type of the plane iterators
+   * @tparam F the type of the visitor
+   * @param cur the start of the range of planes
+   * @param end the end of the range of planes
+   * @param f the visitor
+   * @param stats if not null, the visited nodes are added to this
+   */
+  template <typename I, typename F>
+  void find_in_frustum(I cur, I end, F f, traversal_stats* stats = nullptr) const {
+    auto visitedNodes = std::size_t(0);
+    auto visitedLeaves = std::size_t(0);
+
+    auto stack = detail::traversal_stack<handle>();
+    if (!empty()) {
+      stack.push(m_root);
+    }
+    while (!stack.empty()) {
+      const auto h = stack.pop();
+      const auto& n = m_nodes[h];
+      ++visitedNodes;
+      if (n.is_leaf()) {
+        ++visitedLeaves;
+      }
+
+      auto outside = false;
+      auto inside = true;
+      for (auto it = cur; it != end && !outside; ++it) {
+        switch (detail::bbox_plane_status(*it, n.bounds)) {
+          case plane_status::above:
+            outside = true;
+            break;
+          case plane_status::inside:
+            inside = false;
+            break;
+          case plane_status::below:
+            break;
+        }
+      }
+
+      if (outside) {
+        continue;
+      } else if (n.is_leaf()) {
+        f(h);
+      } else if (inside) {
+        for_each_leaf(n.child1, f, visitedNodes, visitedLeaves);
+        for_each_leaf(n.child2, f, visitedNodes, visitedLeaves);
+      } else {
+        stack.push(n.child2);
+        stack.push(n.child1);
+      }
+    }
+
+    detail::add_traversal_stats(stats, visitedNodes, visitedLeaves);
+  }
+
+private:
+  bool is_leaf(const handle h) const {
+    return h < m_nodes.size() && m_nodes[h].height == 0 && m_nodes[h].is_leaf();
+  }
+
+  template <typename F>
+  void for_each_leaf(
+    const handle start, F& f, std::size_t& visitedNodes, std::size_t& visitedLeaves) const {
+    auto stack = detail::traversal_stack<handle>();
+    stack.push(start);
+    while (!stack.empty()) {
+      const auto h = stack.pop();
+      const auto& n = m_nodes[h];
+      ++visitedNodes;
+      if (n.is_leaf()) {
+        ++visitedLeaves;
+        f(h);
+      } else {
+        stack.push(n.child2);
+        stack.push(n.child1);
+      }
+    }
+  }
+
+  handle allocate_node() {
+    if (m_freeList == null_handle) {
+      m_nodes.push_back(node{box_type(), null_handle, null_handle, null_handle, 0, U()});
+      return m_nodes.size() - 1u;
+    }
+
+    const auto h = m_freeList;
+    m_freeList = m_nodes[h].parent;
+    m_nodes[h].parent = null_handle;
+    m_nodes[h].child1 = null_handle;
+    m_nodes[h].child2 = null_handle;
+    m_nodes[h].height = 0;
+    return h;
+  }
+
+  void free_node(const handle h) {
+    m_nodes[h].parent = m_freeList;
+    m_nodes[h].height = -1;
+    m_nodes[h].data = U();
+    m_freeList = h;
+  }
+
+  /**
+   * Inserts the given leaf as the sibling of the node for which the cost of the insertion is
+   * minimal. The cost is the surface area of the new parent node plus the increase of the surface
+   * area of its ancestors, see Catto, "Dynamic Bounding Volume Hierarchies", GDC 2019.
+   */
+  void insert_leaf(const handle leaf) {
+    if (m_root == null_handle) {
+      m_root = leaf;
+      m_nodes[leaf].parent = null_handle;
+      return;
+    }
+
+    const auto leafBounds = m_nodes[leaf].bounds;
+    auto sibling = m_root;
+    while (!m_nodes[sibling].is_leaf()) {
+      const auto& n = m_nodes[sibling];
+      const auto area = n.bounds.surface_area();
+      const auto combinedArea = merge(n.bounds, leafBounds).surface_area();
+
+      // the cost of making the leaf a sibling of this node
+      const auto cost = static_cast<T>(2.0) * combinedArea;
+      // the cost of pushing the leaf further down the tree
+      const auto inheritanceCost = static_cast<T>(2.0) * (combinedArea - area);
+      const auto descent_cost = [&](const handle child) {
+        const auto& c = m_nodes[child];
+        const auto childArea = merge(c.bounds, leafBounds).surface_area();
+        return c.is_leaf() ? childArea + inheritanceCost
+                           : childArea - c.bounds.surface_area() + inheritanceCost;
+      };
+      const auto cost1 = descent_cost(n.child1);
+      const auto cost2 = descent_cost(n.child2);
+
+      if (cost < cost1 && cost < cost2) {
+        break;
+      }
+      sibling = cost1 < cost2 ? n.child1 : n.child2;
+    }
+
+    const auto oldParent = m_nodes[sibling].parent;
+    const auto newParent = allocate_node();
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].child1 = sibling;
+    m_nodes[newParent].child2 = leaf;
+    m_nodes[newParent].bounds = merge(leafBounds, m_nodes[sibling].bounds);
+    m_nodes[newParent].height = m_nodes[sibling].height + 1;
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    if (oldParent == null_handle) {
+      m_root = newParent;
+    } else {
+      replace_child(oldParent, sibling, newParent);
+    }
+
+    refit_ancestors(newParent);
+  }
+
+  void remove_leaf(const handle leaf) {
+    if (leaf == m_root) {
+      m_root = null_handle;
+      return;
+    }
+
+    const auto parent = m_nodes[leaf].parent;
+    const auto grandParent = m_nodes[parent].parent;
+    const auto sibling =
+      m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    m_nodes[sibling].parent = grandParent;
+    if (grandParent == null_handle) {
+      m_root = sibling;
+    } else {
+      replace_child(grandParent, parent, sibling);
+    }
+    free_node(parent);
+    m_nodes[leaf].parent = null_handle;
+
+    if (grandParent != null_handle) {
+      refit_ancestors(grandParent);
+    }
+  }
+
+  void replace_child(const handle parent, const handle oldChild, const handle newChild) {
+    if (m_nodes[parent].child1 == oldChild) {
+      m_nodes[parent].child1 = newChild;
+    } else {
+      assert(m_nodes[parent].child2 == oldChild);
+      m_nodes[parent].child2 = newChild;
+    }
+  }
+
+  /**
+   * Rebalances the given node and its ancestors, and recomputes their bounds and heights.
+   */
+  void refit_ancestors(handle h) {
+    while (h != null_handle) {
+      h = balance(h);
+      refit(h);
+      h = m_nodes[h].parent;
+    }
+  }
+
+  void refit(const handle h) {
+    auto& n = m_nodes[h];
+    const auto& c1 = m_nodes[n.child1];
+    const auto& c2 = m_nodes[n.child2];
+    n.bounds = merge(c1.bounds, c2.bounds);
+    n.height = 1 + max(c1.height, c2.height);
+  }
+
+  /**
+   * If the heights of the children of the given node differ by more than one, the higher child is
+   * rotated up so that it replaces the given node. Returns the node that is at the position of the
+   * given node afterwards.
+   */
+  handle balance(const handle a) {
+    if (m_nodes[a].is_leaf() || m_nodes[a].height < 2) {
+      return a;
+    }
+
+    const auto b = m_nodes[a].child1;
+    const auto c = m_nodes[a].child2;
+    const auto difference = m_nodes[c].height - m_nodes[b].height;
+    if (difference > 1) {
+      return rotate_up(a, c, false);
+    } else if (difference < -1) {
+      return rotate_up(a, b, true);
+    } else {
+      return a;
+    }
+  }
+
+  /**
+   * Rotates the given child of the given node up so that it replaces the node. The node takes the
+   * place of the child, and the node adopts the lower child of the child.
+   */
+  handle rotate_up(const handle a, const handle up, const bool upIsChild1) {
+    const auto f = m_nodes[up].child1;
+    const auto g = m_nodes[up].child2;
+
+    // up takes the place of a
+    m_nodes[up].child1 = a;
+    m_nodes[up].parent = m_nodes[a].parent;
+    m_nodes[a].parent = up;
+    if (m_nodes[up].parent == null_handle) {
+      m_root = up;
+    } else {
+      replace_child(m_nodes[up].parent, a, up);
+    }
+
+    // up keeps its higher child, a adopts its lower child in place of up
+    const auto keep = m_nodes[f].height > m_nodes[g].height ? f : g;
+    const auto adopt = keep == f ? g : f;
+    m_nodes[up].child2 = keep;
+    if (upIsChild1) {
+      m_nodes[a].child1 = adopt;
+    } else {
+      m_nodes[a].child2 = adopt;
+    }
+    m_nodes[adopt].parent = a;
+
+    refit(a);
+    refit(up);
+    return up;
+  }
+};
+} // namespace vm
@@ -0,0 +1,322 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "mat.h"
+#include "vec.h"
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace vm {
+/**
+ * An affine transformation of S dimensional space, i.e. a linear transformation followed by a
+ * translation.
+ *
+ * An affine transformation is stored as a matrix with S rows and S + 1 columns. The first S columns
+ * are the linear part, and the last column is the translation. The last row of the equivalent
+ * homogeneous (S + 1) x (S + 1) matrix is always (0, ..., 0, 1) and is therefore not stored. This
+ * saves a row of memory per transformation, and composing and applying affine transformations
+ * skips the multiplications and the perspective division involving that row.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ */
+template <typename T, std::size_t S> class affine {
+public:
+  using type = T;
+  static const std::size_t size = S;
+
+  /**
+   * The linear part in the first S columns and the translation in the last column.
+   */
+  mat<T, S, S + 1> matrix;
+
+public:
+  /**
+   * Creates a new identity transformation.
+   */
+  constexpr affine()
+    : matrix{} {}
+
+  // Copy and move constructors
+  affine(const affine<T, S>& other) = default;
+  affine(affine<T, S>&& other) noexcept = default;
+
+  // Assignment operators
+  affine<T, S>& operator=(const affine<T, S>& other) = default;
+  affine<T, S>& operator=(affine<T, S>&& other) noexcept = default;
+
+  /**
+   * Creates a new transformation with the given linear part and translation.
+   *
+   * @param linear the linear part
+   * @param translation the translation
+   */
+  constexpr explicit affine(
+    const mat<T, S, S>& linear, const vec<T, S>& translation = vec<T, S>::zero())
+    : matrix{} {
+    for (std::size_t c = 0u; c < S; ++c) {
+      for (std::size_t r = 0u; r < S; ++r) {
+        matrix[c][r] = linear[c][r];
+      }
+    }
+    matrix[S] = translation;
+  }
+
+  /**
+   * Creates a new transformation from the given matrix, whose first S columns are the linear part
+   * and whose last column is the translation.
+   *
+   * @param i_matrix the matrix
+   */
+  constexpr explicit affine(const mat<T, S, S + 1>& i_matrix)
+    : matrix(i_matrix) {}
+
+  /**
+   * Creates a new transformation from the given homogeneous transformation matrix. The last row of
+   * the given matrix is ignored, so the given matrix must be affine, see is_affine.
+   *
+   * @param m the homogeneous transformation matrix
+   */
+  constexpr explicit affine(const mat<T, S + 1, S + 1>& m)
+    : matrix{} {
+    for (std::size_t c = 0u; c < S + 1u; ++c) {
+      for (std::size_t r = 0u; r < S; ++r) {
+        matrix[c][r] = m[c][r];
+      }
+    }
+  }
+
+  /**
+   * Creates a new transformation by converting the components of the given transformation using
+   * static_cast.
+   *
+   * @tparam U the component type of the given transformation
+   * @param other the transformation to convert
+   */
+  template <typename U>
+  constexpr explicit affine(const affine<U, S>& other)
+    : matrix(other.matrix) {}
+
+  /**
+   * Returns the identity transformation.
+   */
+  static constexpr affine<T, S> identity() { return affine<T, S>(); }
+
+  /**
+   * Returns a transformation that translates by the given offset.
+   *
+   * @param delta the offset
+   */
+  static constexpr affine<T, S> translation(const vec<T, S>& delta) {
+    return affine<T, S>(mat<T, S, S>::identity(), delta);
+  }
+
+  /**
+   * Returns a transformation that scales by the given factors.
+   *
+   * @param factors the scaling factors
+   */
+  static constexpr affine<T, S> scaling(const vec<T, S>& factors) {
+    mat<T, S, S> linear;
+    for (std::size_t i = 0u; i < S; ++i) {
+      linear[i][i] = factors[i];
+    }
+    return affine<T, S>(linear);
+  }
+
+  /**
+   * Returns the linear part of this transformation.
+   */
+  constexpr mat<T, S, S> linear() const {
+    mat<T, S, S> result;
+    for (std::size_t c = 0u; c < S; ++c) {
+      for (std::size_t r = 0u; r < S; ++r) {
+        result[c][r] = matrix[c][r];
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Returns the translation of this transformation.
+   */
+  constexpr const vec<T, S>& translation() const { return matrix[S]; }
+
+  /**
+   * Returns the equivalent homogeneous (S + 1) x (S + 1) transformation matrix.
+   */
+  constexpr mat<T, S + 1, S + 1> to_mat() const {
+    mat<T, S + 1, S + 1> result;
+    for (std::size_t c = 0u; c < S + 1u; ++c) {
+      for (std::size_t r = 0u; r < S; ++r) {
+        result[c][r] = matrix[c][r];
+      }
+    }
+    return result;
+  }
+};
+
+static_assert(std::is_trivially_copyable_v<affine<float, 3>>);
+static_assert(std::is_trivially_copyable_v<affine<double, 3>>);
+
+/* ========== comparison operators ========== */
+
+/**
+ * Checks whether the given transformations have equal components.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param lhs the first transformation
+ * @param rhs the second transformation
+ * @param epsilon the epsilon value
+ * @return true if all components of the given transformations are equal, and false otherwise
+ */
+template <typename T, std::size_t S>
+constexpr bool is_equal(const affine<T, S>& lhs, const affine<T, S>& rhs, const T epsilon) {
+  return is_equal(lhs.matrix, rhs.matrix, epsilon);
+}
+
+/**
+ * Checks whether the given transformations have identical components.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param lhs the first transformation
+ * @param rhs the second transformation
+ * @return true if all components of the given transformations are equal, and false otherwise
+ */
+template <typename T, std::size_t S>
+constexpr bool operator==(const affine<T, S>& lhs, const affine<T, S>& rhs) {
+  return lhs.matrix == rhs.matrix;
+}
+
+/**
+ * Checks whether the given transformations have identical components.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param lhs the first transformation
+ * @param rhs the second transformation
+ * @return false if all components of the given transformations are equal, and true otherwise
+ */
+template <typename T, std::size_t S>
+constexpr bool operator!=(const affine<T, S>& lhs, const affine<T, S>& rhs) {
+  return lhs.matrix != rhs.matrix;
+}
+
+/* ========== arithmetic operators ========== */
+
+/**
+ * Composes the given transformations. The resulting transformation first applies the right hand
+ * side and then the left hand side, just like the product of the equivalent matrices.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param lhs the transformation to apply second
+ * @param rhs the transformation to apply first
+ * @return the composed transformation
+ */
+template <typename T, std::size_t S>
+constexpr affine<T, S> operator*(const affine<T, S>& lhs, const affine<T, S>& rhs) {
+  affine<T, S> result;
+  for (std::size_t c = 0u; c < S + 1u; ++c) {
+    for (std::size_t r = 0u; r < S; ++r) {
+      auto sum = c == S ? lhs.matrix[S][r] : static_cast<T>(0.0);
+      for (std::size_t i = 0u; i < S; ++i) {
+        sum += lhs.matrix[i][r] * rhs.matrix[c][i];
+      }
+      result.matrix[c][r] = sum;
+    }
+  }
+  return result;
+}
+
+/**
+ * Applies the given transformation to the given point.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param lhs the transformation
+ * @param rhs the point
+ * @return the transformed point
+ */
+template <typename T, std::size_t S>
+constexpr vec<T, S> operator*(const affine<T, S>& lhs, const vec<T, S>& rhs) {
+  auto result = lhs.matrix[S];
+  for (std::size_t c = 0u; c < S; ++c) {
+    result = result + lhs.matrix[c] * rhs[c];
+  }
+  return result;
+}
+
+/**
+ * Applies the linear part of the given transformation to the given vector. Unlike a point, a
+ * vector is not translated.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param t the transformation
+ * @param v the vector
+ * @return the transformed vector
+ */
+template <typename T, std::size_t S>
+constexpr vec<T, S> transform_vector(const affine<T, S>& t, const vec<T, S>& v) {
+  auto result = vec<T, S>::zero();
+  for (std::size_t c = 0u; c < S; ++c) {
+    result = result + t.matrix[c] * v[c];
+  }
+  return result;
+}
+
+/**
+ * Inverts the given transformation. The linear part is inverted using invert, and the translation
+ * of the inverse is the negated original translation transformed by the inverted linear part.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param t the transformation to invert
+ * @return a pair of a boolean and a transformation such that the boolean indicates whether the
+ * transformation is invertible, and if so, the transformation is the inverted given transformation
+ */
+template <typename T, std::size_t S>
+constexpr std::tuple<bool, affine<T, S>> invert(const affine<T, S>& t) {
+  const auto linearInverse = invert(t.linear());
+  if (!std::get<0>(linearInverse)) {
+    return std::make_tuple(false, affine<T, S>());
+  }
+
+  const auto& inverse = std::get<1>(linearInverse);
+  auto result = affine<T, S>(inverse);
+
+  // the translation is -inverse * t
+  for (std::size_t r = 0u; r < S; ++r) {
+    auto sum = static_cast<T>(0.0);
+    for (std::size_t c = 0u; c < S; ++c) {
+      sum -= inverse[c][r] * t.matrix[S][c];
+    }
+    result.matrix[S][r] = sum;
+  }
+  return std::make_tuple(true, result);
+}
+} // namespace vm
@@ -20,12 +20,15 @@
 
 #pragma once
 
+#include "affine.h"
 #include "mat.h"
 #include "quat.h"
 #include "scalar.h"
+#include "transformation.h"
 #include "vec.h"
 
 #include <array>
+#include <type_traits>
 
 namespace vm {
 /**
@@ -116,6 +119,13 @@ public:
     : min(vec<T, S>::zero())
     , max(vec<T, S>::zero()) {}
 
+  /**
+   * Creates a new bounding box without initializing its corners.
+   */
+  explicit bbox(uninitialized_t)
+    : min(uninitialized)
+    , max(uninitialized) {}
+
   // Copy and move constructors
   bbox(const bbox<T, S>& other) = default;
   bbox(bbox<T, S>&& other) noexcept = default;
@@ -291,6 +301,28 @@ public:
     return result;
   }
 
+  /**
+   * Computes the surface area of this bounding box, that is, the sum of the areas of its faces. For
+   * two dimensional boxes, this is the perimeter.
+   *
+   * @return the surface area of this bounding box
+   */
+  constexpr T surface_area() const {
+    assert(is_valid());
+    const auto boxSize = size();
+    T result = static_cast<T>(0.0);
+    for (size_t i = 0; i < S; ++i) {
+      T face = static_cast<T>(1.0);
+      for (size_t j = 0; j < S; ++j) {
+        if (j != i) {
+          face *= boxSize[j];
+        }
+      }
+      result += face;
+    }
+    return static_cast<T>(2.0) * result;
+  }
+
   /**
    * Checks whether the given point is cointained in this bounding box.
    *
@@ -472,6 +504,49 @@ public:
     return builder.bounds();
   }
 
+  /**
+   * Transforms this bounding box using the given affine transformation. The result is the smallest
+   * bounding box that contains the transformed corner vertices. It is computed by transforming the
+   * center and by projecting the extents onto the absolute values of the linear part, which
+   * avoids transforming every corner vertex.
+   *
+   * @param transform the transformation
+   * @return the transformed bounding box
+   */
+  constexpr bbox<T, S> transform(const affine<T, S>& transform) const {
+    const auto halfSize = size() / static_cast<T>(2.0);
+    const auto newCenter = transform * center();
+
+    auto newHalfSize = vec<T, S>::zero();
+    for (std::size_t c = 0u; c < S; ++c) {
+      newHalfSize = newHalfSize + abs(transform.matrix[c]) * halfSize[c];
+    }
+    return bbox<T, S>(newCenter - newHalfSize, newCenter + newHalfSize);
+  }
+
+  /**
+   * Transforms this bounding box using the given transformation. A translation is applied by
+   * translating this bounding box, and other affine transformations are applied like the equivalent
+   * affine transformation, see above.
+   *
+   * @param transform the transformation
+   * @return the transformed bounding box
+   */
+  constexpr bbox<T, S> transform(const transformation<T, S>& transform) const {
+    switch (transform.kind()) {
+    case transformation_kind::identity:
+      return *this;
+    case transformation_kind::translation:
+      return translate(transform.translation());
+    case transformation_kind::rigid:
+    case transformation_kind::affine:
+      return this->transform(affine<T, S>(transform.matrix()));
+    case transformation_kind::projective:
+      break;
+    }
+    return this->transform(transform.matrix());
+  }
+
   /**
    * Executes the given operation on every face of this bounding box. For each face, its four
    * vertices are passed to the given operation in a clock wise manner.
@@ -565,6 +640,9 @@ public:
   }
 };
 
+static_assert(std::is_trivially_copyable_v<bbox<float, 3>>);
+static_assert(std::is_trivially_copyable_v<bbox<double, 3>>);
+
 /**
  * Checks whether the two given bounding boxes are identical.
  *
@@ -0,0 +1,918 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "bbox.h"
+#include "intersection.h"
+#include "parallel.h"
+#include "polygon.h"
+#include "ray.h"
+#include "ray_packet.h"
+#include "ray_query.h"
+#include "scalar.h"
+#include "traversal.h"
+#include "vec.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+namespace vm {
+/**
+ * The parameters of the surface area heuristic (SAH) that is used to build a bvh. The SAH
+ * estimates the cost of a node as the cost of traversing it plus the cost of intersecting the
+ * primitives of each child, weighted by the probability that a ray which hits the node also hits
+ * the child, which is the ratio of their surface areas.
+ *
+ * @tparam T the component type
+ */
+template <typename T> struct bvh_options {
+  /**
+   * The maximum number of primitives per leaf.
+   */
+  std::size_t max_leaf_size = 4u;
+
+  /**
+   * The cost of traversing an inner node.
+   */
+  T traversal_cost = static_cast<T>(1.0);
+
+  /**
+   * The cost of intersecting a primitive.
+   */
+  T intersection_cost = static_cast<T>(1.0);
+};
+
+/**
+ * A bounding volume hierarchy for a static set of primitives, built once from the bounding boxes
+ * of the primitives. Compared to aabb_tree, building takes longer, but the tree is of higher
+ * quality because every split is chosen with the surface area heuristic over all primitives of a
+ * node, and the nodes are stored more compactly.
+ *
+ * The nodes are stored in a vector with the root at index 0. The two children of an inner node are
+ * adjacent. A leaf refers to a range of primitive_indices(), which is a permutation of the indices
+ * of the primitives such that the primitives of every leaf are contiguous.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ */
+template <typename T, size_t S> class bvh {
+public:
+  using component_type = T;
+  using box_type = bbox<T, S>;
+
+  /**
+   * The index that find_first_hit returns if no primitive is hit.
+   */
+  static constexpr std::size_t null_index = std::numeric_limits<std::size_t>::max();
+
+  /**
+   * A node of the tree.
+   */
+  struct node {
+    /**
+     * The bounding box of all primitives below this node.
+     */
+    box_type bounds;
+
+    /**
+     * For inner nodes, the index of the first child, which is followed by the second child. For
+     * leaves, the index of the first primitive in primitive_indices().
+     */
+    std::size_t first;
+
+    /**
+     * For leaves, the number of primitives, which is never 0. For inner nodes, 0.
+     */
+    std::size_t count;
+
+    bool is_leaf() const { return count > 0u; }
+  };
+
+private:
+  static constexpr std::size_t bin_count = 16u;
+
+  struct range_info {
+    typename box_type::builder bounds;
+    typename box_type::builder centroidBounds;
+  };
+
+  struct bin {
+    typename box_type::builder bounds;
+    std::size_t count = 0u;
+  };
+
+  struct bins {
+    bin values[S][bin_count];
+  };
+
+  struct split {
+    bool valid = false;
+    std::size_t axis = 0u;
+    std::size_t bin = 0u;
+    T cost = std::numeric_limits<T>::infinity();
+  };
+
+  struct build_task {
+    std::size_t node;
+    std::size_t first;
+    std::size_t last;
+  };
+
+  struct hit_candidate {
+    std::size_t node;
+    T distance;
+  };
+
+  struct packet_candidate {
+    std::size_t node;
+    unsigned int lanes;
+  };
+
+  std::vector<node> m_nodes;
+  std::vector<std::size_t> m_indices;
+
+public:
+  /**
+   * Creates an empty tree.
+   */
+  bvh() = default;
+
+  /**
+   * Builds a tree for primitives with the given bounding boxes. The primitives are identified by
+   * their index in the given vector.
+   *
+   * @param bounds the bounding boxes of the primitives
+   * @param options the parameters of the surface area heuristic
+   */
+  explicit bvh(
+    const std::vector<box_type>& bounds, const bvh_options<T>& options = bvh_options<T>())
+    : bvh(parallel_policy<sequential_executor>(), bounds, options) {}
+
+  /**
+   * Builds a tree for primitives with the given bounding boxes using the given policy.
+   *
+   * The upper levels of the tree are built on the calling thread, and the work on their large
+   * nodes, namely computing the bounds and binning the primitives, is split into chunks that run
+   * in parallel. Once the nodes are small enough, their subtrees are built as independent tasks of
+   * the policy's executor, largest first. Threads that finish early take the next task that is
+   * left, which balances the load. Finally, the subtrees are copied into the tree in parallel. The
+   * resulting tree does not depend on the executor.
+   *
+   * @tparam E the executor type
+   * @param policy the parallel policy
+   * @param bounds the bounding boxes of the primitives
+   * @param options the parameters of the surface area heuristic
+   */
+  template <typename E>
+  bvh(
+    const parallel_policy<E>& policy,
+    const std::vector<box_type>& bounds,
+    const bvh_options<T>& options = bvh_options<T>())
+    : m_indices(bounds.size()) {
+    if (bounds.empty()) {
+      return;
+    }
+    std::iota(std::begin(m_indices), std::end(m_indices), std::size_t(0u));
+
+    const auto count = bounds.size();
+    auto centroids = std::vector<vec<T, S>>(count);
+    detail::for_each_chunk(policy, count, [&](const std::size_t first, const std::size_t last) {
+      for (auto i = first; i < last; ++i) {
+        centroids[i] = bounds[i].center();
+      }
+    });
+
+    // Build the upper levels and collect the subtrees that are left as tasks. With a single
+    // thread, the root is the only task.
+    const auto concurrency = policy.executor().concurrency();
+    const auto grain = concurrency > 1u
+                         ? std::max(count / (8u * concurrency), policy.chunk_size())
+                         : count;
+    auto tasks = std::vector<build_task>();
+    m_nodes.emplace_back();
+    build_node(&policy, bounds, centroids, options, m_nodes, 0u, 0u, count, grain, &tasks);
+
+    std::sort(std::begin(tasks), std::end(tasks), [](const build_task& lhs, const build_task& rhs) {
+      return lhs.last - lhs.first > rhs.last - rhs.first;
+    });
+    auto subtrees = std::vector<std::vector<node>>(tasks.size());
+    policy.executor().run(tasks.size(), [&](const std::size_t i) {
+      const auto& task = tasks[i];
+      subtrees[i].emplace_back();
+      build_node<E>(
+        nullptr, bounds, centroids, options, subtrees[i], 0u, task.first, task.last, 0u, nullptr);
+    });
+
+    // Append the subtrees to the upper levels. The root of each subtree replaces its task's node,
+    // and the remaining nodes are moved by offset - 1 since the root is not appended. The offsets
+    // are known in advance, so the subtrees are copied in parallel.
+    auto offsets = std::vector<std::size_t>(tasks.size());
+    auto nodeCount = m_nodes.size();
+    for (std::size_t i = 0u; i < tasks.size(); ++i) {
+      offsets[i] = nodeCount - 1u;
+      nodeCount += subtrees[i].size() - 1u;
+    }
+    m_nodes.resize(nodeCount);
+    policy.executor().run(tasks.size(), [&](const std::size_t i) {
+      const auto relocate = [&](node n) {
+        if (!n.is_leaf()) {
+          n.first += offsets[i];
+        }
+        return n;
+      };
+      m_nodes[tasks[i].node] = relocate(subtrees[i].front());
+      for (std::size_t j = 1u; j < subtrees[i].size(); ++j) {
+        m_nodes[offsets[i] + j] = relocate(subtrees[i][j]);
+      }
+      subtrees[i] = std::vector<node>();
+    });
+  }
+
+  /**
+   * Indicates whether this tree has no primitives.
+   */
+  bool empty() const { return m_nodes.empty(); }
+
+  /**
+   * Returns the number of primitives in this tree.
+   */
+  std::size_t size() const { return m_indices.size(); }
+
+  /**
+   * Returns the nodes of this tree, with the root at index 0.
+   */
+  const std::vector<node>& nodes() const { return m_nodes; }
+
+  /**
+   * Returns the indices of the primitives in the order in which the leaves refer to them.
+   */
+  const std::vector<std::size_t>& primitive_indices() const { return m_indices; }
+
+  /**
+   * Returns the bounding box of all primitives. The tree must not be empty.
+   */
+  const box_type& bounds() const {
+    assert(!empty());
+    return m_nodes.front().bounds;
+  }
+
+  /**
+   * Computes the cost of this tree according to the surface area heuristic with the given
+   * parameters, that is, the expected cost of intersecting a ray that hits the root with the tree.
+   * Lower costs indicate better trees.
+   *
+   * @param options the parameters of the surface area heuristic
+   * @return the cost of this tree, or 0 if it is empty
+   */
+  T sah_cost(const bvh_options<T>& options = bvh_options<T>()) const {
+    if (empty()) {
+      return static_cast<T>(0.0);
+    }
+
+    auto cost = static_cast<T>(0.0);
+    for (const auto& n : m_nodes) {
+      const auto area = n.bounds.surface_area();
+      cost += n.is_leaf() ? options.intersection_cost * static_cast<T>(n.count) * area
+                          : options.traversal_cost * area;
+    }
+    const auto rootArea = bounds().surface_area();
+    return rootArea > static_cast<T>(0.0) ? cost / rootArea : cost;
+  }
+
+  /**
+   * Calls the given visitor with the index of every primitive whose bounding box intersects the
+   * given bounding box.
+   *
+   * @tparam F the type of the visitor
+   * @param b the bounding box
+   * @param f the visitor
+   * @param stats if not null, the visited nodes are added to this
+   */
+  template <typename F>
+  void find_intersectors(const box_type& b, F f, traversal_stats* stats = nullptr) const {
+    auto visitedNodes = std::size_t(0);
+    auto visitedLeaves = std::size_t(0);
+
+    auto stack = detail::traversal_stack<std::size_t>();
+    if (!empty()) {
+      stack.push(0u);
+    }
+    while (!stack.empty()) {
+      const auto& n = m_nodes[stack.pop()];
+      ++visitedNodes;
+      if (n.is_leaf()) {
+        ++visitedLeaves;
+      }
+      if (n.bounds.intersects(b)) {
+        if (n.is_leaf()) {
+          for (auto i = n.first; i < n.first + n.count; ++i) {
+            f(m_indices[i]);
+          }
+        } else {
+          stack.push(n.first + 1u);
+          stack.push(n.first);
+        }
+      }
+    }
+
+    detail::add_traversal_stats(stats, visitedNodes, visitedLeaves);
+  }
+
+  /**
+   * Finds the closest primitive hit by the given ray. The given function is called with the index
+   * of a primitive whose leaf is hit by the ray, and it returns the distance from the origin of the
+   * ray to the primitive, or NaN if the primitive is not hit. The children of a node are visited in
+   * the order in which the ray enters their bounding boxes, and nodes that the ray enters beyond
+   * the closest hit found so far are skipped.
+   *
+   * @tparam F the type of the hit function
+   * @param r the ray
+   * @param hit the hit function
+   * @param stats if not null, the visited nodes are added to this
+   * @return the index of the primitive that is hit first and the distance to the hit, or null_index
+   * and NaN if no primitive is hit
+   */
+  template <typename F>
+  std::tuple<std::size_t, T> find_first_hit(
+    const ray<T, S>& r, F hit, traversal_stats* stats = nullptr) const {
+    auto visitedNodes = std::size_t(0);
+    auto visitedLeaves = std::size_t(0);
+
+    auto bestIndex = null_index;
+    auto bestDistance = std::numeric_limits<T>::infinity();
+
+    const auto q = ray_query<T, S>(r);
+    const auto entry_distance = [&](const std::size_t i) {
+      const auto tNear = std::get<0>(intersect_ray_bbox(q, m_nodes[i].bounds));
+      // keeps NaN if the ray misses the box
+      return tNear < static_cast<T>(0.0) ? static_cast<T>(0.0) : tNear;
+    };
+
+    auto stack = detail::traversal_stack<hit_candidate>();
+    if (!empty()) {
+      const auto distance = entry_distance(0u);
+      if (!is_nan(distance)) {
+        stack.push({0u, distance});
+      }
+    }
+    while (!stack.empty()) {
+      const auto candidate = stack.pop();
+      if (candidate.distance > bestDistance) {
+        continue;
+      }
+
+      const auto& n = m_nodes[candidate.node];
+      ++visitedNodes;
+      if (n.is_leaf()) {
+        ++visitedLeaves;
+        for (auto i = n.first; i < n.first + n.count; ++i) {
+          const auto distance = hit(m_indices[i]);
+          if (!is_nan(distance) && distance < bestDistance) {
+            bestIndex = m_indices[i];
+            bestDistance = distance;
+          }
+        }
+      } else {
+        const auto distance1 = entry_distance(n.first);
+        const auto distance2 = entry_distance(n.first + 1u);
+        const auto push = [&](const std::size_t i, const T distance) {
+          if (!is_nan(distance) && distance <= bestDistance) {
+            stack.push({i, distance});
+          }
+        };
+        // the nearer child is pushed last so that it is visited first
+        if (distance1 <= distance2) {
+          push(n.first + 1u, distance2);
+          push(n.first, distance1);
+        } else {
+          push(n.first, distance1);
+          push(n.first + 1u, distance2);
+        }
+      }
+    }
+
+    detail::add_traversal_stats(stats, visitedNodes, visitedLeaves);
+    return bestIndex == null_index ? std::make_tuple(null_index, nan<T>())
+                                   : std::make_tuple(bestIndex, bestDistance);
+  }
+
+  /**
+   * Finds the closest primitive hit by each ray of the given packet. The rays traverse the tree
+   * together, so that each node is fetched once for all rays that reach it and its bounding box is
+   * tested against these rays at once. A node is skipped if none of them enters its bounding box
+   * before their closest hit found so far. The children of a node are visited in the order of the
+   * first ray that reaches it, which works well if the rays of the packet are coherent.
+   *
+   * The given function is called with the index of a primitive whose leaf is reached by at least
+   * one ray of the packet, and it returns the distance from the origin of each ray of the packet
+   * to the primitive, or NaN for each ray that does not hit the primitive, e.g. by calling
+   * intersect_ray_triangle with the packet.
+   *
+   * @tparam W the number of lanes of the packet
+   * @tparam F the type of the hit function
+   * @param r the ray packet
+   * @param hit the hit function
+   * @param stats if not null, the visited nodes are added to this
+   * @return for each lane, the index of the primitive that is hit first and the distance to the
+   * hit, or null_index and NaN if no primitive is hit, which is always the case for the lanes that
+   * do not hold one of the rays of the packet
+   */
+  template <size_t W, typename F>
+  std::array<std::tuple<std::size_t, T>, W> find_first_hit(
+    const ray_packet<T, S, W>& r, F hit, traversal_stats* stats = nullptr) const {
+    auto visitedNodes = std::size_t(0);
+    auto visitedLeaves = std::size_t(0);
+
+    std::size_t bestIndices[W];
+    T bestDistances[W];
+    for (std::size_t i = 0u; i < W; ++i) {
+      bestIndices[i] = null_index;
+      bestDistances[i] = std::numeric_limits<T>::infinity();
+    }
+
+    auto stack = detail::traversal_stack<packet_candidate>();
+    if (!empty()) {
+      stack.push({0u, r.lane_mask()});
+    }
+    while (!stack.empty()) {
+      const auto candidate = stack.pop();
+      const auto& n = m_nodes[candidate.node];
+      ++visitedNodes;
+      if (n.is_leaf()) {
+        ++visitedLeaves;
+      }
+
+      const auto lanes =
+        candidate.lanes & detail::intersect_ray_packet_bbox_mask(r, n.bounds, bestDistances);
+      if (lanes == 0u) {
+        continue;
+      }
+
+      if (n.is_leaf()) {
+        for (auto i = n.first; i < n.first + n.count; ++i) {
+          const auto distances = hit(m_indices[i]);
+          for (std::size_t j = 0u; j < W; ++j) {
+            if (
+              ((lanes >> j) & 1u) && !is_nan(distances[j]) && distances[j] < bestDistances[j]) {
+              bestIndices[j] = m_indices[i];
+              bestDistances[j] = distances[j];
+            }
+          }
+        }
+      } else {
+        auto lane = std::size_t(0);
+        while (((lanes >> lane) & 1u) == 0u) {
+          ++lane;
+        }
+
+        // the child whose center comes first along the direction of the lane is pushed last so
+        // that it is visited first
+        const auto offset =
+          m_nodes[n.first + 1u].bounds.center() - m_nodes[n.first].bounds.center();
+        auto projection = static_cast<T>(0.0);
+        for (size_t a = 0; a < S; ++a) {
+          projection += offset[a] * r.direction[a][lane];
+        }
+        if (projection >= static_cast<T>(0.0)) {
+          stack.push({n.first + 1u, lanes});
+          stack.push({n.first, lanes});
+        } else {
+          stack.push({n.first, lanes});
+          stack.push({n.first + 1u, lanes});
+        }
+      }
+    }
+
+    detail::add_traversal_stats(stats, visitedNodes, visitedLeaves);
+
+    auto result = std::array<std::tuple<std::size_t, T>, W>();
+    for (std::size_t i = 0u; i < W; ++i) {
+      result[i] = bestIndices[i] == null_index ? std::make_tuple(null_index, nan<T>())
+                                               : std::make_tuple(bestIndices[i], bestDistances[i]);
+    }
+    return result;
+  }
+
+private:
+  /**
+   * Builds the subtree for the primitives with the indices in [first, last) into the node with the
+   * given index. If tasks is not null and the range has at most grain primitives, the subtree is
+   * added to the tasks instead. If policy is not null, large ranges are processed in parallel.
+   */
+  template <typename E>
+  void build_node(
+    const parallel_policy<E>* policy,
+    const std::vector<box_type>& bounds,
+    const std::vector<vec<T, S>>& centroids,
+    const bvh_options<T>& options,
+    std::vector<node>& nodes,
+    const std::size_t index,
+    const std::size_t first,
+    const std::size_t last,
+    const std::size_t grain,
+    std::vector<build_task>* tasks) {
+    const auto count = last - first;
+    if (tasks != nullptr && count <= grain) {
+      tasks->push_back({index, first, last});
+      return;
+    }
+
+    const auto info = compute_range_info(policy, bounds, centroids, first, last);
+    const auto& nodeBounds = info.bounds.bounds();
+    const auto& centroidBounds = info.centroidBounds.bounds();
+
+    auto mid = first;
+    if (count > 1u) {
+      const auto s = find_split(policy, bounds, centroids, options, first, last, info);
+      const auto leafCost =
+        options.intersection_cost * static_cast<T>(count) * nodeBounds.surface_area();
+      if (s.valid && (count > options.max_leaf_size || s.cost < leafCost)) {
+        const auto inLeftChild = [&](const std::size_t i) {
+          return bin_index(centroids[i], centroidBounds, s.axis) <= s.bin;
+        };
+        mid = static_cast<std::size_t>(
+          std::partition(
+            std::next(std::begin(m_indices), static_cast<std::ptrdiff_t>(first)),
+            std::next(std::begin(m_indices), static_cast<std::ptrdiff_t>(last)), inLeftChild) -
+          std::begin(m_indices));
+      } else if (!s.valid && count > options.max_leaf_size) {
+        // all centroids are equal, so any split is as good as any other
+        mid = first + count / 2u;
+      }
+    }
+
+    if (mid == first || mid == last) {
+      nodes[index] = node{nodeBounds, first, count};
+      return;
+    }
+
+    const auto children = nodes.size();
+    nodes.emplace_back();
+    nodes.emplace_back();
+    nodes[index] = node{nodeBounds, children, 0u};
+    build_node(
+      policy, bounds, centroids, options, nodes, children, first, mid, grain, tasks);
+    build_node(
+      policy, bounds, centroids, options, nodes, children + 1u, mid, last, grain, tasks);
+  }
+
+  template <typename E, typename R, typename M, typename C>
+  R reduce_range(
+    const parallel_policy<E>* policy,
+    const std::size_t first,
+    const std::size_t last,
+    const M& map,
+    const C& combine) const {
+    if (policy == nullptr || last - first <= policy->chunk_size()) {
+      return map(first, last);
+    }
+    return detail::reduce_chunks<R>(
+      *policy, last - first,
+      [&](const std::size_t chunkFirst, const std::size_t chunkLast) {
+        return map(first + chunkFirst, first + chunkLast);
+      },
+      combine);
+  }
+
+  template <typename E>
+  range_info compute_range_info(
+    const parallel_policy<E>* policy,
+    const std::vector<box_type>& bounds,
+    const std::vector<vec<T, S>>& centroids,
+    const std::size_t first,
+    const std::size_t last) const {
+    const auto map = [&](const std::size_t chunkFirst, const std::size_t chunkLast) {
+      auto result = range_info();
+      for (auto i = chunkFirst; i < chunkLast; ++i) {
+        result.bounds.add(bounds[m_indices[i]]);
+        result.centroidBounds.add(centroids[m_indices[i]]);
+      }
+      return result;
+    };
+    const auto combine = [](range_info lhs, const range_info& rhs) {
+      lhs.bounds.add(rhs.bounds.bounds());
+      lhs.centroidBounds.add(rhs.centroidBounds.bounds());
+      return lhs;
+    };
+    return reduce_range<E, range_info>(policy, first, last, map, combine);
+  }
+
+  static std::size_t bin_index(
+    const vec<T, S>& centroid, const box_type& centroidBounds, const std::size_t axis) {
+    const auto extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+    const auto relative = (centroid[axis] - centroidBounds.min[axis]) / extent;
+    return std::min(
+      bin_count - 1u, static_cast<std::size_t>(relative * static_cast<T>(bin_count)));
+  }
+
+  /**
+   * Bins the primitives by their centroids along each axis and returns the split between two bins
+   * with the lowest cost.
+   */
+  template <typename E>
+  split find_split(
+    const parallel_policy<E>* policy,
+    const std::vector<box_type>& bounds,
+    const std::vector<vec<T, S>>& centroids,
+    const bvh_options<T>& options,
+    const std::size_t first,
+    const std::size_t last,
+    const range_info& info) const {
+    const auto& centroidBounds = info.centroidBounds.bounds();
+
+    const auto map = [&](const std::size_t chunkFirst, const std::size_t chunkLast) {
+      auto result = bins();
+      for (auto i = chunkFirst; i < chunkLast; ++i) {
+        const auto index = m_indices[i];
+        for (std::size_t axis = 0u; axis < S; ++axis) {
+          if (centroidBounds.min[axis] < centroidBounds.max[axis]) {
+            auto& b = result.values[axis][bin_index(centroids[index], centroidBounds, axis)];
+            b.bounds.add(bounds[index]);
+            ++b.count;
+          }
+        }
+      }
+      return result;
+    };
+    const auto combine = [](bins lhs, const bins& rhs) {
+      for (std::size_t axis = 0u; axis < S; ++axis) {
+        for (std::size_t i = 0u; i < bin_count; ++i) {
+          if (rhs.values[axis][i].count > 0u) {
+            lhs.values[axis][i].bounds.add(rhs.values[axis][i].bounds.bounds());
+            lhs.values[axis][i].count += rhs.values[axis][i].count;
+          }
+        }
+      }
+      return lhs;
+    };
+    const auto binned = reduce_range<E, bins>(policy, first, last, map, combine);
+
+    // the costs are not divided by the area of the node since that does not change their order
+    const auto nodeArea = info.bounds.bounds().surface_area();
+    auto result = split();
+    for (std::size_t axis = 0u; axis < S; ++axis) {
+      if (!(centroidBounds.min[axis] < centroidBounds.max[axis])) {
+        continue;
+      }
+
+      const auto& axisBins = binned.values[axis];
+      T rightCosts[bin_count]{};
+      auto right = typename box_type::builder();
+      auto rightCount = std::size_t(0u);
+      for (auto i = bin_count - 1u; i > 0u; --i) {
+        if (axisBins[i].count > 0u) {
+          right.add(axisBins[i].bounds.bounds());
+          rightCount += axisBins[i].count;
+        }
+        rightCosts[i - 1u] = right.initialized()
+                               ? right.bounds().surface_area() * static_cast<T>(rightCount)
+                               : static_cast<T>(0.0);
+      }
+
+      auto left = typename box_type::builder();
+      auto leftCount = std::size_t(0u);
+      for (std::size_t i = 0u; i + 1u < bin_count; ++i) {
+        if (axisBins[i].count > 0u) {
+          left.add(axisBins[i].bounds.bounds());
+          leftCount += axisBins[i].count;
+        }
+        if (leftCount == 0u || leftCount == last - first) {
+          continue;
+        }
+
+        const auto cost =
+          options.traversal_cost * nodeArea +
+          options.intersection_cost *
+            (left.bounds().surface_area() * static_cast<T>(leftCount) + rightCosts[i]);
+        if (cost < result.cost) {
+          result = split{true, axis, i, cost};
+        }
+      }
+    }
+    return result;
+  }
+};
+
+/**
+ * Builds a bvh for the triangles with the given vertices. Triangle i has the vertices 3i, 3i + 1
+ * and 3i + 2.
+ *
+ * @tparam T the component type
+ * @param vertices the vertices of the triangles
+ * @param options the parameters of the surface area heuristic
+ * @return the bvh
+ */
+template <typename T>
+bvh<T, 3> make_triangle_bvh(
+  const std::vector<vec<T, 3>>& vertices, const bvh_options<T>& options = bvh_options<T>()) {
+  return make_triangle_bvh(parallel_policy<sequential_executor>(), vertices, options);
+}
+
+/**
+ * Builds a bvh for the triangles with the given vertices using the given policy, see
+ * make_triangle_bvh(const std::vector<vec<T, 3>>&, const bvh_options<T>&).
+ *
+ * @tparam E the executor type
+ * @tparam T the component type
+ * @param policy the parallel policy
+ * @param vertices the vertices of the triangles
+ * @param options the parameters of the surface area heuristic
+ * @return the bvh
+ */
+template <typename E, typename T>
+bvh<T, 3> make_triangle_bvh(
+  const parallel_policy<E>& policy,
+  const std::vector<vec<T, 3>>& vertices,
+  const bvh_options<T>& options = bvh_options<T>()) {
+  assert(vertices.size() % 3u == 0u);
+  const auto count = vertices.size() / 3u;
+  auto bounds = std::vector<bbox<T, 3>>(count);
+  detail::for_each_chunk(policy, count, [&](const std::size_t first, const std::size_t last) {
+    for (auto i = first; i < last; ++i) {
+      const auto& p0 = vertices[3u * i];
+      const auto& p1 = vertices[3u * i + 1u];
+      const auto& p2 = vertices[3u * i + 2u];
+      bounds[i] = bbox<T, 3>(min(p0, p1, p2), max(p0, p1, p2));
+    }
+  });
+  return bvh<T, 3>(policy, bounds, options);
+}
+
+/**
+ * Finds the closest triangle hit by the given ray.
+ *
+ * @tparam T the component type
+ * @param r the ray
+ * @param tree the bvh that was built for the given triangles
+ * @param vertices the vertices of the triangles, see make_triangle_bvh
+ * @param stats if not null, the visited nodes are added to this
+ * @return the index of the triangle that is hit first and the distance to the hit, or
+ * bvh<T, 3>::null_index and NaN if no triangle is hit
+ */
+template <typename T>
+std::tuple<std::size_t, T> intersect_ray_triangles(
+  const ray<T, 3>& r,
+  const bvh<T, 3>& tree,
+  const std::vector<vec<T, 3>>& vertices,
+  traversal_stats* stats = nullptr) {
+  return tree.find_first_hit(
+    r,
+    [&](const std::size_t i) {
+      return intersect_ray_triangle(
+        r, vertices[3u * i], vertices[3u * i + 1u], vertices[3u * i + 2u]);
+    },
+    stats);
+}
+
+/**
+ * Finds the closest triangle hit by each ray of the given packet, see
+ * bvh::find_first_hit(const ray_packet<T, S, W>&, F, traversal_stats*).
+ *
+ * @tparam T the component type
+ * @tparam W the number of lanes of the packet
+ * @param r the ray packet
+ * @param tree the bvh that was built for the given triangles
+ * @param vertices the vertices of the triangles, see make_triangle_bvh
+ * @param stats if not null, the visited nodes are added to this
+ * @return for each lane, the index of the triangle that is hit first and the distance to the hit,
+ * or bvh<T, 3>::null_index and NaN if no triangle is hit
+ */
+template <typename T, size_t W>
+std::array<std::tuple<std::size_t, T>, W> intersect_ray_triangles(
+  const ray_packet<T, 3, W>& r,
+  const bvh<T, 3>& tree,
+  const std::vector<vec<T, 3>>& vertices,
+  traversal_stats* stats = nullptr) {
+  return tree.find_first_hit(
+    r,
+    [&](const std::size_t i) {
+      return intersect_ray_triangle(
+        r, vertices[3u * i], vertices[3u * i + 1u], vertices[3u * i + 2u]);
+    },
+    stats);
+}
+
+/**
+ * Finds the closest triangle hit by each of the given rays. The rays are split into packets of W
+ * consecutive rays, which traverse the tree together, see
+ * intersect_ray_triangles(const ray_packet<T, 3, W>&, const bvh<T, 3>&,
+ * const std::vector<vec<T, 3>>&, traversal_stats*). Consecutive rays should be coherent, e.g. the
+ * rays through the pixels of an image in scanline order.
+ *
+ * @tparam W the number of rays per packet
+ * @tparam T the component type
+ * @param rays the rays
+ * @param tree the bvh that was built for the given triangles
+ * @param vertices the vertices of the triangles, see make_triangle_bvh
+ * @param result receives the index of the triangle that is hit first and the distance to the hit,
+ * or bvh<T, 3>::null_index and NaN, for each ray, it is resized to the number of rays
+ * @param stats if not null, the visited nodes are added to this
+ */
+template <size_t W = 8u, typename T>
+void intersect_ray_triangles(
+  const std::vector<ray<T, 3>>& rays,
+  const bvh<T, 3>& tree,
+  const std::vector<vec<T, 3>>& vertices,
+  std::vector<std::tuple<std::size_t, T>>& result,
+  traversal_stats* stats = nullptr) {
+  result.resize(rays.size());
+  for (std::size_t i = 0u; i < rays.size(); i += W) {
+    const auto count = std::min(W, rays.size() - i);
+    const auto packet = ray_packet<T, 3, W>(rays.data() + i, rays.data() + i + count);
+    const auto hits = intersect_ray_triangles(packet, tree, vertices, stats);
+    std::copy_n(std::begin(hits), count, result.data() + i);
+  }
+}
+
+/**
+ * Builds a bvh for the given polygons.
+ *
+ * @tparam T the component type
+ * @param polygons the polygons, none of which may be empty
+ * @param options the parameters of the surface area heuristic
+ * @return the bvh
+ */
+template <typename T>
+bvh<T, 3> make_polygon_bvh(
+  const std::vector<polygon<T, 3>>& polygons, const bvh_options<T>& options = bvh_options<T>()) {
+  return make_polygon_bvh(parallel_policy<sequential_executor>(), polygons, options);
+}
+
+/**
+ * Builds a bvh for the given polygons using the given policy, see
+ * make_polygon_bvh(const std::vector<polygon<T, 3>>&, const bvh_options<T>&).
+ *
+ * @tparam E the executor type
+ * @tparam T the component type
+ * @param policy the parallel policy
+ * @param polygons the polygons, none of which may be empty
+ * @param options the parameters of the surface area heuristic
+ * @return the bvh
+ */
+template <typename E, typename T>
+bvh<T, 3> make_polygon_bvh(
+  const parallel_policy<E>& policy,
+  const std::vector<polygon<T, 3>>& polygons,
+  const bvh_options<T>& options = bvh_options<T>()) {
+  const auto count = polygons.size();
+  auto bounds = std::vector<bbox<T, 3>>(count);
+  detail::for_each_chunk(policy, count, [&](const std::size_t first, const std::size_t last) {
+    for (auto i = first; i < last; ++i) {
+      const auto& vertices = polygons[i].vertices();
+      bounds[i] = bbox<T, 3>::merge_all(std::begin(vertices), std::end(vertices));
+    }
+  });
+  return bvh<T, 3>(policy, bounds, options);
+}
+
+/**
+ * Finds the closest polygon hit by the given ray.
+ *
+ * @tparam T the component type
+ * @param r the ray
+ * @param tree the bvh that was built for the given polygons
+ * @param polygons the polygons
+ * @param stats if not null, the visited nodes are added to this
+ * @return the index of the polygon that is hit first and the distance to the hit, or
+ * bvh<T, 3>::null_index and NaN if no polygon is hit
+ */
+template <typename T>
+std::tuple<std::size_t, T> intersect_ray_polygons(
+  const ray<T, 3>& r,
+  const bvh<T, 3>& tree,
+  const std::vector<polygon<T, 3>>& polygons,
+  traversal_stats* stats = nullptr) {
+  return tree.find_first_hit(
+    r,
+    [&](const std::size_t i) {
+      const auto& vertices = polygons[i].vertices();
+      return intersect_ray_polygon(r, std::begin(vertices), std::end(vertices));
+    },
+    stats);
+}
+} // namespace vm
@@ -20,10 +20,12 @@
 
 #pragma once
 
+#include "parallel.h"
 #include "util.h"
 #include "vec.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <vector>
 
@@ -216,4 +218,42 @@ template <typename T> std::vector<vec<T, 3>> convex_hull(const std::vector<vec<T
   const detail::convex_hull<T> hull(points);
   return hull.result();
 }
+
+/**
+ * Computes the convex hull of the given points like the overload above, but computes the convex
+ * hull of each chunk of the given points in a task of the given policy's executor, and then the
+ * convex hull of the vertices of these hulls. The vertices of the hulls are concatenated in the
+ * order of the chunks, so the result does not depend on the number of threads.
+ *
+ * @tparam E the executor type
+ * @tparam T the component type
+ * @param policy the parallel policy
+ * @param points the points
+ * @return the convex hull of the points, or an empty list if no convex hull exists
+ */
+template <typename E, typename T>
+std::vector<vec<T, 3>> convex_hull(
+  const parallel_policy<E>& policy, const std::vector<vec<T, 3>>& points) {
+  if (policy.chunk_count(points.size()) <= 1u) {
+    return convex_hull(points);
+  }
+
+  using points_type = std::vector<vec<T, 3>>;
+  const auto vertices = detail::reduce_chunks<points_type>(
+    policy,
+    points.size(),
+    [&](const std::size_t first, const std::size_t last) {
+      const auto chunk = points_type(
+        std::next(std::begin(points), static_cast<std::ptrdiff_t>(first)),
+        std::next(std::begin(points), static_cast<std::ptrdiff_t>(last)));
+      // if the points of a chunk are colinear, they have no hull but may still be vertices
+      auto hull = convex_hull(chunk);
+      return hull.empty() ? chunk : hull;
+    },
+    [](points_type lhs, const points_type& rhs) {
+      lhs.insert(std::end(lhs), std::begin(rhs), std::end(rhs));
+      return lhs;
+    });
+  return convex_hull(vertices);
+}
 } // namespace vm
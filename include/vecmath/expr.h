@@ -0,0 +1,653 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "mat.h"
+#include "vec.h"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace vm {
+/*
+ * Lazy expressions over vectors and matrices.
+ *
+ * The arithmetic operators of vec and mat return a new vector or matrix for every operation, so a
+ * chain such as a * x + b * y - c creates a temporary for every intermediate result. Wrapping one
+ * of the operands with lazy makes the operators build an expression tree instead, which is
+ * evaluated in a single loop over the components of the result when it is converted to a vec or
+ * mat:
+ *
+ *   const vec3f r = lazy(a) * x + b * y - c;
+ *
+ * Expressions store references to their vector and matrix operands, so they must be evaluated
+ * before the end of the full expression in which they are created. In particular, do not store an
+ * expression in a variable declared with auto.
+ *
+ * Matrix products are the exception: Computing every element of a product separately reads a whole
+ * row and column of the operands for each element, which the compiler cannot vectorize as well as
+ * the loop in the product operator of mat. A product of two matrix expressions is therefore
+ * evaluated when it is created, and its result becomes a node of the enclosing expression. The
+ * matrix operand of a matrix vector product is evaluated in the same way unless it is a plain
+ * matrix, because each of its elements is read once only. The vector operand is evaluated unless
+ * it is a plain vector because each of its components is read once for each row.
+ */
+
+template <typename T, std::size_t S, typename E> class vec_expr;
+template <typename T, std::size_t R, std::size_t C, typename E> class mat_expr;
+
+namespace detail {
+struct expr_plus {
+  template <typename T> constexpr T operator()(const T lhs, const T rhs) const { return lhs + rhs; }
+};
+
+struct expr_minus {
+  template <typename T> constexpr T operator()(const T lhs, const T rhs) const { return lhs - rhs; }
+};
+
+struct expr_multiplies {
+  template <typename T> constexpr T operator()(const T lhs, const T rhs) const { return lhs * rhs; }
+};
+
+struct expr_divides {
+  template <typename T> constexpr T operator()(const T lhs, const T rhs) const { return lhs / rhs; }
+};
+
+template <typename T, std::size_t S> struct vec_ref_node {
+  const vec<T, S>& v;
+  constexpr T operator[](const std::size_t i) const { return v[i]; }
+};
+
+template <typename T, std::size_t S> struct vec_value_node {
+  vec<T, S> v;
+  constexpr T operator[](const std::size_t i) const { return v[i]; }
+};
+
+template <typename T, typename E> struct vec_negate_node {
+  E e;
+  constexpr T operator[](const std::size_t i) const { return -e[i]; }
+};
+
+template <typename T, typename L, typename R, typename Op> struct vec_binary_node {
+  L lhs;
+  R rhs;
+  constexpr T operator[](const std::size_t i) const { return Op()(lhs[i], rhs[i]); }
+};
+
+template <typename T, typename E, typename Op> struct vec_scalar_node {
+  E e;
+  T s;
+  constexpr T operator[](const std::size_t i) const { return Op()(e[i], s); }
+};
+
+template <typename T, typename E, typename Op> struct scalar_vec_node {
+  T s;
+  E e;
+  constexpr T operator[](const std::size_t i) const { return Op()(s, e[i]); }
+};
+
+template <typename T, std::size_t R, std::size_t C> struct mat_ref_node {
+  const mat<T, R, C>& m;
+  constexpr T operator()(const std::size_t c, const std::size_t r) const { return m[c][r]; }
+};
+
+template <typename T, std::size_t R, std::size_t C> struct mat_value_node {
+  mat<T, R, C> m;
+  constexpr T operator()(const std::size_t c, const std::size_t r) const { return m[c][r]; }
+};
+
+template <typename T, typename E> struct mat_negate_node {
+  E e;
+  constexpr T operator()(const std::size_t c, const std::size_t r) const { return -e(c, r); }
+};
+
+template <typename T, typename L, typename R, typename Op> struct mat_binary_node {
+  L lhs;
+  R rhs;
+  constexpr T operator()(const std::size_t c, const std::size_t r) const {
+    return Op()(lhs(c, r), rhs(c, r));
+  }
+};
+
+template <typename T, typename E, typename Op> struct mat_scalar_node {
+  E e;
+  T s;
+  constexpr T operator()(const std::size_t c, const std::size_t r) const {
+    return Op()(e(c, r), s);
+  }
+};
+
+template <typename T, std::size_t C, typename L, typename R> struct mat_vec_product_node {
+  L lhs;
+  R rhs;
+  constexpr T operator[](const std::size_t r) const {
+    auto result = T(0);
+    for (std::size_t c = 0; c < C; ++c) {
+      result += lhs(c, r) * rhs[c];
+    }
+    return result;
+  }
+};
+
+template <typename E> struct is_mat_value_node : std::false_type {};
+template <typename T, std::size_t R, std::size_t C>
+struct is_mat_value_node<mat_value_node<T, R, C>> : std::true_type {};
+
+template <typename E> struct is_ref_node : std::false_type {};
+template <typename T, std::size_t S> struct is_ref_node<vec_ref_node<T, S>> : std::true_type {};
+template <typename T, std::size_t R, std::size_t C>
+struct is_ref_node<mat_ref_node<T, R, C>> : std::true_type {};
+
+/*
+ * Returns the node to use for an operand of a product. Nodes that refer to a plain vector or matrix
+ * are used as they are, all other expressions are evaluated into a value node.
+ */
+template <typename T, std::size_t S, typename E>
+constexpr auto product_operand(const vec_expr<T, S, E>& e) {
+  if constexpr (is_ref_node<E>::value) {
+    return e.node();
+  } else {
+    return vec_value_node<T, S>{e.eval()};
+  }
+}
+
+template <typename T, std::size_t R, std::size_t C, typename E>
+constexpr auto product_operand(const mat_expr<T, R, C, E>& e) {
+  if constexpr (is_ref_node<E>::value) {
+    return e.node();
+  } else {
+    return mat_value_node<T, R, C>{e.eval()};
+  }
+}
+
+/*
+ * Returns the value of an operand of a matrix product. Plain matrices and the results of other
+ * products are returned by reference.
+ */
+template <typename T, std::size_t R, std::size_t C>
+constexpr const mat<T, R, C>& product_value(const mat<T, R, C>& m) {
+  return m;
+}
+
+template <typename T, std::size_t R, std::size_t C, typename E>
+constexpr decltype(auto) product_value(const mat_expr<T, R, C, E>& e) {
+  if constexpr (is_ref_node<E>::value || is_mat_value_node<E>::value) {
+    return (e.node().m);
+  } else {
+    return e.eval();
+  }
+}
+
+template <typename T, std::size_t S, typename E>
+constexpr vec_expr<T, S, E> make_vec_expr(const E& node) {
+  return vec_expr<T, S, E>(node);
+}
+
+template <typename T, std::size_t R, std::size_t C, typename E>
+constexpr mat_expr<T, R, C, E> make_mat_expr(const E& node) {
+  return mat_expr<T, R, C, E>(node);
+}
+
+template <typename T, std::size_t S, typename E>
+constexpr const vec_expr<T, S, E>& as_expr(const vec_expr<T, S, E>& e) {
+  return e;
+}
+
+template <typename T, std::size_t S>
+constexpr vec_expr<T, S, vec_ref_node<T, S>> as_expr(const vec<T, S>& v) {
+  return vec_expr<T, S, vec_ref_node<T, S>>(vec_ref_node<T, S>{v});
+}
+
+template <typename T, std::size_t R, std::size_t C, typename E>
+constexpr const mat_expr<T, R, C, E>& as_expr(const mat_expr<T, R, C, E>& e) {
+  return e;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr mat_expr<T, R, C, mat_ref_node<T, R, C>> as_expr(const mat<T, R, C>& m) {
+  return mat_expr<T, R, C, mat_ref_node<T, R, C>>(mat_ref_node<T, R, C>{m});
+}
+
+template <typename X> struct expr_traits {
+  static constexpr bool is_expr = false;
+  static constexpr bool is_vec = false;
+  static constexpr bool is_mat = false;
+};
+
+template <typename T, std::size_t S> struct expr_traits<vec<T, S>> {
+  using type = T;
+  static constexpr std::size_t size = S;
+  static constexpr bool is_expr = false;
+  static constexpr bool is_vec = true;
+  static constexpr bool is_mat = false;
+};
+
+template <typename T, std::size_t S, typename E> struct expr_traits<vec_expr<T, S, E>> {
+  using type = T;
+  static constexpr std::size_t size = S;
+  static constexpr bool is_expr = true;
+  static constexpr bool is_vec = true;
+  static constexpr bool is_mat = false;
+};
+
+template <typename T, std::size_t R, std::size_t C> struct expr_traits<mat<T, R, C>> {
+  using type = T;
+  static constexpr std::size_t rows = R;
+  static constexpr std::size_t cols = C;
+  static constexpr bool is_expr = false;
+  static constexpr bool is_vec = false;
+  static constexpr bool is_mat = true;
+};
+
+template <typename T, std::size_t R, std::size_t C, typename E>
+struct expr_traits<mat_expr<T, R, C, E>> {
+  using type = T;
+  static constexpr std::size_t rows = R;
+  static constexpr std::size_t cols = C;
+  static constexpr bool is_expr = true;
+  static constexpr bool is_vec = false;
+  static constexpr bool is_mat = true;
+};
+
+/*
+ * Enables the binary operators below if at least one operand is an expression and both operands
+ * are vectors of the same type, or both are matrices.
+ */
+template <typename L, typename R> constexpr bool is_vec_expr_operands() {
+  using LT = expr_traits<L>;
+  using RT = expr_traits<R>;
+  if constexpr (LT::is_vec && RT::is_vec) {
+    return (LT::is_expr || RT::is_expr) && std::is_same_v<typename LT::type, typename RT::type> &&
+           LT::size == RT::size;
+  } else {
+    return false;
+  }
+}
+
+template <typename L, typename R> constexpr bool is_mat_expr_operands() {
+  using LT = expr_traits<L>;
+  using RT = expr_traits<R>;
+  if constexpr (LT::is_mat && RT::is_mat) {
+    return (LT::is_expr || RT::is_expr) && std::is_same_v<typename LT::type, typename RT::type>;
+  } else {
+    return false;
+  }
+}
+
+template <typename L, typename R> constexpr bool is_mat_vec_expr_operands() {
+  using LT = expr_traits<L>;
+  using RT = expr_traits<R>;
+  if constexpr (LT::is_mat && RT::is_vec) {
+    return (LT::is_expr || RT::is_expr) && std::is_same_v<typename LT::type, typename RT::type>;
+  } else {
+    return false;
+  }
+}
+
+template <typename L, typename R, typename Op>
+constexpr auto make_vec_binary(const L& lhs, const R& rhs) {
+  using T = typename expr_traits<L>::type;
+  constexpr auto S = expr_traits<L>::size;
+  const auto l = as_expr(lhs).node();
+  const auto r = as_expr(rhs).node();
+  return make_vec_expr<T, S>(vec_binary_node<T, decltype(l), decltype(r), Op>{l, r});
+}
+
+template <typename L, typename R, typename Op>
+constexpr auto make_mat_binary(const L& lhs, const R& rhs) {
+  using T = typename expr_traits<L>::type;
+  constexpr auto R_ = expr_traits<L>::rows;
+  constexpr auto C = expr_traits<L>::cols;
+  static_assert(R_ == expr_traits<R>::rows && C == expr_traits<R>::cols, "dimensions must match");
+  const auto l = as_expr(lhs).node();
+  const auto r = as_expr(rhs).node();
+  return make_mat_expr<T, R_, C>(mat_binary_node<T, decltype(l), decltype(r), Op>{l, r});
+}
+} // namespace detail
+
+/**
+ * A lazily evaluated vector expression. The components of the result are computed when the
+ * expression is converted to a vector.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @tparam E the type of the expression tree
+ */
+template <typename T, std::size_t S, typename E> class vec_expr {
+private:
+  E m_node;
+
+public:
+  /**
+   * Creates a new expression with the given expression tree.
+   *
+   * @param node the expression tree
+   */
+  constexpr explicit vec_expr(const E& node)
+    : m_node(node) {}
+
+  /**
+   * Returns the expression tree.
+   */
+  constexpr const E& node() const { return m_node; }
+
+  /**
+   * Computes the component at the given index.
+   *
+   * @param i the index of the component to compute
+   * @return the value of the component
+   */
+  constexpr T operator[](const std::size_t i) const { return m_node[i]; }
+
+  /**
+   * Evaluates this expression.
+   */
+  constexpr vec<T, S> eval() const {
+    vec<T, S> result;
+    for (std::size_t i = 0; i < S; ++i) {
+      result[i] = m_node[i];
+    }
+    return result;
+  }
+
+  /**
+   * Evaluates this expression.
+   */
+  constexpr operator vec<T, S>() const { return eval(); }
+};
+
+/**
+ * A lazily evaluated matrix expression. The elements of the result are computed when the
+ * expression is converted to a matrix.
+ *
+ * @tparam T the element type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @tparam E the type of the expression tree
+ */
+template <typename T, std::size_t R, std::size_t C, typename E> class mat_expr {
+private:
+  E m_node;
+
+public:
+  /**
+   * Creates a new expression with the given expression tree.
+   *
+   * @param node the expression tree
+   */
+  constexpr explicit mat_expr(const E& node)
+    : m_node(node) {}
+
+  /**
+   * Returns the expression tree.
+   */
+  constexpr const E& node() const { return m_node; }
+
+  /**
+   * Computes the element at the given column and row.
+   *
+   * @param c the column index
+   * @param r the row index
+   * @return the value of the element
+   */
+  constexpr T operator()(const std::size_t c, const std::size_t r) const { return m_node(c, r); }
+
+  /**
+   * Evaluates this expression.
+   */
+  constexpr mat<T, R, C> eval() const {
+    if constexpr (detail::is_mat_value_node<E>::value) {
+      return m_node.m;
+    }
+
+    mat<T, R, C> result;
+    for (std::size_t c = 0; c < C; ++c) {
+      for (std::size_t r = 0; r < R; ++r) {
+        result[c][r] = m_node(c, r);
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Evaluates this expression.
+   */
+  constexpr operator mat<T, R, C>() const { return eval(); }
+};
+
+/**
+ * Returns an expression that refers to the given vector. Arithmetic operators that have such an
+ * expression as an operand return an expression instead of computing their result.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param v the vector, which must outlive the returned expression
+ * @return an expression referring to the given vector
+ */
+template <typename T, std::size_t S>
+constexpr vec_expr<T, S, detail::vec_ref_node<T, S>> lazy(const vec<T, S>& v) {
+  return detail::as_expr(v);
+}
+
+/**
+ * Returns an expression that refers to the given matrix. Arithmetic operators that have such an
+ * expression as an operand return an expression instead of computing their result.
+ *
+ * @tparam T the element type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @param m the matrix, which must outlive the returned expression
+ * @return an expression referring to the given matrix
+ */
+template <typename T, std::size_t R, std::size_t C>
+constexpr mat_expr<T, R, C, detail::mat_ref_node<T, R, C>> lazy(const mat<T, R, C>& m) {
+  return detail::as_expr(m);
+}
+
+/**
+ * Evaluates the given vector expression.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @tparam E the type of the expression tree
+ * @param e the expression
+ * @return the value of the expression
+ */
+template <typename T, std::size_t S, typename E>
+constexpr vec<T, S> eval(const vec_expr<T, S, E>& e) {
+  return e.eval();
+}
+
+/**
+ * Evaluates the given matrix expression.
+ *
+ * @tparam T the element type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @tparam E the type of the expression tree
+ * @param e the expression
+ * @return the value of the expression
+ */
+template <typename T, std::size_t R, std::size_t C, typename E>
+constexpr mat<T, R, C> eval(const mat_expr<T, R, C, E>& e) {
+  return e.eval();
+}
+
+/**
+ * Returns an expression that negates the given vector expression.
+ */
+template <typename T, std::size_t S, typename E>
+constexpr auto operator-(const vec_expr<T, S, E>& e) {
+  return detail::make_vec_expr<T, S>(detail::vec_negate_node<T, E>{e.node()});
+}
+
+/**
+ * Returns an expression that adds the given operands component wise. One operand must be an
+ * expression, the other may be a vector.
+ */
+template <
+  typename L, typename R, std::enable_if_t<detail::is_vec_expr_operands<L, R>(), int> = 0>
+constexpr auto operator+(const L& lhs, const R& rhs) {
+  return detail::make_vec_binary<L, R, detail::expr_plus>(lhs, rhs);
+}
+
+/**
+ * Returns an expression that subtracts the given operands component wise. One operand must be an
+ * expression, the other may be a vector.
+ */
+template <
+  typename L, typename R, std::enable_if_t<detail::is_vec_expr_operands<L, R>(), int> = 0>
+constexpr auto operator-(const L& lhs, const R& rhs) {
+  return detail::make_vec_binary<L, R, detail::expr_minus>(lhs, rhs);
+}
+
+/**
+ * Returns an expression that multiplies the given operands component wise. One operand must be an
+ * expression, the other may be a vector.
+ */
+template <
+  typename L, typename R, std::enable_if_t<detail::is_vec_expr_operands<L, R>(), int> = 0>
+constexpr auto operator*(const L& lhs, const R& rhs) {
+  return detail::make_vec_binary<L, R, detail::expr_multiplies>(lhs, rhs);
+}
+
+/**
+ * Returns an expression that divides the given operands component wise. One operand must be an
+ * expression, the other may be a vector.
+ */
+template <
+  typename L, typename R, std::enable_if_t<detail::is_vec_expr_operands<L, R>(), int> = 0>
+constexpr auto operator/(const L& lhs, const R& rhs) {
+  return detail::make_vec_binary<L, R, detail::expr_divides>(lhs, rhs);
+}
+
+/**
+ * Returns an expression that multiplies the given vector expression by the given scalar.
+ */
+template <typename T, std::size_t S, typename E>
+constexpr auto operator*(const vec_expr<T, S, E>& lhs, const T rhs) {
+  return detail::make_vec_expr<T, S>(
+    detail::vec_scalar_node<T, E, detail::expr_multiplies>{lhs.node(), rhs});
+}
+
+/**
+ * Returns an expression that multiplies the given scalar by the given vector expression.
+ */
+template <typename T, std::size_t S, typename E>
+constexpr auto operator*(const T lhs, const vec_expr<T, S, E>& rhs) {
+  return detail::make_vec_expr<T, S>(
+    detail::scalar_vec_node<T, E, detail::expr_multiplies>{lhs, rhs.node()});
+}
+
+/**
+ * Returns an expression that divides the given vector expression by the given scalar.
+ */
+template <typename T, std::size_t S, typename E>
+constexpr auto operator/(const vec_expr<T, S, E>& lhs, const T rhs) {
+  return detail::make_vec_expr<T, S>(
+    detail::vec_scalar_node<T, E, detail::expr_divides>{lhs.node(), rhs});
+}
+
+/**
+ * Returns an expression that negates the given matrix expression.
+ */
+template <typename T, std::size_t R, std::size_t C, typename E>
+constexpr auto operator-(const mat_expr<T, R, C, E>& e) {
+  return detail::make_mat_expr<T, R, C>(detail::mat_negate_node<T, E>{e.node()});
+}
+
+/**
+ * Returns an expression that adds the given matrices element wise. One operand must be an
+ * expression, the other may be a matrix.
+ */
+template <
+  typename L, typename R, std::enable_if_t<detail::is_mat_expr_operands<L, R>(), int> = 0>
+constexpr auto operator+(const L& lhs, const R& rhs) {
+  return detail::make_mat_binary<L, R, detail::expr_plus>(lhs, rhs);
+}
+
+/**
+ * Returns an expression that subtracts the given matrices element wise. One operand must be an
+ * expression, the other may be a matrix.
+ */
+template <
+  typename L, typename R, std::enable_if_t<detail::is_mat_expr_operands<L, R>(), int> = 0>
+constexpr auto operator-(const L& lhs, const R& rhs) {
+  return detail::make_mat_binary<L, R, detail::expr_minus>(lhs, rhs);
+}
+
+/**
+ * Returns an expression that multiplies the given matrix expression by the given scalar.
+ */
+template <typename T, std::size_t R, std::size_t C, typename E>
+constexpr auto operator*(const mat_expr<T, R, C, E>& lhs, const T rhs) {
+  return detail::make_mat_expr<T, R, C>(
+    detail::mat_scalar_node<T, E, detail::expr_multiplies>{lhs.node(), rhs});
+}
+
+/**
+ * Returns an expression that multiplies the given scalar by the given matrix expression.
+ */
+template <typename T, std::size_t R, std::size_t C, typename E>
+constexpr auto operator*(const T lhs, const mat_expr<T, R, C, E>& rhs) {
+  return rhs * lhs;
+}
+
+/**
+ * Returns an expression that divides the given matrix expression by the given scalar.
+ */
+template <typename T, std::size_t R, std::size_t C, typename E>
+constexpr auto operator/(const mat_expr<T, R, C, E>& lhs, const T rhs) {
+  return detail::make_mat_expr<T, R, C>(
+    detail::mat_scalar_node<T, E, detail::expr_divides>{lhs.node(), rhs});
+}
+
+/**
+ * Returns an expression that holds the product of the given matrices. One operand must be an
+ * expression, the other may be a matrix. The product is computed when the expression is created.
+ */
+template <
+  typename L, typename R, std::enable_if_t<detail::is_mat_expr_operands<L, R>(), int> = 0>
+constexpr auto operator*(const L& lhs, const R& rhs) {
+  using T = typename detail::expr_traits<L>::type;
+  constexpr auto R1 = detail::expr_traits<L>::rows;
+  constexpr auto C2 = detail::expr_traits<R>::cols;
+  return detail::make_mat_expr<T, R1, C2>(detail::mat_value_node<T, R1, C2>{
+    detail::product_value(lhs) * detail::product_value(rhs)});
+}
+
+/**
+ * Returns an expression that multiplies the given vector by the given matrix. One operand must be
+ * an expression, the other may be a matrix or a vector.
+ */
+template <
+  typename L, typename R, std::enable_if_t<detail::is_mat_vec_expr_operands<L, R>(), int> = 0>
+constexpr auto operator*(const L& lhs, const R& rhs) {
+  using T = typename detail::expr_traits<L>::type;
+  constexpr auto R1 = detail::expr_traits<L>::rows;
+  constexpr auto C = detail::expr_traits<L>::cols;
+  static_assert(C == detail::expr_traits<R>::size, "dimensions must match");
+  const auto l = detail::product_operand(detail::as_expr(lhs));
+  const auto r = detail::product_operand(detail::as_expr(rhs));
+  return detail::make_vec_expr<T, R1>(
+    detail::mat_vec_product_node<T, C, decltype(l), decltype(r)>{l, r});
+}
+} // namespace vm
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 namespace vm {
 enum class side;
@@ -51,6 +52,11 @@ using vec3l = vec<long, 3>;
 using vec3s = vec<size_t, 3>;
 using vec3b = vec<bool, 3>;
 
+template <typename T> class vec3a;
+
+using vec3fa = vec3a<float>;
+using vec3da = vec3a<double>;
+
 using vec4f = vec<float, 4>;
 using vec4d = vec<double, 4>;
 using vec4i = vec<int, 4>;
@@ -67,6 +73,20 @@ using mat2x2d = mat<double, 2, 2>;
 using mat3x3d = mat<double, 3, 3>;
 using mat4x4d = mat<double, 4, 4>;
 
+template <typename T, size_t S> class affine;
+
+using affine2f = affine<float, 2>;
+using affine2d = affine<double, 2>;
+using affine3f = affine<float, 3>;
+using affine3d = affine<double, 3>;
+
+template <typename T, size_t S> class transformation;
+
+using transformation2f = transformation<float, 2>;
+using transformation2d = transformation<double, 2>;
+using transformation3f = transformation<float, 3>;
+using transformation3d = transformation<double, 3>;
+
 template <typename T> class quat;
 
 using quatf = quat<float>;
@@ -96,6 +116,18 @@ template <typename T, size_t S> class ray;
 using ray3f = ray<float, 3>;
 using ray3d = ray<double, 3>;
 
+template <typename T, size_t S> class ray_query;
+
+using ray_query3f = ray_query<float, 3>;
+using ray_query3d = ray_query<double, 3>;
+
+template <typename T, size_t S, size_t W> class ray_packet;
+
+using ray_packet4f = ray_packet<float, 3, 4>;
+using ray_packet4d = ray_packet<double, 3, 4>;
+using ray_packet8f = ray_packet<float, 3, 8>;
+using ray_packet8d = ray_packet<double, 3, 8>;
+
 template <typename T, size_t S> class segment;
 
 using segment3d = segment<double, 3>;
@@ -109,4 +141,21 @@ using polygon2f = polygon<float, 2>;
 using polygon2d = polygon<double, 2>;
 using polygon3f = polygon<float, 3>;
 using polygon3d = polygon<double, 3>;
+
+template <typename T, size_t S, size_t W> class wide_bvh;
+
+template <typename T, size_t S> using bvh4 = wide_bvh<T, S, 4u>;
+template <typename T, size_t S> using bvh8 = wide_bvh<T, S, 8u>;
+
+using bvh4f = bvh4<float, 3>;
+using bvh4d = bvh4<double, 3>;
+using bvh8f = bvh8<float, 3>;
+using bvh8d = bvh8<double, 3>;
+
+template <typename T, size_t S, typename Q> class quantized_bvh;
+
+using quantized_bvh8f = quantized_bvh<float, 3, std::uint8_t>;
+using quantized_bvh8d = quantized_bvh<double, 3, std::uint8_t>;
+using quantized_bvh16f = quantized_bvh<float, 3, std::uint16_t>;
+using quantized_bvh16d = quantized_bvh<double, 3, std::uint16_t>;
 } // namespace vm
@@ -24,9 +24,20 @@
 #include "line.h"
 #include "plane.h"
 #include "ray.h"
+#include "ray_packet.h"
+#include "ray_query.h"
 #include "scalar.h"
+#include "simd.h"
+#include "simd_dispatch.h"
 #include "util.h"
 #include "vec.h"
+#include "vec_soa.h"
+
+#include <array>
+#include <cassert>
+#include <limits>
+#include <tuple>
+#include <vector>
 
 namespace vm {
 
@@ -226,6 +237,46 @@ constexpr T intersect_ray_plane(const ray<T, S>& r, const plane<T, S>& p) {
   return s;
 }
 
+/**
+ * Computes the point of intersection between each ray of the given packet and the given plane. For
+ * finite inputs, the result for each lane is equal to the result of
+ * intersect_ray_plane(const ray<T, S>&, const plane<T, S>&) for the ray in that lane.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @tparam W the number of lanes
+ * @param r the ray packet
+ * @param p the plane
+ * @return the distance to the intersection point for each lane, or NaN for each lane whose ray
+ * does not intersect the plane
+ */
+template <typename T, size_t S, size_t W>
+std::array<T, W> intersect_ray_plane(const ray_packet<T, S, W>& r, const plane<T, S>& p) {
+  using pack = detail::fixed_width_pack<T, W>;
+  const auto anchor = p.anchor();
+  const auto zero = pack::set1(static_cast<T>(0.0));
+  const auto epsilon = pack::set1(constants<T>::almost_zero());
+  const auto negEpsilon = pack::set1(-constants<T>::almost_zero());
+  const auto miss = pack::set1(nan<T>());
+
+  auto result = std::array<T, W>();
+  for (std::size_t i = 0u; i < W; i += pack::width) {
+    auto d = zero;
+    auto n = zero;
+    for (size_t a = 0; a < S; ++a) {
+      const auto normal = pack::set1(p.normal[a]);
+      const auto toAnchor = pack::sub(pack::set1(anchor[a]), pack::load(&r.origin[a][i]));
+      d = pack::add(d, pack::mul(pack::load(&r.direction[a][i]), normal));
+      n = pack::add(n, pack::mul(toAnchor, normal));
+    }
+    const auto s = pack::div(n, d);
+    const auto hit = pack::mask_and(
+      pack::mask_or(pack::gt(d, epsilon), pack::lt(d, negEpsilon)), pack::ge(s, negEpsilon));
+    pack::store(&result[i], pack::select(hit, s, miss));
+  }
+  return result;
+}
+
 /**
  * Compute the point of intersection of the given ray and a triangle with the given points as
  * vertices.
@@ -279,6 +330,111 @@ constexpr T intersect_ray_triangle(
   return u;
 }
 
+/**
+ * Computes the point of intersection of the given ray and each of the triangles with the given
+ * vertices. The triangle with index i has the vertices p1[i], p2[i] and p3[i]. For finite inputs,
+ * each result is equal to the result of intersect_ray_triangle for that triangle.
+ *
+ * @tparam T the component type
+ * @param r the ray
+ * @param p1 the first points of the triangles
+ * @param p2 the second points of the triangles, which must have the same size as p1
+ * @param p3 the third points of the triangles, which must have the same size as p1
+ * @param result receives the distances to the points of intersection or NaN for each triangle that
+ * the ray does not intersect, it is resized to the size of p1
+ */
+template <typename T>
+void intersect_ray_triangle(
+  const ray<T, 3>& r,
+  const vec_soa<T, 3>& p1,
+  const vec_soa<T, 3>& p2,
+  const vec_soa<T, 3>& p3,
+  std::vector<T>& result) {
+  assert(p1.size() == p2.size() && p1.size() == p3.size());
+  result.resize(p1.size());
+  const auto p1Data = detail::soa_data(p1);
+  const auto p2Data = detail::soa_data(p2);
+  const auto p3Data = detail::soa_data(p3);
+  detail::dispatch_simd([&](auto k) {
+    decltype(k)::intersect_ray_triangle(
+      r.origin.v, r.direction.v, p1Data, p2Data, p3Data, result.data(), p1.size());
+  });
+}
+
+/**
+ * Computes the point of intersection of each ray of the given packet and a triangle with the given
+ * points as vertices. For finite inputs, the result for each lane is equal to the result of
+ * intersect_ray_triangle(const ray<T, 3>&, const vec<T, 3>&, const vec<T, 3>&, const vec<T, 3>&)
+ * for the ray in that lane.
+ *
+ * @tparam T the component type
+ * @tparam W the number of lanes
+ * @param r the ray packet
+ * @param p1 the first point
+ * @param p2 the second point
+ * @param p3 the third point
+ * @return the distance to the point of intersection for each lane, or NaN for each lane whose ray
+ * does not intersect the given triangle
+ */
+template <typename T, size_t W>
+std::array<T, W> intersect_ray_triangle(
+  const ray_packet<T, 3, W>& r, const vec<T, 3>& p1, const vec<T, 3>& p2, const vec<T, 3>& p3) {
+  using pack = detail::fixed_width_pack<T, W>;
+  // a vector of packs, with one pack per component
+  struct pack_vec {
+    typename pack::type v[3];
+  };
+
+  const auto broadcast = [](const vec<T, 3>& v) {
+    return pack_vec{{pack::set1(v[0]), pack::set1(v[1]), pack::set1(v[2])}};
+  };
+  const auto cross = [](const pack_vec& lhs, const pack_vec& rhs) {
+    return pack_vec{
+      {pack::sub(pack::mul(lhs.v[1], rhs.v[2]), pack::mul(lhs.v[2], rhs.v[1])),
+       pack::sub(pack::mul(lhs.v[2], rhs.v[0]), pack::mul(lhs.v[0], rhs.v[2])),
+       pack::sub(pack::mul(lhs.v[0], rhs.v[1]), pack::mul(lhs.v[1], rhs.v[0]))}};
+  };
+  const auto dot = [](const pack_vec& lhs, const pack_vec& rhs) {
+    return pack::add(
+      pack::add(pack::mul(lhs.v[0], rhs.v[0]), pack::mul(lhs.v[1], rhs.v[1])),
+      pack::mul(lhs.v[2], rhs.v[2]));
+  };
+
+  const auto e1 = broadcast(p2 - p1);
+  const auto e2 = broadcast(p3 - p1);
+  const auto zero = pack::set1(static_cast<T>(0.0));
+  const auto one = pack::set1(static_cast<T>(1.0));
+  const auto epsilon = pack::set1(constants<T>::almost_zero());
+  const auto negEpsilon = pack::set1(-constants<T>::almost_zero());
+  const auto miss = pack::set1(nan<T>());
+
+  auto result = std::array<T, W>();
+  for (std::size_t i = 0u; i < W; i += pack::width) {
+    const auto d = pack_vec{
+      {pack::load(&r.direction[0][i]), pack::load(&r.direction[1][i]),
+       pack::load(&r.direction[2][i])}};
+    const auto t = pack_vec{
+      {pack::sub(pack::load(&r.origin[0][i]), pack::set1(p1[0])),
+       pack::sub(pack::load(&r.origin[1][i]), pack::set1(p1[1])),
+       pack::sub(pack::load(&r.origin[2][i]), pack::set1(p1[2]))}};
+
+    const auto p = cross(d, e2);
+    const auto a = dot(p, e1);
+    const auto q = cross(t, e1);
+    const auto u = pack::div(dot(q, e2), a);
+    const auto v = pack::div(dot(p, t), a);
+    const auto w = pack::div(dot(q, d), a);
+
+    const auto hit = pack::mask_and(
+      pack::mask_and(
+        pack::mask_or(pack::gt(a, epsilon), pack::lt(a, negEpsilon)), pack::ge(u, zero)),
+      pack::mask_and(
+        pack::mask_and(pack::ge(v, zero), pack::ge(w, zero)), pack::le(pack::add(v, w), one)));
+    pack::store(&result[i], pack::select(hit, u, miss));
+  }
+  return result;
+}
+
 /**
  * Computes the point of intersection of the given ray and the polygon with the given vertices.
  *
@@ -415,6 +571,152 @@ constexpr T intersect_ray_bbox(const ray<T, S>& r, const bbox<T, S>& b) {
   return distances[bestPlane];
 }
 
+/**
+ * Intersects the ray of the given query with the given bounding box using the slab test, and
+ * returns the distances on the ray from its origin to the points where it enters and leaves the
+ * bounding box. The entry distance is negative if the origin of the ray is inside of the bounding
+ * box. If the entry distance is not negative, it is the distance returned by intersect_ray_bbox for
+ * the same ray and box, otherwise the exit distance is.
+ *
+ * Unlike intersect_ray_bbox, this function neither divides nor branches per component, which makes
+ * it faster when a ray is tested against many bounding boxes.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param q the ray query
+ * @param b the bounding box
+ * @return the entry and exit distances, or NaN for both if the ray does not intersect the bounding
+ * box
+ */
+template <typename T, size_t S>
+std::tuple<T, T> intersect_ray_bbox(const ray_query<T, S>& q, const bbox<T, S>& b) {
+  auto tNear = -std::numeric_limits<T>::infinity();
+  auto tFar = std::numeric_limits<T>::infinity();
+  for (size_t i = 0; i < S; ++i) {
+    const auto negative = q.is_negative(i);
+    const auto t0 = ((negative ? b.max[i] : b.min[i]) - q.origin[i]) * q.inv_direction[i];
+    const auto t1 = ((negative ? b.min[i] : b.max[i]) - q.origin[i]) * q.inv_direction[i];
+    // if the origin lies on a slab plane and the direction is parallel to it, t0 or t1 is NaN, and
+    // these comparisons ignore it
+    tNear = t0 > tNear ? t0 : tNear;
+    tFar = t1 < tFar ? t1 : tFar;
+  }
+
+  if (tNear > tFar || tFar < static_cast<T>(0.0)) {
+    return {nan<T>(), nan<T>()};
+  }
+  return {tNear, tFar};
+}
+
+/**
+ * Computes the point of intersection between the given ray and each of the bounding boxes with the
+ * given corners. The bounding box with index i has the corners mins[i] and maxs[i]. For finite
+ * inputs, each result is equal to the result of intersect_ray_bbox for that bounding box.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param r the ray
+ * @param mins the min corners of the bounding boxes
+ * @param maxs the max corners of the bounding boxes, which must have the same size as mins
+ * @param result receives the distances to the closest intersection points or NaN for each bounding
+ * box that the ray does not intersect, it is resized to the size of mins
+ */
+template <typename T, size_t S>
+void intersect_ray_bbox(
+  const ray<T, S>& r,
+  const vec_soa<T, S>& mins,
+  const vec_soa<T, S>& maxs,
+  std::vector<T>& result) {
+  assert(mins.size() == maxs.size());
+  result.resize(mins.size());
+  const auto minsData = detail::soa_data(mins);
+  const auto maxsData = detail::soa_data(maxs);
+  detail::dispatch_simd([&](auto k) {
+    decltype(k)::intersect_ray_bbox(
+      r.origin.v, r.direction.v, minsData, maxsData, result.data(), mins.size());
+  });
+}
+
+namespace detail {
+/**
+ * Performs the slab test of intersect_ray_bbox(const ray_query<T, S>&, const bbox<T, S>&) for the
+ * rays in the lanes [i, i + P::width) of the given packet, narrowing the given entry and exit
+ * distances to the given bounding box.
+ */
+template <typename P, typename T, size_t S, size_t W>
+void intersect_ray_packet_slabs(
+  const ray_packet<T, S, W>& r,
+  const bbox<T, S>& b,
+  const std::size_t i,
+  typename P::type& tNear,
+  typename P::type& tFar) {
+  const auto zero = P::set1(static_cast<T>(0.0));
+  for (size_t a = 0; a < S; ++a) {
+    const auto origin = P::load(&r.origin[a][i]);
+    const auto invDirection = P::load(&r.inv_direction[a][i]);
+    const auto negative = P::lt(invDirection, zero);
+    const auto min = P::set1(b.min[a]);
+    const auto max = P::set1(b.max[a]);
+    const auto t0 = P::mul(P::sub(P::select(negative, max, min), origin), invDirection);
+    const auto t1 = P::mul(P::sub(P::select(negative, min, max), origin), invDirection);
+    // if t0 or t1 is NaN, min and max return the second operand
+    tNear = P::max(t0, tNear);
+    tFar = P::min(t1, tFar);
+  }
+}
+
+/**
+ * Returns a mask with bit i set if the ray in lane i of the given packet enters the given bounding
+ * box at a distance in [0, maxDistances[i]], or if its origin is inside of the bounding box.
+ */
+template <typename T, size_t S, size_t W>
+unsigned int intersect_ray_packet_bbox_mask(
+  const ray_packet<T, S, W>& r, const bbox<T, S>& b, const T* maxDistances) {
+  using pack = fixed_width_pack<T, W>;
+  auto result = 0u;
+  for (std::size_t i = 0u; i < W; i += pack::width) {
+    auto tNear = pack::set1(static_cast<T>(0.0));
+    auto tFar = pack::load(maxDistances + i);
+    intersect_ray_packet_slabs<pack>(r, b, i, tNear, tFar);
+    result |= pack::bits(pack::le(tNear, tFar)) << i;
+  }
+  return result;
+}
+} // namespace detail
+
+/**
+ * Computes the point of intersection between each ray of the given packet and the given bounding
+ * box using the slab test. For finite inputs, the result for each lane is equal to the result of
+ * intersect_ray_bbox(const ray<T, S>&, const bbox<T, S>&) for the ray in that lane.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @tparam W the number of lanes
+ * @param r the ray packet
+ * @param b the bounding box
+ * @return the distance to the closest intersection point for each lane, or NaN for each lane whose
+ * ray does not intersect the bounding box
+ */
+template <typename T, size_t S, size_t W>
+std::array<T, W> intersect_ray_bbox(const ray_packet<T, S, W>& r, const bbox<T, S>& b) {
+  using pack = detail::fixed_width_pack<T, W>;
+  const auto zero = pack::set1(static_cast<T>(0.0));
+  const auto miss = pack::set1(nan<T>());
+
+  auto result = std::array<T, W>();
+  for (std::size_t i = 0u; i < W; i += pack::width) {
+    auto tNear = pack::set1(-std::numeric_limits<T>::infinity());
+    auto tFar = pack::set1(std::numeric_limits<T>::infinity());
+    detail::intersect_ray_packet_slabs<pack>(r, b, i, tNear, tFar);
+
+    // if the origin is inside of the box, the closest intersection is where the ray leaves it
+    const auto distance = pack::select(pack::ge(tNear, zero), tNear, tFar);
+    const auto hit = pack::mask_and(pack::le(tNear, tFar), pack::ge(tFar, zero));
+    pack::store(&result[i], pack::select(hit, distance, miss));
+  }
+  return result;
+}
+
 /**
  * Computes the point of intersection between the given ray and a sphere centered at the given
  * position and with the given radius.
@@ -21,9 +21,13 @@
 #pragma once
 
 #include "abstract_line.h"
+#include "affine.h"
 #include "mat.h"
+#include "transformation.h"
 #include "vec.h"
 
+#include <type_traits>
+
 namespace vm {
 /**
  * An infinite line represented by a point and a direction.
@@ -106,6 +110,53 @@ public:
     return line<T, S>(transform * point, normalize_c(strip_translation(transform) * direction));
   }
 
+  /**
+   * Transforms this line using the given affine transformation. The translational part is not
+   * applied to the direction, and the direction is normalized after the transformation was applied.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed line
+   */
+  line<T, S> transform(const affine<T, S>& transform) const {
+    return line<T, S>(transform * point, normalize(transform_vector(transform, direction)));
+  }
+
+  /**
+   * Transforms this line using the given affine transformation at compile time. The translational
+   * part is not applied to the direction, and the direction is normalized after the transformation
+   * was applied.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed line
+   */
+  constexpr line<T, S> transform_c(const affine<T, S>& transform) const {
+    return line<T, S>(transform * point, normalize_c(transform_vector(transform, direction)));
+  }
+
+  /**
+   * Transforms this line using the given transformation. The translational part is not applied to
+   * the direction, and the direction is normalized after the transformation was applied unless the
+   * transformation is rigid. Projective transformations are applied like a transformation matrix.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed line
+   */
+  line<T, S> transform(const transformation<T, S>& transform) const {
+    switch (transform.kind()) {
+    case transformation_kind::identity:
+      return *this;
+    case transformation_kind::translation:
+      return line<T, S>(point + transform.translation(), direction);
+    case transformation_kind::rigid:
+      return line<T, S>(transform * point, transform_vector(transform, direction));
+    case transformation_kind::affine:
+      return line<T, S>(transform * point, normalize(transform_vector(transform, direction)));
+    case transformation_kind::projective:
+      break;
+    }
+    return this->transform(transform.matrix());
+  }
+
   /**
    * Returns a canonical representation of the given line. Since a line could be represented by any
    * point on it plus its direction, every line has an infinite number of representations. This
@@ -134,6 +185,9 @@ public:
   }
 };
 
+static_assert(std::is_trivially_copyable_v<line<float, 3>>);
+static_assert(std::is_trivially_copyable_v<line<double, 3>>);
+
 /**
  * Checks whether the given lines have equal components.
  *
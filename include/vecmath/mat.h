@@ -25,6 +25,8 @@
 
 #include <cassert>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace vm {
 template <typename T, std::size_t R, std::size_t C> class mat {
@@ -39,6 +41,11 @@ public:
    */
   column_type v[C];
 
+private:
+  template <std::size_t... I>
+  mat(uninitialized_t, std::index_sequence<I...>)
+    : v{(static_cast<void>(I), column_type(uninitialized))...} {}
+
 public:
   /* ========== constructors and assignment operators ========== */
 
@@ -54,6 +61,12 @@ public:
     }
   }
 
+  /**
+   * Creates a new matrix without initializing its values.
+   */
+  explicit mat(uninitialized_t)
+    : mat(uninitialized, std::make_index_sequence<C>()) {}
+
   // Copy and move constructors
   mat(const mat<T, R, C>& other) = default;
   mat(mat<T, R, C>&& other) noexcept = default;
@@ -324,6 +337,9 @@ public:
   }
 };
 
+static_assert(std::is_trivially_copyable_v<mat<float, 4, 4>>);
+static_assert(std::is_trivially_copyable_v<mat<double, 4, 4>>);
+
 /* ========== comparison operators ========== */
 
 /**
@@ -499,6 +515,15 @@ constexpr mat<T, R, C> operator-(const mat<T, R, C>& lhs, const mat<T, R, C>& rh
  */
 template <typename T, std::size_t R1, std::size_t C1R2, std::size_t C2>
 constexpr mat<T, R1, C2> operator*(const mat<T, R1, C1R2>& lhs, const mat<T, C1R2, C2>& rhs) {
+  if constexpr (R1 == C1R2 && C1R2 == C2 && detail::simd_mat<T, R1>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      static_assert(sizeof(mat<T, R1, C2>) == R1 * C2 * sizeof(T), "matrix must be contiguous");
+      mat<T, R1, C2> result;
+      detail::simd_mat<T, R1>::mul(lhs.v[0].v, rhs.v[0].v, result.v[0].v);
+      return result;
+    }
+  }
+
   auto result = mat<T, R1, C2>::zero();
   for (size_t c = 0; c < C2; c++) {
     for (size_t r = 0; r < R1; r++) {
@@ -594,6 +619,15 @@ constexpr vec<T, R> operator*(const vec<T, R>& lhs, const mat<T, R, C>& rhs) {
  */
 template <typename T, std::size_t R, std::size_t C>
 constexpr vec<T, R> operator*(const mat<T, R, C>& lhs, const vec<T, C>& rhs) {
+  if constexpr (R == C && detail::simd_mat<T, R>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      static_assert(sizeof(mat<T, R, C>) == R * C * sizeof(T), "matrix must be contiguous");
+      vec<T, R> result;
+      detail::simd_mat<T, R>::mul_vec(lhs.v[0].v, rhs.v, result.v);
+      return result;
+    }
+  }
+
   vec<T, C> result;
   for (size_t r = 0; r < R; r++) {
     for (size_t c = 0; c < C; ++c) {
@@ -732,97 +766,6 @@ constexpr mat<T, R - 1, C - 1> extract_minor(
   return min;
 }
 
-namespace detail {
-/**
- * Helper struct to compute a matrix determinant. This struct implements a method that works for all
- * S, but there are partial specializations of this template for specific values of S for which
- * faster algorithms exist.
- *
- * @tparam T the component type
- * @tparam S the number of components
- */
-template <typename T, std::size_t S> struct matrix_determinant {
-  constexpr T operator()(const mat<T, S, S>& m) const {
-    // Laplace after first col
-    matrix_determinant<T, S - 1> determinant{};
-
-    auto result = static_cast<T>(0.0);
-    for (std::size_t r = 0; r < S; r++) {
-      const auto f = static_cast<T>(r % 2 == 0 ? 1.0 : -1.0);
-      result += f * m[0][r] * determinant(extract_minor(m, r, 0));
-    }
-    return result;
-  }
-};
-
-// TODO: implement faster block-matrix based method for NxN matrices where N = 2^n
-/**
- * Partial specialization to optimize for the case of a 3x3 matrix.
- *
- * @tparam T the component type
- */
-template <typename T> struct matrix_determinant<T, 3> {
-  constexpr T operator()(const mat<T, 3, 3>& m) const {
-    return (
-      m[0][0] * m[1][1] * m[2][2] + m[1][0] * m[2][1] * m[0][2] + m[2][0] * m[0][1] * m[1][2] -
-      m[2][0] * m[1][1] * m[0][2] - m[1][0] * m[0][1] * m[2][2] - m[0][0] * m[2][1] * m[1][2]);
-  }
-};
-
-/**
- * Partial specialization to optimize for the case of a 2x2 matrix.
- *
- * @tparam T the component type
- */
-template <typename T> struct matrix_determinant<T, 2> {
-  constexpr T operator()(const mat<T, 2, 2>& m) const {
-    return (m[0][0] * m[1][1] - m[1][0] * m[0][1]);
-  }
-};
-
-/**
- * Partial specialization to optimize for the case of a 1x1 matrix.
- *
- * @tparam T the component type
- */
-template <typename T> struct matrix_determinant<T, 1> {
-  constexpr T operator()(const mat<T, 1, 1>& m) const { return m[0][0]; }
-};
-} // namespace detail
-
-/**
- * Computes the determinant of the given square matrix.
- *
- * @tparam T the component type
- * @tparam S the number of components
- * @param m the matrix to compute the determinant of
- * @return the determinant of the given matrix
- */
-template <typename T, std::size_t S> constexpr T compute_determinant(const mat<T, S, S>& m) {
-  return detail::matrix_determinant<T, S>()(m);
-}
-
-/**
- * Computes the adjugate of the given square matrix.
- *
- * @tparam T the component type
- * @tparam S the number of components
- * @param m the matrix to compute the adjugate of
- * @return the adjugate of the given matrix
- */
-template <typename T, std::size_t S>
-constexpr mat<T, S, S> compute_adjugate(const mat<T, S, S>& m) {
-  mat<T, S, S> result;
-  for (size_t c = 0; c < S; c++) {
-    for (size_t r = 0; r < S; r++) {
-      const auto f = static_cast<T>((c + r) % 2 == 0 ? 1.0 : -1.0);
-      result[r][c] =
-        f * compute_determinant(extract_minor(m, r, c)); // transpose the matrix on the fly
-    }
-  }
-  return result;
-}
-
 namespace detail {
 /**
  * Finds an LUP decomposition of matrix a.
@@ -910,6 +853,150 @@ constexpr vec<T, S> lup_solve_internal(
 }
 } // namespace detail
 
+namespace detail {
+/**
+ * Helper struct to compute a matrix determinant. This struct implements a method that works for all
+ * S, but there are partial specializations of this template for specific values of S for which
+ * faster algorithms exist.
+ *
+ * The general method performs Gaussian elimination with partial pivoting, which takes O(S^3) steps.
+ * The determinant is then the product of the pivots, negated for each row swap. Unlike
+ * lup_find_decomposition, which rejects pivots below a fixed threshold, the elimination only stops
+ * at a pivot that is exactly 0, so that the determinant of a regular matrix with small components
+ * is not 0.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ */
+template <typename T, std::size_t S> struct matrix_determinant {
+  constexpr T operator()(mat<T, S, S> a) const {
+    auto result = static_cast<T>(1.0);
+    for (std::size_t k = 0; k < S; ++k) {
+      T p(0);
+      std::size_t kPrime = k;
+      for (std::size_t i = k; i < S; ++i) {
+        if (vm::abs(a[k][i]) > p) {
+          p = vm::abs(a[k][i]);
+          kPrime = i;
+        }
+      }
+      if (p == static_cast<T>(0.0)) {
+        return static_cast<T>(0.0);
+      }
+      if (kPrime != k) {
+        for (std::size_t j = k; j < S; ++j) {
+          swap(a[j][k], a[j][kPrime]);
+        }
+        result = -result;
+      }
+      result *= a[k][k];
+      for (std::size_t i = k + 1; i < S; ++i) {
+        const auto f = a[k][i] / a[k][k];
+        for (std::size_t j = k + 1; j < S; ++j) {
+          a[j][i] = a[j][i] - f * a[j][k];
+        }
+      }
+    }
+    return result;
+  }
+};
+
+/**
+ * Partial specialization to optimize for the case of a 4x4 matrix. The determinant is expanded by
+ * the complementary 2x2 minors of the first two and the last two rows (Laplace expansion).
+ *
+ * @tparam T the component type
+ */
+template <typename T> struct matrix_determinant<T, 4> {
+  constexpr T operator()(const mat<T, 4, 4>& m) const {
+    // 2x2 minors of rows 0 and 1
+    const auto s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+    const auto s1 = m[0][0] * m[2][1] - m[2][0] * m[0][1];
+    const auto s2 = m[0][0] * m[3][1] - m[3][0] * m[0][1];
+    const auto s3 = m[1][0] * m[2][1] - m[2][0] * m[1][1];
+    const auto s4 = m[1][0] * m[3][1] - m[3][0] * m[1][1];
+    const auto s5 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+    // 2x2 minors of rows 2 and 3
+    const auto c0 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+    const auto c1 = m[0][2] * m[2][3] - m[2][2] * m[0][3];
+    const auto c2 = m[0][2] * m[3][3] - m[3][2] * m[0][3];
+    const auto c3 = m[1][2] * m[2][3] - m[2][2] * m[1][3];
+    const auto c4 = m[1][2] * m[3][3] - m[3][2] * m[1][3];
+    const auto c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  }
+};
+
+/**
+ * Partial specialization to optimize for the case of a 3x3 matrix.
+ *
+ * @tparam T the component type
+ */
+template <typename T> struct matrix_determinant<T, 3> {
+  constexpr T operator()(const mat<T, 3, 3>& m) const {
+    return (
+      m[0][0] * m[1][1] * m[2][2] + m[1][0] * m[2][1] * m[0][2] + m[2][0] * m[0][1] * m[1][2] -
+      m[2][0] * m[1][1] * m[0][2] - m[1][0] * m[0][1] * m[2][2] - m[0][0] * m[2][1] * m[1][2]);
+  }
+};
+
+/**
+ * Partial specialization to optimize for the case of a 2x2 matrix.
+ *
+ * @tparam T the component type
+ */
+template <typename T> struct matrix_determinant<T, 2> {
+  constexpr T operator()(const mat<T, 2, 2>& m) const {
+    return (m[0][0] * m[1][1] - m[1][0] * m[0][1]);
+  }
+};
+
+/**
+ * Partial specialization to optimize for the case of a 1x1 matrix.
+ *
+ * @tparam T the component type
+ */
+template <typename T> struct matrix_determinant<T, 1> {
+  constexpr T operator()(const mat<T, 1, 1>& m) const { return m[0][0]; }
+};
+} // namespace detail
+
+/**
+ * Computes the determinant of the given square matrix. Matrices with up to four rows and columns
+ * use closed form expressions, larger matrices use their LUP decomposition.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param m the matrix to compute the determinant of
+ * @return the determinant of the given matrix
+ */
+template <typename T, std::size_t S> constexpr T compute_determinant(const mat<T, S, S>& m) {
+  return detail::matrix_determinant<T, S>()(m);
+}
+
+/**
+ * Computes the adjugate of the given square matrix.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param m the matrix to compute the adjugate of
+ * @return the adjugate of the given matrix
+ */
+template <typename T, std::size_t S>
+constexpr mat<T, S, S> compute_adjugate(const mat<T, S, S>& m) {
+  mat<T, S, S> result;
+  for (size_t c = 0; c < S; c++) {
+    for (size_t r = 0; r < S; r++) {
+      const auto f = static_cast<T>((c + r) % 2 == 0 ? 1.0 : -1.0);
+      result[r][c] =
+        f * compute_determinant(extract_minor(m, r, c)); // transpose the matrix on the fly
+    }
+  }
+  return result;
+}
+
 /**
  * Solves a system of equations expressed as a*x=b, using LU factorization with pivoting.
  *
@@ -932,8 +1019,9 @@ constexpr std::tuple<bool, vec<T, S>> lup_solve(const mat<T, S, S>& a, const vec
   return std::make_tuple(true, detail::lup_solve_internal(lu, pi, b));
 }
 
+namespace detail {
 /**
- * Inverts the given square matrix if possible.
+ * Inverts the given square matrix using its LUP decomposition.
  *
  * Uses the technique from "Computing a matrix inverse from an LUP decomposition"
  * Introduction to Algorithms by Cormen et. al., 2nd. ed. p755.
@@ -945,8 +1033,8 @@ constexpr std::tuple<bool, vec<T, S>> lup_solve(const mat<T, S, S>& a, const vec
  * matrix is invertible, and if so, the matrix is the inverted given matrix
  */
 template <typename T, std::size_t S>
-constexpr std::tuple<bool, mat<T, S, S>> invert(const mat<T, S, S>& m) {
-  const auto decomp = detail::lup_find_decomposition(m);
+constexpr std::tuple<bool, mat<T, S, S>> invert_lup(const mat<T, S, S>& m) {
+  const auto decomp = lup_find_decomposition(m);
   const bool success = std::get<0>(decomp);
   if (!success) {
     return std::make_tuple(false, mat<T, S, S>::identity());
@@ -960,8 +1048,240 @@ constexpr std::tuple<bool, mat<T, S, S>> invert(const mat<T, S, S>& m) {
     vec<T, S> targetColumn; // ith column of the S by S identity matrix
     targetColumn[i] = static_cast<T>(1);
 
-    result[i] = detail::lup_solve_internal(lu, pi, targetColumn);
+    result[i] = lup_solve_internal(lu, pi, targetColumn);
+  }
+  return std::make_tuple(true, result);
+}
+
+/**
+ * Indicates whether a matrix with the given determinant can safely be inverted using the closed
+ * form inverses below. The threshold is the one that lup_find_decomposition uses for the pivots, so
+ * that matrices which are singular or nearly so are always left to the LUP decomposition.
+ */
+template <typename T> constexpr bool is_closed_form_invertible(const T determinant) {
+  // also rejects NaN
+  return vm::abs(determinant) >= static_cast<T>(1.0e-15);
+}
+
+/**
+ * Inverts the given 2x2 matrix using its adjugate.
+ *
+ * @tparam T the component type
+ * @param m the matrix to invert
+ * @return a pair of a boolean and a matrix such that the boolean indicates whether the closed form
+ * could safely be used, and if so, the matrix is the inverted given matrix
+ */
+template <typename T>
+constexpr std::tuple<bool, mat<T, 2, 2>> invert_closed_form(const mat<T, 2, 2>& m) {
+  const auto det = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+  if (!is_closed_form_invertible(det)) {
+    return std::make_tuple(false, mat<T, 2, 2>::identity());
+  }
+
+  const auto invDet = static_cast<T>(1) / det;
+  mat<T, 2, 2> result;
+  result[0][0] = m[1][1] * invDet;
+  result[0][1] = -m[0][1] * invDet;
+  result[1][0] = -m[1][0] * invDet;
+  result[1][1] = m[0][0] * invDet;
+  return std::make_tuple(true, result);
+}
+
+/**
+ * Inverts the given 3x3 matrix using its adjugate.
+ *
+ * @tparam T the component type
+ * @param m the matrix to invert
+ * @return a pair of a boolean and a matrix such that the boolean indicates whether the closed form
+ * could safely be used, and if so, the matrix is the inverted given matrix
+ */
+template <typename T>
+constexpr std::tuple<bool, mat<T, 3, 3>> invert_closed_form(const mat<T, 3, 3>& m) {
+  // cofactors of the first row
+  const auto c00 = m[1][1] * m[2][2] - m[2][1] * m[1][2];
+  const auto c01 = m[2][1] * m[0][2] - m[0][1] * m[2][2];
+  const auto c02 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+
+  const auto det = m[0][0] * c00 + m[1][0] * c01 + m[2][0] * c02;
+  if (!is_closed_form_invertible(det)) {
+    return std::make_tuple(false, mat<T, 3, 3>::identity());
   }
+
+  const auto invDet = static_cast<T>(1) / det;
+  mat<T, 3, 3> result;
+  result[0][0] = c00 * invDet;
+  result[0][1] = c01 * invDet;
+  result[0][2] = c02 * invDet;
+  result[1][0] = (m[2][0] * m[1][2] - m[1][0] * m[2][2]) * invDet;
+  result[1][1] = (m[0][0] * m[2][2] - m[2][0] * m[0][2]) * invDet;
+  result[1][2] = (m[1][0] * m[0][2] - m[0][0] * m[1][2]) * invDet;
+  result[2][0] = (m[1][0] * m[2][1] - m[2][0] * m[1][1]) * invDet;
+  result[2][1] = (m[2][0] * m[0][1] - m[0][0] * m[2][1]) * invDet;
+  result[2][2] = (m[0][0] * m[1][1] - m[1][0] * m[0][1]) * invDet;
   return std::make_tuple(true, result);
 }
+
+/**
+ * Inverts the given 4x4 matrix using its adjugate. The cofactors are computed from the 2x2 minors
+ * of the first two and the last two rows, which are shared between the cofactors.
+ *
+ * @tparam T the component type
+ * @param m the matrix to invert
+ * @return a pair of a boolean and a matrix such that the boolean indicates whether the closed form
+ * could safely be used, and if so, the matrix is the inverted given matrix
+ */
+template <typename T>
+constexpr std::tuple<bool, mat<T, 4, 4>> invert_closed_form(const mat<T, 4, 4>& m) {
+  // 2x2 minors of rows 0 and 1
+  const auto s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+  const auto s1 = m[0][0] * m[2][1] - m[2][0] * m[0][1];
+  const auto s2 = m[0][0] * m[3][1] - m[3][0] * m[0][1];
+  const auto s3 = m[1][0] * m[2][1] - m[2][0] * m[1][1];
+  const auto s4 = m[1][0] * m[3][1] - m[3][0] * m[1][1];
+  const auto s5 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+  // 2x2 minors of rows 2 and 3
+  const auto c0 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+  const auto c1 = m[0][2] * m[2][3] - m[2][2] * m[0][3];
+  const auto c2 = m[0][2] * m[3][3] - m[3][2] * m[0][3];
+  const auto c3 = m[1][2] * m[2][3] - m[2][2] * m[1][3];
+  const auto c4 = m[1][2] * m[3][3] - m[3][2] * m[1][3];
+  const auto c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+
+  const auto det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  if (!is_closed_form_invertible(det)) {
+    return std::make_tuple(false, mat<T, 4, 4>::identity());
+  }
+
+  const auto invDet = static_cast<T>(1) / det;
+  mat<T, 4, 4> result;
+  result[0][0] = (m[1][1] * c5 - m[2][1] * c4 + m[3][1] * c3) * invDet;
+  result[1][0] = (-m[1][0] * c5 + m[2][0] * c4 - m[3][0] * c3) * invDet;
+  result[2][0] = (m[1][3] * s5 - m[2][3] * s4 + m[3][3] * s3) * invDet;
+  result[3][0] = (-m[1][2] * s5 + m[2][2] * s4 - m[3][2] * s3) * invDet;
+
+  result[0][1] = (-m[0][1] * c5 + m[2][1] * c2 - m[3][1] * c1) * invDet;
+  result[1][1] = (m[0][0] * c5 - m[2][0] * c2 + m[3][0] * c1) * invDet;
+  result[2][1] = (-m[0][3] * s5 + m[2][3] * s2 - m[3][3] * s1) * invDet;
+  result[3][1] = (m[0][2] * s5 - m[2][2] * s2 + m[3][2] * s1) * invDet;
+
+  result[0][2] = (m[0][1] * c4 - m[1][1] * c2 + m[3][1] * c0) * invDet;
+  result[1][2] = (-m[0][0] * c4 + m[1][0] * c2 - m[3][0] * c0) * invDet;
+  result[2][2] = (m[0][3] * s4 - m[1][3] * s2 + m[3][3] * s0) * invDet;
+  result[3][2] = (-m[0][2] * s4 + m[1][2] * s2 - m[3][2] * s0) * invDet;
+
+  result[0][3] = (-m[0][1] * c3 + m[1][1] * c1 - m[2][1] * c0) * invDet;
+  result[1][3] = (m[0][0] * c3 - m[1][0] * c1 + m[2][0] * c0) * invDet;
+  result[2][3] = (-m[0][3] * s3 + m[1][3] * s1 - m[2][3] * s0) * invDet;
+  result[3][3] = (m[0][2] * s3 - m[1][2] * s1 + m[2][2] * s0) * invDet;
+  return std::make_tuple(true, result);
+}
+
+/**
+ * Inverts the given 2x2, 3x3 or 4x4 matrix using the closed form inverse if that is safe, and
+ * using the LUP decomposition otherwise.
+ */
+template <typename T, std::size_t S>
+constexpr std::tuple<bool, mat<T, S, S>> invert_small(const mat<T, S, S>& m) {
+  const auto closedForm = invert_closed_form(m);
+  if (std::get<0>(closedForm)) {
+    return closedForm;
+  }
+  return invert_lup(m);
+}
+} // namespace detail
+
+/**
+ * Checks whether the given square matrix is an affine transformation, i.e., whether its last row
+ * is (0, ..., 0, 1).
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param m the matrix to check
+ * @return true if the given matrix is an affine transformation and false otherwise
+ */
+template <typename T, std::size_t S> constexpr bool is_affine(const mat<T, S, S>& m) {
+  for (std::size_t c = 0; c < S - 1; ++c) {
+    if (m[c][S - 1] != static_cast<T>(0)) {
+      return false;
+    }
+  }
+  return m[S - 1][S - 1] == static_cast<T>(1);
+}
+
+/**
+ * Inverts the given affine transformation if possible. The upper left (S-1)x(S-1) block of the
+ * given matrix is inverted, and the inverse translation is obtained by transforming the negated
+ * translation with the inverted block.
+ *
+ * The result is unspecified if the given matrix is not an affine transformation, see is_affine.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param m the matrix to invert
+ * @return a pair of a boolean and a matrix such that the boolean indicates whether the
+ * matrix is invertible, and if so, the matrix is the inverted given matrix
+ */
+template <typename T, std::size_t S>
+constexpr std::tuple<bool, mat<T, S, S>> invert_affine(const mat<T, S, S>& m) {
+  static_assert(S > 1, "matrix must have at least two rows and columns");
+
+  mat<T, S - 1, S - 1> block;
+  for (std::size_t c = 0; c < S - 1; ++c) {
+    for (std::size_t r = 0; r < S - 1; ++r) {
+      block[c][r] = m[c][r];
+    }
+  }
+
+  const auto blockInverse = invert(block);
+  if (!std::get<0>(blockInverse)) {
+    return std::make_tuple(false, mat<T, S, S>::identity());
+  }
+
+  const auto& inverse = std::get<1>(blockInverse);
+  mat<T, S, S> result;
+  for (std::size_t c = 0; c < S - 1; ++c) {
+    for (std::size_t r = 0; r < S - 1; ++r) {
+      result[c][r] = inverse[c][r];
+    }
+  }
+
+  // the translation is -inverse * t
+  for (std::size_t r = 0; r < S - 1; ++r) {
+    auto t = static_cast<T>(0);
+    for (std::size_t c = 0; c < S - 1; ++c) {
+      t -= inverse[c][r] * m[S - 1][c];
+    }
+    result[S - 1][r] = t;
+  }
+  return std::make_tuple(true, result);
+}
+
+/**
+ * Inverts the given square matrix if possible.
+ *
+ * Affine transformations with three or four rows and columns are inverted with invert_affine. Other
+ * matrices with up to four rows and columns are inverted in closed form unless their determinant is
+ * close to zero. All other matrices are inverted using the technique from "Computing a matrix
+ * inverse from an LUP decomposition" Introduction to Algorithms by Cormen et. al., 2nd. ed. p755.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param m the matrix to invert
+ * @return a pair of a boolean and a matrix such that the boolean indicates whether the
+ * matrix is invertible, and if so, the matrix is the inverted given matrix
+ */
+template <typename T, std::size_t S>
+constexpr std::tuple<bool, mat<T, S, S>> invert(const mat<T, S, S>& m) {
+  if constexpr (S == 3u || S == 4u) {
+    if (is_affine(m)) {
+      return invert_affine(m);
+    }
+  }
+  if constexpr (S >= 2u && S <= 4u) {
+    return detail::invert_small(m);
+  } else {
+    return detail::invert_lup(m);
+  }
+}
 } // namespace vm
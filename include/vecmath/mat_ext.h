@@ -25,12 +25,195 @@
 #include "quat.h"
 #include "util.h"
 #include "vec.h"
+#include "vec_ext.h"
 
 #include <array>
+#include <cstddef>
+#include <iterator>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 namespace vm {
+/**
+ * Multiplies each of the vectors in the range [cur, end) with the given matrix and writes the
+ * products to the given output iterator, which may be cur. If the vectors have C - 1 components,
+ * they are treated as points, i.e., they are converted to homogeneous coordinates before the
+ * multiplication, and the products are converted back to cartesian coordinates. Runs as a SIMD
+ * loop if the iterators are pointers.
+ *
+ * @tparam T the component type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @tparam I the input iterator type
+ * @tparam O the output iterator type
+ * @param lhs the matrix
+ * @param cur the start of the range of vectors
+ * @param end the end of the range of vectors
+ * @param out the output iterator
+ * @return the output iterator past the last product
+ */
+template <typename T, std::size_t R, std::size_t C, typename I, typename O>
+O multiply(const mat<T, R, C>& lhs, I cur, I end, O out) {
+  using V = typename std::iterator_traits<I>::value_type;
+  if constexpr (std::is_base_of_v<vec<T, C>, V>) {
+    return detail::aos_transform<T, C, R>(cur, end, out, [=](auto p, const auto& in, auto& result) {
+      using P = decltype(p);
+      for (std::size_t r = 0; r < R; ++r) {
+        result[r] = P::set1(T(0));
+        for (std::size_t c = 0; c < C; ++c) {
+          result[r] = P::add(result[r], P::mul(P::set1(lhs[c][r]), in[c]));
+        }
+      }
+    });
+  } else {
+    static_assert(
+      std::is_base_of_v<vec<T, C - 1>, V>, "vectors must have C or C - 1 components");
+    return detail::aos_transform<T, C - 1, R - 1>(
+      cur, end, out, [=](auto p, const auto& in, auto& result) {
+        using P = decltype(p);
+        auto w = P::set1(lhs[C - 1][R - 1]);
+        for (std::size_t c = 0; c < C - 1; ++c) {
+          w = P::add(w, P::mul(P::set1(lhs[c][R - 1]), in[c]));
+        }
+        for (std::size_t r = 0; r < R - 1; ++r) {
+          auto sum = P::set1(lhs[C - 1][r]);
+          for (std::size_t c = 0; c < C - 1; ++c) {
+            sum = P::add(sum, P::mul(P::set1(lhs[c][r]), in[c]));
+          }
+          result[r] = P::div(sum, w);
+        }
+      });
+  }
+}
+
+/**
+ * Multiplies each of the vectors in the range [cur, end) with the given matrix from the left and
+ * writes the products to the given output iterator, which may be cur. If the vectors have R - 1
+ * components, they are treated as points, see above. Runs as a SIMD loop if the iterators are
+ * pointers.
+ *
+ * @tparam I the input iterator type
+ * @tparam O the output iterator type
+ * @tparam T the component type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @param cur the start of the range of vectors
+ * @param end the end of the range of vectors
+ * @param rhs the matrix
+ * @param out the output iterator
+ * @return the output iterator past the last product
+ */
+template <typename I, typename O, typename T, std::size_t R, std::size_t C>
+O multiply(I cur, I end, const mat<T, R, C>& rhs, O out) {
+  using V = typename std::iterator_traits<I>::value_type;
+  if constexpr (std::is_base_of_v<vec<T, R>, V>) {
+    return detail::aos_transform<T, R, C>(cur, end, out, [=](auto p, const auto& in, auto& result) {
+      using P = decltype(p);
+      for (std::size_t c = 0; c < C; ++c) {
+        result[c] = P::set1(T(0));
+        for (std::size_t r = 0; r < R; ++r) {
+          result[c] = P::add(result[c], P::mul(in[r], P::set1(rhs[c][r])));
+        }
+      }
+    });
+  } else {
+    static_assert(
+      std::is_base_of_v<vec<T, R - 1>, V>, "vectors must have R or R - 1 components");
+    return detail::aos_transform<T, R - 1, C - 1>(
+      cur, end, out, [=](auto p, const auto& in, auto& result) {
+        using P = decltype(p);
+        auto w = P::set1(rhs[C - 1][R - 1]);
+        for (std::size_t r = 0; r < R - 1; ++r) {
+          w = P::add(w, P::mul(in[r], P::set1(rhs[C - 1][r])));
+        }
+        for (std::size_t c = 0; c < C - 1; ++c) {
+          auto sum = P::set1(rhs[c][R - 1]);
+          for (std::size_t r = 0; r < R - 1; ++r) {
+            sum = P::add(sum, P::mul(in[r], P::set1(rhs[c][r])));
+          }
+          result[c] = P::div(sum, w);
+        }
+      });
+  }
+}
+
+/**
+ * Multiplies each of the vectors in the given vector with the given matrix. The result may be rhs
+ * if R equals C, and it is not reallocated if its capacity suffices.
+ *
+ * @tparam T the component type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @param lhs the matrix
+ * @param rhs the vector of vectors
+ * @param result receives the products, it is resized to the size of rhs
+ */
+template <typename T, std::size_t R, std::size_t C>
+void multiply(
+  const mat<T, R, C>& lhs, const std::vector<vec<T, C>>& rhs, std::vector<vec<T, R>>& result) {
+  result.resize(rhs.size());
+  multiply(lhs, rhs.data(), rhs.data() + rhs.size(), result.data());
+}
+
+/**
+ * Multiplies each of the points in the given vector with the given matrix, see above. The result
+ * may be rhs, and it is not reallocated if its capacity suffices.
+ *
+ * @tparam T the component type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @param lhs the matrix
+ * @param rhs the vector of points
+ * @param result receives the transformed points, it is resized to the size of rhs
+ */
+template <typename T, std::size_t R, std::size_t C>
+void multiply(
+  const mat<T, R, C>& lhs,
+  const std::vector<vec<T, C - 1>>& rhs,
+  std::vector<vec<T, R - 1>>& result) {
+  result.resize(rhs.size());
+  multiply(lhs, rhs.data(), rhs.data() + rhs.size(), result.data());
+}
+
+/**
+ * Multiplies each of the vectors in the given vector with the given matrix from the left. The
+ * result may be lhs if R equals C, and it is not reallocated if its capacity suffices.
+ *
+ * @tparam T the component type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @param lhs the vector of vectors
+ * @param rhs the matrix
+ * @param result receives the products, it is resized to the size of lhs
+ */
+template <typename T, std::size_t R, std::size_t C>
+void multiply(
+  const std::vector<vec<T, R>>& lhs, const mat<T, R, C>& rhs, std::vector<vec<T, C>>& result) {
+  result.resize(lhs.size());
+  multiply(lhs.data(), lhs.data() + lhs.size(), rhs, result.data());
+}
+
+/**
+ * Multiplies each of the points in the given vector with the given matrix from the left, see
+ * above. The result may be lhs, and it is not reallocated if its capacity suffices.
+ *
+ * @tparam T the component type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @param lhs the vector of points
+ * @param rhs the matrix
+ * @param result receives the transformed points, it is resized to the size of lhs
+ */
+template <typename T, std::size_t R, std::size_t C>
+void multiply(
+  const std::vector<vec<T, R - 1>>& lhs,
+  const mat<T, R, C>& rhs,
+  std::vector<vec<T, C - 1>>& result) {
+  result.resize(lhs.size());
+  multiply(lhs.data(), lhs.data() + lhs.size(), rhs, result.data());
+}
+
 /**
  * Multiplies the given list of vectors with the given matrix.
  *
@@ -44,10 +227,7 @@ namespace vm {
 template <typename T, std::size_t R, std::size_t C>
 std::vector<vec<T, C>> operator*(const mat<T, R, C>& lhs, const std::vector<vec<T, C>>& rhs) {
   std::vector<vec<T, C>> result;
-  result.reserve(rhs.size());
-  for (const auto& v : rhs) {
-    result.push_back(lhs * v);
-  }
+  multiply(lhs, rhs, result);
   return result;
 }
 
@@ -86,10 +266,7 @@ template <typename T, std::size_t R, std::size_t C>
 std::vector<vec<T, C - 1>> operator*(
   const mat<T, R, C>& lhs, const std::vector<vec<T, C - 1>>& rhs) {
   std::vector<vec<T, C - 1>> result;
-  result.reserve(rhs.size());
-  for (const auto& v : rhs) {
-    result.push_back(lhs * v);
-  }
+  multiply(lhs, rhs, result);
   return result;
 }
 
@@ -127,10 +304,7 @@ constexpr std::array<vec<T, C - 1>, N> operator*(
 template <typename T, std::size_t R, std::size_t C>
 std::vector<vec<T, R>> operator*(const std::vector<vec<T, R>>& lhs, const mat<T, R, C>& rhs) {
   std::vector<vec<T, R>> result;
-  result.reserve(lhs.size());
-  for (const auto& v : lhs) {
-    result.push_back(v * rhs);
-  }
+  multiply(lhs, rhs, result);
   return result;
 }
 
@@ -169,10 +343,7 @@ template <typename T, std::size_t R, std::size_t C>
 std::vector<vec<T, R - 1>> operator*(
   const std::vector<vec<T, R - 1>>& lhs, const mat<T, R, C>& rhs) {
   std::vector<vec<T, R - 1>> result;
-  result.reserve(lhs.size());
-  for (const auto& v : lhs) {
-    result.push_back(v * rhs);
-  }
+  multiply(lhs, rhs, result);
   return result;
 }
 
@@ -708,39 +879,37 @@ constexpr mat<T, 4, 4> points_transformation_matrix(
   const auto vec1Out = onPlane2Out - onPlane0Out;
   const auto vec2Out = offPlaneOut - onPlane0Out;
 
-  // Set up a system of equations that will find the upper-left 3x3 part of a 4x4 affine matrix with
-  // no translation.
+  // The upper-left 3x3 part L of the affine matrix must map the input vectors to the output
+  // vectors, i.e. L * In = Out where In and Out have the input and output vectors as columns. Hence
+  // L = Out * In^-1.
+  mat<T, 3, 3> in;
+  in[0] = vec0In;
+  in[1] = vec1In;
+  in[2] = vec2In;
 
-  // A*X=B
-
-  const vec<T, 9> B{
-    vec0Out.x(), vec0Out.y(), vec0Out.z(), vec1Out.x(), vec1Out.y(),
-    vec1Out.z(), vec2Out.x(), vec2Out.y(), vec2Out.z(),
-  };
-
-  const mat<T, 9, 9> A{
-    vec0In.x(), vec0In.y(), vec0In.z(), 0.0,        0.0,        0.0,        0.0,        0.0,
-    0.0,        0.0,        0.0,        0.0,        vec0In.x(), vec0In.y(), vec0In.z(), 0.0,
-    0.0,        0.0,        0.0,        0.0,        0.0,        0.0,        0.0,        0.0,
-    vec0In.x(), vec0In.y(), vec0In.z(), vec1In.x(), vec1In.y(), vec1In.z(), 0.0,        0.0,
-    0.0,        0.0,        0.0,        0.0,        0.0,        0.0,        0.0,        vec1In.x(),
-    vec1In.y(), vec1In.z(), 0.0,        0.0,        0.0,        0.0,        0.0,        0.0,
-    0.0,        0.0,        0.0,        vec1In.x(), vec1In.y(), vec1In.z(), vec2In.x(), vec2In.y(),
-    vec2In.z(), 0.0,        0.0,        0.0,        0.0,        0.0,        0.0,        0.0,
-    0.0,        0.0,        vec2In.x(), vec2In.y(), vec2In.z(), 0.0,        0.0,        0.0,
-    0.0,        0.0,        0.0,        0.0,        0.0,        0.0,        vec2In.x(), vec2In.y(),
-    vec2In.z()};
-
-  const auto [success, X] = lup_solve(A, B);
+  const auto [success, inInverse] = invert(in);
   if (!success) {
     return mat<T, 4, 4>::fill(nan<T>());
   }
 
-  const mat<T, 4, 4> xformWithoutTranslation(
-    X[0], X[1], X[2], 0.0, X[3], X[4], X[5], 0.0, X[6], X[7], X[8], 0.0, 0.0, 0.0, 0.0, 1.0);
+  mat<T, 3, 3> out;
+  out[0] = vec0Out;
+  out[1] = vec1Out;
+  out[2] = vec2Out;
+
+  const auto xformWithoutTranslation = out * inInverse;
 
-  return translation_matrix(onPlane0Out) * xformWithoutTranslation *
-         translation_matrix(-onPlane0In);
+  // compensate for the translations, i.e. onPlane0In must be mapped to onPlane0Out
+  const auto translation = onPlane0Out - xformWithoutTranslation * onPlane0In;
+
+  mat<T, 4, 4> result;
+  for (std::size_t c = 0u; c < 3u; ++c) {
+    for (std::size_t r = 0u; r < 3u; ++r) {
+      result[c][r] = xformWithoutTranslation[c][r];
+    }
+    result[3][c] = translation[c];
+  }
+  return result;
 }
 
 /**
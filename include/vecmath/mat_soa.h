@@ -0,0 +1,741 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "mat.h"
+#include "simd.h"
+#include "vec.h"
+#include "vec_soa.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace vm {
+/**
+ * A sequence of matrices that is stored as a structure of arrays: Each element of all matrices is
+ * stored in a separate contiguous array, so the batch operations below can process one matrix per
+ * SIMD lane.
+ *
+ * @tparam T the element type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ */
+template <typename T, std::size_t R, std::size_t C> class mat_soa {
+public:
+  using element_type = T;
+  static constexpr std::size_t rows = R;
+  static constexpr std::size_t cols = C;
+
+private:
+  // column major, like mat
+  std::vector<T> m_elements[C][R];
+
+public:
+  /**
+   * Creates a new empty instance.
+   */
+  mat_soa() = default;
+
+  /**
+   * Creates a new instance with the given number of matrices, all of whose elements are
+   * initialized to 0.
+   *
+   * @param size the number of matrices
+   */
+  explicit mat_soa(const std::size_t size) { resize(size); }
+
+  /**
+   * Creates a new instance containing the matrices in the given range. For each element of the
+   * range, the given getter is called to obtain the matrix to store.
+   *
+   * @tparam I the range iterator type
+   * @tparam G the type of the getter
+   * @param cur the start of the range
+   * @param end the end of the range
+   * @param get the getter
+   */
+  template <typename I, typename G = identity> mat_soa(I cur, I end, const G& get = G()) {
+    while (cur != end) {
+      push_back(get(*cur));
+      ++cur;
+    }
+  }
+
+  /**
+   * Creates a new instance containing the given matrices.
+   *
+   * @param mats the matrices to store
+   */
+  explicit mat_soa(const std::vector<mat<T, R, C>>& mats) {
+    reserve(mats.size());
+    for (const auto& m : mats) {
+      push_back(m);
+    }
+  }
+
+  /**
+   * Returns the number of matrices.
+   */
+  std::size_t size() const { return m_elements[0][0].size(); }
+
+  /**
+   * Indicates whether this instance contains no matrices.
+   */
+  bool empty() const { return m_elements[0][0].empty(); }
+
+  /**
+   * Reserves memory for the given number of matrices.
+   *
+   * @param capacity the number of matrices
+   */
+  void reserve(const std::size_t capacity) {
+    for (std::size_t c = 0; c < C; ++c) {
+      for (std::size_t r = 0; r < R; ++r) {
+        m_elements[c][r].reserve(capacity);
+      }
+    }
+  }
+
+  /**
+   * Changes the number of matrices. The elements of added matrices are initialized to 0.
+   *
+   * @param size the number of matrices
+   */
+  void resize(const std::size_t size) {
+    for (std::size_t c = 0; c < C; ++c) {
+      for (std::size_t r = 0; r < R; ++r) {
+        m_elements[c][r].resize(size);
+      }
+    }
+  }
+
+  /**
+   * Removes all matrices.
+   */
+  void clear() {
+    for (std::size_t c = 0; c < C; ++c) {
+      for (std::size_t r = 0; r < R; ++r) {
+        m_elements[c][r].clear();
+      }
+    }
+  }
+
+  /**
+   * Appends the given matrix.
+   *
+   * @param m the matrix to append
+   */
+  void push_back(const mat<T, R, C>& m) {
+    for (std::size_t c = 0; c < C; ++c) {
+      for (std::size_t r = 0; r < R; ++r) {
+        m_elements[c][r].push_back(m[c][r]);
+      }
+    }
+  }
+
+  /**
+   * Returns the matrix at the given index.
+   *
+   * @param index the index of the matrix to return, which must be less than size()
+   * @return the matrix at the given index
+   */
+  mat<T, R, C> operator[](const std::size_t index) const {
+    assert(index < size());
+    mat<T, R, C> result;
+    for (std::size_t c = 0; c < C; ++c) {
+      for (std::size_t r = 0; r < R; ++r) {
+        result[c][r] = m_elements[c][r][index];
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Replaces the matrix at the given index.
+   *
+   * @param index the index of the matrix to replace, which must be less than size()
+   * @param m the new matrix
+   */
+  void set(const std::size_t index, const mat<T, R, C>& m) {
+    assert(index < size());
+    for (std::size_t c = 0; c < C; ++c) {
+      for (std::size_t r = 0; r < R; ++r) {
+        m_elements[c][r][index] = m[c][r];
+      }
+    }
+  }
+
+  /**
+   * Returns a pointer to the array that contains the given element of every matrix.
+   *
+   * @param col the column of the element, which must be less than C
+   * @param row the row of the element, which must be less than R
+   * @return a pointer to the first element of the array
+   */
+  T* data(const std::size_t col, const std::size_t row) {
+    assert(col < C && row < R);
+    return m_elements[col][row].data();
+  }
+
+  /**
+   * Returns a pointer to the array that contains the given element of every matrix.
+   *
+   * @param col the column of the element, which must be less than C
+   * @param row the row of the element, which must be less than R
+   * @return a pointer to the first element of the array
+   */
+  const T* data(const std::size_t col, const std::size_t row) const {
+    assert(col < C && row < R);
+    return m_elements[col][row].data();
+  }
+
+  /**
+   * Returns the stored matrices as an array of matrices.
+   */
+  std::vector<mat<T, R, C>> to_vector() const {
+    std::vector<mat<T, R, C>> result;
+    result.reserve(size());
+    for (std::size_t i = 0; i < size(); ++i) {
+      result.push_back((*this)[i]);
+    }
+    return result;
+  }
+
+  /**
+   * Checks whether the given instances contain the same matrices.
+   *
+   * @param lhs the first instance
+   * @param rhs the second instance
+   * @return true if the given instances are equal and false otherwise
+   */
+  friend bool operator==(const mat_soa& lhs, const mat_soa& rhs) {
+    for (std::size_t c = 0; c < C; ++c) {
+      for (std::size_t r = 0; r < R; ++r) {
+        if (lhs.m_elements[c][r] != rhs.m_elements[c][r]) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Checks whether the given instances do not contain the same matrices.
+   *
+   * @param lhs the first instance
+   * @param rhs the second instance
+   * @return false if the given instances are equal and true otherwise
+   */
+  friend bool operator!=(const mat_soa& lhs, const mat_soa& rhs) { return !(lhs == rhs); }
+};
+
+namespace detail {
+template <typename T, std::size_t R, std::size_t C>
+std::array<std::array<const T*, R>, C> soa_data(const mat_soa<T, R, C>& m) {
+  std::array<std::array<const T*, R>, C> result;
+  for (std::size_t c = 0; c < C; ++c) {
+    for (std::size_t r = 0; r < R; ++r) {
+      result[c][r] = m.data(c, r);
+    }
+  }
+  return result;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+std::array<std::array<T*, R>, C> soa_data(mat_soa<T, R, C>& m) {
+  std::array<std::array<T*, R>, C> result;
+  for (std::size_t c = 0; c < C; ++c) {
+    for (std::size_t r = 0; r < R; ++r) {
+      result[c][r] = m.data(c, r);
+    }
+  }
+  return result;
+}
+
+template <typename P, typename T, std::size_t R, std::size_t C>
+void soa_load(
+  const std::array<std::array<const T*, R>, C>& m,
+  const std::size_t i,
+  typename P::type (&out)[C][R]) {
+  for (std::size_t c = 0; c < C; ++c) {
+    for (std::size_t r = 0; r < R; ++r) {
+      out[c][r] = P::load(m[c][r] + i);
+    }
+  }
+}
+
+template <typename P, typename T, std::size_t R, std::size_t C>
+void soa_store(
+  const std::array<std::array<T*, R>, C>& m,
+  const std::size_t i,
+  const typename P::type (&in)[C][R]) {
+  for (std::size_t c = 0; c < C; ++c) {
+    for (std::size_t r = 0; r < R; ++r) {
+      P::store(m[c][r] + i, in[c][r]);
+    }
+  }
+}
+
+/*
+ * Transposes P::width consecutive matrices into one matrix per SIMD lane and back, so that the
+ * batch operations can also be applied to arrays of matrices.
+ */
+template <typename P, typename T, std::size_t R, std::size_t C>
+void aos_load(const mat<T, R, C>* m, typename P::type (&out)[C][R]) {
+  for (std::size_t c = 0; c < C; ++c) {
+    for (std::size_t r = 0; r < R; ++r) {
+      T lanes[P::width];
+      for (std::size_t l = 0; l < P::width; ++l) {
+        lanes[l] = m[l][c][r];
+      }
+      out[c][r] = P::load(lanes);
+    }
+  }
+}
+
+template <typename P, typename T, std::size_t R, std::size_t C>
+void aos_store(mat<T, R, C>* m, const typename P::type (&in)[C][R]) {
+  for (std::size_t c = 0; c < C; ++c) {
+    for (std::size_t r = 0; r < R; ++r) {
+      T lanes[P::width];
+      P::store(lanes, in[c][r]);
+      for (std::size_t l = 0; l < P::width; ++l) {
+        m[l][c][r] = lanes[l];
+      }
+    }
+  }
+}
+
+/**
+ * Stores the given mask into the given flags, one flag per lane.
+ */
+template <typename P>
+void soa_store_flags(
+  std::vector<bool>& flags, const std::size_t i, const typename P::mask_type m) {
+  const auto bits = P::bits(m);
+  for (std::size_t l = 0; l < P::width; ++l) {
+    flags[i + l] = ((bits >> l) & 1u) != 0u;
+  }
+}
+
+/**
+ * Factors the matrix in each lane of a using LUP decomposition and applies the factorization to
+ * the N right hand sides in b, so that b contains the solution x of a*x=b afterwards. This is the
+ * batch equivalent of lup_find_decomposition followed by lup_solve_internal, with the difference
+ * that the row swaps are applied to b directly instead of being recorded in a permutation vector,
+ * since the lanes generally pick different pivots.
+ *
+ * The pivots are chosen exactly like in lup_find_decomposition. Instead of returning early when a
+ * lane has no suitable pivot, that lane is marked as failed and computation continues with a
+ * pivot of 1, so that the failed lane doesn't produce floating point exceptions.
+ *
+ * @tparam P the pack type
+ * @tparam T the component type
+ * @tparam S the size of the systems
+ * @tparam N the number of right hand sides
+ * @param a the matrices, which are overwritten with unspecified values
+ * @param b the right hand sides, which are replaced by the solutions
+ * @return a mask of the lanes for which a solution was found
+ */
+template <typename P, typename T, std::size_t S, std::size_t N>
+typename P::mask_type lup_solve_packed(typename P::type (&a)[S][S], typename P::type (&b)[N][S]) {
+  using type = typename P::type;
+  const auto zero = P::set1(T(0));
+  const auto one = P::set1(T(1));
+  const auto epsilon = P::set1(T(1.0e-15));
+
+  auto success = P::ge(one, zero);
+  for (std::size_t k = 0; k < S; ++k) {
+    // find the pivot row in each lane, the row index is kept as a T so that it can be selected
+    auto p = zero;
+    auto kPrime = zero;
+    for (std::size_t i = k; i < S; ++i) {
+      const auto abs = P::max(a[k][i], P::sub(zero, a[k][i]));
+      const auto greater = P::gt(abs, p);
+      p = P::select(greater, abs, p);
+      kPrime = P::select(greater, P::set1(static_cast<T>(i)), kPrime);
+    }
+    const auto found = P::ge(p, epsilon);
+    success = P::mask_and(success, found);
+
+    // swap row k with row kPrime, only one of the rows below k is selected in each lane
+    for (std::size_t i = k + 1; i < S; ++i) {
+      const auto row = P::set1(static_cast<T>(i));
+      const auto isPivot = P::mask_and(P::ge(kPrime, row), P::ge(row, kPrime));
+      for (std::size_t j = 0; j < S; ++j) {
+        const type tmp = a[j][k];
+        a[j][k] = P::select(isPivot, a[j][i], tmp);
+        a[j][i] = P::select(isPivot, tmp, a[j][i]);
+      }
+      for (std::size_t n = 0; n < N; ++n) {
+        const type tmp = b[n][k];
+        b[n][k] = P::select(isPivot, b[n][i], tmp);
+        b[n][i] = P::select(isPivot, tmp, b[n][i]);
+      }
+    }
+
+    const auto pivot = P::select(found, a[k][k], one);
+    a[k][k] = pivot;
+    for (std::size_t i = k + 1; i < S; ++i) {
+      a[k][i] = P::div(a[k][i], pivot);
+      for (std::size_t j = k + 1; j < S; ++j) {
+        a[j][i] = P::sub(a[j][i], P::mul(a[k][i], a[j][k]));
+      }
+    }
+  }
+
+  for (std::size_t n = 0; n < N; ++n) {
+    // forward substitution, the diagonal of L is 1
+    for (std::size_t i = 1; i < S; ++i) {
+      auto sum = zero;
+      for (std::size_t j = 0; j < i; ++j) {
+        sum = P::add(sum, P::mul(a[j][i], b[n][j]));
+      }
+      b[n][i] = P::sub(b[n][i], sum);
+    }
+    // back substitution
+    for (std::size_t i = S - 1; i < S; --i) {
+      auto sum = zero;
+      for (std::size_t j = i + 1; j < S; ++j) {
+        sum = P::add(sum, P::mul(a[j][i], b[n][j]));
+      }
+      b[n][i] = P::div(P::sub(b[n][i], sum), a[i][i]);
+    }
+  }
+
+  return success;
+}
+
+/**
+ * Inverts the 4x4 matrix in each lane of m using its adjugate, like invert_closed_form.
+ *
+ * @tparam P the pack type
+ * @tparam T the component type
+ * @param m the matrices to invert
+ * @param out receives the inverted matrices
+ * @return a mask of the lanes for which the closed form could safely be used; the other lanes of
+ * out are unspecified
+ */
+template <typename P, typename T>
+typename P::mask_type invert_closed_form_packed(
+  const typename P::type (&m)[4][4], typename P::type (&out)[4][4]) {
+  using type = typename P::type;
+  const auto minor = [](const type a, const type b, const type c, const type d) {
+    return P::sub(P::mul(a, b), P::mul(c, d));
+  };
+  const auto cofactor =
+    [](const type a, const type x, const type b, const type y, const type c, const type z) {
+      return P::add(P::sub(P::mul(a, x), P::mul(b, y)), P::mul(c, z));
+    };
+
+  // 2x2 minors of rows 0 and 1
+  const auto s0 = minor(m[0][0], m[1][1], m[1][0], m[0][1]);
+  const auto s1 = minor(m[0][0], m[2][1], m[2][0], m[0][1]);
+  const auto s2 = minor(m[0][0], m[3][1], m[3][0], m[0][1]);
+  const auto s3 = minor(m[1][0], m[2][1], m[2][0], m[1][1]);
+  const auto s4 = minor(m[1][0], m[3][1], m[3][0], m[1][1]);
+  const auto s5 = minor(m[2][0], m[3][1], m[3][0], m[2][1]);
+
+  // 2x2 minors of rows 2 and 3
+  const auto c0 = minor(m[0][2], m[1][3], m[1][2], m[0][3]);
+  const auto c1 = minor(m[0][2], m[2][3], m[2][2], m[0][3]);
+  const auto c2 = minor(m[0][2], m[3][3], m[3][2], m[0][3]);
+  const auto c3 = minor(m[1][2], m[2][3], m[2][2], m[1][3]);
+  const auto c4 = minor(m[1][2], m[3][3], m[3][2], m[1][3]);
+  const auto c5 = minor(m[2][2], m[3][3], m[3][2], m[2][3]);
+
+  const auto det = P::add(
+    P::add(cofactor(s0, c5, s1, c4, s2, c3), P::mul(s3, c2)), minor(s5, c0, s4, c1));
+
+  const auto zero = P::set1(T(0));
+  const auto one = P::set1(T(1));
+  // also rejects NaN, see is_closed_form_invertible
+  const auto invertible = P::ge(P::max(det, P::sub(zero, det)), P::set1(T(1.0e-15)));
+  const auto invDet = P::div(one, P::select(invertible, det, one));
+  const auto negInvDet = P::sub(zero, invDet);
+
+  out[0][0] = P::mul(cofactor(m[1][1], c5, m[2][1], c4, m[3][1], c3), invDet);
+  out[1][0] = P::mul(cofactor(m[1][0], c5, m[2][0], c4, m[3][0], c3), negInvDet);
+  out[2][0] = P::mul(cofactor(m[1][3], s5, m[2][3], s4, m[3][3], s3), invDet);
+  out[3][0] = P::mul(cofactor(m[1][2], s5, m[2][2], s4, m[3][2], s3), negInvDet);
+
+  out[0][1] = P::mul(cofactor(m[0][1], c5, m[2][1], c2, m[3][1], c1), negInvDet);
+  out[1][1] = P::mul(cofactor(m[0][0], c5, m[2][0], c2, m[3][0], c1), invDet);
+  out[2][1] = P::mul(cofactor(m[0][3], s5, m[2][3], s2, m[3][3], s1), negInvDet);
+  out[3][1] = P::mul(cofactor(m[0][2], s5, m[2][2], s2, m[3][2], s1), invDet);
+
+  out[0][2] = P::mul(cofactor(m[0][1], c4, m[1][1], c2, m[3][1], c0), invDet);
+  out[1][2] = P::mul(cofactor(m[0][0], c4, m[1][0], c2, m[3][0], c0), negInvDet);
+  out[2][2] = P::mul(cofactor(m[0][3], s4, m[1][3], s2, m[3][3], s0), invDet);
+  out[3][2] = P::mul(cofactor(m[0][2], s4, m[1][2], s2, m[3][2], s0), negInvDet);
+
+  out[0][3] = P::mul(cofactor(m[0][1], c3, m[1][1], c1, m[2][1], c0), negInvDet);
+  out[1][3] = P::mul(cofactor(m[0][0], c3, m[1][0], c1, m[2][0], c0), invDet);
+  out[2][3] = P::mul(cofactor(m[0][3], s3, m[1][3], s1, m[2][3], s0), negInvDet);
+  out[3][3] = P::mul(cofactor(m[0][2], s3, m[1][2], s1, m[2][2], s0), invDet);
+
+  return invertible;
+}
+
+/**
+ * Inverts the matrix in each lane of m. 4x4 matrices are inverted using the closed form, all other
+ * matrices are inverted by solving for the columns of the identity matrix.
+ *
+ * @tparam P the pack type
+ * @tparam T the component type
+ * @tparam S the number of rows and columns
+ * @param m the matrices to invert, which are overwritten with unspecified values
+ * @param out receives the inverted matrices
+ * @return a mask of the lanes that were inverted; the other lanes of out are unspecified and must
+ * be inverted with invert, which can still succeed for nearly singular matrices
+ */
+template <typename P, typename T, std::size_t S>
+typename P::mask_type invert_packed(typename P::type (&m)[S][S], typename P::type (&out)[S][S]) {
+  if constexpr (S == 4u) {
+    return invert_closed_form_packed<P, T>(m, out);
+  } else {
+    for (std::size_t c = 0; c < S; ++c) {
+      for (std::size_t r = 0; r < S; ++r) {
+        out[c][r] = P::set1(c == r ? T(1) : T(0));
+      }
+    }
+    return lup_solve_packed<P, T>(m, out);
+  }
+}
+
+/**
+ * Inverts the matrices of the lanes for which the given mask is not set with invert.
+ *
+ * @tparam P the pack type
+ * @tparam T the component type
+ * @tparam S the number of rows and columns
+ * @tparam F the type of the function that stores an inverted matrix at an index
+ * @param inverted the mask returned by invert_packed
+ * @param original the matrices of all lanes
+ * @param i the index of the first lane
+ * @param set the function that stores an inverted matrix at an index
+ * @param invertible receives whether each matrix is invertible
+ */
+template <typename P, typename T, std::size_t S, typename F>
+void invert_remaining(
+  const typename P::mask_type inverted,
+  const std::array<mat<T, S, S>, P::width>& original,
+  const std::size_t i,
+  const F& set,
+  std::vector<bool>& invertible) {
+  const auto bits = P::bits(inverted);
+  for (std::size_t l = 0; l < P::width; ++l) {
+    if ((bits >> l) & 1u) {
+      invertible[i + l] = true;
+    } else {
+      const auto [success, inverse] = invert(original[l]);
+      set(i + l, inverse);
+      invertible[i + l] = success;
+    }
+  }
+}
+} // namespace detail
+
+/**
+ * Solves each system of equations a[i]*x[i]=b[i] in the given sequences using LU factorization
+ * with partial pivoting. This computes the same solutions as calling lup_solve for each system, but
+ * solves one system per SIMD lane.
+ *
+ * @tparam T the component type
+ * @tparam S the size of the systems
+ * @param a the square matrices
+ * @param b the column vectors, which must have the same size as a
+ * @param x receives the solutions, it is resized to the size of a; the solutions of the systems for
+ * which no solution could be found are unspecified
+ * @param success receives whether a solution was found for each system, it is resized to the size
+ * of a
+ */
+template <typename T, std::size_t S>
+void lup_solve(
+  const mat_soa<T, S, S>& a,
+  const vec_soa<T, S>& b,
+  vec_soa<T, S>& x,
+  std::vector<bool>& success) {
+  assert(a.size() == b.size());
+  x.resize(a.size());
+  success.resize(a.size());
+  const auto aData = detail::soa_data(a);
+  const auto bData = detail::soa_data(b);
+  const auto xData = detail::soa_data(x);
+  auto* successData = &success;
+  detail::for_each_pack<T>(a.size(), [=](auto p, const std::size_t first, const std::size_t last) {
+    using P = decltype(p);
+    for (auto i = first; i < last; i += P::width) {
+      typename P::type m[S][S], v[1][S];
+      detail::soa_load<P>(aData, i, m);
+      detail::soa_load<P>(bData, i, v[0]);
+      const auto solved = detail::lup_solve_packed<P, T>(m, v);
+      detail::soa_store<P>(xData, i, v[0]);
+      detail::soa_store_flags<P>(*successData, i, solved);
+    }
+  });
+}
+
+/**
+ * Solves each system of equations a[i]*x[i]=b[i] in the given sequences using LU factorization
+ * with partial pivoting.
+ *
+ * @tparam T the component type
+ * @tparam S the size of the systems
+ * @param a the square matrices
+ * @param b the column vectors, which must have the same size as a
+ * @return {whether a solution was found for each system, the solutions}; the solutions of the
+ * systems for which no solution could be found are unspecified
+ */
+template <typename T, std::size_t S>
+std::tuple<std::vector<bool>, vec_soa<T, S>> lup_solve(
+  const mat_soa<T, S, S>& a, const vec_soa<T, S>& b) {
+  std::vector<bool> success;
+  vec_soa<T, S> x;
+  lup_solve(a, b, x, success);
+  return std::make_tuple(std::move(success), std::move(x));
+}
+
+/**
+ * Inverts each matrix in the given sequence. The matrices are inverted using the closed form
+ * (4x4) or LUP decomposition (other sizes) with one matrix per SIMD lane, and the few matrices for
+ * which that fails are inverted individually with invert, so that the same matrices are reported as
+ * invertible as if invert were called for each matrix. The result may be the given sequence.
+ *
+ * @tparam T the component type
+ * @tparam S the number of rows and columns
+ * @param mats the matrices to invert
+ * @param result receives the inverted matrices, it is resized to the size of mats; the matrices
+ * that are not invertible are replaced by the identity matrix
+ * @param invertible receives whether each matrix is invertible, it is resized to the size of mats
+ */
+template <typename T, std::size_t S>
+void invert(
+  const mat_soa<T, S, S>& mats, mat_soa<T, S, S>& result, std::vector<bool>& invertible) {
+  result.resize(mats.size());
+  invertible.resize(mats.size());
+  const auto matsData = detail::soa_data(mats);
+  const auto resultData = detail::soa_data(result);
+  const auto* matsPtr = &mats;
+  auto* resultPtr = &result;
+  auto* invertiblePtr = &invertible;
+  detail::for_each_pack<T>(
+    mats.size(), [=](auto p, const std::size_t first, const std::size_t last) {
+      using P = decltype(p);
+      for (auto i = first; i < last; i += P::width) {
+        typename P::type m[S][S], inv[S][S];
+        detail::soa_load<P>(matsData, i, m);
+        const auto inverted = detail::invert_packed<P, T>(m, inv);
+        if (P::bits(inverted) == (1u << P::width) - 1u) {
+          detail::soa_store<P>(resultData, i, inv);
+          for (std::size_t l = 0; l < P::width; ++l) {
+            (*invertiblePtr)[i + l] = true;
+          }
+        } else {
+          // keep the original matrices for the fallback, since result may be mats
+          std::array<mat<T, S, S>, P::width> original;
+          for (std::size_t l = 0; l < P::width; ++l) {
+            original[l] = (*matsPtr)[i + l];
+          }
+          detail::soa_store<P>(resultData, i, inv);
+          detail::invert_remaining<P>(
+            inverted,
+            original,
+            i,
+            [&](const std::size_t j, const mat<T, S, S>& inverse) { resultPtr->set(j, inverse); },
+            *invertiblePtr);
+        }
+      }
+    });
+}
+
+/**
+ * Inverts each matrix in the given sequence, see above.
+ *
+ * @tparam T the component type
+ * @tparam S the number of rows and columns
+ * @param mats the matrices to invert
+ * @return {whether each matrix is invertible, the inverted matrices}; the matrices that are not
+ * invertible are replaced by the identity matrix
+ */
+template <typename T, std::size_t S>
+std::tuple<std::vector<bool>, mat_soa<T, S, S>> invert(const mat_soa<T, S, S>& mats) {
+  std::vector<bool> invertible;
+  mat_soa<T, S, S> result;
+  invert(mats, result, invertible);
+  return std::make_tuple(std::move(invertible), std::move(result));
+}
+
+/**
+ * Inverts each matrix in the given array of matrices, see above. The matrices are transposed into
+ * one matrix per SIMD lane on the fly, which is faster than inverting them one by one, but slower
+ * than inverting matrices that are already stored in a mat_soa. The result may be the given array.
+ *
+ * @tparam T the component type
+ * @tparam S the number of rows and columns
+ * @param mats the matrices to invert
+ * @param result receives the inverted matrices, it is resized to the size of mats; the matrices
+ * that are not invertible are replaced by the identity matrix
+ * @param invertible receives whether each matrix is invertible, it is resized to the size of mats
+ */
+template <typename T, std::size_t S>
+void invert(
+  const std::vector<mat<T, S, S>>& mats,
+  std::vector<mat<T, S, S>>& result,
+  std::vector<bool>& invertible) {
+  result.resize(mats.size());
+  invertible.resize(mats.size());
+  const auto* matsData = mats.data();
+  auto* resultData = result.data();
+  auto* invertiblePtr = &invertible;
+  detail::for_each_pack<T>(
+    mats.size(), [=](auto p, const std::size_t first, const std::size_t last) {
+      using P = decltype(p);
+      for (auto i = first; i < last; i += P::width) {
+        typename P::type m[S][S], inv[S][S];
+        detail::aos_load<P>(matsData + i, m);
+        const auto inverted = detail::invert_packed<P, T>(m, inv);
+        if (P::bits(inverted) == (1u << P::width) - 1u) {
+          detail::aos_store<P>(resultData + i, inv);
+          for (std::size_t l = 0; l < P::width; ++l) {
+            (*invertiblePtr)[i + l] = true;
+          }
+        } else {
+          // keep the original matrices for the fallback, since result may be mats
+          std::array<mat<T, S, S>, P::width> original;
+          std::copy(matsData + i, matsData + i + P::width, std::begin(original));
+          detail::aos_store<P>(resultData + i, inv);
+          detail::invert_remaining<P>(
+            inverted,
+            original,
+            i,
+            [&](const std::size_t j, const mat<T, S, S>& inverse) { resultData[j] = inverse; },
+            *invertiblePtr);
+        }
+      }
+    });
+}
+} // namespace vm
@@ -0,0 +1,624 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "bbox.h"
+#include "mat.h"
+#include "mat_ext.h"
+#include "scalar.h"
+#include "vec.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vm {
+/**
+ * Runs tasks one after another on the calling thread.
+ */
+class sequential_executor {
+public:
+  /**
+   * Returns the number of tasks that may run at the same time.
+   */
+  std::size_t concurrency() const { return 1u; }
+
+  /**
+   * Calls f(i) for each i in [0, count) in ascending order.
+   *
+   * @tparam F the type of the task function
+   * @param count the number of tasks
+   * @param f the task function
+   */
+  template <typename F> void run(const std::size_t count, const F& f) const {
+    for (std::size_t i = 0u; i < count; ++i) {
+      f(i);
+    }
+  }
+};
+
+namespace detail {
+/**
+ * A fixed set of worker threads that wait for jobs. Each job is run by the calling thread together
+ * with the workers, and each of them takes the next task from a shared counter until no tasks
+ * remain. The workers are started when they are first needed and are joined when the pool is
+ * destroyed.
+ */
+class thread_pool {
+private:
+  struct job {
+    std::size_t count;
+    std::size_t workerCount;
+    const void* function;
+    void (*call)(const void*, std::size_t);
+    std::atomic<std::size_t> next;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+  };
+
+  std::size_t m_maxWorkerCount;
+  std::vector<std::thread> m_workers;
+  std::mutex m_runMutex;
+  std::mutex m_mutex;
+  std::condition_variable m_jobAvailable;
+  std::condition_variable m_jobDone;
+  job* m_job;
+  std::size_t m_generation;
+  std::size_t m_busyWorkerCount;
+  bool m_stop;
+
+public:
+  explicit thread_pool(const std::size_t maxWorkerCount)
+    : m_maxWorkerCount(maxWorkerCount)
+    , m_job(nullptr)
+    , m_generation(0u)
+    , m_busyWorkerCount(0u)
+    , m_stop(false) {}
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  ~thread_pool() {
+    {
+      const auto lock = std::lock_guard<std::mutex>(m_mutex);
+      m_stop = true;
+    }
+    m_jobAvailable.notify_all();
+    for (auto& worker : m_workers) {
+      worker.join();
+    }
+  }
+
+  /**
+   * Calls f(i) for each i in [0, count) on the calling thread and on up to the given number of
+   * workers. Returns false without calling f if the pool is already running a job, i.e., if this
+   * is called from a task or concurrently from another thread.
+   */
+  template <typename F>
+  bool try_run(const std::size_t count, const std::size_t workerCount, const F& f) {
+    auto runLock = std::unique_lock<std::mutex>(m_runMutex, std::try_to_lock);
+    if (!runLock.owns_lock()) {
+      return false;
+    }
+
+    start_workers(std::min(workerCount, m_maxWorkerCount));
+
+    auto j = job{
+      count,
+      workerCount,
+      &f,
+      [](const void* function, const std::size_t i) { (*static_cast<const F*>(function))(i); },
+      {0u},
+      nullptr,
+      {}};
+    {
+      const auto lock = std::lock_guard<std::mutex>(m_mutex);
+      m_job = &j;
+      m_busyWorkerCount = m_workers.size();
+      ++m_generation;
+    }
+    m_jobAvailable.notify_all();
+
+    work(j);
+    {
+      auto lock = std::unique_lock<std::mutex>(m_mutex);
+      m_jobDone.wait(lock, [&]() { return m_busyWorkerCount == 0u; });
+      m_job = nullptr;
+    }
+    if (j.error) {
+      std::rethrow_exception(j.error);
+    }
+    return true;
+  }
+
+private:
+  void start_workers(const std::size_t workerCount) {
+    try {
+      while (m_workers.size() < workerCount) {
+        const auto index = m_workers.size();
+        const auto generation = m_generation;
+        m_workers.emplace_back([this, index, generation]() { worker_loop(index, generation); });
+      }
+    } catch (const std::system_error&) {
+      // run the jobs on the workers that could be started
+    }
+  }
+
+  /**
+   * Runs each job after the one with the given generation until the pool is destroyed.
+   */
+  void worker_loop(const std::size_t index, std::size_t generation) {
+    auto lock = std::unique_lock<std::mutex>(m_mutex);
+    while (true) {
+      m_jobAvailable.wait(lock, [&]() { return m_stop || m_generation != generation; });
+      if (m_stop) {
+        return;
+      }
+      generation = m_generation;
+
+      auto* j = m_job;
+      lock.unlock();
+      if (index < j->workerCount) {
+        work(*j);
+      }
+      lock.lock();
+
+      if (--m_busyWorkerCount == 0u) {
+        m_jobDone.notify_one();
+      }
+    }
+  }
+
+  static void work(job& j) {
+    for (auto i = j.next++; i < j.count; i = j.next++) {
+      try {
+        j.call(j.function, i);
+      } catch (...) {
+        const auto lock = std::lock_guard<std::mutex>(j.errorMutex);
+        if (!j.error) {
+          j.error = std::current_exception();
+        }
+        j.next = j.count;
+      }
+    }
+  }
+};
+} // namespace detail
+
+/**
+ * Runs tasks on up to a given number of threads, one of which is the calling thread. The other
+ * threads are kept in a pool that is started by the first call to run and is shared by all copies
+ * of the executor, so that each call only has to wake them up. Each thread takes the next task
+ * from a shared counter until no tasks remain, so threads that finish early take over the tasks
+ * that are left.
+ */
+class thread_executor {
+private:
+  std::size_t m_concurrency;
+  std::shared_ptr<detail::thread_pool> m_pool;
+
+  static std::size_t hardware_concurrency() {
+    return std::max(std::size_t(1u), std::size_t(std::thread::hardware_concurrency()));
+  }
+
+public:
+  /**
+   * Creates a new executor that runs tasks on up to the given number of threads. If the given
+   * number is 0, the number of hardware threads is used.
+   *
+   * @param i_concurrency the maximum number of threads
+   */
+  explicit thread_executor(const std::size_t i_concurrency = 0u)
+    : m_concurrency(i_concurrency > 0u ? i_concurrency : hardware_concurrency())
+    , m_pool(std::make_shared<detail::thread_pool>(m_concurrency - 1u)) {}
+
+  /**
+   * Returns the number of tasks that may run at the same time.
+   */
+  std::size_t concurrency() const { return m_concurrency; }
+
+  /**
+   * Calls f(i) for each i in [0, count) and returns once all calls have returned. The calls may run
+   * concurrently and in any order. If a call throws an exception, no further tasks are started and
+   * the first exception is rethrown once the running tasks have finished. If no thread can be
+   * started, or if the executor is already running tasks, e.g. when this is called from a task, all
+   * tasks run on the calling thread.
+   *
+   * @tparam F the type of the task function
+   * @param count the number of tasks
+   * @param f the task function
+   */
+  template <typename F> void run(const std::size_t count, const F& f) const {
+    const auto threadCount = std::min(m_concurrency, count);
+    if (threadCount <= 1u || !m_pool->try_run(count, threadCount - 1u, f)) {
+      sequential_executor().run(count, f);
+    }
+  }
+};
+
+/**
+ * Selects the parallel overloads of the batch operations. These split their range into chunks of
+ * a fixed size, process the chunks as tasks of the given executor, and combine the partial results
+ * pairwise in a fixed order. Since the chunks and the order only depend on the size of the range
+ * and on the chunk size, the results are bit-identical for every executor and number of threads.
+ * If the range fits into a single chunk, it is processed on the calling thread. The overloads are
+ * declared in this header, so that code that does not use them neither includes the thread headers
+ * nor needs to link a thread library.
+ *
+ * @tparam E the executor type, see sequential_executor and thread_executor
+ */
+template <typename E = thread_executor> class parallel_policy {
+public:
+  /**
+   * The default number of elements per chunk, large enough to make the cost of starting a task
+   * negligible for most operations.
+   */
+  static constexpr std::size_t default_chunk_size = 16384u;
+
+private:
+  E m_executor;
+  std::size_t m_chunkSize;
+
+public:
+  /**
+   * Creates a new policy with the given executor and chunk size.
+   *
+   * @param i_executor the executor that runs the chunks
+   * @param i_chunkSize the number of elements per chunk, must not be 0
+   */
+  explicit parallel_policy(E i_executor = E(), const std::size_t i_chunkSize = default_chunk_size)
+    : m_executor(std::move(i_executor))
+    , m_chunkSize(std::max(std::size_t(1u), i_chunkSize)) {}
+
+  /**
+   * Returns the executor.
+   */
+  const E& executor() const { return m_executor; }
+
+  /**
+   * Returns the number of elements per chunk.
+   */
+  std::size_t chunk_size() const { return m_chunkSize; }
+
+  /**
+   * Returns the number of chunks that a range of the given size is split into.
+   */
+  std::size_t chunk_count(const std::size_t count) const {
+    return (count + m_chunkSize - 1u) / m_chunkSize;
+  }
+};
+
+namespace detail {
+/**
+ * Calls f(first, last) for each chunk [first, last) of the range [0, count) using the given
+ * policy's executor.
+ */
+template <typename E, typename F>
+void for_each_chunk(const parallel_policy<E>& policy, const std::size_t count, const F& f) {
+  const auto chunkSize = policy.chunk_size();
+  const auto chunkCount = policy.chunk_count(count);
+  if (chunkCount <= 1u) {
+    f(std::size_t(0u), count);
+    return;
+  }
+  policy.executor().run(chunkCount, [&](const std::size_t chunk) {
+    const auto first = chunk * chunkSize;
+    f(first, std::min(first + chunkSize, count));
+  });
+}
+
+/**
+ * Maps each chunk [first, last) of the range [0, count) to a partial result by calling
+ * map(first, last), and combines the partial results pairwise using combine, i.e., neighbouring
+ * partial results are combined until one remains, and an odd one out is carried to the next round.
+ * Compared to folding from left to right, this reduces the rounding error of sums from O(n) to
+ * O(log n) in the number of chunks. The range must not be empty.
+ *
+ * @return the combined result
+ */
+template <typename R, typename E, typename M, typename C>
+R reduce_chunks(
+  const parallel_policy<E>& policy, const std::size_t count, const M& map, const C& combine) {
+  const auto chunkSize = policy.chunk_size();
+  const auto chunkCount = policy.chunk_count(count);
+  if (chunkCount <= 1u) {
+    return map(std::size_t(0u), count);
+  }
+
+  std::vector<R> partials(chunkCount);
+  policy.executor().run(chunkCount, [&](const std::size_t chunk) {
+    const auto first = chunk * chunkSize;
+    partials[chunk] = map(first, std::min(first + chunkSize, count));
+  });
+
+  for (auto n = chunkCount; n > 1u; n = (n + 1u) / 2u) {
+    for (std::size_t i = 0u; i < n / 2u; ++i) {
+      partials[i] = combine(partials[2u * i], partials[2u * i + 1u]);
+    }
+    if (n % 2u == 1u) {
+      partials[n / 2u] = partials[n - 1u];
+    }
+  }
+  return partials.front();
+}
+
+/**
+ * Indicates whether an iterator of type I is known to refer to contiguous storage of values of
+ * type V, so that the values can be processed through a pointer.
+ */
+template <typename I, typename V>
+constexpr bool is_contiguous_iterator_v =
+  std::is_same_v<I, V*> || std::is_same_v<I, const V*> ||
+  std::is_same_v<I, typename std::vector<V>::iterator> ||
+  std::is_same_v<I, typename std::vector<V>::const_iterator>;
+
+/**
+ * Creates the smallest bounding box that contains the given points, which must not be empty,
+ * using one SIMD min and max accumulator per lane and component, see reduce_packed.
+ */
+template <typename T, std::size_t S>
+bbox<T, S> merge_all_packed(const vec<T, S>* points, const std::size_t count) {
+  const auto* data = reinterpret_cast<const T*>(points);
+  const auto mergePoints = [=](auto p, const std::size_t first, const std::size_t last) {
+    using P = decltype(p);
+    typename P::type minAcc[S], maxAcc[S];
+    for (std::size_t k = 0u; k < S; ++k) {
+      T lanes[P::width];
+      for (std::size_t l = 0u; l < P::width; ++l) {
+        lanes[l] = data[first * S + packed_component<P, S>(k, l)];
+      }
+      minAcc[k] = maxAcc[k] = P::load(lanes);
+    }
+    for (auto i = first; i < last; i += P::width) {
+      for (std::size_t k = 0u; k < S; ++k) {
+        const auto v = P::load(data + i * S + k * P::width);
+        minAcc[k] = P::min(minAcc[k], v);
+        maxAcc[k] = P::max(maxAcc[k], v);
+      }
+    }
+
+    auto result = bbox<T, S>(points[first], points[first]);
+    for (std::size_t k = 0u; k < S; ++k) {
+      T minLanes[P::width], maxLanes[P::width];
+      P::store(minLanes, minAcc[k]);
+      P::store(maxLanes, maxAcc[k]);
+      for (std::size_t l = 0u; l < P::width; ++l) {
+        const auto c = packed_component<P, S>(k, l);
+        result.min[c] = vm::min(result.min[c], minLanes[l]);
+        result.max[c] = vm::max(result.max[c], maxLanes[l]);
+      }
+    }
+    return result;
+  };
+  const auto mergeBoxes = [](const bbox<T, S>& lhs, const bbox<T, S>& rhs) {
+    return merge(lhs, rhs);
+  };
+  return reduce_packed<T, S>(count, mergePoints, mergeBoxes);
+}
+} // namespace detail
+
+/**
+ * Computes the average of the given range of elements like average(I, I, const G&) in vec.h, but
+ * sums the elements of each chunk of the range in a task of the given policy's executor, and adds
+ * the partial sums pairwise, see parallel_policy. The result is bit-identical for any number of
+ * threads. If the elements are vectors in contiguous storage, e.g. in a std::vector, each chunk is
+ * also summed pairwise, in blocks that are summed with one SIMD accumulator per lane. This reduces
+ * the rounding error compared to the serial overload, so the results of the overloads may differ
+ * slightly.
+ *
+ * @tparam E the executor type
+ * @tparam I the type of the range iterators, must be random access iterators
+ * @tparam G the type of the transformation function from a range element to a vector type
+ * @param policy the parallel policy
+ * @param cur the start of the range
+ * @param end the end of the range
+ * @param get the transformation function, defaults to identity
+ * @return the average of the vectors obtained from the given range of elements
+ */
+template <typename E, typename I, typename G = identity>
+auto average(const parallel_policy<E>& policy, I cur, I end, const G& get = G()) ->
+  typename std::remove_reference<decltype(get(*cur))>::type {
+  assert(cur != end);
+
+  using V = std::decay_t<decltype(get(*cur))>;
+  using T = typename V::type;
+
+  const auto count = static_cast<std::size_t>(end - cur);
+  const auto sum = detail::reduce_chunks<V>(
+    policy,
+    count,
+    [&](const std::size_t first, const std::size_t last) {
+      // sum_pairwise reads the vectors as an array of components, which excludes padded vectors
+      if constexpr (
+        detail::is_contiguous_iterator_v<I, V> && std::is_same_v<V, vec<T, V::size>> &&
+        std::is_same_v<G, identity>) {
+        return detail::sum_pairwise(&cur[static_cast<std::ptrdiff_t>(first)], last - first);
+      } else {
+        auto result = get(cur[static_cast<std::ptrdiff_t>(first)]);
+        for (auto i = first + 1u; i < last; ++i) {
+          result = result + get(cur[static_cast<std::ptrdiff_t>(i)]);
+        }
+        return result;
+      }
+    },
+    [](const V& lhs, const V& rhs) { return lhs + rhs; });
+  return sum / static_cast<T>(count);
+}
+
+/**
+ * Creates the smallest bounding box that contains all points in the given range like
+ * bbox::merge_all, but merges the points of each chunk of the range in a task of the given
+ * policy's executor. If the points are in contiguous storage, e.g. in a std::vector, each chunk
+ * is merged with SIMD min and max accumulators. Since merging is exact, the result is the same as
+ * that of the serial function. The given range must not be empty.
+ *
+ * @tparam E the executor type
+ * @tparam I the range iterator type, must be a random access iterator
+ * @tparam G type of the transformation
+ * @param policy the parallel policy
+ * @param cur the start of the range
+ * @param end the end of the range
+ * @param get the transformation
+ * @return the bounding box
+ */
+template <typename E, typename I, typename G = identity>
+auto merge_all(const parallel_policy<E>& policy, I cur, I end, const G& get = G())
+  -> bbox<
+    typename std::decay_t<decltype(get(*cur))>::type,
+    std::decay_t<decltype(get(*cur))>::size> {
+  assert(cur != end);
+
+  using V = std::decay_t<decltype(get(*cur))>;
+  using T = typename V::type;
+  constexpr auto S = V::size;
+
+  return detail::reduce_chunks<bbox<T, S>>(
+    policy,
+    static_cast<std::size_t>(end - cur),
+    [&](const std::size_t first, const std::size_t last) {
+      if constexpr (detail::is_contiguous_iterator_v<I, V> && std::is_same_v<G, identity>) {
+        return detail::merge_all_packed(&cur[static_cast<std::ptrdiff_t>(first)], last - first);
+      } else {
+        return bbox<T, S>::merge_all(
+          cur + static_cast<std::ptrdiff_t>(first), cur + static_cast<std::ptrdiff_t>(last), get);
+      }
+    },
+    [](const bbox<T, S>& lhs, const bbox<T, S>& rhs) { return merge(lhs, rhs); });
+}
+
+/**
+ * Multiplies each of the vectors in the range [cur, end) with the given matrix like the
+ * corresponding overload in mat_ext.h, but multiplies each chunk of the range in a task of the
+ * given policy's executor.
+ *
+ * @tparam E the executor type
+ * @tparam T the component type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @tparam I the input iterator type, must be a random access iterator
+ * @tparam O the output iterator type, must be a random access iterator
+ * @param policy the parallel policy
+ * @param lhs the matrix
+ * @param cur the start of the range of vectors
+ * @param end the end of the range of vectors
+ * @param out the output iterator
+ * @return the output iterator past the last product
+ */
+template <typename E, typename T, std::size_t R, std::size_t C, typename I, typename O>
+O multiply(const parallel_policy<E>& policy, const mat<T, R, C>& lhs, I cur, I end, O out) {
+  const auto count = static_cast<std::size_t>(end - cur);
+  detail::for_each_chunk(policy, count, [&](const std::size_t first, const std::size_t last) {
+    const auto offset = static_cast<std::ptrdiff_t>(first);
+    multiply(lhs, cur + offset, cur + static_cast<std::ptrdiff_t>(last), out + offset);
+  });
+  return out + static_cast<std::ptrdiff_t>(count);
+}
+
+/**
+ * Multiplies each of the vectors in the range [cur, end) with the given matrix from the left like
+ * the corresponding overload in mat_ext.h, but multiplies each chunk of the range in a task of the
+ * given policy's executor.
+ *
+ * @tparam E the executor type
+ * @tparam I the input iterator type, must be a random access iterator
+ * @tparam O the output iterator type, must be a random access iterator
+ * @tparam T the component type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @param policy the parallel policy
+ * @param cur the start of the range of vectors
+ * @param end the end of the range of vectors
+ * @param rhs the matrix
+ * @param out the output iterator
+ * @return the output iterator past the last product
+ */
+template <typename E, typename I, typename O, typename T, std::size_t R, std::size_t C>
+O multiply(const parallel_policy<E>& policy, I cur, I end, const mat<T, R, C>& rhs, O out) {
+  const auto count = static_cast<std::size_t>(end - cur);
+  detail::for_each_chunk(policy, count, [&](const std::size_t first, const std::size_t last) {
+    const auto offset = static_cast<std::ptrdiff_t>(first);
+    multiply(cur + offset, cur + static_cast<std::ptrdiff_t>(last), rhs, out + offset);
+  });
+  return out + static_cast<std::ptrdiff_t>(count);
+}
+
+/**
+ * Multiplies each of the vectors or points in the given vector with the given matrix like the
+ * corresponding overloads in mat_ext.h, but multiplies each chunk of the vector in a task of the
+ * given policy's executor.
+ *
+ * @tparam E the executor type
+ * @tparam T the component type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @tparam V the type of the vectors, either vec<T, C> or vec<T, C - 1>
+ * @tparam W the type of the products, either vec<T, R> or vec<T, R - 1>
+ * @param policy the parallel policy
+ * @param lhs the matrix
+ * @param rhs the vector of vectors
+ * @param result receives the products, it is resized to the size of rhs
+ */
+template <typename E, typename T, std::size_t R, std::size_t C, typename V, typename W>
+void multiply(
+  const parallel_policy<E>& policy,
+  const mat<T, R, C>& lhs,
+  const std::vector<V>& rhs,
+  std::vector<W>& result) {
+  result.resize(rhs.size());
+  multiply(policy, lhs, rhs.data(), rhs.data() + rhs.size(), result.data());
+}
+
+/**
+ * Multiplies each of the vectors or points in the given vector with the given matrix from the left
+ * like the corresponding overloads in mat_ext.h, but multiplies each chunk of the vector in a task
+ * of the given policy's executor.
+ *
+ * @tparam E the executor type
+ * @tparam V the type of the vectors, either vec<T, R> or vec<T, R - 1>
+ * @tparam T the component type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @tparam W the type of the products, either vec<T, C> or vec<T, C - 1>
+ * @param policy the parallel policy
+ * @param lhs the vector of vectors
+ * @param rhs the matrix
+ * @param result receives the products, it is resized to the size of lhs
+ */
+template <typename E, typename V, typename T, std::size_t R, std::size_t C, typename W>
+void multiply(
+  const parallel_policy<E>& policy,
+  const std::vector<V>& lhs,
+  const mat<T, R, C>& rhs,
+  std::vector<W>& result) {
+  result.resize(lhs.size());
+  multiply(policy, lhs.data(), lhs.data() + lhs.size(), rhs, result.data());
+}
+} // namespace vm
@@ -20,14 +20,21 @@
 
 #pragma once
 
+#include "affine.h"
 #include "constants.h"
 #include "mat.h"
 #include "scalar.h"
+#include "simd.h"
+#include "transformation.h"
 #include "util.h"
 #include "vec.h"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 namespace vm {
 /**
@@ -193,6 +200,64 @@ public:
     return plane<T, S>(transform * anchor(), normalize_c(strip_translation(transform) * normal));
   }
 
+  /**
+   * Transforms this plane using the given affine transformation. The translational part is not
+   * applied to the normal.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed plane
+   */
+  plane<T, S> transform(const affine<T, S>& transform) const {
+    return plane<T, S>(transform * anchor(), normalize(transform_vector(transform, normal)));
+  }
+
+  /**
+   * Transforms this plane using the given affine transformation at compile time. The translational
+   * part is not applied to the normal.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed plane
+   */
+  constexpr plane<T, S> transform_c(const affine<T, S>& transform) const {
+    return plane<T, S>(transform * anchor(), normalize_c(transform_vector(transform, normal)));
+  }
+
+  /**
+   * Transforms this plane using the given transformation. Unlike the overloads above, this
+   * transforms the normal with the inverse transpose of the transformation, so the transformed
+   * plane is correct even if the transformation scales non-uniformly. A translation only changes
+   * the distance, and the normal is not normalized again after a rigid transformation. Projective
+   * transformations are applied like a transformation matrix.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed plane
+   */
+  plane<T, S> transform(const transformation<T, S>& transform) const {
+    switch (transform.kind()) {
+    case transformation_kind::identity:
+      return *this;
+    case transformation_kind::translation:
+      return plane<T, S>(distance + dot(normal, transform.translation()), normal);
+    case transformation_kind::rigid: {
+      // the transformed anchor is distance * n + translation, and dot(n, n) = 1
+      const auto n = transform_vector(transform, normal);
+      return plane<T, S>(distance + dot(n, transform.translation()), n);
+    }
+    case transformation_kind::affine:
+      if (transform.invertible()) {
+        // the transformed anchor is distance * linear * normal + translation, and
+        // dot(n, linear * normal) = dot(normal, normal) = 1 for the unnormalized normal n
+        const auto n = detail::apply_normal_matrix(transform, normal);
+        const auto l = length(n);
+        return plane<T, S>((distance + dot(n, transform.translation())) / l, n / l);
+      }
+      break;
+    case transformation_kind::projective:
+      break;
+    }
+    return this->transform(transform.matrix());
+  }
+
   /**
    * Projects the given point onto this plane along the plane normal.
    *
@@ -243,6 +308,9 @@ public:
   }
 };
 
+static_assert(std::is_trivially_copyable_v<plane<float, 3>>);
+static_assert(std::is_trivially_copyable_v<plane<double, 3>>);
+
 /**
  * Checks whether the given planes are equal using the given epsilon.
  *
@@ -449,4 +517,128 @@ constexpr plane<T, 3> aligned_orthogonal_plane(
   const vec<T, 3>& position, const vec<T, 3>& direction) {
   return plane<T, 3>(position, get_abs_max_component_axis(direction));
 }
+
+/**
+ * Transforms each of the given planes using the given transformation, which computes the same
+ * planes as plane::transform(const transformation<T, S>&). The normal matrix is taken from the
+ * given transformation once, and the planes are transformed with one plane per SIMD lane. The
+ * normals are not normalized again if the transformation is rigid. The result may be the given
+ * planes.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param planes the planes to transform
+ * @param transform the transformation to apply
+ * @param result receives the transformed planes, it is resized to the size of planes
+ */
+template <typename T, std::size_t S>
+void transform(
+  const std::vector<plane<T, S>>& planes,
+  const transformation<T, S>& transform,
+  std::vector<plane<T, S>>& result) {
+  result.resize(planes.size());
+  const auto kind = transform.kind();
+  if (kind == transformation_kind::identity) {
+    std::copy(std::begin(planes), std::end(planes), std::begin(result));
+    return;
+  }
+  if (kind == transformation_kind::projective || !transform.invertible()) {
+    for (std::size_t i = 0u; i < planes.size(); ++i) {
+      result[i] = planes[i].transform(transform);
+    }
+    return;
+  }
+
+  // the normal matrix is the linear part itself unless the transformation scales or shears
+  const auto& m =
+    kind == transformation_kind::affine ? transform.inverse_transpose() : transform.matrix();
+  std::array<std::array<T, S>, S> normalMatrix;
+  for (std::size_t c = 0u; c < S; ++c) {
+    for (std::size_t r = 0u; r < S; ++r) {
+      normalMatrix[c][r] = m[c][r];
+    }
+  }
+  const auto translation = transform.translation();
+  const auto* planesData = planes.data();
+  auto* resultData = result.data();
+
+  // the normals only need to be normalized again if the transformation scales or shears, this is
+  // decided at compile time to keep the branch out of the kernel
+  const auto transformPlanes = [&](auto renormalize) {
+    detail::for_each_pack<T>(
+      planes.size(), [=](auto p, const std::size_t first, const std::size_t last) {
+        using P = decltype(p);
+        for (auto i = first; i < last; i += P::width) {
+          // the distance in lanes[S] and the normal components in lanes[0] to lanes[S - 1]
+          T lanes[S + 1u][P::width];
+          for (std::size_t l = 0u; l < P::width; ++l) {
+            lanes[S][l] = planesData[i + l].distance;
+            for (std::size_t c = 0u; c < S; ++c) {
+              lanes[c][l] = planesData[i + l].normal[c];
+            }
+          }
+
+          typename P::type normal[S], n[S];
+          for (std::size_t c = 0u; c < S; ++c) {
+            normal[c] = P::load(lanes[c]);
+          }
+
+          // see plane::transform
+          auto distance = P::load(lanes[S]);
+          for (std::size_t r = 0u; r < S; ++r) {
+            n[r] = P::set1(T(0));
+            for (std::size_t c = 0u; c < S; ++c) {
+              n[r] = P::add(n[r], P::mul(P::set1(normalMatrix[c][r]), normal[c]));
+            }
+            distance = P::add(distance, P::mul(n[r], P::set1(translation[r])));
+          }
+          if constexpr (decltype(renormalize)::value) {
+            auto squaredLength = P::set1(T(0));
+            for (std::size_t r = 0u; r < S; ++r) {
+              squaredLength = P::add(squaredLength, P::mul(n[r], n[r]));
+            }
+            const auto length = P::sqrt(squaredLength);
+            for (std::size_t r = 0u; r < S; ++r) {
+              n[r] = P::div(n[r], length);
+            }
+            distance = P::div(distance, length);
+          }
+
+          P::store(lanes[S], distance);
+          for (std::size_t c = 0u; c < S; ++c) {
+            P::store(lanes[c], n[c]);
+          }
+          for (std::size_t l = 0u; l < P::width; ++l) {
+            resultData[i + l].distance = lanes[S][l];
+            for (std::size_t c = 0u; c < S; ++c) {
+              resultData[i + l].normal[c] = lanes[c][l];
+            }
+          }
+        }
+      });
+  };
+
+  if (kind == transformation_kind::affine) {
+    transformPlanes(std::true_type());
+  } else {
+    transformPlanes(std::false_type());
+  }
+}
+
+/**
+ * Transforms each of the given planes using the given transformation, see above.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param planes the planes to transform
+ * @param transform the transformation to apply
+ * @return the transformed planes
+ */
+template <typename T, std::size_t S>
+std::vector<plane<T, S>> transform(
+  const std::vector<plane<T, S>>& planes, const transformation<T, S>& transform) {
+  std::vector<plane<T, S>> result;
+  vm::transform(planes, transform, result);
+  return result;
+}
 } // namespace vm
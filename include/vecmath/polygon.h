@@ -20,8 +20,10 @@
 
 #pragma once
 
+#include <vecmath/affine.h>
 #include <vecmath/mat.h>
 #include <vecmath/mat_ext.h>
+#include <vecmath/transformation.h>
 #include <vecmath/vec.h>
 #include <vecmath/vec_ext.h>
 
@@ -215,6 +217,42 @@ public:
     return polygon<T, S>(mat * vertices());
   }
 
+  /**
+   * Transforms this polygon using the given affine transformation.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed polygon
+   */
+  polygon<T, S> transform(const affine<T, S>& transform) const {
+    std::vector<vec<T, S>> result;
+    result.reserve(m_vertices.size());
+    for (const auto& vertex : m_vertices) {
+      result.push_back(transform * vertex);
+    }
+    return polygon<T, S>(std::move(result));
+  }
+
+  /**
+   * Transforms this polygon using the given transformation.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed polygon
+   */
+  polygon<T, S> transform(const transformation<T, S>& transform) const {
+    if (transform.kind() == transformation_kind::identity) {
+      return *this;
+    } else if (transform.kind() == transformation_kind::translation) {
+      return translate(transform.translation());
+    }
+
+    std::vector<vec<T, S>> result;
+    result.reserve(m_vertices.size());
+    for (const auto& vertex : m_vertices) {
+      result.push_back(transform * vertex);
+    }
+    return polygon<T, S>(std::move(result));
+  }
+
   // FIXME: this is only here because TB's VertexToolBase needs it, it should be moved elsewhere
   /**
    * Adds the vertices of the given range of polygons to the given output iterator.
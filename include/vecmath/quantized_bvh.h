@@ -0,0 +1,744 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "bbox.h"
+#include "bvh.h"
+#include "intersection.h"
+#include "ray.h"
+#include "ray_query.h"
+#include "scalar.h"
+#include "traversal.h"
+#include "vec.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vm {
+/**
+ * The header at the start of a serialized quantized_bvh. It is followed by the nodes and then by
+ * the primitive indices. All values are stored in the byte order of the machine that wrote them.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ */
+template <typename T, size_t S> struct quantized_bvh_header {
+  /**
+   * The characters VMQB.
+   */
+  char magic[4];
+
+  /**
+   * The version of the format, see quantized_bvh_view::format_version.
+   */
+  std::uint32_t version;
+
+  /**
+   * The value 0x01020304, which reads differently on a machine with a different byte order.
+   */
+  std::uint32_t byte_order;
+
+  /**
+   * The size of T in bytes.
+   */
+  std::uint32_t component_size;
+
+  /**
+   * The number of components S.
+   */
+  std::uint32_t dimension;
+
+  /**
+   * The number of bits of the quantized coordinates.
+   */
+  std::uint32_t quantization_bits;
+
+  /**
+   * The number of nodes.
+   */
+  std::uint32_t node_count;
+
+  /**
+   * The number of primitive indices.
+   */
+  std::uint32_t primitive_count;
+
+  /**
+   * The min corner of the bounding box of the tree.
+   */
+  T min[S];
+
+  /**
+   * The max corner of the bounding box of the tree.
+   */
+  T max[S];
+};
+
+/**
+ * A node of a quantized_bvh. Each node stores the bounding boxes of its two children, whose
+ * coordinates are quantized to the integers in [0, std::numeric_limits<Q>::max()] relative to the
+ * bounding box of the node itself, see quantized_bvh_view::child_bounds. Leaves are not stored as
+ * nodes, their primitives are referred to by their parent instead.
+ *
+ * @tparam S the number of components
+ * @tparam Q the type of the quantized coordinates
+ */
+template <size_t S, typename Q> struct quantized_bvh_node {
+  /**
+   * The quantized bounds of the children, bounds[i][0] holds the min corner of child i and
+   * bounds[i][1] its max corner.
+   */
+  Q bounds[2][2][S];
+
+  /**
+   * For a leaf child, the index of its first primitive in the primitive indices. For an inner
+   * child, its index in the nodes. For an empty child, quantized_bvh_view::empty_child.
+   */
+  std::uint32_t first[2];
+
+  /**
+   * For a leaf child, the number of primitives. For inner and empty children, 0.
+   */
+  std::uint32_t count[2];
+};
+
+template <typename T, size_t S, typename Q> class quantized_bvh;
+
+/**
+ * A read only view of a quantized bounding volume hierarchy that is stored in a contiguous block
+ * of memory in the format written by quantized_bvh::write. Since the nodes refer to each other by
+ * index, the block can be used in place, e.g., after mapping a file into memory, without
+ * deserializing it.
+ *
+ * The nodes are stored in depth first order, so the first inner child of a node directly follows
+ * the node. The root is at index 0 and its bounding box is stored unquantized in the header.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @tparam Q the type of the quantized coordinates, std::uint8_t or std::uint16_t
+ */
+template <typename T, size_t S, typename Q> class quantized_bvh_view {
+  static_assert(std::is_floating_point_v<T>, "T must be a floating point type");
+  static_assert(
+    std::is_same_v<Q, std::uint8_t> || std::is_same_v<Q, std::uint16_t>,
+    "Q must be std::uint8_t or std::uint16_t");
+
+public:
+  using component_type = T;
+  using box_type = bbox<T, S>;
+  using header = quantized_bvh_header<T, S>;
+  using node = quantized_bvh_node<S, Q>;
+
+  /**
+   * The version of the binary format, which is incremented whenever the format changes.
+   */
+  static constexpr std::uint32_t format_version = 1u;
+
+  /**
+   * The value of quantized_bvh_node::first for an empty child.
+   */
+  static constexpr std::uint32_t empty_child = std::numeric_limits<std::uint32_t>::max();
+
+  /**
+   * The index that find_first_hit returns if no primitive is hit.
+   */
+  static constexpr std::size_t null_index = std::numeric_limits<std::size_t>::max();
+
+private:
+  static constexpr Q max_quantized = std::numeric_limits<Q>::max();
+
+  struct candidate {
+    std::uint32_t first;
+    std::uint32_t count;
+    T distance;
+    box_type bounds;
+  };
+
+  const header* m_header = nullptr;
+  const node* m_nodes = nullptr;
+  const std::uint32_t* m_indices = nullptr;
+
+  friend class quantized_bvh<T, S, Q>;
+
+  explicit quantized_bvh_view(const void* data)
+    : m_header(static_cast<const header*>(data))
+    , m_nodes(reinterpret_cast<const node*>(m_header + 1))
+    , m_indices(reinterpret_cast<const std::uint32_t*>(m_nodes + m_header->node_count)) {}
+
+public:
+  /**
+   * Creates a view of no tree, which is empty.
+   */
+  quantized_bvh_view() = default;
+
+  /**
+   * Creates a view of the tree stored in the given block of memory. The block must remain valid
+   * for as long as the view is used. Every node and every primitive index is checked once, so that
+   * a damaged block cannot cause a traversal to access memory outside of it or to report an index
+   * that is not less than the number of primitives.
+   *
+   * @param data the start of the block, which must be aligned for T
+   * @param size the size of the block in bytes
+   * @return the view, or nullopt if the block is misaligned, was written by an incompatible
+   * version or machine, or is inconsistent
+   */
+  static std::optional<quantized_bvh_view> from_bytes(const void* data, const std::size_t size) {
+    if (
+      data == nullptr || reinterpret_cast<std::uintptr_t>(data) % alignof(header) != 0u ||
+      size < sizeof(header)) {
+      return std::nullopt;
+    }
+
+    const auto& h = *static_cast<const header*>(data);
+    if (
+      std::memcmp(h.magic, "VMQB", 4u) != 0 || h.version != format_version ||
+      h.byte_order != 0x01020304u || h.component_size != sizeof(T) || h.dimension != S ||
+      h.quantization_bits != 8u * sizeof(Q) || size != byte_size(h.node_count, h.primitive_count) ||
+      (h.node_count == 0u) != (h.primitive_count == 0u)) {
+      return std::nullopt;
+    }
+
+    const auto result = quantized_bvh_view(data);
+    auto referenced = std::vector<bool>(h.node_count, false);
+    for (std::uint32_t i = 0u; i < h.node_count; ++i) {
+      const auto& n = result.m_nodes[i];
+      for (std::size_t j = 0u; j < 2u; ++j) {
+        const auto isLeaf = n.count[j] > 0u;
+        const auto validLeaf =
+          n.first[j] <= h.primitive_count && n.count[j] <= h.primitive_count - n.first[j];
+        // inner children follow their parents, so the nodes cannot form a cycle, and since every
+        // node has at most one parent, no node is visited twice by a traversal
+        const auto validInner =
+          n.first[j] == empty_child ||
+          (n.first[j] > i && n.first[j] < h.node_count && !referenced[n.first[j]]);
+        if (isLeaf ? !validLeaf : !validInner) {
+          return std::nullopt;
+        }
+        if (!isLeaf && n.first[j] != empty_child) {
+          referenced[n.first[j]] = true;
+        }
+      }
+    }
+    for (std::uint32_t i = 0u; i < h.primitive_count; ++i) {
+      if (result.m_indices[i] >= h.primitive_count) {
+        return std::nullopt;
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Returns the size in bytes of a tree with the given numbers of nodes and primitives.
+   */
+  static constexpr std::size_t byte_size(
+    const std::size_t nodeCount, const std::size_t primitiveCount) {
+    return sizeof(header) + nodeCount * sizeof(node) + primitiveCount * sizeof(std::uint32_t);
+  }
+
+  /**
+   * Indicates whether the tree has no primitives.
+   */
+  bool empty() const { return size() == 0u; }
+
+  /**
+   * Returns the number of primitives in the tree.
+   */
+  std::size_t size() const { return m_header != nullptr ? m_header->primitive_count : 0u; }
+
+  /**
+   * Returns the number of nodes of the tree.
+   */
+  std::size_t node_count() const { return m_header != nullptr ? m_header->node_count : 0u; }
+
+  /**
+   * Returns the nodes of the tree, with the root at index 0.
+   */
+  const node* nodes() const { return m_nodes; }
+
+  /**
+   * Returns the indices of the primitives in the order in which the leaves refer to them.
+   */
+  const std::uint32_t* primitive_indices() const { return m_indices; }
+
+  /**
+   * Returns the bounding box of the tree.
+   */
+  box_type bounds() const {
+    auto result = box_type();
+    if (m_header != nullptr) {
+      for (size_t a = 0; a < S; ++a) {
+        result.min[a] = m_header->min[a];
+        result.max[a] = m_header->max[a];
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Returns the bounding box of the given child of the given node, whose bounding box is given.
+   * The quantized coordinate 0 is mapped to the min corner of the node's bounding box and the
+   * largest quantized coordinate is mapped to its max corner. The returned box contains the
+   * bounding box of all primitives below the child.
+   *
+   * @param parent the bounding box of the node
+   * @param n the node
+   * @param i the index of the child, which must not be empty
+   * @return the bounding box of the child
+   */
+  static box_type child_bounds(const box_type& parent, const node& n, const std::size_t i) {
+    assert(n.first[i] != empty_child);
+    auto result = box_type(uninitialized);
+    for (size_t a = 0; a < S; ++a) {
+      result.min[a] = dequantize(parent.min[a], parent.max[a], n.bounds[i][0][a]);
+      result.max[a] = dequantize(parent.min[a], parent.max[a], n.bounds[i][1][a]);
+    }
+    return result;
+  }
+
+  /**
+   * Returns the coordinate that the given quantized coordinate is mapped to within [lower, upper].
+   */
+  static T dequantize(const T lower, const T upper, const Q q) {
+    constexpr auto step = static_cast<T>(1.0) / static_cast<T>(max_quantized);
+    return q == max_quantized ? upper : lower + static_cast<T>(q) * step * (upper - lower);
+  }
+
+  /**
+   * Calls the given visitor with the index of every primitive whose leaf intersects the given
+   * bounding box.
+   *
+   * @tparam F the type of the visitor
+   * @param b the bounding box
+   * @param f the visitor
+   * @param stats if not null, the visited nodes are added to this
+   */
+  template <typename F>
+  void find_intersectors(const box_type& b, F f, traversal_stats* stats = nullptr) const {
+    auto visitedNodes = std::size_t(0);
+    auto visitedLeaves = std::size_t(0);
+
+    auto stack = detail::traversal_stack<candidate>();
+    if (!empty() && bounds().intersects(b)) {
+      stack.push({0u, 0u, static_cast<T>(0.0), bounds()});
+    }
+    while (!stack.empty()) {
+      const auto c = stack.pop();
+      ++visitedNodes;
+      if (c.count > 0u) {
+        ++visitedLeaves;
+        for (auto i = c.first; i < c.first + c.count; ++i) {
+          f(static_cast<std::size_t>(m_indices[i]));
+        }
+        continue;
+      }
+
+      const auto& n = m_nodes[c.first];
+      for (std::size_t i = 2u; i > 0u; --i) {
+        if (n.first[i - 1u] != empty_child) {
+          const auto childBounds = child_bounds(c.bounds, n, i - 1u);
+          if (childBounds.intersects(b)) {
+            stack.push({n.first[i - 1u], n.count[i - 1u], static_cast<T>(0.0), childBounds});
+          }
+        }
+      }
+    }
+
+    detail::add_traversal_stats(stats, visitedNodes, visitedLeaves);
+  }
+
+  /**
+   * Finds the closest primitive hit by the given ray, see bvh::find_first_hit. The bounding boxes
+   * of the children of each node are dequantized while the tree is traversed.
+   *
+   * @tparam F the type of the hit function
+   * @param r the ray
+   * @param hit the hit function
+   * @param stats if not null, the visited nodes are added to this
+   * @return the index of the primitive that is hit first and the distance to the hit, or null_index
+   * and NaN if no primitive is hit
+   */
+  template <typename F>
+  std::tuple<std::size_t, T> find_first_hit(
+    const ray<T, S>& r, F hit, traversal_stats* stats = nullptr) const {
+    auto visitedNodes = std::size_t(0);
+    auto visitedLeaves = std::size_t(0);
+
+    auto bestIndex = null_index;
+    auto bestDistance = std::numeric_limits<T>::infinity();
+
+    const auto q = ray_query<T, S>(r);
+    const auto entry_distance = [&](const box_type& b) {
+      const auto tNear = std::get<0>(intersect_ray_bbox(q, b));
+      // keeps NaN if the ray misses the box
+      return tNear < static_cast<T>(0.0) ? static_cast<T>(0.0) : tNear;
+    };
+
+    auto stack = detail::traversal_stack<candidate>();
+    if (!empty()) {
+      const auto distance = entry_distance(bounds());
+      if (!is_nan(distance)) {
+        stack.push({0u, 0u, distance, bounds()});
+      }
+    }
+    while (!stack.empty()) {
+      const auto c = stack.pop();
+      if (c.distance > bestDistance) {
+        continue;
+      }
+
+      ++visitedNodes;
+      if (c.count > 0u) {
+        ++visitedLeaves;
+        for (auto i = c.first; i < c.first + c.count; ++i) {
+          const auto distance = hit(static_cast<std::size_t>(m_indices[i]));
+          if (!is_nan(distance) && distance < bestDistance) {
+            bestIndex = static_cast<std::size_t>(m_indices[i]);
+            bestDistance = distance;
+          }
+        }
+        continue;
+      }
+
+      const auto& n = m_nodes[c.first];
+      candidate children[2];
+      auto childCount = std::size_t(0);
+      for (std::size_t i = 0u; i < 2u; ++i) {
+        if (n.first[i] != empty_child) {
+          const auto childBounds = child_bounds(c.bounds, n, i);
+          const auto distance = entry_distance(childBounds);
+          if (!is_nan(distance) && distance <= bestDistance) {
+            children[childCount++] = {n.first[i], n.count[i], distance, childBounds};
+          }
+        }
+      }
+
+      // the nearer child is pushed last so that it is visited first
+      if (childCount == 2u && children[0].distance <= children[1].distance) {
+        stack.push(children[1]);
+        stack.push(children[0]);
+      } else {
+        for (std::size_t i = 0u; i < childCount; ++i) {
+          stack.push(children[i]);
+        }
+      }
+    }
+
+    detail::add_traversal_stats(stats, visitedNodes, visitedLeaves);
+    return bestIndex == null_index ? std::make_tuple(null_index, nan<T>())
+                                   : std::make_tuple(bestIndex, bestDistance);
+  }
+};
+
+/**
+ * A bounding volume hierarchy with compact nodes, built from a bvh. The bounding boxes of the
+ * children of each node are quantized relative to the bounding box of the node, see
+ * quantized_bvh_node, and the leaves are stored in their parents. With 8 bit coordinates, a node
+ * takes 28 bytes for S = 3, and the nodes take about a third of the memory of the nodes of the bvh
+ * that the tree is built from. The quantized boxes are slightly larger than the boxes of the bvh,
+ * so a traversal visits a few more nodes, and it must dequantize every box that it tests.
+ *
+ * The tree is stored in one contiguous block of memory that can be written to a file with write
+ * and used in place with quantized_bvh_view::from_bytes, e.g., by mapping the file into memory.
+ * Use read to load such a file into a new tree instead.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @tparam Q the type of the quantized coordinates, std::uint8_t or std::uint16_t
+ */
+template <typename T, size_t S, typename Q> class quantized_bvh {
+public:
+  using view_type = quantized_bvh_view<T, S, Q>;
+  using box_type = bbox<T, S>;
+  using header = typename view_type::header;
+  using node = typename view_type::node;
+
+private:
+  static constexpr Q max_quantized = std::numeric_limits<Q>::max();
+
+  struct pending_node {
+    std::size_t binary;
+    std::size_t parent;
+    std::size_t child;
+    box_type bounds;
+  };
+
+  // the allocator aligns the data for any fundamental type
+  std::vector<std::byte> m_data;
+
+public:
+  /**
+   * Creates an empty tree.
+   */
+  quantized_bvh()
+    : m_data(*build(bvh<T, S>())) {}
+
+  /**
+   * Creates a tree from the given bvh. The primitive indices are the same as those of the given
+   * bvh. The primitive indices and the node indices are stored with 32 bits, so the tree cannot be
+   * created if the bvh has more than 2^32 - 1 primitives or if the tree would have more than
+   * 2^32 - 1 nodes.
+   *
+   * @param binary the bvh
+   * @return the tree, or nullopt if the bvh is too large
+   */
+  static std::optional<quantized_bvh> from_bvh(const bvh<T, S>& binary) {
+    auto data = build(binary);
+    if (!data) {
+      return std::nullopt;
+    }
+    return quantized_bvh(std::move(*data));
+  }
+
+private:
+  explicit quantized_bvh(std::vector<std::byte> data)
+    : m_data(std::move(data)) {}
+
+  /**
+   * Returns the block of memory that stores the tree for the given bvh, or nullopt if the bvh is
+   * too large, see from_bvh.
+   */
+  static std::optional<std::vector<std::byte>> build(const bvh<T, S>& binary) {
+    constexpr auto maxCount = std::size_t(std::numeric_limits<std::uint32_t>::max());
+    const auto& binaryNodes = binary.nodes();
+    if (binary.size() > maxCount) {
+      return std::nullopt;
+    }
+
+    auto nodes = std::vector<node>();
+    auto pending = std::vector<pending_node>();
+    if (!binary.empty()) {
+      pending.push_back({0u, 0u, 0u, binary.bounds()});
+    }
+    while (!pending.empty()) {
+      const auto p = pending.back();
+      pending.pop_back();
+
+      const auto index = nodes.size();
+      if (index > 0u) {
+        nodes[p.parent].first[p.child] = static_cast<std::uint32_t>(index);
+      }
+      nodes.emplace_back();
+
+      const auto& binaryNode = binaryNodes[p.binary];
+      // the root is always a node, even if it is a leaf of the bvh
+      const std::size_t children[2] = {
+        binaryNode.is_leaf() ? p.binary : binaryNode.first,
+        binaryNode.is_leaf() ? bvh<T, S>::null_index : binaryNode.first + 1u};
+
+      auto& n = nodes[index];
+      for (std::size_t i = 0u; i < 2u; ++i) {
+        if (children[i] == bvh<T, S>::null_index) {
+          for (size_t a = 0; a < S; ++a) {
+            n.bounds[i][0][a] = max_quantized;
+            n.bounds[i][1][a] = 0u;
+          }
+          n.first[i] = view_type::empty_child;
+          n.count[i] = 0u;
+          continue;
+        }
+
+        const auto& child = binaryNodes[children[i]];
+        for (size_t a = 0; a < S; ++a) {
+          n.bounds[i][0][a] = quantize_min(p.bounds.min[a], p.bounds.max[a], child.bounds.min[a]);
+          n.bounds[i][1][a] = quantize_max(p.bounds.min[a], p.bounds.max[a], child.bounds.max[a]);
+        }
+        if (child.is_leaf()) {
+          n.first[i] = static_cast<std::uint32_t>(child.first);
+          n.count[i] = static_cast<std::uint32_t>(child.count);
+        } else {
+          n.count[i] = 0u;
+        }
+      }
+
+      // the first child is pushed last so that it directly follows its parent
+      for (std::size_t i = 2u; i > 0u; --i) {
+        const auto c = children[i - 1u];
+        if (c != bvh<T, S>::null_index && !binaryNodes[c].is_leaf()) {
+          pending.push_back({c, index, i - 1u, view_type::child_bounds(p.bounds, n, i - 1u)});
+        }
+      }
+    }
+
+    // an inner child's index is always less than the node count, so it cannot equal empty_child
+    if (nodes.size() > maxCount) {
+      return std::nullopt;
+    }
+
+    const auto& indices = binary.primitive_indices();
+    auto data = std::vector<std::byte>(view_type::byte_size(nodes.size(), indices.size()));
+
+    auto h = header();
+    std::memcpy(h.magic, "VMQB", 4u);
+    h.version = view_type::format_version;
+    h.byte_order = 0x01020304u;
+    h.component_size = static_cast<std::uint32_t>(sizeof(T));
+    h.dimension = static_cast<std::uint32_t>(S);
+    h.quantization_bits = static_cast<std::uint32_t>(8u * sizeof(Q));
+    h.node_count = static_cast<std::uint32_t>(nodes.size());
+    h.primitive_count = static_cast<std::uint32_t>(indices.size());
+    const auto rootBounds = binary.empty() ? box_type() : binary.bounds();
+    for (size_t a = 0; a < S; ++a) {
+      h.min[a] = rootBounds.min[a];
+      h.max[a] = rootBounds.max[a];
+    }
+
+    auto* out = data.data();
+    std::memcpy(out, &h, sizeof(header));
+    out += sizeof(header);
+    if (!nodes.empty()) {
+      std::memcpy(out, nodes.data(), nodes.size() * sizeof(node));
+      out += nodes.size() * sizeof(node);
+    }
+    for (const auto i : indices) {
+      const auto i32 = static_cast<std::uint32_t>(i);
+      std::memcpy(out, &i32, sizeof(i32));
+      out += sizeof(i32);
+    }
+    return data;
+  }
+
+public:
+  /**
+   * Returns a view of this tree, which is valid for as long as this tree is not modified or
+   * destroyed.
+   */
+  view_type view() const { return view_type(m_data.data()); }
+
+  /**
+   * Returns the block of memory that stores this tree.
+   */
+  const std::vector<std::byte>& data() const { return m_data; }
+
+  /**
+   * Writes this tree to the given stream. The written bytes can be used as a tree with
+   * quantized_bvh_view::from_bytes or read.
+   *
+   * @param str the stream, which should be opened in binary mode
+   */
+  void write(std::ostream& str) const {
+    str.write(
+      reinterpret_cast<const char*>(m_data.data()), static_cast<std::streamsize>(m_data.size()));
+  }
+
+  /**
+   * Reads a tree that was written with write from the given stream. The stream is read to its
+   * end.
+   *
+   * @param str the stream, which should be opened in binary mode
+   * @return the tree, or nullopt if the stream does not contain a tree that can be used on this
+   * machine, see quantized_bvh_view::from_bytes
+   */
+  static std::optional<quantized_bvh> read(std::istream& str) {
+    auto data = std::vector<std::byte>();
+    char buffer[4096];
+    while (str.read(buffer, sizeof(buffer)) || str.gcount() > 0) {
+      const auto* bytes = reinterpret_cast<const std::byte*>(buffer);
+      data.insert(std::end(data), bytes, bytes + str.gcount());
+    }
+
+    if (!view_type::from_bytes(data.data(), data.size())) {
+      return std::nullopt;
+    }
+    return quantized_bvh(std::move(data));
+  }
+
+private:
+  /**
+   * Returns the largest quantized coordinate that is mapped to a value not greater than the given
+   * value within [lower, upper].
+   */
+  static Q quantize_min(const T lower, const T upper, const T value) {
+    if (!(upper > lower)) {
+      return 0u;
+    }
+    const auto scaled = (value - lower) / (upper - lower) * static_cast<T>(max_quantized);
+    auto q = to_quantized(std::floor(scaled));
+    while (q > 0u && view_type::dequantize(lower, upper, static_cast<Q>(q)) > value) {
+      --q;
+    }
+    return static_cast<Q>(q);
+  }
+
+  /**
+   * Returns the smallest quantized coordinate that is mapped to a value not less than the given
+   * value within [lower, upper].
+   */
+  static Q quantize_max(const T lower, const T upper, const T value) {
+    if (!(upper > lower)) {
+      return max_quantized;
+    }
+    const auto scaled = (value - lower) / (upper - lower) * static_cast<T>(max_quantized);
+    auto q = to_quantized(std::ceil(scaled));
+    while (q < max_quantized && view_type::dequantize(lower, upper, static_cast<Q>(q)) < value) {
+      ++q;
+    }
+    return static_cast<Q>(q);
+  }
+
+  /**
+   * Clamps the given value to the range of quantized coordinates.
+   */
+  static unsigned int to_quantized(const T value) {
+    return static_cast<unsigned int>(
+      vm::max(static_cast<T>(0.0), vm::min(value, static_cast<T>(max_quantized))));
+  }
+};
+
+/**
+ * Finds the closest triangle hit by the given ray, see
+ * intersect_ray_triangles(const ray<T, 3>&, const bvh<T, 3>&, const std::vector<vec<T, 3>>&,
+ * traversal_stats*).
+ *
+ * @tparam T the component type
+ * @tparam Q the type of the quantized coordinates
+ * @param r the ray
+ * @param tree a view of the quantized bvh that was built from a bvh for the given triangles
+ * @param vertices the vertices of the triangles
+ * @param stats if not null, the visited nodes are added to this
+ * @return the index of the triangle that is hit first and the distance to the hit, or null_index
+ * and NaN if no triangle is hit
+ */
+template <typename T, typename Q>
+std::tuple<std::size_t, T> intersect_ray_triangles(
+  const ray<T, 3>& r,
+  const quantized_bvh_view<T, 3, Q>& tree,
+  const std::vector<vec<T, 3>>& vertices,
+  traversal_stats* stats = nullptr) {
+  return tree.find_first_hit(
+    r,
+    [&](const std::size_t i) {
+      return intersect_ray_triangle(
+        r, vertices[3u * i], vertices[3u * i + 1u], vertices[3u * i + 2u]);
+    },
+    stats);
+}
+} // namespace vm
@@ -24,6 +24,7 @@
 #include "vec.h"
 
 #include <cassert>
+#include <type_traits>
 
 namespace vm {
 template <typename T> class quat {
@@ -45,6 +46,12 @@ public:
     : r(T(0))
     , v(vec<T, 3>::zero()) {}
 
+  /**
+   * Creates a new quaternion without initializing its components.
+   */
+  explicit quat(uninitialized_t)
+    : v(uninitialized) {}
+
   // Copy and move constructors
   quat(const quat<T>& other) = default;
   quat(quat<T>&& other) noexcept = default;
@@ -149,6 +156,9 @@ public:
   constexpr quat<T> conjugate() const { return quat<T>(r, -v); }
 };
 
+static_assert(std::is_trivially_copyable_v<quat<float>>);
+static_assert(std::is_trivially_copyable_v<quat<double>>);
+
 /**
  * Checks whether the given quaternions are equal up to the given epsilon. Two quaternions p, q are
  * considered to be equal when they represent the same rotation, that is, if
@@ -20,13 +20,17 @@
 
 #pragma once
 
+#include "affine.h"
 #include "mat.h"
 #include "vec.h"
 
 #include "abstract_line.h"
 #include "scalar.h"
+#include "transformation.h"
 #include "util.h"
 
+#include <type_traits>
+
 namespace vm {
 /**
  * A ray, represented by the origin and direction.
@@ -118,6 +122,55 @@ public:
     return ray<T, S>(newOrigin, newDirection);
   }
 
+  /**
+   * Transforms this ray using the given affine transformation. The translational part is not
+   * applied to the direction, and the direction is normalized after the transformation has been
+   * applied.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed ray
+   */
+  ray<T, S> transform(const affine<T, S>& transform) const {
+    return ray<T, S>(transform * origin, normalize(transform_vector(transform, direction)));
+  }
+
+  /**
+   * Transforms this ray using the given affine transformation at compile time. The translational
+   * part is not applied to the direction, and the direction is normalized after the transformation
+   * has been applied.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed ray
+   */
+  constexpr ray<T, S> transform_c(const affine<T, S>& transform) const {
+    return ray<T, S>(transform * origin, normalize_c(transform_vector(transform, direction)));
+  }
+
+  /**
+   * Transforms this ray using the given transformation. The translational part is not applied to
+   * the direction, and the direction is normalized after the transformation has been applied unless
+   * the transformation is rigid. Projective transformations are applied like a transformation
+   * matrix.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed ray
+   */
+  ray<T, S> transform(const transformation<T, S>& transform) const {
+    switch (transform.kind()) {
+    case transformation_kind::identity:
+      return *this;
+    case transformation_kind::translation:
+      return ray<T, S>(origin + transform.translation(), direction);
+    case transformation_kind::rigid:
+      return ray<T, S>(transform * origin, transform_vector(transform, direction));
+    case transformation_kind::affine:
+      return ray<T, S>(transform * origin, normalize(transform_vector(transform, direction)));
+    case transformation_kind::projective:
+      break;
+    }
+    return this->transform(transform.matrix());
+  }
+
   /**
    * Determines the position of the given point in relation to the origin and direction of this ray.
    * Suppose that the ray determines a plane that splits the space into two half spaces. The plane
@@ -144,6 +197,9 @@ public:
   }
 };
 
+static_assert(std::is_trivially_copyable_v<ray<float, 3>>);
+static_assert(std::is_trivially_copyable_v<ray<double, 3>>);
+
 /**
  * Checks whether the given rays have equal components.
  *
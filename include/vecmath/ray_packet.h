@@ -0,0 +1,139 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "ray.h"
+#include "vec.h"
+
+#include <cassert>
+#include <cstddef>
+
+namespace vm {
+/**
+ * A group of up to W rays whose components are stored as structure of arrays, so that the rays can
+ * be intersected with the same primitive at once with SIMD instructions, see the overloads of
+ * intersect_ray_bbox, intersect_ray_triangle and intersect_ray_plane that take a ray packet. Each
+ * array holds one component of all rays, and the ray with index i is stored in lane i.
+ *
+ * A packet that holds fewer than W rays fills the remaining lanes with copies of its last ray, so
+ * that every lane holds valid values. The results for these lanes are computed but have no
+ * meaning.
+ *
+ * Packets work best for coherent rays, i.e., rays with similar origins and directions such as the
+ * rays through neighboring pixels of an image.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @tparam W the number of lanes
+ */
+template <typename T, size_t S, size_t W> class ray_packet {
+  static_assert(W >= 1u && W <= 32u, "unsupported number of lanes");
+
+public:
+  using component_type = T;
+  static constexpr std::size_t size = S;
+  static constexpr std::size_t width = W;
+
+public:
+  /**
+   * The origins of the rays.
+   */
+  T origin[S][W];
+
+  /**
+   * The directions of the rays.
+   */
+  T direction[S][W];
+
+  /**
+   * The componentwise reciprocals of the directions, see ray_query::inv_direction.
+   */
+  T inv_direction[S][W];
+
+  /**
+   * The number of rays in this packet. The lanes at and after this index hold copies of the last
+   * ray.
+   */
+  std::size_t count;
+
+  /**
+   * Creates a new packet for the rays in the given range, which must contain between 1 and W rays.
+   *
+   * @tparam I the iterator type
+   * @param first the start of the range
+   * @param last the end of the range
+   */
+  template <typename I> ray_packet(I first, I last) : count(0u) {
+    assert(first != last);
+    auto lastRay = ray<T, S>();
+    for (; first != last; ++first) {
+      assert(count < W);
+      lastRay = *first;
+      set_lane(count++, lastRay);
+    }
+    for (auto i = count; i < W; ++i) {
+      set_lane(i, lastRay);
+    }
+  }
+
+  /**
+   * Creates a new packet that holds the given ray in every lane.
+   *
+   * @param r the ray
+   */
+  explicit ray_packet(const ray<T, S>& r) : count(1u) {
+    for (std::size_t i = 0u; i < W; ++i) {
+      set_lane(i, r);
+    }
+  }
+
+  /**
+   * Returns the ray in the given lane.
+   *
+   * @param i the lane, which must be less than W
+   */
+  ray<T, S> get_ray(const std::size_t i) const {
+    assert(i < W);
+    auto result = ray<T, S>();
+    for (size_t a = 0; a < S; ++a) {
+      result.origin[a] = origin[a][i];
+      result.direction[a] = direction[a][i];
+    }
+    return result;
+  }
+
+  /**
+   * Returns a mask with bit i set for every lane i that holds one of the rays of this packet.
+   */
+  unsigned int lane_mask() const {
+    return count == 32u ? ~0u : (1u << count) - 1u;
+  }
+
+private:
+  void set_lane(const std::size_t i, const ray<T, S>& r) {
+    for (size_t a = 0; a < S; ++a) {
+      origin[a][i] = r.origin[a];
+      direction[a][i] = r.direction[a];
+      inv_direction[a][i] = static_cast<T>(1.0) / r.direction[a];
+    }
+  }
+};
+} // namespace vm
@@ -0,0 +1,98 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "ray.h"
+#include "vec.h"
+
+#include <cstddef>
+
+namespace vm {
+/**
+ * A ray with precomputed values for intersecting it with many bounding boxes, see the overload of
+ * intersect_ray_bbox that takes a ray query. Create a query once per ray and reuse it for every
+ * box that is tested against the ray.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ */
+template <typename T, size_t S> class ray_query {
+public:
+  using component_type = T;
+  static constexpr std::size_t size = S;
+
+public:
+  /**
+   * The origin of the ray.
+   */
+  vec<T, S> origin;
+
+  /**
+   * The direction of the ray.
+   */
+  vec<T, S> direction;
+
+  /**
+   * The componentwise reciprocal of the direction. A component of the direction that is 0 yields an
+   * infinite component with the same sign.
+   */
+  vec<T, S> inv_direction;
+
+  /**
+   * Bit i is set if component i of the inverse direction is negative. If it is set, the ray enters
+   * the slab of a bounding box along axis i at the max corner, otherwise at the min corner.
+   */
+  unsigned int sign_mask;
+
+  /**
+   * Creates a new query for the given ray.
+   *
+   * @param r the ray
+   */
+  explicit ray_query(const ray<T, S>& r)
+    : origin(r.origin)
+    , direction(r.direction)
+    , inv_direction(uninitialized)
+    , sign_mask(0u) {
+    static_assert(S <= sizeof(unsigned int) * 8u, "too many components for the sign mask");
+    for (size_t i = 0; i < S; ++i) {
+      inv_direction[i] = static_cast<T>(1.0) / direction[i];
+      if (inv_direction[i] < static_cast<T>(0.0)) {
+        sign_mask |= 1u << i;
+      }
+    }
+  }
+
+  /**
+   * Returns the ray that this query was created from.
+   */
+  constexpr ray<T, S> get_ray() const { return ray<T, S>(origin, direction); }
+
+  /**
+   * Indicates whether the ray enters the slab of a bounding box along the given axis at the max
+   * corner.
+   *
+   * @param i the axis
+   * @return true if the inverse direction is negative along the given axis
+   */
+  constexpr bool is_negative(const size_t i) const { return (sign_mask >> i) & 1u; }
+};
+} // namespace vm
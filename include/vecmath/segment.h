@@ -21,9 +21,13 @@
 #pragma once
 
 #include "abstract_line.h"
+#include "affine.h"
 #include "mat.h"
+#include "transformation.h"
 #include "vec.h"
 
+#include <type_traits>
+
 namespace vm {
 /**
  * A line segment, represented by its two end points.
@@ -138,6 +142,29 @@ public:
     return segment<T, S>(transform * m_start, transform * m_end);
   }
 
+  /**
+   * Transforms this segment using the given affine transformation.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed segment
+   */
+  constexpr segment<T, S> transform(const affine<T, S>& transform) const {
+    return segment<T, S>(transform * m_start, transform * m_end);
+  }
+
+  /**
+   * Transforms this segment using the given transformation.
+   *
+   * @param transform the transformation to apply
+   * @return the transformed segment
+   */
+  constexpr segment<T, S> transform(const transformation<T, S>& transform) const {
+    if (transform.kind() == transformation_kind::identity) {
+      return *this;
+    }
+    return segment<T, S>(transform * m_start, transform * m_end);
+  }
+
   /**
    * Translates this segment by the given offset.
    *
@@ -199,6 +226,9 @@ public:
   }
 };
 
+static_assert(std::is_trivially_copyable_v<segment<float, 3>>);
+static_assert(std::is_trivially_copyable_v<segment<double, 3>>);
+
 /**
  * Compares the given segments using the given epsilon value. Thereby, the start points of the
  * segments are compared first, and if the comparison yields a value other than 0, that value is
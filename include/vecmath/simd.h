@@ -0,0 +1,758 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+/*
+ * SIMD kernels are opt-in. They are only used if VM_ENABLE_SIMD is defined, the target supports at
+ * least SSE2, and the compiler lets us detect constant evaluation, because every constexpr function
+ * that uses a kernel must fall back to its scalar implementation when evaluated at compile time.
+ */
+#if defined(VM_ENABLE_SIMD)
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define VM_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+#elif (defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define VM_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+
+#if defined(VM_HAS_IS_CONSTANT_EVALUATED)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VM_SIMD_SSE2 1
+#endif
+#if defined(VM_SIMD_SSE2) && defined(__AVX__)
+#define VM_SIMD_AVX 1
+#endif
+#endif
+#endif
+
+#if defined(VM_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(VM_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace vm {
+namespace detail {
+/**
+ * Returns true if the calling function is being evaluated at compile time. Functions that dispatch
+ * to a SIMD kernel use this to keep their scalar implementation for constant evaluation. If the
+ * compiler cannot detect constant evaluation, this function conservatively returns true.
+ */
+constexpr bool is_constant_evaluated() noexcept {
+#if defined(VM_HAS_IS_CONSTANT_EVALUATED)
+  return __builtin_is_constant_evaluated();
+#else
+  return true;
+#endif
+}
+
+/**
+ * Provides SIMD kernels for the arithmetic operations of vectors with component type T and S
+ * components. This primary template is used for all combinations of T and S for which no kernels
+ * exist, and signals this by setting enabled to false.
+ *
+ * Every specialization with enabled set to true provides static functions that take pointers to
+ * the components of the operands and write the result to the given output pointer. The kernels
+ * compute each component with the same operations as the scalar code, and reductions such as dot
+ * sum the component products in index order, so the results are bit-identical to the scalar path.
+ *
+ * There are no kernels for vectors with three components: Loading and storing them without touching
+ * the memory past the last component costs more than the compiler's scalar code for these vectors.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ */
+template <typename T, std::size_t S> struct simd_vec {
+  static constexpr bool enabled = false;
+};
+
+#if defined(VM_SIMD_SSE2)
+/**
+ * Kernels for vectors with four float components, using one SSE register per vector.
+ */
+template <> struct simd_vec<float, 4> {
+  static constexpr bool enabled = true;
+  using reg = __m128;
+
+  static __m128 load(const float* p) { return _mm_loadu_ps(p); }
+  static void store(float* p, const __m128 v) { _mm_storeu_ps(p, v); }
+  static __m128 zero() { return _mm_setzero_ps(); }
+
+  static __m128 mul_add(const __m128 acc, const __m128 a, const __m128 b) {
+    return _mm_add_ps(acc, _mm_mul_ps(a, b));
+  }
+
+  // broadcasts each component of the given vector to all lanes of a register
+  static void broadcast(const float* p, __m128 out[4]) {
+    const auto v = load(p);
+    out[0] = _mm_shuffle_ps(v, v, 0x00);
+    out[1] = _mm_shuffle_ps(v, v, 0x55);
+    out[2] = _mm_shuffle_ps(v, v, 0xaa);
+    out[3] = _mm_shuffle_ps(v, v, 0xff);
+  }
+
+  static void neg(const float* a, float* out) {
+    store(out, _mm_xor_ps(load(a), _mm_set1_ps(-0.0f)));
+  }
+
+  static void add(const float* a, const float* b, float* out) {
+    store(out, _mm_add_ps(load(a), load(b)));
+  }
+
+  static void sub(const float* a, const float* b, float* out) {
+    store(out, _mm_sub_ps(load(a), load(b)));
+  }
+
+  static void mul(const float* a, const float* b, float* out) {
+    store(out, _mm_mul_ps(load(a), load(b)));
+  }
+
+  static void mul(const float* a, const float b, float* out) {
+    store(out, _mm_mul_ps(load(a), _mm_set1_ps(b)));
+  }
+
+  static void div(const float* a, const float* b, float* out) {
+    store(out, _mm_div_ps(load(a), load(b)));
+  }
+
+  static void div(const float* a, const float b, float* out) {
+    store(out, _mm_div_ps(load(a), _mm_set1_ps(b)));
+  }
+
+  static void div(const float a, const float* b, float* out) {
+    store(out, _mm_div_ps(_mm_set1_ps(a), load(b)));
+  }
+
+  // minps and maxps return the second operand if the comparison fails, which matches the behavior
+  // of vm::min and vm::max for scalars, including the handling of NaN
+  static void min(const float* a, const float* b, float* out) {
+    store(out, _mm_min_ps(load(a), load(b)));
+  }
+
+  static void max(const float* a, const float* b, float* out) {
+    store(out, _mm_max_ps(load(a), load(b)));
+  }
+
+  static void abs(const float* a, float* out) {
+    const auto va = load(a);
+    const auto isNeg = _mm_cmplt_ps(va, _mm_setzero_ps());
+    const auto negA = _mm_xor_ps(va, _mm_set1_ps(-0.0f));
+    store(out, _mm_or_ps(_mm_and_ps(isNeg, negA), _mm_andnot_ps(isNeg, va)));
+  }
+
+  static float dot(const float* a, const float* b) {
+    alignas(16) float p[4];
+    _mm_store_ps(p, _mm_mul_ps(load(a), load(b)));
+    auto result = 0.0f;
+    result += p[0];
+    result += p[1];
+    result += p[2];
+    result += p[3];
+    return result;
+  }
+};
+
+#if defined(VM_SIMD_AVX)
+/**
+ * Kernels for vectors with four double components, using one AVX register per vector.
+ */
+template <> struct simd_vec<double, 4> {
+  static constexpr bool enabled = true;
+  using reg = __m256d;
+
+  static __m256d load(const double* p) { return _mm256_loadu_pd(p); }
+  static void store(double* p, const __m256d v) { _mm256_storeu_pd(p, v); }
+  static __m256d zero() { return _mm256_setzero_pd(); }
+
+  static __m256d mul_add(const __m256d acc, const __m256d a, const __m256d b) {
+    return _mm256_add_pd(acc, _mm256_mul_pd(a, b));
+  }
+
+  // broadcasts each component of the given vector to all lanes of a register
+  static void broadcast(const double* p, __m256d out[4]) {
+    out[0] = _mm256_broadcast_sd(p);
+    out[1] = _mm256_broadcast_sd(p + 1);
+    out[2] = _mm256_broadcast_sd(p + 2);
+    out[3] = _mm256_broadcast_sd(p + 3);
+  }
+
+  static void neg(const double* a, double* out) {
+    store(out, _mm256_xor_pd(load(a), _mm256_set1_pd(-0.0)));
+  }
+
+  static void add(const double* a, const double* b, double* out) {
+    store(out, _mm256_add_pd(load(a), load(b)));
+  }
+
+  static void sub(const double* a, const double* b, double* out) {
+    store(out, _mm256_sub_pd(load(a), load(b)));
+  }
+
+  static void mul(const double* a, const double* b, double* out) {
+    store(out, _mm256_mul_pd(load(a), load(b)));
+  }
+
+  static void mul(const double* a, const double b, double* out) {
+    store(out, _mm256_mul_pd(load(a), _mm256_set1_pd(b)));
+  }
+
+  static void div(const double* a, const double* b, double* out) {
+    store(out, _mm256_div_pd(load(a), load(b)));
+  }
+
+  static void div(const double* a, const double b, double* out) {
+    store(out, _mm256_div_pd(load(a), _mm256_set1_pd(b)));
+  }
+
+  static void div(const double a, const double* b, double* out) {
+    store(out, _mm256_div_pd(_mm256_set1_pd(a), load(b)));
+  }
+
+  static void min(const double* a, const double* b, double* out) {
+    store(out, _mm256_min_pd(load(a), load(b)));
+  }
+
+  static void max(const double* a, const double* b, double* out) {
+    store(out, _mm256_max_pd(load(a), load(b)));
+  }
+
+  static void abs(const double* a, double* out) {
+    const auto va = load(a);
+    const auto isNeg = _mm256_cmp_pd(va, _mm256_setzero_pd(), _CMP_LT_OQ);
+    store(out, _mm256_blendv_pd(va, _mm256_xor_pd(va, _mm256_set1_pd(-0.0)), isNeg));
+  }
+
+  static double dot(const double* a, const double* b) {
+    alignas(32) double p[4];
+    _mm256_store_pd(p, _mm256_mul_pd(load(a), load(b)));
+    auto result = 0.0;
+    result += p[0];
+    result += p[1];
+    result += p[2];
+    result += p[3];
+    return result;
+  }
+};
+#else
+/**
+ * Kernels for vectors with four double components, using two SSE2 registers per vector.
+ */
+template <> struct simd_vec<double, 4> {
+  static constexpr bool enabled = true;
+
+  struct reg {
+    __m128d lo;
+    __m128d hi;
+  };
+
+  static reg load(const double* p) { return {_mm_loadu_pd(p), _mm_loadu_pd(p + 2)}; }
+
+  static void store(double* p, const reg& v) {
+    _mm_storeu_pd(p, v.lo);
+    _mm_storeu_pd(p + 2, v.hi);
+  }
+
+  static reg zero() { return {_mm_setzero_pd(), _mm_setzero_pd()}; }
+
+  static reg mul_add(const reg& acc, const reg& a, const reg& b) {
+    return {_mm_add_pd(acc.lo, _mm_mul_pd(a.lo, b.lo)), _mm_add_pd(acc.hi, _mm_mul_pd(a.hi, b.hi))};
+  }
+
+  // broadcasts each component of the given vector to all lanes of a register
+  static void broadcast(const double* p, reg out[4]) {
+    for (std::size_t i = 0u; i < 4u; ++i) {
+      const auto b = _mm_load1_pd(p + i);
+      out[i] = {b, b};
+    }
+  }
+
+  template <typename Op> static void apply(const double* a, const double* b, double* out, Op op) {
+    const auto va = load(a);
+    const auto vb = load(b);
+    store(out, {op(va.lo, vb.lo), op(va.hi, vb.hi)});
+  }
+
+  static void neg(const double* a, double* out) {
+    const auto va = load(a);
+    const auto sign = _mm_set1_pd(-0.0);
+    store(out, {_mm_xor_pd(va.lo, sign), _mm_xor_pd(va.hi, sign)});
+  }
+
+  static void add(const double* a, const double* b, double* out) {
+    apply(a, b, out, [](const __m128d x, const __m128d y) {
+      return _mm_add_pd(x, y);
+    });
+  }
+
+  static void sub(const double* a, const double* b, double* out) {
+    apply(a, b, out, [](const __m128d x, const __m128d y) {
+      return _mm_sub_pd(x, y);
+    });
+  }
+
+  static void mul(const double* a, const double* b, double* out) {
+    apply(a, b, out, [](const __m128d x, const __m128d y) {
+      return _mm_mul_pd(x, y);
+    });
+  }
+
+  static void mul(const double* a, const double b, double* out) {
+    const auto va = load(a);
+    const auto vb = _mm_set1_pd(b);
+    store(out, {_mm_mul_pd(va.lo, vb), _mm_mul_pd(va.hi, vb)});
+  }
+
+  static void div(const double* a, const double* b, double* out) {
+    apply(a, b, out, [](const __m128d x, const __m128d y) {
+      return _mm_div_pd(x, y);
+    });
+  }
+
+  static void div(const double* a, const double b, double* out) {
+    const auto va = load(a);
+    const auto vb = _mm_set1_pd(b);
+    store(out, {_mm_div_pd(va.lo, vb), _mm_div_pd(va.hi, vb)});
+  }
+
+  static void div(const double a, const double* b, double* out) {
+    const auto va = _mm_set1_pd(a);
+    const auto vb = load(b);
+    store(out, {_mm_div_pd(va, vb.lo), _mm_div_pd(va, vb.hi)});
+  }
+
+  static void min(const double* a, const double* b, double* out) {
+    apply(a, b, out, [](const __m128d x, const __m128d y) {
+      return _mm_min_pd(x, y);
+    });
+  }
+
+  static void max(const double* a, const double* b, double* out) {
+    apply(a, b, out, [](const __m128d x, const __m128d y) {
+      return _mm_max_pd(x, y);
+    });
+  }
+
+  static void abs(const double* a, double* out) {
+    const auto va = load(a);
+    const auto abs2 = [](const __m128d x) {
+      const auto isNeg = _mm_cmplt_pd(x, _mm_setzero_pd());
+      const auto negX = _mm_xor_pd(x, _mm_set1_pd(-0.0));
+      return _mm_or_pd(_mm_and_pd(isNeg, negX), _mm_andnot_pd(isNeg, x));
+    };
+    store(out, {abs2(va.lo), abs2(va.hi)});
+  }
+
+  static double dot(const double* a, const double* b) {
+    alignas(16) double p[4];
+    const auto va = load(a);
+    const auto vb = load(b);
+    _mm_store_pd(p, _mm_mul_pd(va.lo, vb.lo));
+    _mm_store_pd(p + 2, _mm_mul_pd(va.hi, vb.hi));
+    auto result = 0.0;
+    result += p[0];
+    result += p[1];
+    result += p[2];
+    result += p[3];
+    return result;
+  }
+};
+#endif
+#endif
+
+/**
+ * Provides SIMD kernels for the products of square matrices with component type T and S rows and
+ * columns. This primary template is used for all combinations of T and S for which no kernels
+ * exist, and signals this by setting enabled to false.
+ *
+ * The kernels take pointers to the components of the operands in column major order and write the
+ * result to the given output pointer, which must not alias the operands. Every column of a product
+ * is accumulated from the columns of the left hand matrix, scaled by the components of the right
+ * hand operand, in the same order in which the scalar code sums the products.
+ *
+ * @tparam T the component type
+ * @tparam S the number of rows and columns
+ */
+template <typename T, std::size_t S> struct simd_mat {
+  static constexpr bool enabled = false;
+};
+
+#if defined(VM_SIMD_SSE2)
+/**
+ * Kernels for 4x4 matrices, which hold each column in the registers used by simd_vec<T, 4>.
+ *
+ * @tparam T the component type
+ */
+template <typename T> struct simd_mat4x4 {
+  using column = simd_vec<T, 4>;
+  static constexpr bool enabled = true;
+
+  static void mul(const T* a, const T* b, T* out) {
+    const auto a0 = column::load(a);
+    const auto a1 = column::load(a + 4);
+    const auto a2 = column::load(a + 8);
+    const auto a3 = column::load(a + 12);
+    const auto product_column = [&](const T* bc) {
+      typename column::reg bs[4];
+      column::broadcast(bc, bs);
+      auto acc = column::zero();
+      acc = column::mul_add(acc, a0, bs[0]);
+      acc = column::mul_add(acc, a1, bs[1]);
+      acc = column::mul_add(acc, a2, bs[2]);
+      return column::mul_add(acc, a3, bs[3]);
+    };
+
+    // compute all columns before storing any of them, otherwise b must be reloaded after every
+    // store because the store intrinsics may alias it
+    const auto r0 = product_column(b);
+    const auto r1 = product_column(b + 4);
+    const auto r2 = product_column(b + 8);
+    const auto r3 = product_column(b + 12);
+    column::store(out, r0);
+    column::store(out + 4, r1);
+    column::store(out + 8, r2);
+    column::store(out + 12, r3);
+  }
+
+  static void mul_vec(const T* a, const T* v, T* out) {
+    typename column::reg vs[4];
+    column::broadcast(v, vs);
+    auto acc = column::zero();
+    acc = column::mul_add(acc, column::load(a), vs[0]);
+    acc = column::mul_add(acc, column::load(a + 4), vs[1]);
+    acc = column::mul_add(acc, column::load(a + 8), vs[2]);
+    acc = column::mul_add(acc, column::load(a + 12), vs[3]);
+    column::store(out, acc);
+  }
+};
+
+#if defined(VM_SIMD_AVX)
+/**
+ * Kernels for 4x4 float matrices using AVX. The product of two matrices computes two columns per
+ * register, with each column of the left hand matrix duplicated into both halves of a register.
+ */
+template <> struct simd_mat<float, 4> : simd_mat4x4<float> {
+  static void mul(const float* a, const float* b, float* out) {
+    const auto a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+    const auto a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+    const auto a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+    const auto a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+    const auto product_columns = [&](const float* bc) {
+      // broadcast component i of both columns to their halves of the register
+      const auto bv = _mm256_loadu_ps(bc);
+      auto acc = _mm256_setzero_ps();
+      acc = _mm256_add_ps(acc, _mm256_mul_ps(a0, _mm256_permute_ps(bv, 0x00)));
+      acc = _mm256_add_ps(acc, _mm256_mul_ps(a1, _mm256_permute_ps(bv, 0x55)));
+      acc = _mm256_add_ps(acc, _mm256_mul_ps(a2, _mm256_permute_ps(bv, 0xaa)));
+      return _mm256_add_ps(acc, _mm256_mul_ps(a3, _mm256_permute_ps(bv, 0xff)));
+    };
+
+    const auto r01 = product_columns(b);
+    const auto r23 = product_columns(b + 8);
+    _mm256_storeu_ps(out, r01);
+    _mm256_storeu_ps(out + 8, r23);
+  }
+};
+#else
+template <> struct simd_mat<float, 4> : simd_mat4x4<float> {};
+#endif
+template <> struct simd_mat<double, 4> : simd_mat4x4<double> {};
+#endif
+
+/**
+ * Provides the operations on a register that holds width values of type T. This is the scalar
+ * implementation with a width of one, which is used to process the elements that remain at the end
+ * of an array, and in place of simd_pack if there are no SIMD instructions for T.
+ *
+ * Comparisons return a mask_type, which can be combined with mask_and and mask_or, used to choose
+ * between the lanes of two values with select, or converted to an integer with one bit per lane
+ * with bits.
+ *
+ * @tparam T the value type
+ */
+template <typename T> struct scalar_pack {
+  using type = T;
+  using mask_type = bool;
+  static constexpr std::size_t width = 1u;
+
+  static type load(const T* p) { return *p; }
+  static void store(T* p, const type v) { *p = v; }
+  static type set1(const T v) { return v; }
+
+  static type add(const type a, const type b) { return a + b; }
+  static type sub(const type a, const type b) { return a - b; }
+  static type mul(const type a, const type b) { return a * b; }
+  static type div(const type a, const type b) { return a / b; }
+  static type min(const type a, const type b) { return a < b ? a : b; }
+  static type max(const type a, const type b) { return a > b ? a : b; }
+  static type sqrt(const type a) { return std::sqrt(a); }
+
+  static mask_type lt(const type a, const type b) { return a < b; }
+  static mask_type le(const type a, const type b) { return a <= b; }
+  static mask_type gt(const type a, const type b) { return a > b; }
+  static mask_type ge(const type a, const type b) { return a >= b; }
+  static mask_type mask_and(const mask_type a, const mask_type b) { return a && b; }
+  static mask_type mask_or(const mask_type a, const mask_type b) { return a || b; }
+  static type select(const mask_type m, const type a, const type b) { return m ? a : b; }
+  static unsigned bits(const mask_type m) { return m ? 1u : 0u; }
+};
+
+/**
+ * Provides the operations on the widest SIMD register available for values of type T. The results
+ * of every operation are the same as those of the corresponding operation of scalar_pack applied to
+ * each lane. This primary template is used if no SIMD instructions are available for T.
+ *
+ * @tparam T the value type
+ */
+template <typename T> struct simd_pack : scalar_pack<T> {};
+
+#if defined(VM_SIMD_AVX)
+template <> struct simd_pack<float> {
+  using type = __m256;
+  using mask_type = __m256;
+  static constexpr std::size_t width = 8u;
+
+  static type load(const float* p) { return _mm256_loadu_ps(p); }
+  static void store(float* p, const type v) { _mm256_storeu_ps(p, v); }
+  static type set1(const float v) { return _mm256_set1_ps(v); }
+
+  static type add(const type a, const type b) { return _mm256_add_ps(a, b); }
+  static type sub(const type a, const type b) { return _mm256_sub_ps(a, b); }
+  static type mul(const type a, const type b) { return _mm256_mul_ps(a, b); }
+  static type div(const type a, const type b) { return _mm256_div_ps(a, b); }
+  static type min(const type a, const type b) { return _mm256_min_ps(a, b); }
+  static type max(const type a, const type b) { return _mm256_max_ps(a, b); }
+  static type sqrt(const type a) { return _mm256_sqrt_ps(a); }
+
+  static mask_type lt(const type a, const type b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static mask_type le(const type a, const type b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+  static mask_type gt(const type a, const type b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  static mask_type ge(const type a, const type b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+  static mask_type mask_and(const mask_type a, const mask_type b) { return _mm256_and_ps(a, b); }
+  static mask_type mask_or(const mask_type a, const mask_type b) { return _mm256_or_ps(a, b); }
+  static type select(const mask_type m, const type a, const type b) {
+    return _mm256_blendv_ps(b, a, m);
+  }
+  static unsigned bits(const mask_type m) { return static_cast<unsigned>(_mm256_movemask_ps(m)); }
+};
+
+template <> struct simd_pack<double> {
+  using type = __m256d;
+  using mask_type = __m256d;
+  static constexpr std::size_t width = 4u;
+
+  static type load(const double* p) { return _mm256_loadu_pd(p); }
+  static void store(double* p, const type v) { _mm256_storeu_pd(p, v); }
+  static type set1(const double v) { return _mm256_set1_pd(v); }
+
+  static type add(const type a, const type b) { return _mm256_add_pd(a, b); }
+  static type sub(const type a, const type b) { return _mm256_sub_pd(a, b); }
+  static type mul(const type a, const type b) { return _mm256_mul_pd(a, b); }
+  static type div(const type a, const type b) { return _mm256_div_pd(a, b); }
+  static type min(const type a, const type b) { return _mm256_min_pd(a, b); }
+  static type max(const type a, const type b) { return _mm256_max_pd(a, b); }
+  static type sqrt(const type a) { return _mm256_sqrt_pd(a); }
+
+  static mask_type lt(const type a, const type b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  static mask_type le(const type a, const type b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+  static mask_type gt(const type a, const type b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+  static mask_type ge(const type a, const type b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+  static mask_type mask_and(const mask_type a, const mask_type b) { return _mm256_and_pd(a, b); }
+  static mask_type mask_or(const mask_type a, const mask_type b) { return _mm256_or_pd(a, b); }
+  static type select(const mask_type m, const type a, const type b) {
+    return _mm256_blendv_pd(b, a, m);
+  }
+  static unsigned bits(const mask_type m) { return static_cast<unsigned>(_mm256_movemask_pd(m)); }
+};
+#elif defined(VM_SIMD_SSE2)
+template <> struct simd_pack<float> {
+  using type = __m128;
+  using mask_type = __m128;
+  static constexpr std::size_t width = 4u;
+
+  static type load(const float* p) { return _mm_loadu_ps(p); }
+  static void store(float* p, const type v) { _mm_storeu_ps(p, v); }
+  static type set1(const float v) { return _mm_set1_ps(v); }
+
+  static type add(const type a, const type b) { return _mm_add_ps(a, b); }
+  static type sub(const type a, const type b) { return _mm_sub_ps(a, b); }
+  static type mul(const type a, const type b) { return _mm_mul_ps(a, b); }
+  static type div(const type a, const type b) { return _mm_div_ps(a, b); }
+  static type min(const type a, const type b) { return _mm_min_ps(a, b); }
+  static type max(const type a, const type b) { return _mm_max_ps(a, b); }
+  static type sqrt(const type a) { return _mm_sqrt_ps(a); }
+
+  static mask_type lt(const type a, const type b) { return _mm_cmplt_ps(a, b); }
+  static mask_type le(const type a, const type b) { return _mm_cmple_ps(a, b); }
+  static mask_type gt(const type a, const type b) { return _mm_cmpgt_ps(a, b); }
+  static mask_type ge(const type a, const type b) { return _mm_cmpge_ps(a, b); }
+  static mask_type mask_and(const mask_type a, const mask_type b) { return _mm_and_ps(a, b); }
+  static mask_type mask_or(const mask_type a, const mask_type b) { return _mm_or_ps(a, b); }
+  static type select(const mask_type m, const type a, const type b) {
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+  }
+  static unsigned bits(const mask_type m) { return static_cast<unsigned>(_mm_movemask_ps(m)); }
+};
+
+template <> struct simd_pack<double> {
+  using type = __m128d;
+  using mask_type = __m128d;
+  static constexpr std::size_t width = 2u;
+
+  static type load(const double* p) { return _mm_loadu_pd(p); }
+  static void store(double* p, const type v) { _mm_storeu_pd(p, v); }
+  static type set1(const double v) { return _mm_set1_pd(v); }
+
+  static type add(const type a, const type b) { return _mm_add_pd(a, b); }
+  static type sub(const type a, const type b) { return _mm_sub_pd(a, b); }
+  static type mul(const type a, const type b) { return _mm_mul_pd(a, b); }
+  static type div(const type a, const type b) { return _mm_div_pd(a, b); }
+  static type min(const type a, const type b) { return _mm_min_pd(a, b); }
+  static type max(const type a, const type b) { return _mm_max_pd(a, b); }
+  static type sqrt(const type a) { return _mm_sqrt_pd(a); }
+
+  static mask_type lt(const type a, const type b) { return _mm_cmplt_pd(a, b); }
+  static mask_type le(const type a, const type b) { return _mm_cmple_pd(a, b); }
+  static mask_type gt(const type a, const type b) { return _mm_cmpgt_pd(a, b); }
+  static mask_type ge(const type a, const type b) { return _mm_cmpge_pd(a, b); }
+  static mask_type mask_and(const mask_type a, const mask_type b) { return _mm_and_pd(a, b); }
+  static mask_type mask_or(const mask_type a, const mask_type b) { return _mm_or_pd(a, b); }
+  static type select(const mask_type m, const type a, const type b) {
+    return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+  }
+  static unsigned bits(const mask_type m) { return static_cast<unsigned>(_mm_movemask_pd(m)); }
+};
+#endif
+
+/**
+ * The pack type for processing arrays of exactly W values of type T: simd_pack<T> if W is a
+ * multiple of its width, and scalar_pack<T> otherwise.
+ *
+ * @tparam T the value type
+ * @tparam W the number of values
+ */
+template <typename T, std::size_t W>
+using fixed_width_pack = std::conditional_t<
+  W % simd_pack<T>::width == 0u, simd_pack<T>, scalar_pack<T>>;
+
+/**
+ * Loads and stores simd_pack<T>::width vectors with three components of type T that are padded to
+ * four components and aligned to their size, see vec3a. Each vector is loaded with one aligned load
+ * and the vectors are transposed so that each register holds one component of all vectors. Storing
+ * transposes them back and sets the padding to zero. This primary template is used if there are no
+ * SIMD instructions for T, and signals this by setting enabled to false.
+ *
+ * @tparam T the component type
+ */
+template <typename T> struct simd_padded_vec3 {
+  static constexpr bool enabled = false;
+};
+
+#if defined(VM_SIMD_AVX)
+template <> struct simd_padded_vec3<float> {
+  static constexpr bool enabled = true;
+
+  // each register holds vector i in its lower half and vector i + 4 in its upper half
+  static __m256 load_pair(const float* p, const std::size_t i) {
+    const auto lower = _mm256_castps128_ps256(_mm_load_ps(p + 4 * i));
+    return _mm256_insertf128_ps(lower, _mm_load_ps(p + 4 * (i + 4)), 1);
+  }
+
+  static void store_pair(float* p, const std::size_t i, const __m256 v) {
+    _mm_store_ps(p + 4 * i, _mm256_castps256_ps128(v));
+    _mm_store_ps(p + 4 * (i + 4), _mm256_extractf128_ps(v, 1));
+  }
+
+  static void load(const float* p, __m256 (&out)[3]) {
+    const auto v0 = load_pair(p, 0), v1 = load_pair(p, 1);
+    const auto v2 = load_pair(p, 2), v3 = load_pair(p, 3);
+    const auto xy01 = _mm256_unpacklo_ps(v0, v1);
+    const auto xy23 = _mm256_unpacklo_ps(v2, v3);
+    const auto zw01 = _mm256_unpackhi_ps(v0, v1);
+    const auto zw23 = _mm256_unpackhi_ps(v2, v3);
+    out[0] = _mm256_shuffle_ps(xy01, xy23, 0x44);
+    out[1] = _mm256_shuffle_ps(xy01, xy23, 0xee);
+    out[2] = _mm256_shuffle_ps(zw01, zw23, 0x44);
+  }
+
+  static void store(float* p, const __m256 (&in)[3]) {
+    const auto zero = _mm256_setzero_ps();
+    const auto xy01 = _mm256_unpacklo_ps(in[0], in[1]);
+    const auto xy23 = _mm256_unpackhi_ps(in[0], in[1]);
+    const auto zw01 = _mm256_unpacklo_ps(in[2], zero);
+    const auto zw23 = _mm256_unpackhi_ps(in[2], zero);
+    store_pair(p, 0, _mm256_shuffle_ps(xy01, zw01, 0x44));
+    store_pair(p, 1, _mm256_shuffle_ps(xy01, zw01, 0xee));
+    store_pair(p, 2, _mm256_shuffle_ps(xy23, zw23, 0x44));
+    store_pair(p, 3, _mm256_shuffle_ps(xy23, zw23, 0xee));
+  }
+};
+#elif defined(VM_SIMD_SSE2)
+template <> struct simd_padded_vec3<float> {
+  static constexpr bool enabled = true;
+
+  static void load(const float* p, __m128 (&out)[3]) {
+    auto v0 = _mm_load_ps(p), v1 = _mm_load_ps(p + 4);
+    auto v2 = _mm_load_ps(p + 8), v3 = _mm_load_ps(p + 12);
+    _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+    out[0] = v0;
+    out[1] = v1;
+    out[2] = v2;
+  }
+
+  static void store(float* p, const __m128 (&in)[3]) {
+    auto v0 = in[0], v1 = in[1], v2 = in[2], v3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+    _mm_store_ps(p, v0);
+    _mm_store_ps(p + 4, v1);
+    _mm_store_ps(p + 8, v2);
+    _mm_store_ps(p + 12, v3);
+  }
+};
+#endif
+
+/**
+ * Splits an array with the given number of elements into a part that can be processed with
+ * simd_pack<T>, whose size is a multiple of simd_pack<T>::width, and the remaining elements, which
+ * must be processed with scalar_pack<T>. The given function is called once for each part, and is
+ * passed an instance of the pack type to use and the range of indices to process.
+ *
+ * The function processes a range rather than a single group of elements so that the compiler does
+ * not have to inline it into the loop to produce a tight loop. It is taken by value so that its
+ * captures can be kept in registers: A capture that is accessed by reference must be reloaded after
+ * every SIMD store, because the store intrinsics may alias any object.
+ *
+ * @tparam T the value type
+ * @tparam F the type of the function to call
+ * @param count the number of elements
+ * @param f the function to call
+ */
+template <typename T, typename F> void for_each_pack(const std::size_t count, F f) {
+  const auto packed = count - count % simd_pack<T>::width;
+  f(simd_pack<T>(), std::size_t(0), packed);
+  f(scalar_pack<T>(), packed, count);
+}
+} // namespace detail
+} // namespace vm
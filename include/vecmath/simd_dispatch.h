@@ -0,0 +1,477 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "constants.h"
+#include "simd.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+
+/*
+ * Runtime dispatch is opt-in. If VM_ENABLE_SIMD_DISPATCH is defined, the batch kernels in
+ * simd_kernels.h are compiled once for each supported instruction set, and the widest one that the
+ * CPU supports is selected when the program runs, independently of the instruction set that the
+ * program is compiled for. This is only available on x86-64, where SSE2 is part of the baseline.
+ */
+#if defined(VM_ENABLE_SIMD_DISPATCH)
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define VM_SIMD_DISPATCH 1
+#endif
+#endif
+#endif
+
+#if defined(VM_SIMD_DISPATCH)
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+namespace vm {
+/**
+ * The instruction sets that the batch kernels can be compiled for, ordered by their register width.
+ */
+enum class simd_isa {
+  scalar,
+  sse2,
+  avx2,
+  avx512
+};
+
+namespace detail {
+/**
+ * Returns the widest instruction set that the CPU and the operating system support.
+ */
+inline simd_isa detect_simd_isa() {
+#if defined(VM_SIMD_DISPATCH)
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  const auto maxLeaf = info[0];
+
+  __cpuid(info, 1);
+  const auto osxsave = (info[2] & (1 << 27)) != 0;
+  const auto avx = (info[2] & (1 << 28)) != 0;
+  // the operating system must save the AVX registers, and for AVX-512 the mask and upper registers
+  const auto xcr0 = osxsave ? _xgetbv(0) : 0u;
+  const auto ymm = (xcr0 & 0x06u) == 0x06u;
+  const auto zmm = (xcr0 & 0xe6u) == 0xe6u;
+
+  auto avx2 = false;
+  auto avx512 = false;
+  if (maxLeaf >= 7) {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0;
+    avx512 = (info[1] & (1 << 16)) != 0;
+  }
+
+  if (avx && avx512 && zmm) {
+    return simd_isa::avx512;
+  } else if (avx && avx2 && ymm) {
+    return simd_isa::avx2;
+  }
+  return simd_isa::sse2;
+#else
+  // these builtins also check that the operating system saves the registers
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return simd_isa::avx512;
+  } else if (__builtin_cpu_supports("avx2")) {
+    return simd_isa::avx2;
+  }
+  return simd_isa::sse2;
+#endif
+#else
+  return simd_isa::scalar;
+#endif
+}
+} // namespace detail
+
+/**
+ * Returns the widest instruction set that the batch kernels can use on this CPU. The CPU is only
+ * queried on the first call.
+ *
+ * Without VM_ENABLE_SIMD_DISPATCH, the batch kernels are compiled for the instruction set that the
+ * program is compiled for, see simd_pack, and this function returns simd_isa::scalar.
+ *
+ * @return the widest supported instruction set
+ */
+inline simd_isa supported_simd_isa() {
+  static const auto isa = detail::detect_simd_isa();
+  return isa;
+}
+
+namespace detail {
+inline std::atomic<simd_isa>& simd_isa_selection() {
+  static auto isa = std::atomic<simd_isa>(supported_simd_isa());
+  return isa;
+}
+} // namespace detail
+
+/**
+ * Returns the instruction set that the batch kernels currently use. Initially, this is the widest
+ * supported instruction set.
+ *
+ * @return the selected instruction set
+ */
+inline simd_isa selected_simd_isa() {
+  return detail::simd_isa_selection().load(std::memory_order_relaxed);
+}
+
+/**
+ * Selects the instruction set for the batch kernels. If the given instruction set is not supported,
+ * the widest supported one is selected instead. This lets tests check the kernels of every
+ * instruction set that the CPU supports against each other.
+ *
+ * Batch operations that are running while the instruction set is changed complete with the
+ * instruction set they started with.
+ *
+ * @param isa the instruction set to select
+ * @return the instruction set that was selected
+ */
+inline simd_isa select_simd_isa(const simd_isa isa) {
+  const auto supported = supported_simd_isa();
+  const auto selected = isa < supported ? isa : supported;
+  detail::simd_isa_selection().store(selected, std::memory_order_relaxed);
+  return selected;
+}
+
+} // namespace vm
+
+#if defined(VM_SIMD_DISPATCH)
+namespace vm {
+namespace detail {
+namespace simd_scalar {
+template <typename T> using pack = scalar_pack<T>;
+} // namespace simd_scalar
+} // namespace detail
+} // namespace vm
+
+#define VM_SIMD_KERNEL_NAMESPACE simd_scalar
+#include "simd_kernels.h"
+#undef VM_SIMD_KERNEL_NAMESPACE
+
+namespace vm {
+namespace detail {
+namespace simd_sse2 {
+template <typename T> struct pack;
+
+template <> struct pack<float> {
+  using type = __m128;
+  using mask_type = __m128;
+  static constexpr std::size_t width = 4u;
+
+  static type load(const float* p) { return _mm_loadu_ps(p); }
+  static void store(float* p, const type v) { _mm_storeu_ps(p, v); }
+  static type set1(const float v) { return _mm_set1_ps(v); }
+
+  static type add(const type a, const type b) { return _mm_add_ps(a, b); }
+  static type sub(const type a, const type b) { return _mm_sub_ps(a, b); }
+  static type mul(const type a, const type b) { return _mm_mul_ps(a, b); }
+  static type div(const type a, const type b) { return _mm_div_ps(a, b); }
+  static type min(const type a, const type b) { return _mm_min_ps(a, b); }
+  static type max(const type a, const type b) { return _mm_max_ps(a, b); }
+  static type sqrt(const type a) { return _mm_sqrt_ps(a); }
+
+  static mask_type lt(const type a, const type b) { return _mm_cmplt_ps(a, b); }
+  static mask_type le(const type a, const type b) { return _mm_cmple_ps(a, b); }
+  static mask_type gt(const type a, const type b) { return _mm_cmpgt_ps(a, b); }
+  static mask_type ge(const type a, const type b) { return _mm_cmpge_ps(a, b); }
+  static mask_type mask_and(const mask_type a, const mask_type b) { return _mm_and_ps(a, b); }
+  static mask_type mask_or(const mask_type a, const mask_type b) { return _mm_or_ps(a, b); }
+  static type select(const mask_type m, const type a, const type b) {
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+  }
+  static unsigned bits(const mask_type m) { return static_cast<unsigned>(_mm_movemask_ps(m)); }
+};
+
+template <> struct pack<double> {
+  using type = __m128d;
+  using mask_type = __m128d;
+  static constexpr std::size_t width = 2u;
+
+  static type load(const double* p) { return _mm_loadu_pd(p); }
+  static void store(double* p, const type v) { _mm_storeu_pd(p, v); }
+  static type set1(const double v) { return _mm_set1_pd(v); }
+
+  static type add(const type a, const type b) { return _mm_add_pd(a, b); }
+  static type sub(const type a, const type b) { return _mm_sub_pd(a, b); }
+  static type mul(const type a, const type b) { return _mm_mul_pd(a, b); }
+  static type div(const type a, const type b) { return _mm_div_pd(a, b); }
+  static type min(const type a, const type b) { return _mm_min_pd(a, b); }
+  static type max(const type a, const type b) { return _mm_max_pd(a, b); }
+  static type sqrt(const type a) { return _mm_sqrt_pd(a); }
+
+  static mask_type lt(const type a, const type b) { return _mm_cmplt_pd(a, b); }
+  static mask_type le(const type a, const type b) { return _mm_cmple_pd(a, b); }
+  static mask_type gt(const type a, const type b) { return _mm_cmpgt_pd(a, b); }
+  static mask_type ge(const type a, const type b) { return _mm_cmpge_pd(a, b); }
+  static mask_type mask_and(const mask_type a, const mask_type b) { return _mm_and_pd(a, b); }
+  static mask_type mask_or(const mask_type a, const mask_type b) { return _mm_or_pd(a, b); }
+  static type select(const mask_type m, const type a, const type b) {
+    return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+  }
+  static unsigned bits(const mask_type m) { return static_cast<unsigned>(_mm_movemask_pd(m)); }
+};
+} // namespace simd_sse2
+} // namespace detail
+} // namespace vm
+
+#define VM_SIMD_KERNEL_NAMESPACE simd_sse2
+#include "simd_kernels.h"
+#undef VM_SIMD_KERNEL_NAMESPACE
+
+/*
+ * Everything up to the matching pop is compiled for AVX2, including the kernels. Only functions
+ * that are defined in this region may exchange AVX registers: A function outside of it that takes a
+ * register as an argument passes it differently.
+ */
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace vm {
+namespace detail {
+namespace simd_avx2 {
+template <typename T> struct pack;
+
+template <> struct pack<float> {
+  using type = __m256;
+  using mask_type = __m256;
+  static constexpr std::size_t width = 8u;
+
+  static type load(const float* p) { return _mm256_loadu_ps(p); }
+  static void store(float* p, const type v) { _mm256_storeu_ps(p, v); }
+  static type set1(const float v) { return _mm256_set1_ps(v); }
+
+  static type add(const type a, const type b) { return _mm256_add_ps(a, b); }
+  static type sub(const type a, const type b) { return _mm256_sub_ps(a, b); }
+  static type mul(const type a, const type b) { return _mm256_mul_ps(a, b); }
+  static type div(const type a, const type b) { return _mm256_div_ps(a, b); }
+  static type min(const type a, const type b) { return _mm256_min_ps(a, b); }
+  static type max(const type a, const type b) { return _mm256_max_ps(a, b); }
+  static type sqrt(const type a) { return _mm256_sqrt_ps(a); }
+
+  static mask_type lt(const type a, const type b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static mask_type le(const type a, const type b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+  static mask_type gt(const type a, const type b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  static mask_type ge(const type a, const type b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+  static mask_type mask_and(const mask_type a, const mask_type b) { return _mm256_and_ps(a, b); }
+  static mask_type mask_or(const mask_type a, const mask_type b) { return _mm256_or_ps(a, b); }
+  static type select(const mask_type m, const type a, const type b) {
+    return _mm256_blendv_ps(b, a, m);
+  }
+  static unsigned bits(const mask_type m) { return static_cast<unsigned>(_mm256_movemask_ps(m)); }
+};
+
+template <> struct pack<double> {
+  using type = __m256d;
+  using mask_type = __m256d;
+  static constexpr std::size_t width = 4u;
+
+  static type load(const double* p) { return _mm256_loadu_pd(p); }
+  static void store(double* p, const type v) { _mm256_storeu_pd(p, v); }
+  static type set1(const double v) { return _mm256_set1_pd(v); }
+
+  static type add(const type a, const type b) { return _mm256_add_pd(a, b); }
+  static type sub(const type a, const type b) { return _mm256_sub_pd(a, b); }
+  static type mul(const type a, const type b) { return _mm256_mul_pd(a, b); }
+  static type div(const type a, const type b) { return _mm256_div_pd(a, b); }
+  static type min(const type a, const type b) { return _mm256_min_pd(a, b); }
+  static type max(const type a, const type b) { return _mm256_max_pd(a, b); }
+  static type sqrt(const type a) { return _mm256_sqrt_pd(a); }
+
+  static mask_type lt(const type a, const type b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  static mask_type le(const type a, const type b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+  static mask_type gt(const type a, const type b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+  static mask_type ge(const type a, const type b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+  static mask_type mask_and(const mask_type a, const mask_type b) { return _mm256_and_pd(a, b); }
+  static mask_type mask_or(const mask_type a, const mask_type b) { return _mm256_or_pd(a, b); }
+  static type select(const mask_type m, const type a, const type b) {
+    return _mm256_blendv_pd(b, a, m);
+  }
+  static unsigned bits(const mask_type m) { return static_cast<unsigned>(_mm256_movemask_pd(m)); }
+};
+} // namespace simd_avx2
+} // namespace detail
+} // namespace vm
+
+#define VM_SIMD_KERNEL_NAMESPACE simd_avx2
+#include "simd_kernels.h"
+#undef VM_SIMD_KERNEL_NAMESPACE
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+/*
+ * The AVX-512 kernels use the AVX-512F mask registers for comparisons, so a mask has one bit per
+ * lane.
+ */
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+
+namespace vm {
+namespace detail {
+namespace simd_avx512 {
+template <typename T> struct pack;
+
+template <> struct pack<float> {
+  using type = __m512;
+  using mask_type = __mmask16;
+  static constexpr std::size_t width = 16u;
+
+  static type load(const float* p) { return _mm512_loadu_ps(p); }
+  static void store(float* p, const type v) { _mm512_storeu_ps(p, v); }
+  static type set1(const float v) { return _mm512_set1_ps(v); }
+
+  static type add(const type a, const type b) { return _mm512_add_ps(a, b); }
+  static type sub(const type a, const type b) { return _mm512_sub_ps(a, b); }
+  static type mul(const type a, const type b) { return _mm512_mul_ps(a, b); }
+  static type div(const type a, const type b) { return _mm512_div_ps(a, b); }
+  static type min(const type a, const type b) { return _mm512_min_ps(a, b); }
+  static type max(const type a, const type b) { return _mm512_max_ps(a, b); }
+  // _mm512_sqrt_ps triggers a false maybe-uninitialized warning in GCC's headers
+  static type sqrt(const type a) { return _mm512_maskz_sqrt_ps(0xffff, a); }
+
+  static mask_type lt(const type a, const type b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+  static mask_type le(const type a, const type b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+  static mask_type gt(const type a, const type b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+  static mask_type ge(const type a, const type b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+  static mask_type mask_and(const mask_type a, const mask_type b) {
+    return static_cast<mask_type>(a & b);
+  }
+  static mask_type mask_or(const mask_type a, const mask_type b) {
+    return static_cast<mask_type>(a | b);
+  }
+  static type select(const mask_type m, const type a, const type b) {
+    return _mm512_mask_blend_ps(m, b, a);
+  }
+  static unsigned bits(const mask_type m) { return static_cast<unsigned>(m); }
+};
+
+template <> struct pack<double> {
+  using type = __m512d;
+  using mask_type = __mmask8;
+  static constexpr std::size_t width = 8u;
+
+  static type load(const double* p) { return _mm512_loadu_pd(p); }
+  static void store(double* p, const type v) { _mm512_storeu_pd(p, v); }
+  static type set1(const double v) { return _mm512_set1_pd(v); }
+
+  static type add(const type a, const type b) { return _mm512_add_pd(a, b); }
+  static type sub(const type a, const type b) { return _mm512_sub_pd(a, b); }
+  static type mul(const type a, const type b) { return _mm512_mul_pd(a, b); }
+  static type div(const type a, const type b) { return _mm512_div_pd(a, b); }
+  static type min(const type a, const type b) { return _mm512_min_pd(a, b); }
+  static type max(const type a, const type b) { return _mm512_max_pd(a, b); }
+  static type sqrt(const type a) { return _mm512_maskz_sqrt_pd(0xff, a); }
+
+  static mask_type lt(const type a, const type b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+  static mask_type le(const type a, const type b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+  static mask_type gt(const type a, const type b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+  static mask_type ge(const type a, const type b) { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+  static mask_type mask_and(const mask_type a, const mask_type b) {
+    return static_cast<mask_type>(a & b);
+  }
+  static mask_type mask_or(const mask_type a, const mask_type b) {
+    return static_cast<mask_type>(a | b);
+  }
+  static type select(const mask_type m, const type a, const type b) {
+    return _mm512_mask_blend_pd(m, b, a);
+  }
+  static unsigned bits(const mask_type m) { return static_cast<unsigned>(m); }
+};
+} // namespace simd_avx512
+} // namespace detail
+} // namespace vm
+
+#define VM_SIMD_KERNEL_NAMESPACE simd_avx512
+#include "simd_kernels.h"
+#undef VM_SIMD_KERNEL_NAMESPACE
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#else
+namespace vm {
+namespace detail {
+namespace simd_static {
+template <typename T> using pack = simd_pack<T>;
+} // namespace simd_static
+} // namespace detail
+} // namespace vm
+
+#define VM_SIMD_KERNEL_NAMESPACE simd_static
+#include "simd_kernels.h"
+#undef VM_SIMD_KERNEL_NAMESPACE
+#endif
+
+namespace vm {
+namespace detail {
+/**
+ * Calls the given function with the kernels for the selected instruction set. The kernels are
+ * passed as an instance of a type whose static member functions are the kernels in
+ * simd_kernels.h. The function must only pass pointers and scalars to the kernels.
+ *
+ * Without VM_ENABLE_SIMD_DISPATCH, the function is always called with the kernels for the
+ * instruction set that the program is compiled for.
+ *
+ * @tparam F the type of the function to call
+ * @param f the function to call
+ */
+template <typename F> void dispatch_simd(const F& f) {
+#if defined(VM_SIMD_DISPATCH)
+  switch (selected_simd_isa()) {
+  case simd_isa::avx512:
+    f(simd_avx512::kernels());
+    break;
+  case simd_isa::avx2:
+    f(simd_avx2::kernels());
+    break;
+  case simd_isa::sse2:
+    f(simd_sse2::kernels());
+    break;
+  case simd_isa::scalar:
+    f(simd_scalar::kernels());
+    break;
+  }
+#else
+  f(simd_static::kernels());
+#endif
+}
+} // namespace detail
+} // namespace vm
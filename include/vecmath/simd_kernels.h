@@ -0,0 +1,399 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+ * The batch kernels that can be selected at run time. This file has no include guard because
+ * simd_dispatch.h includes it once for each instruction set, with VM_SIMD_KERNEL_NAMESPACE defined
+ * to the namespace to put the kernels in. That namespace must declare a template pack<T> that
+ * provides the SIMD operations for the instruction set, see simd_pack. The code of this file is
+ * compiled for the instruction set of the enclosing target region, so it must not include any
+ * headers, and it must not call any function outside of that namespace that takes or returns a SIMD
+ * register.
+ *
+ * Every kernel processes the elements that are left over after the packed part with scalar_pack,
+ * and computes each element with the same operations in the same order as the scalar code. The
+ * results of different instruction sets can still differ in the last bits if the compiler
+ * contracts a multiplication and an addition into a fused multiply-add for some of them.
+ */
+
+namespace vm {
+namespace detail {
+namespace VM_SIMD_KERNEL_NAMESPACE {
+struct kernels {
+  /**
+   * Computes the dot product of each pair of vectors with the same index in the given component
+   * arrays.
+   */
+  template <typename T, std::size_t S>
+  static void dot(
+    const std::array<const T*, S>& lhs,
+    const std::array<const T*, S>& rhs,
+    T* out,
+    const std::size_t count) {
+    const auto packed = count - count % pack<T>::width;
+    dot<pack<T>>(lhs, rhs, out, 0u, packed);
+    dot<scalar_pack<T>>(lhs, rhs, out, packed, count);
+  }
+
+  /**
+   * Computes the dot product of each vector in the given component arrays and the given vector.
+   */
+  template <typename T, std::size_t S>
+  static void dot(
+    const std::array<const T*, S>& lhs, const T (&rhs)[S], T* out, const std::size_t count) {
+    const auto packed = count - count % pack<T>::width;
+    dot<pack<T>>(lhs, rhs, out, 0u, packed);
+    dot<scalar_pack<T>>(lhs, rhs, out, packed, count);
+  }
+
+  /**
+   * Normalizes each vector in the given component arrays.
+   */
+  template <typename T, std::size_t S>
+  static void normalize(
+    const std::array<const T*, S>& vecs, const std::array<T*, S>& out, const std::size_t count) {
+    const auto packed = count - count % pack<T>::width;
+    normalize<pack<T>>(vecs, out, 0u, packed);
+    normalize<scalar_pack<T>>(vecs, out, packed, count);
+  }
+
+  /**
+   * Multiplies each vector in the given component arrays by the given matrix, which is given by
+   * its columns.
+   */
+  template <typename T, std::size_t R, std::size_t C>
+  static void multiply(
+    const T (&m)[C][R],
+    const std::array<const T*, C>& vecs,
+    const std::array<T*, R>& out,
+    const std::size_t count) {
+    const auto packed = count - count % pack<T>::width;
+    multiply<pack<T>>(m, vecs, out, 0u, packed);
+    multiply<scalar_pack<T>>(m, vecs, out, packed, count);
+  }
+
+  /**
+   * Multiplies each point in the given component arrays by the given matrix, which is given by its
+   * columns, and converts the products back to cartesian coordinates.
+   */
+  template <typename T, std::size_t S>
+  static void multiply_points(
+    const T (&m)[S + 1][S + 1],
+    const std::array<const T*, S>& points,
+    const std::array<T*, S>& out,
+    const std::size_t count) {
+    const auto packed = count - count % pack<T>::width;
+    multiply_points<pack<T>>(m, points, out, 0u, packed);
+    multiply_points<scalar_pack<T>>(m, points, out, packed, count);
+  }
+
+  /**
+   * Computes the distance from the origin of the given ray to each of the bounding boxes with the
+   * given min and max component arrays, or NaN for each box that the ray does not hit.
+   */
+  template <typename T, std::size_t S>
+  static void intersect_ray_bbox(
+    const T (&origin)[S],
+    const T (&direction)[S],
+    const std::array<const T*, S>& mins,
+    const std::array<const T*, S>& maxs,
+    T* out,
+    const std::size_t count) {
+    const auto packed = count - count % pack<T>::width;
+    intersect_ray_bbox<pack<T>>(origin, direction, mins, maxs, out, 0u, packed);
+    intersect_ray_bbox<scalar_pack<T>>(origin, direction, mins, maxs, out, packed, count);
+  }
+
+  /**
+   * Computes the distance from the origin of the given ray to each of the triangles with the given
+   * vertex component arrays, or NaN for each triangle that the ray does not hit.
+   */
+  template <typename T>
+  static void intersect_ray_triangle(
+    const T (&origin)[3],
+    const T (&direction)[3],
+    const std::array<const T*, 3>& p1,
+    const std::array<const T*, 3>& p2,
+    const std::array<const T*, 3>& p3,
+    T* out,
+    const std::size_t count) {
+    const auto packed = count - count % pack<T>::width;
+    intersect_ray_triangle<pack<T>>(origin, direction, p1, p2, p3, out, 0u, packed);
+    intersect_ray_triangle<scalar_pack<T>>(origin, direction, p1, p2, p3, out, packed, count);
+  }
+
+private:
+  template <typename P, typename T, std::size_t S>
+  static void load(
+    const std::array<const T*, S>& v, const std::size_t i, typename P::type (&out)[S]) {
+    for (std::size_t c = 0; c < S; ++c) {
+      out[c] = P::load(v[c] + i);
+    }
+  }
+
+  template <typename P, typename T, std::size_t S>
+  static void set1(const T (&v)[S], typename P::type (&out)[S]) {
+    for (std::size_t c = 0; c < S; ++c) {
+      out[c] = P::set1(v[c]);
+    }
+  }
+
+  template <typename P, typename T, std::size_t S>
+  static void store(
+    const std::array<T*, S>& v, const std::size_t i, const typename P::type (&in)[S]) {
+    for (std::size_t c = 0; c < S; ++c) {
+      P::store(v[c] + i, in[c]);
+    }
+  }
+
+  template <typename P, std::size_t S>
+  static void sub(
+    const typename P::type (&lhs)[S],
+    const typename P::type (&rhs)[S],
+    typename P::type (&out)[S]) {
+    for (std::size_t c = 0; c < S; ++c) {
+      out[c] = P::sub(lhs[c], rhs[c]);
+    }
+  }
+
+  template <typename P, typename T, std::size_t S>
+  static typename P::type dot(const typename P::type (&lhs)[S], const typename P::type (&rhs)[S]) {
+    auto result = P::set1(T(0));
+    for (std::size_t c = 0; c < S; ++c) {
+      result = P::add(result, P::mul(lhs[c], rhs[c]));
+    }
+    return result;
+  }
+
+  template <typename P>
+  static void cross(
+    const typename P::type (&lhs)[3],
+    const typename P::type (&rhs)[3],
+    typename P::type (&out)[3]) {
+    out[0] = P::sub(P::mul(lhs[1], rhs[2]), P::mul(lhs[2], rhs[1]));
+    out[1] = P::sub(P::mul(lhs[2], rhs[0]), P::mul(lhs[0], rhs[2]));
+    out[2] = P::sub(P::mul(lhs[0], rhs[1]), P::mul(lhs[1], rhs[0]));
+  }
+
+  template <typename P, typename T, std::size_t S>
+  static void dot(
+    const std::array<const T*, S>& lhs,
+    const std::array<const T*, S>& rhs,
+    T* out,
+    const std::size_t first,
+    const std::size_t last) {
+    for (auto i = first; i < last; i += P::width) {
+      typename P::type l[S], r[S];
+      load<P>(lhs, i, l);
+      load<P>(rhs, i, r);
+      P::store(out + i, dot<P, T>(l, r));
+    }
+  }
+
+  template <typename P, typename T, std::size_t S>
+  static void dot(
+    const std::array<const T*, S>& lhs,
+    const T (&rhs)[S],
+    T* out,
+    const std::size_t first,
+    const std::size_t last) {
+    typename P::type r[S];
+    set1<P>(rhs, r);
+    for (auto i = first; i < last; i += P::width) {
+      typename P::type l[S];
+      load<P>(lhs, i, l);
+      P::store(out + i, dot<P, T>(l, r));
+    }
+  }
+
+  template <typename P, typename T, std::size_t S>
+  static void normalize(
+    const std::array<const T*, S>& vecs,
+    const std::array<T*, S>& out,
+    const std::size_t first,
+    const std::size_t last) {
+    for (auto i = first; i < last; i += P::width) {
+      typename P::type v[S];
+      load<P>(vecs, i, v);
+      const auto length = P::sqrt(dot<P, T>(v, v));
+      for (std::size_t c = 0; c < S; ++c) {
+        v[c] = P::div(v[c], length);
+      }
+      store<P>(out, i, v);
+    }
+  }
+
+  template <typename P, typename T, std::size_t R, std::size_t C>
+  static void multiply(
+    const T (&m)[C][R],
+    const std::array<const T*, C>& vecs,
+    const std::array<T*, R>& out,
+    const std::size_t first,
+    const std::size_t last) {
+    for (auto i = first; i < last; i += P::width) {
+      typename P::type v[C], result[R];
+      load<P>(vecs, i, v);
+      for (std::size_t r = 0; r < R; ++r) {
+        result[r] = P::set1(T(0));
+        for (std::size_t c = 0; c < C; ++c) {
+          result[r] = P::add(result[r], P::mul(P::set1(m[c][r]), v[c]));
+        }
+      }
+      store<P>(out, i, result);
+    }
+  }
+
+  template <typename P, typename T, std::size_t S>
+  static void multiply_points(
+    const T (&m)[S + 1][S + 1],
+    const std::array<const T*, S>& points,
+    const std::array<T*, S>& out,
+    const std::size_t first,
+    const std::size_t last) {
+    for (auto i = first; i < last; i += P::width) {
+      typename P::type v[S], result[S + 1];
+      load<P>(points, i, v);
+      for (std::size_t r = 0; r < S + 1; ++r) {
+        result[r] = P::set1(T(0));
+        for (std::size_t c = 0; c < S; ++c) {
+          result[r] = P::add(result[r], P::mul(P::set1(m[c][r]), v[c]));
+        }
+        result[r] = P::add(result[r], P::set1(m[S][r]));
+      }
+      for (std::size_t r = 0; r < S; ++r) {
+        P::store(out[r] + i, P::div(result[r], result[S]));
+      }
+    }
+  }
+
+  /*
+   * Follows the branches of the scalar intersect_ray_bbox with masks. The search for the farthest
+   * plane starts at negative infinity instead of at the first plane that the origin is outside of,
+   * which chooses the same plane for every finite distance.
+   */
+  template <typename P, typename T, std::size_t S>
+  static void intersect_ray_bbox(
+    const T (&origin)[S],
+    const T (&direction)[S],
+    const std::array<const T*, S>& mins,
+    const std::array<const T*, S>& maxs,
+    T* out,
+    const std::size_t first,
+    const std::size_t last) {
+    typename P::type o[S], d[S];
+    set1<P>(origin, o);
+    set1<P>(direction, d);
+    const auto zero = P::set1(T(0));
+    const auto nan = P::set1(std::numeric_limits<T>::quiet_NaN());
+
+    for (auto i = first; i < last; i += P::width) {
+      typename P::type min[S], max[S], distances[S];
+      typename P::mask_type outside[S];
+      load<P>(mins, i, min);
+      load<P>(maxs, i, max);
+
+      for (std::size_t c = 0; c < S; ++c) {
+        const auto below = P::lt(o[c], min[c]);
+        const auto above = P::gt(o[c], max[c]);
+        const auto inner = direction[c] < T(0) ? min[c] : max[c];
+        const auto plane = P::select(below, min[c], P::select(above, max[c], inner));
+        outside[c] = P::mask_or(below, above);
+        distances[c] =
+          direction[c] != T(0) ? P::div(P::sub(plane, o[c]), d[c]) : P::set1(T(-1));
+      }
+
+      // the closest plane if the origin is inside, and the farthest plane it is outside of if not
+      auto nearest = distances[0];
+      auto nearestAxis = zero;
+      auto farthest = P::set1(-std::numeric_limits<T>::infinity());
+      auto farthestAxis = zero;
+      auto anyOutside = outside[0];
+      for (std::size_t c = 0; c < S; ++c) {
+        const auto axis = P::set1(T(c));
+        const auto nearer = P::lt(distances[c], nearest);
+        nearest = P::select(nearer, distances[c], nearest);
+        nearestAxis = P::select(nearer, axis, nearestAxis);
+
+        const auto farther = P::mask_and(outside[c], P::gt(distances[c], farthest));
+        farthest = P::select(farther, distances[c], farthest);
+        farthestAxis = P::select(farther, axis, farthestAxis);
+        anyOutside = P::mask_or(anyOutside, outside[c]);
+      }
+
+      const auto distance = P::select(anyOutside, farthest, nearest);
+      const auto distanceAxis = P::select(anyOutside, farthestAxis, nearestAxis);
+      auto miss = P::lt(distance, zero);
+      for (std::size_t c = 0; c < S; ++c) {
+        const auto axis = P::set1(T(c));
+        const auto otherAxis = P::mask_or(P::lt(distanceAxis, axis), P::gt(distanceAxis, axis));
+        const auto coord = P::add(o[c], P::mul(distance, d[c]));
+        const auto outsideBox = P::mask_or(P::lt(coord, min[c]), P::gt(coord, max[c]));
+        miss = P::mask_or(miss, P::mask_and(otherAxis, outsideBox));
+      }
+      P::store(out + i, P::select(miss, nan, distance));
+    }
+  }
+
+  template <typename P, typename T>
+  static void intersect_ray_triangle(
+    const T (&origin)[3],
+    const T (&direction)[3],
+    const std::array<const T*, 3>& p1s,
+    const std::array<const T*, 3>& p2s,
+    const std::array<const T*, 3>& p3s,
+    T* out,
+    const std::size_t first,
+    const std::size_t last) {
+    typename P::type o[3], d[3];
+    set1<P>(origin, o);
+    set1<P>(direction, d);
+    const auto zero = P::set1(T(0));
+    const auto one = P::set1(T(1));
+    const auto epsilon = P::set1(constants<T>::almost_zero());
+    const auto negEpsilon = P::set1(-constants<T>::almost_zero());
+    const auto nan = P::set1(std::numeric_limits<T>::quiet_NaN());
+
+    for (auto i = first; i < last; i += P::width) {
+      typename P::type p1[3], p2[3], p3[3];
+      load<P>(p1s, i, p1);
+      load<P>(p2s, i, p2);
+      load<P>(p3s, i, p3);
+
+      typename P::type e1[3], e2[3], p[3], t[3], q[3];
+      sub<P>(p2, p1, e1);
+      sub<P>(p3, p1, e2);
+      cross<P>(d, e2, p);
+      const auto a = dot<P, T>(p, e1);
+      auto miss = P::mask_and(P::le(a, epsilon), P::ge(a, negEpsilon));
+
+      sub<P>(o, p1, t);
+      cross<P>(t, e1, q);
+      const auto u = P::div(dot<P, T>(q, e2), a);
+      const auto v = P::div(dot<P, T>(p, t), a);
+      const auto w = P::div(dot<P, T>(q, d), a);
+      miss = P::mask_or(miss, P::mask_or(P::lt(u, zero), P::lt(v, zero)));
+      miss = P::mask_or(miss, P::mask_or(P::lt(w, zero), P::gt(P::add(v, w), one)));
+      P::store(out + i, P::select(miss, nan, u));
+    }
+  }
+};
+} // namespace VM_SIMD_KERNEL_NAMESPACE
+} // namespace detail
+} // namespace vm
@@ -0,0 +1,519 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "affine.h"
+#include "mat.h"
+#include "scalar.h"
+#include "vec.h"
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+namespace vm {
+/**
+ * Classifies a transformation. Every kind of transformation is a special case of the kinds that
+ * follow it, so a composition of two transformations is at most as special as the less special
+ * of the two.
+ */
+enum class transformation_kind {
+  /**
+   * Maps every point to itself.
+   */
+  identity,
+  /**
+   * Adds the same offset to every point.
+   */
+  translation,
+  /**
+   * An orthonormal linear transformation followed by a translation, i.e. a rotation, possibly
+   * combined with a reflection, and a translation. Such a transformation preserves lengths and
+   * angles.
+   */
+  rigid,
+  /**
+   * A linear transformation followed by a translation.
+   */
+  affine,
+  /**
+   * Any other transformation, which requires a perspective division.
+   */
+  projective
+};
+
+namespace detail {
+/**
+ * Classifies the given homogeneous transformation matrix. The linear part is considered to be
+ * orthonormal if the dot products of its columns differ from those of the identity matrix by at
+ * most a few machine epsilons of T, i.e. only if it is orthonormal to the precision of T, so that
+ * its transpose is as accurate an inverse as a general matrix inversion would compute.
+ *
+ * @tparam T the component type
+ * @tparam S the number of rows and columns
+ * @param m the matrix to classify
+ * @return the kind of transformation
+ */
+template <typename T, std::size_t S>
+constexpr transformation_kind classify_transformation(const mat<T, S, S>& m) {
+  if (!is_affine(m)) {
+    return transformation_kind::projective;
+  }
+
+  constexpr auto tolerance = static_cast<T>(4u * S) * std::numeric_limits<T>::epsilon();
+
+  auto identityLinear = true;
+  auto orthonormal = true;
+  for (std::size_t i = 0u; i < S - 1u; ++i) {
+    for (std::size_t j = 0u; j < S - 1u; ++j) {
+      const auto expected = i == j ? static_cast<T>(1) : static_cast<T>(0);
+      identityLinear = identityLinear && m[i][j] == expected;
+
+      auto dot = static_cast<T>(0);
+      for (std::size_t r = 0u; r < S - 1u; ++r) {
+        dot += m[i][r] * m[j][r];
+      }
+      orthonormal = orthonormal && vm::abs(dot - expected) <= tolerance;
+    }
+  }
+
+  if (identityLinear) {
+    for (std::size_t r = 0u; r < S - 1u; ++r) {
+      if (m[S - 1u][r] != static_cast<T>(0)) {
+        return transformation_kind::translation;
+      }
+    }
+    return transformation_kind::identity;
+  }
+  return orthonormal ? transformation_kind::rigid : transformation_kind::affine;
+}
+
+/**
+ * Inverts the given homogeneous transformation matrix of the given kind. The inverse of a
+ * translation negates the offset, and the linear part of the inverse of a rigid transformation is
+ * its transpose, so that these need not be computed by a general matrix inversion.
+ *
+ * @tparam T the component type
+ * @tparam S the number of rows and columns
+ * @param m the matrix to invert
+ * @param kind the kind of transformation, see classify_transformation
+ * @return a pair of a boolean and a matrix such that the boolean indicates whether the matrix is
+ * invertible, and if so, the matrix is the inverted given matrix
+ */
+template <typename T, std::size_t S>
+constexpr std::tuple<bool, mat<T, S, S>> invert_transformation(
+  const mat<T, S, S>& m, const transformation_kind kind) {
+  switch (kind) {
+  case transformation_kind::identity:
+    return std::make_tuple(true, m);
+  case transformation_kind::translation: {
+    auto result = m;
+    for (std::size_t r = 0u; r < S - 1u; ++r) {
+      result[S - 1u][r] = -m[S - 1u][r];
+    }
+    return std::make_tuple(true, result);
+  }
+  case transformation_kind::rigid: {
+    mat<T, S, S> result;
+    for (std::size_t c = 0u; c < S - 1u; ++c) {
+      for (std::size_t r = 0u; r < S - 1u; ++r) {
+        result[c][r] = m[r][c];
+      }
+    }
+    // the translation is -transpose(linear) * t
+    for (std::size_t r = 0u; r < S - 1u; ++r) {
+      auto sum = static_cast<T>(0);
+      for (std::size_t c = 0u; c < S - 1u; ++c) {
+        sum -= m[r][c] * m[S - 1u][c];
+      }
+      result[S - 1u][r] = sum;
+    }
+    return std::make_tuple(true, result);
+  }
+  case transformation_kind::affine:
+    return invert_affine(m);
+  case transformation_kind::projective:
+    return invert(m);
+  }
+  return invert(m);
+}
+} // namespace detail
+
+/**
+ * A transformation of S dimensional space given by a homogeneous (S + 1) x (S + 1) matrix, together
+ * with data that is derived from the matrix once when the transformation is created: its kind, its
+ * inverse, and the transpose of its inverse, which transforms normals.
+ *
+ * Transforming geometry with an instance of this class rather than with a bare matrix allows the
+ * geometry types to skip work depending on the kind of the transformation, e.g. a plane is moved by
+ * adjusting its distance if the transformation is a translation, and a transformed normal need not
+ * be normalized if the transformation is rigid.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ */
+template <typename T, std::size_t S> class transformation {
+public:
+  using type = T;
+  static const std::size_t size = S;
+
+private:
+  mat<T, S + 1, S + 1> m_matrix;
+  mat<T, S + 1, S + 1> m_inverse;
+  mat<T, S + 1, S + 1> m_inverse_transpose;
+  transformation_kind m_kind;
+  bool m_invertible;
+
+  constexpr transformation(
+    const mat<T, S + 1, S + 1>& i_matrix,
+    const mat<T, S + 1, S + 1>& i_inverse,
+    const transformation_kind i_kind,
+    const bool i_invertible)
+    : m_matrix(i_matrix)
+    , m_inverse(i_inverse)
+    , m_inverse_transpose(transpose(i_inverse))
+    , m_kind(i_kind)
+    , m_invertible(i_invertible) {}
+
+public:
+  /**
+   * Creates a new identity transformation.
+   */
+  constexpr transformation()
+    : m_matrix()
+    , m_inverse()
+    , m_inverse_transpose()
+    , m_kind(transformation_kind::identity)
+    , m_invertible(true) {}
+
+  // Copy and move constructors
+  transformation(const transformation<T, S>& other) = default;
+  transformation(transformation<T, S>&& other) noexcept = default;
+
+  // Assignment operators
+  transformation<T, S>& operator=(const transformation<T, S>& other) = default;
+  transformation<T, S>& operator=(transformation<T, S>&& other) noexcept = default;
+
+  /**
+   * Creates a new transformation with the given matrix. The kind and the inverse of the
+   * transformation are computed here.
+   *
+   * @param i_matrix the homogeneous transformation matrix
+   */
+  constexpr explicit transformation(const mat<T, S + 1, S + 1>& i_matrix)
+    : m_matrix(i_matrix)
+    , m_inverse()
+    , m_inverse_transpose()
+    , m_kind(detail::classify_transformation(i_matrix))
+    , m_invertible(false) {
+    const auto inverse = detail::invert_transformation(m_matrix, m_kind);
+    m_invertible = std::get<0>(inverse);
+    m_inverse = std::get<1>(inverse);
+    m_inverse_transpose = transpose(m_inverse);
+  }
+
+  /**
+   * Creates a new transformation from the given affine transformation.
+   *
+   * @param t the affine transformation
+   */
+  constexpr explicit transformation(const affine<T, S>& t)
+    : transformation(t.to_mat()) {}
+
+  /**
+   * Returns the identity transformation.
+   */
+  static constexpr transformation<T, S> identity() { return transformation<T, S>(); }
+
+  /**
+   * Returns a transformation that translates by the given offset.
+   *
+   * @param delta the offset
+   */
+  static constexpr transformation<T, S> translation(const vec<T, S>& delta) {
+    auto matrix = mat<T, S + 1, S + 1>::identity();
+    auto inverse = mat<T, S + 1, S + 1>::identity();
+    for (std::size_t r = 0u; r < S; ++r) {
+      matrix[S][r] = delta[r];
+      inverse[S][r] = -delta[r];
+    }
+    return transformation<T, S>(matrix, inverse, transformation_kind::translation, true);
+  }
+
+  /**
+   * Returns the homogeneous transformation matrix.
+   */
+  constexpr const mat<T, S + 1, S + 1>& matrix() const { return m_matrix; }
+
+  /**
+   * Returns the inverse of the homogeneous transformation matrix, or the identity matrix if this
+   * transformation is not invertible.
+   */
+  constexpr const mat<T, S + 1, S + 1>& inverse() const { return m_inverse; }
+
+  /**
+   * Returns the transpose of inverse().
+   */
+  constexpr const mat<T, S + 1, S + 1>& inverse_transpose() const { return m_inverse_transpose; }
+
+  /**
+   * Returns the kind of this transformation.
+   */
+  constexpr transformation_kind kind() const { return m_kind; }
+
+  /**
+   * Indicates whether this transformation is invertible.
+   */
+  constexpr bool invertible() const { return m_invertible; }
+
+  /**
+   * Returns the translation of this transformation, i.e. the first S components of the last column
+   * of its matrix.
+   */
+  constexpr vec<T, S> translation() const {
+    vec<T, S> result;
+    for (std::size_t r = 0u; r < S; ++r) {
+      result[r] = m_matrix[S][r];
+    }
+    return result;
+  }
+
+  template <typename TT, std::size_t SS>
+  friend constexpr transformation<TT, SS> operator*(
+    const transformation<TT, SS>& lhs, const transformation<TT, SS>& rhs);
+
+  template <typename TT, std::size_t SS>
+  friend constexpr std::tuple<bool, transformation<TT, SS>> invert(
+    const transformation<TT, SS>& t);
+};
+
+static_assert(std::is_trivially_copyable_v<transformation<float, 3>>);
+static_assert(std::is_trivially_copyable_v<transformation<double, 3>>);
+
+/* ========== comparison operators ========== */
+
+/**
+ * Checks whether the matrices of the given transformations have equal components.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param lhs the first transformation
+ * @param rhs the second transformation
+ * @param epsilon the epsilon value
+ * @return true if all components of the given transformations are equal, and false otherwise
+ */
+template <typename T, std::size_t S>
+constexpr bool is_equal(
+  const transformation<T, S>& lhs, const transformation<T, S>& rhs, const T epsilon) {
+  return is_equal(lhs.matrix(), rhs.matrix(), epsilon);
+}
+
+/**
+ * Checks whether the matrices of the given transformations have identical components.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param lhs the first transformation
+ * @param rhs the second transformation
+ * @return true if all components of the given transformations are equal, and false otherwise
+ */
+template <typename T, std::size_t S>
+constexpr bool operator==(const transformation<T, S>& lhs, const transformation<T, S>& rhs) {
+  return lhs.matrix() == rhs.matrix();
+}
+
+/**
+ * Checks whether the matrices of the given transformations have identical components.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param lhs the first transformation
+ * @param rhs the second transformation
+ * @return false if all components of the given transformations are equal, and true otherwise
+ */
+template <typename T, std::size_t S>
+constexpr bool operator!=(const transformation<T, S>& lhs, const transformation<T, S>& rhs) {
+  return lhs.matrix() != rhs.matrix();
+}
+
+/* ========== arithmetic operators ========== */
+
+/**
+ * Composes the given transformations. The resulting transformation first applies the right hand
+ * side and then the left hand side, just like the product of their matrices. The inverse of the
+ * result is the product of the inverses in reverse order, so no matrix is inverted.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param lhs the transformation to apply second
+ * @param rhs the transformation to apply first
+ * @return the composed transformation
+ */
+template <typename T, std::size_t S>
+constexpr transformation<T, S> operator*(
+  const transformation<T, S>& lhs, const transformation<T, S>& rhs) {
+  const auto matrix = lhs.m_matrix * rhs.m_matrix;
+  const auto invertible = lhs.m_invertible && rhs.m_invertible;
+  const auto inverse = invertible ? rhs.m_inverse * lhs.m_inverse : mat<T, S + 1, S + 1>();
+
+  // a product of projective transformations can be affine again
+  const auto kind = lhs.m_kind < rhs.m_kind ? rhs.m_kind : lhs.m_kind;
+  return transformation<T, S>(
+    matrix,
+    inverse,
+    kind == transformation_kind::projective ? detail::classify_transformation(matrix) : kind,
+    invertible);
+}
+
+/**
+ * Inverts the given transformation. Since the inverse is computed when the transformation is
+ * created, this only swaps the matrix and its inverse.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param t the transformation to invert
+ * @return a pair of a boolean and a transformation such that the boolean indicates whether the
+ * transformation is invertible, and if so, the transformation is the inverted given transformation
+ */
+template <typename T, std::size_t S>
+constexpr std::tuple<bool, transformation<T, S>> invert(const transformation<T, S>& t) {
+  if (!t.m_invertible) {
+    return std::make_tuple(false, transformation<T, S>());
+  }
+  return std::make_tuple(true, transformation<T, S>(t.m_inverse, t.m_matrix, t.m_kind, true));
+}
+
+/**
+ * Applies the given transformation to the given point.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param lhs the transformation
+ * @param rhs the point
+ * @return the transformed point
+ */
+template <typename T, std::size_t S>
+constexpr vec<T, S> operator*(const transformation<T, S>& lhs, const vec<T, S>& rhs) {
+  const auto& m = lhs.matrix();
+  switch (lhs.kind()) {
+  case transformation_kind::identity:
+    return rhs;
+  case transformation_kind::translation:
+    return rhs + lhs.translation();
+  case transformation_kind::rigid:
+  case transformation_kind::affine: {
+    vec<T, S> result;
+    for (std::size_t r = 0u; r < S; ++r) {
+      auto sum = m[S][r];
+      for (std::size_t c = 0u; c < S; ++c) {
+        sum += m[c][r] * rhs[c];
+      }
+      result[r] = sum;
+    }
+    return result;
+  }
+  case transformation_kind::projective:
+    return m * rhs;
+  }
+  return m * rhs;
+}
+
+/**
+ * Applies the upper left S x S block of the given transformation's matrix to the given vector.
+ * Unlike a point, a vector is not translated. For affine transformations, this is equivalent to
+ * multiplying the vector with the result of strip_translation; for projective transformations, no
+ * perspective division is performed.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param t the transformation
+ * @param v the vector
+ * @return the transformed vector
+ */
+template <typename T, std::size_t S>
+constexpr vec<T, S> transform_vector(const transformation<T, S>& t, const vec<T, S>& v) {
+  if (t.kind() <= transformation_kind::translation) {
+    return v;
+  }
+
+  const auto& m = t.matrix();
+  vec<T, S> result;
+  for (std::size_t r = 0u; r < S; ++r) {
+    auto sum = static_cast<T>(0);
+    for (std::size_t c = 0u; c < S; ++c) {
+      sum += m[c][r] * v[c];
+    }
+    result[r] = sum;
+  }
+  return result;
+}
+
+namespace detail {
+/**
+ * Multiplies the given vector with the upper left S x S block of the given transformation's
+ * inverse transpose without normalizing the result, see transform_normal.
+ */
+template <typename T, std::size_t S>
+constexpr vec<T, S> apply_normal_matrix(const transformation<T, S>& t, const vec<T, S>& n) {
+  const auto& m = t.inverse_transpose();
+  vec<T, S> result;
+  for (std::size_t r = 0u; r < S; ++r) {
+    auto sum = static_cast<T>(0);
+    for (std::size_t c = 0u; c < S; ++c) {
+      sum += m[c][r] * n[c];
+    }
+    result[r] = sum;
+  }
+  return result;
+}
+} // namespace detail
+
+/**
+ * Transforms the given normal of a hyperplane by the given affine transformation, so that the
+ * result is perpendicular to the transformed hyperplane even if the transformation scales
+ * non-uniformly. The normal is transformed with the inverse transpose of the linear part, and the
+ * result is normalized unless the transformation is rigid.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ * @param t the transformation, which must be affine and invertible
+ * @param n the normal, which must be normalized
+ * @return the transformed normal
+ */
+template <typename T, std::size_t S>
+vec<T, S> transform_normal(const transformation<T, S>& t, const vec<T, S>& n) {
+  assert(t.kind() <= transformation_kind::affine && t.invertible());
+  switch (t.kind()) {
+  case transformation_kind::identity:
+  case transformation_kind::translation:
+    return n;
+  case transformation_kind::rigid:
+    // the inverse transpose of an orthonormal matrix is the matrix itself
+    return transform_vector(t, n);
+  case transformation_kind::affine:
+  case transformation_kind::projective:
+    break;
+  }
+  return normalize(detail::apply_normal_matrix(t, n));
+}
+} // namespace vm
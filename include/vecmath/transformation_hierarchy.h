@@ -0,0 +1,254 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "mat.h"
+#include "transformation.h"
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace vm {
+/**
+ * A hierarchy of transformations, e.g. of nested groups of objects. Each node has a local
+ * transformation relative to its parent, and its world transformation is the world transformation
+ * of its parent composed with its local transformation.
+ *
+ * The world transformations are cached, together with their inverses, which are computed by
+ * composing the cached inverses rather than by matrix inversion, see transformation. Changing the
+ * local transformation of a node marks the world transformations of the node and of its
+ * descendants as dirty, but a dirty world transformation is only recomputed when it is requested.
+ * Changing a node therefore takes O(subtree) steps, and requesting a world transformation takes
+ * O(depth) steps.
+ *
+ * The nodes are identified by the indices that add_node returns. Since a node's parent must exist
+ * when the node is added, every parent has a smaller index than its children.
+ *
+ * Requesting a world transformation updates the cache even though world is a const member
+ * function, so an instance must not be accessed from multiple threads without synchronization.
+ *
+ * @tparam T the component type
+ * @tparam S the number of dimensions
+ */
+template <typename T, std::size_t S> class transformation_hierarchy {
+public:
+  /**
+   * The parent of a root node.
+   */
+  static constexpr std::size_t no_parent = std::numeric_limits<std::size_t>::max();
+
+private:
+  std::vector<std::size_t> m_parents;
+  std::vector<std::vector<std::size_t>> m_children;
+  std::vector<transformation<T, S>> m_local;
+  // invariant: if a node is dirty, so are all of its descendants
+  mutable std::vector<transformation<T, S>> m_world;
+  mutable std::vector<bool> m_dirty;
+  mutable std::vector<std::size_t> m_path;
+
+public:
+  /**
+   * Creates a new empty hierarchy.
+   */
+  transformation_hierarchy() = default;
+
+  /**
+   * Returns the number of nodes.
+   */
+  std::size_t size() const { return m_parents.size(); }
+
+  /**
+   * Reserves memory for the given number of nodes.
+   *
+   * @param capacity the number of nodes
+   */
+  void reserve(const std::size_t capacity) {
+    m_parents.reserve(capacity);
+    m_children.reserve(capacity);
+    m_local.reserve(capacity);
+    m_world.reserve(capacity);
+    m_dirty.reserve(capacity);
+  }
+
+  /**
+   * Adds a node with the given local transformation.
+   *
+   * @param local the transformation of the node relative to its parent
+   * @param parent the index of the parent node, or no_parent to add a root node
+   * @return the index of the added node
+   */
+  std::size_t add_node(
+    const transformation<T, S>& local, const std::size_t parent = no_parent) {
+    assert(parent == no_parent || parent < size());
+    const auto index = size();
+    m_parents.push_back(parent);
+    m_children.emplace_back();
+    m_local.push_back(local);
+    m_world.emplace_back();
+    m_dirty.push_back(true);
+    if (parent != no_parent) {
+      m_children[parent].push_back(index);
+    }
+    return index;
+  }
+
+  /**
+   * Adds a node with the given local transformation matrix.
+   *
+   * @param local the transformation matrix of the node relative to its parent
+   * @param parent the index of the parent node, or no_parent to add a root node
+   * @return the index of the added node
+   */
+  std::size_t add_node(
+    const mat<T, S + 1, S + 1>& local, const std::size_t parent = no_parent) {
+    return add_node(transformation<T, S>(local), parent);
+  }
+
+  /**
+   * Returns the index of the parent of the given node, or no_parent if it is a root node.
+   *
+   * @param node the index of the node
+   */
+  std::size_t parent(const std::size_t node) const {
+    assert(node < size());
+    return m_parents[node];
+  }
+
+  /**
+   * Returns the indices of the children of the given node.
+   *
+   * @param node the index of the node
+   */
+  const std::vector<std::size_t>& children(const std::size_t node) const {
+    assert(node < size());
+    return m_children[node];
+  }
+
+  /**
+   * Returns the local transformation of the given node.
+   *
+   * @param node the index of the node
+   */
+  const transformation<T, S>& local(const std::size_t node) const {
+    assert(node < size());
+    return m_local[node];
+  }
+
+  /**
+   * Replaces the local transformation of the given node and marks the world transformations of the
+   * node and its descendants as dirty.
+   *
+   * @param node the index of the node
+   * @param local the new transformation of the node relative to its parent
+   */
+  void set_local(const std::size_t node, const transformation<T, S>& local) {
+    assert(node < size());
+    m_local[node] = local;
+    invalidate(node);
+  }
+
+  /**
+   * Replaces the local transformation matrix of the given node, see above.
+   *
+   * @param node the index of the node
+   * @param local the new transformation matrix of the node relative to its parent
+   */
+  void set_local(const std::size_t node, const mat<T, S + 1, S + 1>& local) {
+    set_local(node, transformation<T, S>(local));
+  }
+
+  /**
+   * Indicates whether the world transformation of the given node must be recomputed.
+   *
+   * @param node the index of the node
+   */
+  bool dirty(const std::size_t node) const {
+    assert(node < size());
+    return m_dirty[node];
+  }
+
+  /**
+   * Returns the world transformation of the given node, recomputing it and the world
+   * transformations of its dirty ancestors if necessary.
+   *
+   * @param node the index of the node
+   * @return the world transformation, whose inverse is the inverse world transformation
+   */
+  const transformation<T, S>& world(const std::size_t node) const {
+    assert(node < size());
+    if (!m_dirty[node]) {
+      return m_world[node];
+    }
+
+    // collect the dirty ancestors, the world transformation of the first clean one is valid
+    m_path.clear();
+    auto cur = node;
+    while (cur != no_parent && m_dirty[cur]) {
+      m_path.push_back(cur);
+      cur = m_parents[cur];
+    }
+
+    for (auto it = m_path.rbegin(); it != m_path.rend(); ++it) {
+      const auto parent = m_parents[*it];
+      m_world[*it] = parent == no_parent ? m_local[*it] : m_world[parent] * m_local[*it];
+      m_dirty[*it] = false;
+    }
+    return m_world[node];
+  }
+
+  /**
+   * Recomputes the world transformations of all dirty nodes.
+   */
+  void update() const {
+    // parents have smaller indices than their children
+    for (std::size_t node = 0u; node < size(); ++node) {
+      if (m_dirty[node]) {
+        const auto parent = m_parents[node];
+        m_world[node] = parent == no_parent ? m_local[node] : m_world[parent] * m_local[node];
+        m_dirty[node] = false;
+      }
+    }
+  }
+
+private:
+  void invalidate(const std::size_t node) {
+    // the descendants of a dirty node are already dirty
+    if (m_dirty[node]) {
+      return;
+    }
+
+    m_path.clear();
+    m_path.push_back(node);
+    while (!m_path.empty()) {
+      const auto cur = m_path.back();
+      m_path.pop_back();
+      m_dirty[cur] = true;
+      for (const auto child : m_children[cur]) {
+        if (!m_dirty[child]) {
+          m_path.push_back(child);
+        }
+      }
+    }
+  }
+};
+} // namespace vm
@@ -0,0 +1,96 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace vm {
+/**
+ * Counts the nodes of a bounding volume hierarchy that a query visits. Pass a pointer to an
+ * instance of this class to a query of aabb_tree or bvh to profile its traversal cost. The counters
+ * are incremented and never reset by the queries, so one instance can accumulate the cost of many
+ * queries.
+ */
+struct traversal_stats {
+  /**
+   * The number of nodes visited, including leaves.
+   */
+  std::size_t visited_nodes = 0u;
+
+  /**
+   * The number of leaves visited.
+   */
+  std::size_t visited_leaves = 0u;
+};
+
+namespace detail {
+/**
+ * A stack for tree traversals that keeps the first elements on the call stack, so that a query
+ * does not allocate unless the tree is very deep.
+ *
+ * @tparam E the element type, should be trivially default constructible
+ */
+template <typename E> class traversal_stack {
+private:
+  static constexpr std::size_t inline_capacity = 64u;
+
+  E m_inline[inline_capacity];
+  std::vector<E> m_overflow;
+  std::size_t m_size = 0u;
+
+public:
+  bool empty() const { return m_size == 0u; }
+
+  void push(const E& e) {
+    if (m_size < inline_capacity) {
+      m_inline[m_size] = e;
+    } else {
+      m_overflow.push_back(e);
+    }
+    ++m_size;
+  }
+
+  E pop() {
+    assert(!empty());
+    --m_size;
+    if (m_size < inline_capacity) {
+      return m_inline[m_size];
+    }
+    const auto e = m_overflow.back();
+    m_overflow.pop_back();
+    return e;
+  }
+};
+
+/**
+ * Adds the given counts to the given stats unless it is null.
+ */
+inline void add_traversal_stats(
+  traversal_stats* stats, const std::size_t visitedNodes, const std::size_t visitedLeaves) {
+  if (stats != nullptr) {
+    stats->visited_nodes += visitedNodes;
+    stats->visited_leaves += visitedLeaves;
+  }
+}
+} // namespace detail
+} // namespace vm
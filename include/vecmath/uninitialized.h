@@ -0,0 +1,97 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace vm {
+/**
+ * A tag type to select the constructors of vec, mat, quat and bbox that leave the components
+ * uninitialized. The default constructors of these types set the components to zero or to the
+ * identity, which is wasted work if the values are overwritten right away, for example when a
+ * large output buffer is allocated for a batch operation or filled from a file.
+ *
+ * The values of an object constructed this way are indeterminate until they are assigned.
+ */
+struct uninitialized_t {
+  explicit uninitialized_t() = default;
+};
+
+/**
+ * The tag to pass to the constructors that leave the components uninitialized.
+ */
+inline constexpr uninitialized_t uninitialized{};
+
+/**
+ * An allocator that constructs elements without arguments by passing uninitialized to their
+ * constructor if they have such a constructor, and by default initialization otherwise, which
+ * leaves scalars uninitialized. All other operations are forwarded to the given allocator. With
+ * this allocator, a std::vector of vectors or matrices can be created or resized without writing to
+ * the new elements. Note that this also applies to calling emplace_back without arguments.
+ *
+ * All of vec, mat, quat and bbox are trivially copyable, so the contents of such a vector can be
+ * filled with std::memcpy.
+ *
+ * @tparam T the element type
+ * @tparam A the allocator to forward to
+ */
+template <typename T, typename A = std::allocator<T>> class uninitialized_allocator : public A {
+private:
+  using traits = std::allocator_traits<A>;
+
+public:
+  template <typename U> struct rebind {
+    using other = uninitialized_allocator<U, typename traits::template rebind_alloc<U>>;
+  };
+
+  using A::A;
+
+  /**
+   * Constructs an element without initializing its values.
+   *
+   * @tparam U the element type
+   * @param p the storage for the element
+   */
+  template <typename U>
+  void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+    if constexpr (std::is_constructible_v<U, uninitialized_t>) {
+      ::new (static_cast<void*>(p)) U(uninitialized);
+    } else {
+      ::new (static_cast<void*>(p)) U;
+    }
+  }
+
+  /**
+   * Constructs an element from the given arguments using the given allocator.
+   *
+   * @tparam U the element type
+   * @tparam Args the argument types
+   * @param p the storage for the element
+   * @param args the arguments to pass to the constructor
+   */
+  template <typename U, typename... Args> void construct(U* p, Args&&... args) {
+    traits::construct(static_cast<A&>(*this), p, std::forward<Args>(args)...);
+  }
+};
+} // namespace vm
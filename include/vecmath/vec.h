@@ -23,12 +23,28 @@
 #include "constants.h"
 #include "constexpr_util.h"
 #include "scalar.h"
+#include "simd.h"
+#include "uninitialized.h"
 
 #include <cassert>
 #include <cstddef>
 #include <type_traits>
 
 namespace vm {
+template <typename T, std::size_t S> class vec;
+
+namespace detail {
+/*
+ * Overloads to check whether a type derives from any vec, see the component constructor of vec.
+ */
+template <typename T, std::size_t S> std::true_type derives_from_vec(const vec<T, S>*);
+std::false_type derives_from_vec(const void*);
+
+template <typename V>
+constexpr bool derives_from_vec_v =
+  decltype(derives_from_vec(static_cast<const V*>(nullptr)))::value;
+} // namespace detail
+
 template <typename T, std::size_t S> class vec {
 public:
   using float_type = vec<float, S>;
@@ -50,6 +66,11 @@ public:
   constexpr vec()
     : v{} {}
 
+  /**
+   * Creates a new vector without initializing its components.
+   */
+  explicit vec(uninitialized_t) {}
+
   // Copy and move constructors
   vec(const vec<T, S>& other) = default;
   vec(vec<T, S>&& other) noexcept = default;
@@ -78,12 +99,18 @@ public:
    * converted to the component type T using static_cast. The number of values must match the number
    * of components S.
    *
+   * The first value must not be a vector, so that a vector of a type derived from vec, such as
+   * vec3a, is passed to the copy and conversion constructors instead.
+   *
    * @tparam A1 the type of the first value
    * @tparam Args the types of the remaining values
    * @param a1 the first value
    * @param args the remaining values
    */
-  template <typename A1, typename... Args>
+  template <
+    typename A1,
+    typename... Args,
+    std::enable_if_t<!detail::derives_from_vec_v<A1>, int> = 0>
   constexpr explicit vec(const A1 a1, const Args... args)
     : v{static_cast<T>(a1), static_cast<T>(args)...} {
     static_assert(sizeof...(args) == S - 1u, "Wrong number of parameters");
@@ -381,6 +408,9 @@ public:
   }
 };
 
+static_assert(std::is_trivially_copyable_v<vec<float, 3>>);
+static_assert(std::is_trivially_copyable_v<vec<double, 3>>);
+
 /* ========== comparison operators ========== */
 
 /**
@@ -746,6 +776,14 @@ template <typename T, std::size_t S> constexpr vec<T, S> operator+(const vec<T,
  * @return the inverted copy
  */
 template <typename T, std::size_t S> constexpr vec<T, S> operator-(const vec<T, S>& vector) {
+  if constexpr (detail::simd_vec<T, S>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      vec<T, S> result;
+      detail::simd_vec<T, S>::neg(vector.v, result.v);
+      return result;
+    }
+  }
+
   vec<T, S> result;
   for (size_t i = 0; i < S; ++i) {
     result[i] = -vector[i];
@@ -764,6 +802,14 @@ template <typename T, std::size_t S> constexpr vec<T, S> operator-(const vec<T,
  */
 template <typename T, std::size_t S>
 constexpr vec<T, S> operator+(const vec<T, S>& lhs, const vec<T, S>& rhs) {
+  if constexpr (detail::simd_vec<T, S>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      vec<T, S> result;
+      detail::simd_vec<T, S>::add(lhs.v, rhs.v, result.v);
+      return result;
+    }
+  }
+
   vec<T, S> result;
   for (size_t i = 0; i < S; ++i) {
     result[i] = lhs[i] + rhs[i];
@@ -783,6 +829,14 @@ constexpr vec<T, S> operator+(const vec<T, S>& lhs, const vec<T, S>& rhs) {
  */
 template <typename T, std::size_t S>
 constexpr vec<T, S> operator-(const vec<T, S>& lhs, const vec<T, S>& rhs) {
+  if constexpr (detail::simd_vec<T, S>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      vec<T, S> result;
+      detail::simd_vec<T, S>::sub(lhs.v, rhs.v, result.v);
+      return result;
+    }
+  }
+
   vec<T, S> result;
   for (size_t i = 0; i < S; ++i) {
     result[i] = lhs[i] - rhs[i];
@@ -803,6 +857,14 @@ constexpr vec<T, S> operator-(const vec<T, S>& lhs, const vec<T, S>& rhs) {
  */
 template <typename T, std::size_t S>
 constexpr vec<T, S> operator*(const vec<T, S>& lhs, const vec<T, S>& rhs) {
+  if constexpr (detail::simd_vec<T, S>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      vec<T, S> result;
+      detail::simd_vec<T, S>::mul(lhs.v, rhs.v, result.v);
+      return result;
+    }
+  }
+
   vec<T, S> result;
   for (size_t i = 0; i < S; ++i) {
     result[i] = lhs[i] * rhs[i];
@@ -822,6 +884,14 @@ constexpr vec<T, S> operator*(const vec<T, S>& lhs, const vec<T, S>& rhs) {
  */
 template <typename T, std::size_t S>
 constexpr vec<T, S> operator*(const vec<T, S>& lhs, const T rhs) {
+  if constexpr (detail::simd_vec<T, S>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      vec<T, S> result;
+      detail::simd_vec<T, S>::mul(lhs.v, rhs, result.v);
+      return result;
+    }
+  }
+
   vec<T, S> result;
   for (size_t i = 0; i < S; ++i) {
     result[i] = lhs[i] * rhs;
@@ -856,6 +926,14 @@ constexpr vec<T, S> operator*(const T lhs, const vec<T, S>& rhs) {
  */
 template <typename T, std::size_t S>
 constexpr vec<T, S> operator/(const vec<T, S>& lhs, const vec<T, S>& rhs) {
+  if constexpr (detail::simd_vec<T, S>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      vec<T, S> result;
+      detail::simd_vec<T, S>::div(lhs.v, rhs.v, result.v);
+      return result;
+    }
+  }
+
   vec<T, S> result;
   for (size_t i = 0; i < S; ++i) {
     result[i] = lhs[i] / rhs[i];
@@ -875,6 +953,14 @@ constexpr vec<T, S> operator/(const vec<T, S>& lhs, const vec<T, S>& rhs) {
  */
 template <typename T, std::size_t S>
 constexpr vec<T, S> operator/(const vec<T, S>& lhs, const T rhs) {
+  if constexpr (detail::simd_vec<T, S>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      vec<T, S> result;
+      detail::simd_vec<T, S>::div(lhs.v, rhs, result.v);
+      return result;
+    }
+  }
+
   vec<T, S> result;
   for (size_t i = 0; i < S; ++i) {
     result[i] = lhs[i] / rhs;
@@ -894,6 +980,14 @@ constexpr vec<T, S> operator/(const vec<T, S>& lhs, const T rhs) {
  */
 template <typename T, std::size_t S>
 constexpr vec<T, S> operator/(const T lhs, const vec<T, S>& rhs) {
+  if constexpr (detail::simd_vec<T, S>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      vec<T, S> result;
+      detail::simd_vec<T, S>::div(lhs, rhs.v, result.v);
+      return result;
+    }
+  }
+
   vec<T, S> result;
   for (size_t i = 0; i < S; ++i) {
     result[i] = lhs / rhs[i];
@@ -917,6 +1011,14 @@ constexpr vec<T, S> operator/(const T lhs, const vec<T, S>& rhs) {
  */
 template <typename T, std::size_t S, typename... Rest>
 constexpr vec<T, S> min(const vec<T, S>& lhs, const vec<T, S>& rhs, Rest... rest) {
+  if constexpr (detail::simd_vec<T, S>::enabled && sizeof...(Rest) == 0u) {
+    if (!detail::is_constant_evaluated()) {
+      vec<T, S> result;
+      detail::simd_vec<T, S>::min(lhs.v, rhs.v, result.v);
+      return result;
+    }
+  }
+
   vec<T, S> result;
   for (size_t i = 0; i < S; ++i) {
     result[i] = min(lhs[i], rhs[i], rest[i]...);
@@ -938,6 +1040,14 @@ constexpr vec<T, S> min(const vec<T, S>& lhs, const vec<T, S>& rhs, Rest... rest
  */
 template <typename T, std::size_t S, typename... Rest>
 constexpr vec<T, S> max(const vec<T, S>& lhs, const vec<T, S>& rhs, Rest... rest) {
+  if constexpr (detail::simd_vec<T, S>::enabled && sizeof...(Rest) == 0u) {
+    if (!detail::is_constant_evaluated()) {
+      vec<T, S> result;
+      detail::simd_vec<T, S>::max(lhs.v, rhs.v, result.v);
+      return result;
+    }
+  }
+
   vec<T, S> result;
   for (size_t i = 0; i < S; ++i) {
     result[i] = max(lhs[i], rhs[i], rest[i]...);
@@ -1013,6 +1123,14 @@ constexpr vec<T, S> clamp(const vec<T, S>& v, const vec<T, S>& minVal, const vec
  * @return the absolute vector
  */
 template <typename T, std::size_t S> constexpr vec<T, S> abs(const vec<T, S>& v) {
+  if constexpr (detail::simd_vec<T, S>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      vec<T, S> result;
+      detail::simd_vec<T, S>::abs(v.v, result.v);
+      return result;
+    }
+  }
+
   vec<T, S> result;
   for (size_t i = 0; i < S; ++i) {
     result[i] = abs(v[i]);
@@ -1091,6 +1209,12 @@ constexpr vec<T, S> smoothstep(const vec<T, S>& e0, const vec<T, S>& e1, const v
  * @return the dot product of the given vectors
  */
 template <typename T, std::size_t S> constexpr T dot(const vec<T, S>& lhs, const vec<T, S>& rhs) {
+  if constexpr (detail::simd_vec<T, S>::enabled) {
+    if (!detail::is_constant_evaluated()) {
+      return detail::simd_vec<T, S>::dot(lhs.v, rhs.v);
+    }
+  }
+
   auto result = static_cast<T>(0.0);
   for (size_t i = 0; i < S; ++i) {
     result += (lhs[i] * rhs[i]);
@@ -1729,6 +1853,82 @@ constexpr auto average(I cur, I end, const G& get = G()) ->
   return result / count;
 }
 
+namespace detail {
+/**
+ * Calls f(p, first, last) for a SIMD pack p on the vectors [0, packed) and for a scalar pack on the
+ * remaining vectors [packed, count), and combines the results of the non-empty parts using
+ * combine. The components of the vectors are loaded as a flat array in blocks of S registers, so
+ * that each lane of each register always refers to the same component, see packed_component.
+ */
+template <typename T, std::size_t S, typename F, typename C>
+auto reduce_packed(const std::size_t count, const F& f, const C& combine) {
+  static_assert(sizeof(vec<T, S>) == S * sizeof(T), "vectors must be contiguous");
+  const auto packed = count - count % simd_pack<T>::width;
+  if (packed == 0u) {
+    return f(scalar_pack<T>(), std::size_t(0), count);
+  }
+  const auto result = f(simd_pack<T>(), std::size_t(0), packed);
+  return packed < count ? combine(result, f(scalar_pack<T>(), packed, count)) : result;
+}
+
+/**
+ * Returns the index of the component in lane l of register k of a block, see reduce_packed.
+ */
+template <typename P, std::size_t S>
+constexpr std::size_t packed_component(const std::size_t k, const std::size_t l) {
+  return (k * P::width + l) % S;
+}
+
+/**
+ * Sums the given vectors with one accumulator per SIMD lane and component, which also reduces the
+ * rounding error compared to a single accumulator per component.
+ */
+template <typename T, std::size_t S>
+vec<T, S> sum_packed(const vec<T, S>* vecs, const std::size_t count) {
+  const auto* data = reinterpret_cast<const T*>(vecs);
+  const auto sum = [=](auto p, const std::size_t first, const std::size_t last) {
+    using P = decltype(p);
+    typename P::type acc[S];
+    for (std::size_t k = 0u; k < S; ++k) {
+      acc[k] = P::set1(T(0));
+    }
+    for (auto i = first; i < last; i += P::width) {
+      for (std::size_t k = 0u; k < S; ++k) {
+        acc[k] = P::add(acc[k], P::load(data + i * S + k * P::width));
+      }
+    }
+
+    vec<T, S> result;
+    for (std::size_t k = 0u; k < S; ++k) {
+      T lanes[P::width];
+      P::store(lanes, acc[k]);
+      for (std::size_t l = 0u; l < P::width; ++l) {
+        result[packed_component<P, S>(k, l)] += lanes[l];
+      }
+    }
+    return result;
+  };
+  return reduce_packed<T, S>(
+    count, sum, [](const vec<T, S>& lhs, const vec<T, S>& rhs) { return lhs + rhs; });
+}
+
+/**
+ * Sums the given vectors by splitting them into two halves recursively and adding the sums of the
+ * halves. Blocks of up to 128 vectors are summed by sum_packed. The rounding error grows with the
+ * logarithm of the number of vectors rather than linearly.
+ */
+template <typename T, std::size_t S>
+vec<T, S> sum_pairwise(const vec<T, S>* vecs, const std::size_t count) {
+  constexpr auto blockSize = std::size_t(128u);
+  if (count <= blockSize) {
+    return sum_packed(vecs, count);
+  }
+  // the first half is a multiple of the block size so that all blocks but the last are full
+  const auto half = (count / blockSize + 1u) / 2u * blockSize;
+  return sum_pairwise(vecs, half) + sum_pairwise(vecs + half, count - half);
+}
+} // namespace detail
+
 /**
  * Computes the CCW angle between axis and vector in relation to the given up vector. All vectors
  * are expected to be normalized. The CCW angle is the angle by which the given axis must be rotated
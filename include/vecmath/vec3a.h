@@ -0,0 +1,157 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "vec.h"
+
+#include <type_traits>
+
+namespace vm {
+/**
+ * A vector with three components that is padded to the size of four components and aligned to that
+ * size. Arrays of these vectors can be processed with one aligned SIMD load or store per vector,
+ * which the batch operations in vec_ext.h and mat_ext.h do if SIMD kernels are enabled.
+ *
+ * Since this class derives from vec<T, 3>, it can be passed to every function that takes a
+ * vec<T, 3>, and it converts to a vec<T, 3> by copying the first three components. Functions that
+ * return vectors return vec<T, 3>, which converts back implicitly. The padding is always zero.
+ *
+ * @tparam T the component type
+ */
+template <typename T> class alignas(4 * sizeof(T)) vec3a : public vec<T, 3> {
+private:
+  T m_padding;
+
+public:
+  /**
+   * Creates a new vector with all components initialized to 0.
+   */
+  constexpr vec3a()
+    : vec<T, 3>()
+    , m_padding(T(0)) {}
+
+  /**
+   * Creates a new vector without initializing its components. The padding is set to zero.
+   */
+  explicit vec3a(uninitialized_t)
+    : vec<T, 3>(uninitialized)
+    , m_padding(T(0)) {}
+
+  /**
+   * Creates a new vector with the components of the given vector. This constructor is implicit so
+   * that the results of functions on vectors can be assigned to a vec3a.
+   *
+   * @param other the vector to copy
+   */
+  constexpr vec3a(const vec<T, 3>& other)
+    : vec<T, 3>(other)
+    , m_padding(T(0)) {}
+
+  /**
+   * Creates a new vector with the given components.
+   *
+   * @param x the X component
+   * @param y the Y component
+   * @param z the Z component
+   */
+  constexpr vec3a(const T x, const T y, const T z)
+    : vec<T, 3>(x, y, z)
+    , m_padding(T(0)) {}
+};
+
+static_assert(std::is_trivially_copyable_v<vec3a<float>>);
+static_assert(std::is_trivially_copyable_v<vec3a<double>>);
+
+/*
+ * The generic functions in scalar.h, such as min or abs, accept any argument type and are an exact
+ * match for vec3a, which is a better match than the vector overloads, which need a conversion to
+ * vec<T, 3>. The following overloads forward these functions to the vector overloads.
+ */
+namespace detail {
+template <typename T> constexpr const vec<T, 3>& as_vec(const vec3a<T>& v) {
+  return v;
+}
+} // namespace detail
+
+template <typename T> constexpr vec<T, 3> abs(const vec3a<T>& v) {
+  return abs(detail::as_vec(v));
+}
+
+template <typename T> constexpr vec<T, 3> ceil(const vec3a<T>& v) {
+  return ceil(detail::as_vec(v));
+}
+
+template <typename T> constexpr vec<T, 3> floor(const vec3a<T>& v) {
+  return floor(detail::as_vec(v));
+}
+
+template <typename T> constexpr vec<T, 3> fract(const vec3a<T>& v) {
+  return fract(detail::as_vec(v));
+}
+
+template <typename T> constexpr vec<T, 3> round(const vec3a<T>& v) {
+  return round(detail::as_vec(v));
+}
+
+template <typename T> constexpr vec<T, 3> trunc(const vec3a<T>& v) {
+  return trunc(detail::as_vec(v));
+}
+
+template <typename T> constexpr vec<T, 3> sign(const vec3a<T>& v) {
+  return sign(detail::as_vec(v));
+}
+
+template <typename T, typename... Rest>
+constexpr vec<T, 3> min(const vec3a<T>& lhs, const vec3a<T>& rhs, const Rest&... rest) {
+  return min(detail::as_vec(lhs), detail::as_vec(rhs), rest...);
+}
+
+template <typename T, typename... Rest>
+constexpr vec<T, 3> max(const vec3a<T>& lhs, const vec3a<T>& rhs, const Rest&... rest) {
+  return max(detail::as_vec(lhs), detail::as_vec(rhs), rest...);
+}
+
+template <typename T> constexpr vec<T, 3> mod(const vec3a<T>& v, const vec3a<T>& f) {
+  return mod(detail::as_vec(v), detail::as_vec(f));
+}
+
+template <typename T> constexpr vec<T, 3> snap(const vec3a<T>& v, const vec3a<T>& m) {
+  return snap(detail::as_vec(v), detail::as_vec(m));
+}
+
+template <typename T> constexpr vec<T, 3> step(const vec3a<T>& e, const vec3a<T>& v) {
+  return step(detail::as_vec(e), detail::as_vec(v));
+}
+
+template <typename T>
+constexpr vec<T, 3> mix(const vec3a<T>& lhs, const vec3a<T>& rhs, const vec3a<T>& f) {
+  return mix(detail::as_vec(lhs), detail::as_vec(rhs), detail::as_vec(f));
+}
+
+template <typename T>
+constexpr vec<T, 3> clamp(const vec3a<T>& v, const vec3a<T>& minVal, const vec3a<T>& maxVal) {
+  return clamp(detail::as_vec(v), detail::as_vec(minVal), detail::as_vec(maxVal));
+}
+
+template <typename T> constexpr bool is_nan(const vec3a<T>& v) {
+  return is_nan(detail::as_vec(v));
+}
+} // namespace vm
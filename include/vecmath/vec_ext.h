@@ -20,12 +20,201 @@
 
 #pragma once
 
+#include "simd.h"
 #include "vec.h"
+#include "vec3a.h"
 
 #include <array>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
 #include <vector>
 
 namespace vm {
+namespace detail {
+template <typename P, typename T, std::size_t S>
+void aos_load(const vec<T, S>* v, typename P::type (&out)[S]) {
+  for (std::size_t c = 0; c < S; ++c) {
+    T lanes[P::width];
+    for (std::size_t l = 0; l < P::width; ++l) {
+      lanes[l] = v[l][c];
+    }
+    out[c] = P::load(lanes);
+  }
+}
+
+template <typename P, typename T, std::size_t S>
+void aos_store(vec<T, S>* v, const typename P::type (&in)[S]) {
+  for (std::size_t c = 0; c < S; ++c) {
+    T lanes[P::width];
+    P::store(lanes, in[c]);
+    for (std::size_t l = 0; l < P::width; ++l) {
+      v[l][c] = lanes[l];
+    }
+  }
+}
+
+/*
+ * Padded vectors use one aligned load or store per vector if SIMD kernels are enabled, see
+ * simd_padded_vec3. These overloads are chosen over the ones above, which would use the stride of
+ * vec<T, 3>.
+ */
+template <typename P, typename T>
+void aos_load(const vec3a<T>* v, typename P::type (&out)[3]) {
+  if constexpr (std::is_same_v<P, simd_pack<T>> && simd_padded_vec3<T>::enabled) {
+    simd_padded_vec3<T>::load(v->v, out);
+  } else {
+    for (std::size_t c = 0; c < 3; ++c) {
+      T lanes[P::width];
+      for (std::size_t l = 0; l < P::width; ++l) {
+        lanes[l] = v[l][c];
+      }
+      out[c] = P::load(lanes);
+    }
+  }
+}
+
+template <typename P, typename T>
+void aos_store(vec3a<T>* v, const typename P::type (&in)[3]) {
+  if constexpr (std::is_same_v<P, simd_pack<T>> && simd_padded_vec3<T>::enabled) {
+    simd_padded_vec3<T>::store(v->v, in);
+  } else {
+    for (std::size_t c = 0; c < 3; ++c) {
+      T lanes[P::width];
+      P::store(lanes, in[c]);
+      for (std::size_t l = 0; l < P::width; ++l) {
+        v[l][c] = lanes[l];
+      }
+    }
+  }
+}
+
+/**
+ * Applies the given kernel to each vector in the range [cur, end) and writes the results to the
+ * given output iterator. The kernel is called as f(p, in, out) where p is a pack, in holds the S
+ * components and out receives the SR components of the result. If both iterators are pointers,
+ * the kernel runs on SIMD packs and never allocates, otherwise it is called with a scalar_pack for
+ * each vector. The output may be the input range.
+ *
+ * @return the output iterator past the last written vector
+ */
+template <typename T, std::size_t S, std::size_t SR, typename I, typename O, typename F>
+O aos_transform(I cur, I end, O out, const F& f) {
+  if constexpr (std::is_pointer_v<I> && std::is_pointer_v<O>) {
+    const auto count = static_cast<std::size_t>(end - cur);
+    for_each_pack<T>(count, [=](auto p, const std::size_t first, const std::size_t last) {
+      using P = decltype(p);
+      for (auto i = first; i < last; i += P::width) {
+        typename P::type in[S], result[SR];
+        aos_load<P>(cur + i, in);
+        f(p, in, result);
+        aos_store<P>(out + i, result);
+      }
+    });
+    return out + count;
+  } else {
+    using P = scalar_pack<T>;
+    for (; cur != end; ++cur, ++out) {
+      const vec<T, S>& v = *cur;
+      typename P::type in[S], result[SR];
+      for (std::size_t c = 0; c < S; ++c) {
+        in[c] = v[c];
+      }
+      f(P(), in, result);
+      vec<T, SR> r;
+      for (std::size_t c = 0; c < SR; ++c) {
+        r[c] = result[c];
+      }
+      *out = r;
+    }
+    return out;
+  }
+}
+} // namespace detail
+
+/**
+ * Adds the given vector to each of the vectors in the range [cur, end) and writes the sums to the
+ * given output iterator, which may be cur. Runs as a SIMD loop if the iterators are pointers.
+ *
+ * @tparam I the input iterator type
+ * @tparam O the output iterator type
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param cur the start of the range of vectors
+ * @param end the end of the range of vectors
+ * @param rhs the right hand vector
+ * @param out the output iterator
+ * @return the output iterator past the last sum
+ */
+template <typename I, typename O, typename T, std::size_t S>
+O add(I cur, I end, const vec<T, S>& rhs, O out) {
+  return detail::aos_transform<T, S, S>(cur, end, out, [=](auto p, const auto& in, auto& result) {
+    using P = decltype(p);
+    for (std::size_t c = 0; c < S; ++c) {
+      result[c] = P::add(in[c], P::set1(rhs[c]));
+    }
+  });
+}
+
+/**
+ * Adds the given vector to each of the vectors in the given vector. The result may be lhs, and it
+ * is not reallocated if its capacity suffices.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the vector of vectors
+ * @param rhs the right hand vector
+ * @param result receives the sums, it is resized to the size of lhs
+ */
+template <typename T, std::size_t S>
+void add(
+  const std::vector<vec<T, S>>& lhs, const vec<T, S>& rhs, std::vector<vec<T, S>>& result) {
+  result.resize(lhs.size());
+  add(lhs.data(), lhs.data() + lhs.size(), rhs, result.data());
+}
+
+/**
+ * Multiplies each of the vectors in the range [cur, end) by the given scalar and writes the
+ * products to the given output iterator, which may be cur. Runs as a SIMD loop if the iterators are
+ * pointers.
+ *
+ * @tparam I the input iterator type
+ * @tparam O the output iterator type
+ * @tparam T the component type
+ * @param cur the start of the range of vectors
+ * @param end the end of the range of vectors
+ * @param rhs the scalar factor
+ * @param out the output iterator
+ * @return the output iterator past the last product
+ */
+template <typename I, typename O, typename T>
+O multiply(I cur, I end, const T rhs, O out) {
+  using V = typename std::iterator_traits<I>::value_type;
+  constexpr auto S = V::size;
+  return detail::aos_transform<T, S, S>(cur, end, out, [=](auto p, const auto& in, auto& result) {
+    using P = decltype(p);
+    for (std::size_t c = 0; c < S; ++c) {
+      result[c] = P::mul(in[c], P::set1(rhs));
+    }
+  });
+}
+
+/**
+ * Multiplies each of the vectors in the given vector by the given scalar. The result may be lhs,
+ * and it is not reallocated if its capacity suffices.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the vector of vectors
+ * @param rhs the scalar factor
+ * @param result receives the products, it is resized to the size of lhs
+ */
+template <typename T, std::size_t S>
+void multiply(const std::vector<vec<T, S>>& lhs, const T rhs, std::vector<vec<T, S>>& result) {
+  result.resize(lhs.size());
+  multiply(lhs.data(), lhs.data() + lhs.size(), rhs, result.data());
+}
+
 /**
  * Adds the given vector to each of the vectors in the given vector.
  *
@@ -39,10 +228,7 @@ namespace vm {
 template <typename T, std::size_t S>
 std::vector<vec<T, S>> operator+(const std::vector<vec<T, S>>& lhs, const vec<T, S>& rhs) {
   std::vector<vec<T, S>> result;
-  result.reserve(lhs.size());
-  for (const auto& vec : lhs) {
-    result.push_back(vec + rhs);
-  }
+  add(lhs, rhs, result);
   return result;
 }
 
@@ -112,10 +298,7 @@ constexpr std::array<vec<T, S>, N> operator+(
 template <typename T, std::size_t S>
 std::vector<vec<T, S>> operator*(const std::vector<vec<T, S>>& lhs, const T rhs) {
   std::vector<vec<T, S>> result;
-  result.reserve(lhs.size());
-  for (const auto& vec : lhs) {
-    result.push_back(vec * rhs);
-  }
+  multiply(lhs, rhs, result);
   return result;
 }
 
@@ -0,0 +1,730 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "mat.h"
+#include "scalar.h"
+#include "simd.h"
+#include "simd_dispatch.h"
+#include "vec.h"
+
+#include <cassert>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace vm {
+/**
+ * A sequence of vectors that is stored as a structure of arrays: The i-th components of all vectors
+ * are stored in a separate contiguous array, so the batch operations below can process several
+ * vectors with one SIMD instruction without having to shuffle their components first.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ */
+template <typename T, std::size_t S> class vec_soa {
+public:
+  using component_type = T;
+  static constexpr std::size_t components = S;
+
+private:
+  std::vector<T> m_components[S];
+
+public:
+  /**
+   * Creates a new empty instance.
+   */
+  vec_soa() = default;
+
+  /**
+   * Creates a new instance with the given number of vectors, all of which are initialized to 0.
+   *
+   * @param size the number of vectors
+   */
+  explicit vec_soa(const std::size_t size) {
+    for (std::size_t i = 0; i < S; ++i) {
+      m_components[i].resize(size);
+    }
+  }
+
+  /**
+   * Creates a new instance containing the vectors in the given range. For each element of the
+   * range, the given getter is called to obtain the vector to store.
+   *
+   * @tparam I the range iterator type
+   * @tparam G the type of the getter
+   * @param cur the start of the range
+   * @param end the end of the range
+   * @param get the getter
+   */
+  template <typename I, typename G = identity> vec_soa(I cur, I end, const G& get = G()) {
+    while (cur != end) {
+      push_back(get(*cur));
+      ++cur;
+    }
+  }
+
+  /**
+   * Creates a new instance containing the given vectors.
+   *
+   * @param vecs the vectors to store
+   */
+  explicit vec_soa(const std::vector<vec<T, S>>& vecs) {
+    reserve(vecs.size());
+    for (const auto& v : vecs) {
+      push_back(v);
+    }
+  }
+
+  /**
+   * Returns the number of vectors.
+   */
+  std::size_t size() const { return m_components[0].size(); }
+
+  /**
+   * Indicates whether this instance contains no vectors.
+   */
+  bool empty() const { return m_components[0].empty(); }
+
+  /**
+   * Reserves memory for the given number of vectors.
+   *
+   * @param capacity the number of vectors
+   */
+  void reserve(const std::size_t capacity) {
+    for (std::size_t i = 0; i < S; ++i) {
+      m_components[i].reserve(capacity);
+    }
+  }
+
+  /**
+   * Changes the number of vectors. Added vectors are initialized to 0.
+   *
+   * @param size the number of vectors
+   */
+  void resize(const std::size_t size) {
+    for (std::size_t i = 0; i < S; ++i) {
+      m_components[i].resize(size);
+    }
+  }
+
+  /**
+   * Removes all vectors.
+   */
+  void clear() {
+    for (std::size_t i = 0; i < S; ++i) {
+      m_components[i].clear();
+    }
+  }
+
+  /**
+   * Appends the given vector.
+   *
+   * @param v the vector to append
+   */
+  void push_back(const vec<T, S>& v) {
+    for (std::size_t i = 0; i < S; ++i) {
+      m_components[i].push_back(v[i]);
+    }
+  }
+
+  /**
+   * Returns the vector at the given index.
+   *
+   * @param index the index of the vector to return, which must be less than size()
+   * @return the vector at the given index
+   */
+  vec<T, S> operator[](const std::size_t index) const {
+    assert(index < size());
+    vec<T, S> result;
+    for (std::size_t i = 0; i < S; ++i) {
+      result[i] = m_components[i][index];
+    }
+    return result;
+  }
+
+  /**
+   * Replaces the vector at the given index.
+   *
+   * @param index the index of the vector to replace, which must be less than size()
+   * @param v the new vector
+   */
+  void set(const std::size_t index, const vec<T, S>& v) {
+    assert(index < size());
+    for (std::size_t i = 0; i < S; ++i) {
+      m_components[i][index] = v[i];
+    }
+  }
+
+  /**
+   * Returns a pointer to the array that contains the given component of every vector.
+   *
+   * @param component the index of the component, which must be less than S
+   * @return a pointer to the first element of the array
+   */
+  T* data(const std::size_t component) {
+    assert(component < S);
+    return m_components[component].data();
+  }
+
+  /**
+   * Returns a pointer to the array that contains the given component of every vector.
+   *
+   * @param component the index of the component, which must be less than S
+   * @return a pointer to the first element of the array
+   */
+  const T* data(const std::size_t component) const {
+    assert(component < S);
+    return m_components[component].data();
+  }
+
+  /**
+   * Returns the stored vectors as an array of vectors.
+   */
+  std::vector<vec<T, S>> to_vector() const {
+    std::vector<vec<T, S>> result;
+    result.reserve(size());
+    for (std::size_t i = 0; i < size(); ++i) {
+      result.push_back((*this)[i]);
+    }
+    return result;
+  }
+
+  /**
+   * Checks whether the given instances contain the same vectors.
+   *
+   * @param lhs the first instance
+   * @param rhs the second instance
+   * @return true if the given instances are equal and false otherwise
+   */
+  friend bool operator==(const vec_soa& lhs, const vec_soa& rhs) {
+    for (std::size_t i = 0; i < S; ++i) {
+      if (lhs.m_components[i] != rhs.m_components[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Checks whether the given instances do not contain the same vectors.
+   *
+   * @param lhs the first instance
+   * @param rhs the second instance
+   * @return false if the given instances are equal and true otherwise
+   */
+  friend bool operator!=(const vec_soa& lhs, const vec_soa& rhs) { return !(lhs == rhs); }
+};
+
+namespace detail {
+/*
+ * The batch operations copy the component array pointers of their operands to local arrays and
+ * capture these by value, see for_each_pack.
+ */
+template <typename T, std::size_t S> std::array<const T*, S> soa_data(const vec_soa<T, S>& v) {
+  std::array<const T*, S> result;
+  for (std::size_t c = 0; c < S; ++c) {
+    result[c] = v.data(c);
+  }
+  return result;
+}
+
+template <typename T, std::size_t S> std::array<T*, S> soa_data(vec_soa<T, S>& v) {
+  std::array<T*, S> result;
+  for (std::size_t c = 0; c < S; ++c) {
+    result[c] = v.data(c);
+  }
+  return result;
+}
+
+/*
+ * Copies the elements of the given matrix to an array of columns for the batch kernels, see
+ * dispatch_simd.
+ */
+template <typename T, std::size_t R, std::size_t C>
+void mat_columns(const mat<T, R, C>& m, T (&out)[C][R]) {
+  for (std::size_t c = 0; c < C; ++c) {
+    for (std::size_t r = 0; r < R; ++r) {
+      out[c][r] = m[c][r];
+    }
+  }
+}
+
+template <typename P, typename T, std::size_t S>
+void soa_load(
+  const std::array<const T*, S>& v, const std::size_t i, typename P::type (&out)[S]) {
+  for (std::size_t c = 0; c < S; ++c) {
+    out[c] = P::load(v[c] + i);
+  }
+}
+
+template <typename P, typename T, std::size_t S>
+void soa_store(const std::array<T*, S>& v, const std::size_t i, const typename P::type (&in)[S]) {
+  for (std::size_t c = 0; c < S; ++c) {
+    P::store(v[c] + i, in[c]);
+  }
+}
+
+template <typename P, typename T, std::size_t S>
+typename P::type soa_dot(const typename P::type (&lhs)[S], const typename P::type (&rhs)[S]) {
+  auto result = P::set1(T(0));
+  for (std::size_t c = 0; c < S; ++c) {
+    result = P::add(result, P::mul(lhs[c], rhs[c]));
+  }
+  return result;
+}
+} // namespace detail
+
+/**
+ * Computes the dot product of each pair of vectors with the same index in the given sequences.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the first sequence of vectors
+ * @param rhs the second sequence of vectors, which must have the same size as lhs
+ * @param result receives the dot products, it is resized to the size of lhs
+ */
+template <typename T, std::size_t S>
+void dot(const vec_soa<T, S>& lhs, const vec_soa<T, S>& rhs, std::vector<T>& result) {
+  assert(lhs.size() == rhs.size());
+  result.resize(lhs.size());
+  const auto lhsData = detail::soa_data(lhs);
+  const auto rhsData = detail::soa_data(rhs);
+  detail::dispatch_simd([&](auto k) {
+    decltype(k)::dot(lhsData, rhsData, result.data(), lhs.size());
+  });
+}
+
+/**
+ * Computes the dot product of each pair of vectors with the same index in the given sequences.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the first sequence of vectors
+ * @param rhs the second sequence of vectors, which must have the same size as lhs
+ * @return the dot products
+ */
+template <typename T, std::size_t S>
+std::vector<T> dot(const vec_soa<T, S>& lhs, const vec_soa<T, S>& rhs) {
+  std::vector<T> result;
+  dot(lhs, rhs, result);
+  return result;
+}
+
+/**
+ * Computes the dot product of each vector in the given sequence and the given vector.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the sequence of vectors
+ * @param rhs the vector
+ * @param result receives the dot products, it is resized to the size of lhs
+ */
+template <typename T, std::size_t S>
+void dot(const vec_soa<T, S>& lhs, const vec<T, S>& rhs, std::vector<T>& result) {
+  result.resize(lhs.size());
+  const auto lhsData = detail::soa_data(lhs);
+  detail::dispatch_simd([&](auto k) {
+    decltype(k)::dot(lhsData, rhs.v, result.data(), lhs.size());
+  });
+}
+
+/**
+ * Computes the dot product of each vector in the given sequence and the given vector.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the sequence of vectors
+ * @param rhs the vector
+ * @return the dot products
+ */
+template <typename T, std::size_t S>
+std::vector<T> dot(const vec_soa<T, S>& lhs, const vec<T, S>& rhs) {
+  std::vector<T> result;
+  dot(lhs, rhs, result);
+  return result;
+}
+
+/**
+ * Computes the cross product of each pair of vectors with the same index in the given sequences.
+ * The result may be one of the operands.
+ *
+ * @tparam T the component type
+ * @param lhs the first sequence of vectors
+ * @param rhs the second sequence of vectors, which must have the same size as lhs
+ * @param result receives the cross products, it is resized to the size of lhs
+ */
+template <typename T>
+void cross(const vec_soa<T, 3>& lhs, const vec_soa<T, 3>& rhs, vec_soa<T, 3>& result) {
+  assert(lhs.size() == rhs.size());
+  result.resize(lhs.size());
+  const auto lhsData = detail::soa_data(lhs);
+  const auto rhsData = detail::soa_data(rhs);
+  const auto resultData = detail::soa_data(result);
+  detail::for_each_pack<T>(
+    lhs.size(), [=](auto p, const std::size_t first, const std::size_t last) {
+      using P = decltype(p);
+      for (auto i = first; i < last; i += P::width) {
+        typename P::type l[3], r[3];
+        detail::soa_load<P>(lhsData, i, l);
+        detail::soa_load<P>(rhsData, i, r);
+        const typename P::type c[3] = {
+          P::sub(P::mul(l[1], r[2]), P::mul(l[2], r[1])),
+          P::sub(P::mul(l[2], r[0]), P::mul(l[0], r[2])),
+          P::sub(P::mul(l[0], r[1]), P::mul(l[1], r[0]))};
+        detail::soa_store<P>(resultData, i, c);
+      }
+    });
+}
+
+/**
+ * Computes the cross product of each pair of vectors with the same index in the given sequences.
+ *
+ * @tparam T the component type
+ * @param lhs the first sequence of vectors
+ * @param rhs the second sequence of vectors, which must have the same size as lhs
+ * @return the cross products
+ */
+template <typename T> vec_soa<T, 3> cross(const vec_soa<T, 3>& lhs, const vec_soa<T, 3>& rhs) {
+  vec_soa<T, 3> result;
+  cross(lhs, rhs, result);
+  return result;
+}
+
+/**
+ * Computes the squared length of each vector in the given sequence.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param vecs the sequence of vectors
+ * @param result receives the squared lengths, it is resized to the size of vecs
+ */
+template <typename T, std::size_t S>
+void squared_length(const vec_soa<T, S>& vecs, std::vector<T>& result) {
+  dot(vecs, vecs, result);
+}
+
+/**
+ * Computes the squared length of each vector in the given sequence.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param vecs the sequence of vectors
+ * @return the squared lengths
+ */
+template <typename T, std::size_t S> std::vector<T> squared_length(const vec_soa<T, S>& vecs) {
+  return dot(vecs, vecs);
+}
+
+/**
+ * Normalizes each vector in the given sequence. The result may be the given sequence.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param vecs the sequence of vectors
+ * @param result receives the normalized vectors, it is resized to the size of vecs
+ */
+template <typename T, std::size_t S>
+void normalize(const vec_soa<T, S>& vecs, vec_soa<T, S>& result) {
+  result.resize(vecs.size());
+  const auto vecsData = detail::soa_data(vecs);
+  const auto resultData = detail::soa_data(result);
+  detail::dispatch_simd([&](auto k) {
+    decltype(k)::normalize(vecsData, resultData, vecs.size());
+  });
+}
+
+/**
+ * Normalizes each vector in the given sequence.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param vecs the sequence of vectors
+ * @return the normalized vectors
+ */
+template <typename T, std::size_t S> vec_soa<T, S> normalize(const vec_soa<T, S>& vecs) {
+  vec_soa<T, S> result;
+  normalize(vecs, result);
+  return result;
+}
+
+/**
+ * Computes the squared distance of each pair of vectors with the same index in the given
+ * sequences.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the first sequence of vectors
+ * @param rhs the second sequence of vectors, which must have the same size as lhs
+ * @param result receives the squared distances, it is resized to the size of lhs
+ */
+template <typename T, std::size_t S>
+void squared_distance(const vec_soa<T, S>& lhs, const vec_soa<T, S>& rhs, std::vector<T>& result) {
+  assert(lhs.size() == rhs.size());
+  result.resize(lhs.size());
+  const auto lhsData = detail::soa_data(lhs);
+  const auto rhsData = detail::soa_data(rhs);
+  auto* resultData = result.data();
+  detail::for_each_pack<T>(
+    lhs.size(), [=](auto p, const std::size_t first, const std::size_t last) {
+      using P = decltype(p);
+      for (auto i = first; i < last; i += P::width) {
+        typename P::type l[S], r[S];
+        detail::soa_load<P>(lhsData, i, l);
+        detail::soa_load<P>(rhsData, i, r);
+        for (std::size_t c = 0; c < S; ++c) {
+          l[c] = P::sub(l[c], r[c]);
+        }
+        P::store(resultData + i, detail::soa_dot<P, T>(l, l));
+      }
+    });
+}
+
+/**
+ * Computes the squared distance of each pair of vectors with the same index in the given
+ * sequences.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the first sequence of vectors
+ * @param rhs the second sequence of vectors, which must have the same size as lhs
+ * @return the squared distances
+ */
+template <typename T, std::size_t S>
+std::vector<T> squared_distance(const vec_soa<T, S>& lhs, const vec_soa<T, S>& rhs) {
+  std::vector<T> result;
+  squared_distance(lhs, rhs, result);
+  return result;
+}
+
+/**
+ * Computes the squared distance of each vector in the given sequence to the given vector.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the sequence of vectors
+ * @param rhs the vector
+ * @param result receives the squared distances, it is resized to the size of lhs
+ */
+template <typename T, std::size_t S>
+void squared_distance(const vec_soa<T, S>& lhs, const vec<T, S>& rhs, std::vector<T>& result) {
+  result.resize(lhs.size());
+  const auto lhsData = detail::soa_data(lhs);
+  auto* resultData = result.data();
+  detail::for_each_pack<T>(
+    lhs.size(), [=](auto p, const std::size_t first, const std::size_t last) {
+      using P = decltype(p);
+      for (auto i = first; i < last; i += P::width) {
+        typename P::type l[S];
+        detail::soa_load<P>(lhsData, i, l);
+        for (std::size_t c = 0; c < S; ++c) {
+          l[c] = P::sub(l[c], P::set1(rhs[c]));
+        }
+        P::store(resultData + i, detail::soa_dot<P, T>(l, l));
+      }
+    });
+}
+
+/**
+ * Computes the squared distance of each vector in the given sequence to the given vector.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the sequence of vectors
+ * @param rhs the vector
+ * @return the squared distances
+ */
+template <typename T, std::size_t S>
+std::vector<T> squared_distance(const vec_soa<T, S>& lhs, const vec<T, S>& rhs) {
+  std::vector<T> result;
+  squared_distance(lhs, rhs, result);
+  return result;
+}
+
+namespace detail {
+template <typename T, std::size_t S, typename Op>
+void soa_component_wise(
+  const vec_soa<T, S>& lhs, const vec_soa<T, S>& rhs, vec_soa<T, S>& result, const Op& op) {
+  assert(lhs.size() == rhs.size());
+  result.resize(lhs.size());
+  for (std::size_t c = 0; c < S; ++c) {
+    const auto* l = lhs.data(c);
+    const auto* r = rhs.data(c);
+    auto* out = result.data(c);
+    for_each_pack<T>(lhs.size(), [=](auto p, const std::size_t first, const std::size_t last) {
+      using P = decltype(p);
+      for (auto i = first; i < last; i += P::width) {
+        P::store(out + i, op(p, P::load(l + i), P::load(r + i)));
+      }
+    });
+  }
+}
+} // namespace detail
+
+/**
+ * Computes the component wise minimum of each pair of vectors with the same index in the given
+ * sequences. The result may be one of the operands.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the first sequence of vectors
+ * @param rhs the second sequence of vectors, which must have the same size as lhs
+ * @param result receives the component wise minima, it is resized to the size of lhs
+ */
+template <typename T, std::size_t S>
+void min(const vec_soa<T, S>& lhs, const vec_soa<T, S>& rhs, vec_soa<T, S>& result) {
+  detail::soa_component_wise(lhs, rhs, result, [](auto p, const auto l, const auto r) {
+    return decltype(p)::min(l, r);
+  });
+}
+
+/**
+ * Computes the component wise minimum of each pair of vectors with the same index in the given
+ * sequences.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the first sequence of vectors
+ * @param rhs the second sequence of vectors, which must have the same size as lhs
+ * @return the component wise minima
+ */
+template <typename T, std::size_t S>
+vec_soa<T, S> min(const vec_soa<T, S>& lhs, const vec_soa<T, S>& rhs) {
+  vec_soa<T, S> result;
+  min(lhs, rhs, result);
+  return result;
+}
+
+/**
+ * Computes the component wise maximum of each pair of vectors with the same index in the given
+ * sequences. The result may be one of the operands.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the first sequence of vectors
+ * @param rhs the second sequence of vectors, which must have the same size as lhs
+ * @param result receives the component wise maxima, it is resized to the size of lhs
+ */
+template <typename T, std::size_t S>
+void max(const vec_soa<T, S>& lhs, const vec_soa<T, S>& rhs, vec_soa<T, S>& result) {
+  detail::soa_component_wise(lhs, rhs, result, [](auto p, const auto l, const auto r) {
+    return decltype(p)::max(l, r);
+  });
+}
+
+/**
+ * Computes the component wise maximum of each pair of vectors with the same index in the given
+ * sequences.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @param lhs the first sequence of vectors
+ * @param rhs the second sequence of vectors, which must have the same size as lhs
+ * @return the component wise maxima
+ */
+template <typename T, std::size_t S>
+vec_soa<T, S> max(const vec_soa<T, S>& lhs, const vec_soa<T, S>& rhs) {
+  vec_soa<T, S> result;
+  max(lhs, rhs, result);
+  return result;
+}
+
+/**
+ * Multiplies each vector in the given sequence by the given matrix. The result may be the given
+ * sequence if R equals C.
+ *
+ * @tparam T the element type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @param lhs the matrix
+ * @param rhs the sequence of vectors
+ * @param result receives the products, it is resized to the size of rhs
+ */
+template <typename T, std::size_t R, std::size_t C>
+void multiply(const mat<T, R, C>& lhs, const vec_soa<T, C>& rhs, vec_soa<T, R>& result) {
+  result.resize(rhs.size());
+  T columns[C][R];
+  detail::mat_columns(lhs, columns);
+  const auto rhsData = detail::soa_data(rhs);
+  const auto resultData = detail::soa_data(result);
+  detail::dispatch_simd([&](auto k) {
+    decltype(k)::multiply(columns, rhsData, resultData, rhs.size());
+  });
+}
+
+/**
+ * Multiplies each point in the given sequence by the given matrix. Each point is converted to
+ * homogeneous coordinates before the multiplication, and the product is converted back to cartesian
+ * coordinates. The result may be the given sequence.
+ *
+ * @tparam T the element type
+ * @tparam S the number of components of the points
+ * @param lhs the matrix
+ * @param rhs the sequence of points
+ * @param result receives the transformed points, it is resized to the size of rhs
+ */
+template <typename T, std::size_t S>
+void multiply(const mat<T, S + 1, S + 1>& lhs, const vec_soa<T, S>& rhs, vec_soa<T, S>& result) {
+  result.resize(rhs.size());
+  T columns[S + 1][S + 1];
+  detail::mat_columns(lhs, columns);
+  const auto rhsData = detail::soa_data(rhs);
+  const auto resultData = detail::soa_data(result);
+  detail::dispatch_simd([&](auto k) {
+    decltype(k)::multiply_points(columns, rhsData, resultData, rhs.size());
+  });
+}
+
+/**
+ * Multiplies each vector in the given sequence by the given matrix.
+ *
+ * @tparam T the element type
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ * @param lhs the matrix
+ * @param rhs the sequence of vectors
+ * @return the products of the given matrix and the given vectors
+ */
+template <typename T, std::size_t R, std::size_t C>
+vec_soa<T, R> operator*(const mat<T, R, C>& lhs, const vec_soa<T, C>& rhs) {
+  vec_soa<T, R> result;
+  multiply(lhs, rhs, result);
+  return result;
+}
+
+/**
+ * Multiplies each point in the given sequence by the given matrix. Each point is converted to
+ * homogeneous coordinates before the multiplication, and the product is converted back to cartesian
+ * coordinates.
+ *
+ * @tparam T the element type
+ * @tparam S the number of components of the points
+ * @param lhs the matrix
+ * @param rhs the sequence of points
+ * @return the transformed points
+ */
+template <typename T, std::size_t S>
+vec_soa<T, S> operator*(const mat<T, S + 1, S + 1>& lhs, const vec_soa<T, S>& rhs) {
+  vec_soa<T, S> result;
+  multiply(lhs, rhs, result);
+  return result;
+}
+} // namespace vm
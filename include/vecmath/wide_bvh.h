@@ -0,0 +1,435 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "bbox.h"
+#include "bvh.h"
+#include "forward.h"
+#include "intersection.h"
+#include "ray.h"
+#include "ray_query.h"
+#include "scalar.h"
+#include "simd.h"
+#include "traversal.h"
+#include "vec.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+namespace vm {
+/**
+ * A bounding volume hierarchy whose inner nodes have up to W children, built by collapsing a
+ * binary bvh. The bounds of the children of a node are stored as structure of arrays, so that a ray
+ * can be tested against all children at once with SIMD instructions, see detail::simd_pack. This
+ * is most effective if W is a multiple of the SIMD width for T, e.g. W = 4 for SSE2 or W = 8 for
+ * AVX with float. Otherwise, the children are tested one by one.
+ *
+ * Each node also stores an order of its children for each octant of ray directions, such that the
+ * children are sorted by the position of their centers along a direction from that octant. A ray
+ * visits the children that it hits in the order of its octant, which is given by the signs of its
+ * direction, without sorting them.
+ *
+ * The leaves are the leaves of the binary bvh and refer to the same primitive indices.
+ *
+ * @tparam T the component type
+ * @tparam S the number of components
+ * @tparam W the maximum number of children per node
+ */
+template <typename T, size_t S, size_t W> class wide_bvh {
+  // the hits of the children of a node are collected in a 64 bit mask
+  static_assert(W >= 2u && W <= 64u, "unsupported number of children");
+
+public:
+  using component_type = T;
+  using box_type = bbox<T, S>;
+  static constexpr std::size_t width = W;
+  static constexpr std::size_t octant_count = std::size_t(1u) << S;
+
+  /**
+   * The index that find_first_hit returns if no primitive is hit.
+   */
+  static constexpr std::size_t null_index = std::numeric_limits<std::size_t>::max();
+
+  /**
+   * A node of the tree.
+   */
+  struct node {
+    /**
+     * The bounds of the children, bounds[0] holds the min corners and bounds[1] the max corners.
+     * The bounds of empty slots are inverted and infinite so that they are never hit.
+     */
+    T bounds[2][S][W];
+
+    /**
+     * For a leaf child, the index of its first primitive in primitive_indices(). For an inner child,
+     * its index in nodes(). For an empty slot, null_index.
+     */
+    std::size_t first[W];
+
+    /**
+     * For a leaf child, the number of primitives. For inner children and empty slots, 0.
+     */
+    std::size_t count[W];
+
+    /**
+     * For each octant of ray directions, the indices of the children in front to back order. Bit i
+     * of an octant is set if the directions are negative along axis i.
+     */
+    std::uint8_t order[octant_count][W];
+
+    /**
+     * Returns the bounding box of the child at the given index, which must not be empty.
+     */
+    box_type child_bounds(const std::size_t i) const {
+      assert(first[i] != null_index);
+      auto result = box_type(uninitialized);
+      for (size_t a = 0; a < S; ++a) {
+        result.min[a] = bounds[0][a][i];
+        result.max[a] = bounds[1][a][i];
+      }
+      return result;
+    }
+  };
+
+private:
+  using pack = detail::fixed_width_pack<T, W>;
+
+  struct child_candidate {
+    std::size_t first;
+    std::size_t count;
+    T distance;
+  };
+
+  std::vector<node> m_nodes;
+  std::vector<std::size_t> m_indices;
+
+public:
+  /**
+   * Creates an empty tree.
+   */
+  wide_bvh() = default;
+
+  /**
+   * Creates a tree by collapsing the given binary tree. Starting with the children of a binary node,
+   * the inner child with the largest surface area is replaced by its children until the node has W
+   * children or only leaves are left.
+   *
+   * @param binary the binary tree
+   */
+  explicit wide_bvh(const bvh<T, S>& binary)
+    : m_indices(binary.primitive_indices()) {
+    if (binary.empty()) {
+      return;
+    }
+
+    const auto& binaryNodes = binary.nodes();
+    // pairs of a wide node and the binary node that it is collapsed from
+    auto pending = std::vector<std::pair<std::size_t, std::size_t>>();
+    m_nodes.emplace_back();
+    pending.emplace_back(0u, 0u);
+    while (!pending.empty()) {
+      const auto [wideIndex, binaryIndex] = pending.back();
+      pending.pop_back();
+
+      const auto& binaryNode = binaryNodes[binaryIndex];
+      // the root of a wide tree is always an inner node, even if it has a single leaf child
+      auto children = binaryNode.is_leaf()
+                        ? std::vector<std::size_t>{binaryIndex}
+                        : std::vector<std::size_t>{binaryNode.first, binaryNode.first + 1u};
+      while (children.size() < W) {
+        auto largest = std::end(children);
+        auto largestArea = static_cast<T>(-1.0);
+        for (auto it = std::begin(children); it != std::end(children); ++it) {
+          const auto& child = binaryNodes[*it];
+          if (!child.is_leaf() && child.bounds.surface_area() > largestArea) {
+            largest = it;
+            largestArea = child.bounds.surface_area();
+          }
+        }
+        if (largest == std::end(children)) {
+          break;
+        }
+
+        const auto grandChild = binaryNodes[*largest].first;
+        *largest = grandChild;
+        children.push_back(grandChild + 1u);
+      }
+
+      auto n = node();
+      set_children(n, binaryNodes, children, pending);
+      m_nodes[wideIndex] = n;
+    }
+  }
+
+  /**
+   * Indicates whether this tree has no primitives.
+   */
+  bool empty() const { return m_nodes.empty(); }
+
+  /**
+   * Returns the number of primitives in this tree.
+   */
+  std::size_t size() const { return m_indices.size(); }
+
+  /**
+   * Returns the nodes of this tree, with the root at index 0.
+   */
+  const std::vector<node>& nodes() const { return m_nodes; }
+
+  /**
+   * Returns the indices of the primitives in the order in which the leaves refer to them.
+   */
+  const std::vector<std::size_t>& primitive_indices() const { return m_indices; }
+
+  /**
+   * Calls the given visitor with the index of every primitive whose leaf intersects the given
+   * bounding box.
+   *
+   * @tparam F the type of the visitor
+   * @param b the bounding box
+   * @param f the visitor
+   * @param stats if not null, the visited nodes are added to this
+   */
+  template <typename F>
+  void find_intersectors(const box_type& b, F f, traversal_stats* stats = nullptr) const {
+    auto visitedNodes = std::size_t(0);
+    auto visitedLeaves = std::size_t(0);
+
+    auto stack = detail::traversal_stack<std::size_t>();
+    if (!empty()) {
+      stack.push(0u);
+    }
+    while (!stack.empty()) {
+      const auto& n = m_nodes[stack.pop()];
+      ++visitedNodes;
+
+      bool hit[W];
+      for (std::size_t i = 0u; i < W; ++i) {
+        // the bounds of empty slots contain infinities and can intersect an infinite box
+        hit[i] = n.first[i] != null_index;
+        for (size_t a = 0; a < S; ++a) {
+          hit[i] = hit[i] && n.bounds[0][a][i] <= b.max[a] && n.bounds[1][a][i] >= b.min[a];
+        }
+      }
+
+      for (std::size_t i = 0u; i < W; ++i) {
+        if (!hit[i]) {
+          continue;
+        } else if (n.count[i] > 0u) {
+          ++visitedNodes;
+          ++visitedLeaves;
+          for (auto j = n.first[i]; j < n.first[i] + n.count[i]; ++j) {
+            f(m_indices[j]);
+          }
+        } else {
+          stack.push(n.first[i]);
+        }
+      }
+    }
+
+    detail::add_traversal_stats(stats, visitedNodes, visitedLeaves);
+  }
+
+  /**
+   * Finds the closest primitive hit by the given ray, see bvh::find_first_hit. The children of a
+   * node that the ray hits are visited in the order that the node stores for the octant of the
+   * ray's direction.
+   *
+   * @tparam F the type of the hit function
+   * @param r the ray
+   * @param hit the hit function
+   * @param stats if not null, the visited nodes are added to this
+   * @return the index of the primitive that is hit first and the distance to the hit, or null_index
+   * and NaN if no primitive is hit
+   */
+  template <typename F>
+  std::tuple<std::size_t, T> find_first_hit(
+    const ray<T, S>& r, F hit, traversal_stats* stats = nullptr) const {
+    auto visitedNodes = std::size_t(0);
+    auto visitedLeaves = std::size_t(0);
+
+    auto bestIndex = null_index;
+    auto bestDistance = std::numeric_limits<T>::infinity();
+
+    const auto q = ray_query<T, S>(r);
+
+    auto stack = detail::traversal_stack<child_candidate>();
+    if (!empty()) {
+      stack.push({0u, 0u, static_cast<T>(0.0)});
+    }
+    while (!stack.empty()) {
+      const auto candidate = stack.pop();
+      if (candidate.distance > bestDistance) {
+        continue;
+      }
+
+      ++visitedNodes;
+      if (candidate.count > 0u) {
+        ++visitedLeaves;
+        for (auto i = candidate.first; i < candidate.first + candidate.count; ++i) {
+          const auto distance = hit(m_indices[i]);
+          if (!is_nan(distance) && distance < bestDistance) {
+            bestIndex = m_indices[i];
+            bestDistance = distance;
+          }
+        }
+        continue;
+      }
+
+      const auto& n = m_nodes[candidate.first];
+      T distances[W];
+      const auto hits = intersect_children(n, q, bestDistance, distances);
+
+      // the nearest child is pushed last so that it is visited first
+      const auto& order = n.order[q.sign_mask];
+      for (std::size_t i = W; i > 0u; --i) {
+        const auto child = order[i - 1u];
+        if ((hits >> child) & 1u) {
+          stack.push({n.first[child], n.count[child], distances[child]});
+        }
+      }
+    }
+
+    detail::add_traversal_stats(stats, visitedNodes, visitedLeaves);
+    return bestIndex == null_index ? std::make_tuple(null_index, nan<T>())
+                                   : std::make_tuple(bestIndex, bestDistance);
+  }
+
+private:
+  /**
+   * Intersects the ray of the given query with the bounds of all children of the given node using
+   * the slab test. Returns a mask with bit i set if child i is hit at a distance in [0, maxDistance],
+   * and stores the distance at which the ray enters each child, or 0 if the origin is inside.
+   */
+  static std::uint64_t intersect_children(
+    const node& n, const ray_query<T, S>& q, const T maxDistance, T* distances) {
+    std::uint64_t result = 0u;
+    for (std::size_t i = 0u; i < W; i += pack::width) {
+      auto tNear = pack::set1(static_cast<T>(0.0));
+      auto tFar = pack::set1(maxDistance);
+      for (size_t a = 0; a < S; ++a) {
+        const auto negative = q.is_negative(a) ? 1u : 0u;
+        const auto origin = pack::set1(q.origin[a]);
+        const auto invDirection = pack::set1(q.inv_direction[a]);
+        const auto t0 =
+          pack::mul(pack::sub(pack::load(&n.bounds[negative][a][i]), origin), invDirection);
+        const auto t1 =
+          pack::mul(pack::sub(pack::load(&n.bounds[1u - negative][a][i]), origin), invDirection);
+        // if t0 or t1 is NaN, min and max return the second operand
+        tNear = pack::max(t0, tNear);
+        tFar = pack::min(t1, tFar);
+      }
+      pack::store(distances + i, tNear);
+      result |= std::uint64_t(pack::bits(pack::le(tNear, tFar))) << i;
+    }
+    return result;
+  }
+
+  /**
+   * Sets the children of the given wide node to the given binary nodes. Inner children are added
+   * to the pending nodes.
+   */
+  void set_children(
+    node& n,
+    const std::vector<typename bvh<T, S>::node>& binaryNodes,
+    const std::vector<std::size_t>& children,
+    std::vector<std::pair<std::size_t, std::size_t>>& pending) {
+    assert(children.size() <= W);
+    for (std::size_t i = 0u; i < W; ++i) {
+      for (size_t a = 0; a < S; ++a) {
+        n.bounds[0][a][i] = std::numeric_limits<T>::infinity();
+        n.bounds[1][a][i] = -std::numeric_limits<T>::infinity();
+      }
+      n.first[i] = null_index;
+      n.count[i] = 0u;
+    }
+
+    for (std::size_t i = 0u; i < children.size(); ++i) {
+      const auto& child = binaryNodes[children[i]];
+      for (size_t a = 0; a < S; ++a) {
+        n.bounds[0][a][i] = child.bounds.min[a];
+        n.bounds[1][a][i] = child.bounds.max[a];
+      }
+      if (child.is_leaf()) {
+        n.first[i] = child.first;
+        n.count[i] = child.count;
+      } else {
+        n.first[i] = m_nodes.size();
+        m_nodes.emplace_back();
+        pending.emplace_back(n.first[i], children[i]);
+      }
+    }
+
+    // empty slots are never hit, their position in the order does not matter
+    for (std::size_t octant = 0u; octant < octant_count; ++octant) {
+      auto projections = std::vector<std::pair<T, std::size_t>>();
+      for (std::size_t i = 0u; i < W; ++i) {
+        auto projection = static_cast<T>(0.0);
+        if (i < children.size()) {
+          const auto center = binaryNodes[children[i]].bounds.center();
+          for (size_t a = 0; a < S; ++a) {
+            projection += ((octant >> a) & 1u) ? -center[a] : center[a];
+          }
+        }
+        projections.emplace_back(projection, i);
+      }
+      std::stable_sort(std::begin(projections), std::end(projections));
+      for (std::size_t i = 0u; i < W; ++i) {
+        n.order[octant][i] = static_cast<std::uint8_t>(projections[i].second);
+      }
+    }
+  }
+};
+
+/**
+ * Finds the closest triangle hit by the given ray, see
+ * intersect_ray_triangles(const ray<T, 3>&, const bvh<T, 3>&, const std::vector<vec<T, 3>>&,
+ * traversal_stats*).
+ *
+ * @tparam T the component type
+ * @tparam W the maximum number of children per node
+ * @param r the ray
+ * @param tree the wide bvh that was collapsed from a bvh built for the given triangles
+ * @param vertices the vertices of the triangles
+ * @param stats if not null, the visited nodes are added to this
+ * @return the index of the triangle that is hit first and the distance to the hit, or null_index
+ * and NaN if no triangle is hit
+ */
+template <typename T, size_t W>
+std::tuple<std::size_t, T> intersect_ray_triangles(
+  const ray<T, 3>& r,
+  const wide_bvh<T, 3, W>& tree,
+  const std::vector<vec<T, 3>>& vertices,
+  traversal_stats* stats = nullptr) {
+  return tree.find_first_hit(
+    r,
+    [&](const std::size_t i) {
+      return intersect_ray_triangle(
+        r, vertices[3u * i], vertices[3u * i + 1u], vertices[3u * i + 2u]);
+    },
+    stats);
+}
+} // namespace vm
@@ -0,0 +1,253 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/aabb_tree.h>
+#include <vecmath/approx.h>
+#include <vecmath/bbox.h>
+#include <vecmath/bbox_io.h>
+#include <vecmath/forward.h>
+#include <vecmath/intersection.h>
+#include <vecmath/plane.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_io.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+using tree = aabb_tree<double, 3, std::size_t>;
+
+static std::vector<bbox3d> random_boxes(const std::size_t count, const unsigned int seed) {
+  auto rng = std::mt19937(seed);
+  auto position = std::uniform_real_distribution<double>(-100.0, 100.0);
+  auto extent = std::uniform_real_distribution<double>(0.5, 5.0);
+
+  auto result = std::vector<bbox3d>();
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto min = vec3d(position(rng), position(rng), position(rng));
+    result.emplace_back(min, min + vec3d(extent(rng), extent(rng), extent(rng)));
+  }
+  return result;
+}
+
+static std::vector<std::size_t> sorted(std::vector<std::size_t> values) {
+  std::sort(std::begin(values), std::end(values));
+  return values;
+}
+
+/**
+ * Collects the user values of the leaves found by a query.
+ */
+static auto collect(const tree& t, std::vector<std::size_t>& result) {
+  return [&](const tree::handle h) { result.push_back(t.data(h)); };
+}
+
+TEST_CASE("aabb_tree.insert_remove") {
+  auto t = tree();
+  CHECK(t.empty());
+  CHECK(t.size() == 0u);
+  CHECK(t.height() == 0u);
+
+  const auto h1 = t.insert(bbox3d(vec3d(0, 0, 0), vec3d(1, 1, 1)), 1u);
+  CHECK_FALSE(t.empty());
+  CHECK(t.size() == 1u);
+  CHECK(t.height() == 0u);
+  CHECK(t.data(h1) == 1u);
+  CHECK(t.bounds() == bbox3d(vec3d(0, 0, 0), vec3d(1, 1, 1)));
+
+  const auto h2 = t.insert(bbox3d(vec3d(2, 2, 2), vec3d(3, 3, 3)), 2u);
+  CHECK(t.size() == 2u);
+  CHECK(t.height() == 1u);
+  CHECK(t.bounds() == bbox3d(vec3d(0, 0, 0), vec3d(3, 3, 3)));
+
+  t.remove(h1);
+  CHECK(t.size() == 1u);
+  CHECK(t.height() == 0u);
+  CHECK(t.data(h2) == 2u);
+  CHECK(t.bounds() == bbox3d(vec3d(2, 2, 2), vec3d(3, 3, 3)));
+
+  t.remove(h2);
+  CHECK(t.empty());
+
+  // nodes are reused
+  const auto h3 = t.insert(bbox3d(vec3d(0, 0, 0), vec3d(1, 1, 1)), 3u);
+  CHECK(t.data(h3) == 3u);
+
+  t.clear();
+  CHECK(t.empty());
+  CHECK(t.size() == 0u);
+}
+
+TEST_CASE("aabb_tree.balance") {
+  // inserting sorted boxes degenerates an unbalanced tree into a list
+  auto t = tree();
+  for (std::size_t i = 0; i < 1024u; ++i) {
+    const auto x = static_cast<double>(i);
+    t.insert(bbox3d(vec3d(x, 0, 0), vec3d(x + 0.5, 1, 1)), i);
+  }
+  CHECK(t.height() <= 20u);
+}
+
+TEST_CASE("aabb_tree.margin") {
+  auto t = tree(0.5);
+  const auto h = t.insert(bbox3d(vec3d(0, 0, 0), vec3d(1, 1, 1)), 0u);
+  CHECK(t.bounds(h) == bbox3d(vec3d(-0.5, -0.5, -0.5), vec3d(1.5, 1.5, 1.5)));
+
+  // within the margin
+  CHECK_FALSE(t.move(h, bbox3d(vec3d(0.25, 0, 0), vec3d(1.25, 1, 1))));
+  CHECK(t.bounds(h) == bbox3d(vec3d(-0.5, -0.5, -0.5), vec3d(1.5, 1.5, 1.5)));
+
+  // beyond the margin
+  CHECK(t.move(h, bbox3d(vec3d(1, 0, 0), vec3d(2, 1, 1))));
+  CHECK(t.bounds(h) == bbox3d(vec3d(0.5, -0.5, -0.5), vec3d(2.5, 1.5, 1.5)));
+
+  // shrunk by more than the margin
+  CHECK(t.move(h, bbox3d(vec3d(2, 0, 0), vec3d(2.25, 0.25, 0.25))));
+  CHECK(t.bounds(h) == bbox3d(vec3d(1.5, -0.5, -0.5), vec3d(2.75, 0.75, 0.75)));
+}
+
+TEST_CASE("aabb_tree.queries") {
+  auto boxes = random_boxes(1000u, 1u);
+  auto t = tree(0.1);
+  auto handles = std::vector<tree::handle>();
+  for (std::size_t i = 0; i < boxes.size(); ++i) {
+    handles.push_back(t.insert(boxes[i], i));
+  }
+
+  // remove some leaves and move others
+  auto present = std::vector<bool>(boxes.size(), true);
+  const auto moved = random_boxes(boxes.size(), 2u);
+  for (std::size_t i = 0; i < boxes.size(); i += 3u) {
+    t.remove(handles[i]);
+    present[i] = false;
+  }
+  for (std::size_t i = 1; i < boxes.size(); i += 3u) {
+    boxes[i] = moved[i];
+    t.move(handles[i], boxes[i]);
+  }
+  for (std::size_t i = 2; i < boxes.size(); i += 9u) {
+    boxes[i] = boxes[i].translate(vec3d(0.05, 0.05, 0.05));
+    t.move(handles[i], boxes[i]);
+  }
+  CHECK(t.size() == 666u);
+
+  const auto& constTree = t;
+  const auto exact_hit = [&](const ray3d& r) {
+    return [&, r](const tree::handle h) { return intersect_ray_bbox(r, boxes[t.data(h)]); };
+  };
+
+  auto rng = std::mt19937(3u);
+  auto position = std::uniform_real_distribution<double>(-100.0, 100.0);
+  for (std::size_t i = 0; i < 20u; ++i) {
+    const auto center = vec3d(position(rng), position(rng), position(rng));
+    const auto query = bbox3d(center - vec3d(10, 10, 10), center + vec3d(10, 10, 10));
+
+    auto expected = std::vector<std::size_t>();
+    for (std::size_t j = 0; j < boxes.size(); ++j) {
+      if (present[j] && boxes[j].intersects(query)) {
+        expected.push_back(j);
+      }
+    }
+
+    // the leaf boxes are enlarged, so the tree finds a superset
+    auto found = std::vector<std::size_t>();
+    auto stats = traversal_stats();
+    constTree.find_intersectors(query, collect(t, found), &stats);
+    auto exact = std::vector<std::size_t>();
+    std::copy_if(
+      std::begin(found), std::end(found), std::back_inserter(exact),
+      [&](const std::size_t j) { return boxes[j].intersects(query); });
+    CHECK(sorted(exact) == expected);
+    CHECK(stats.visited_leaves <= stats.visited_nodes);
+    CHECK(stats.visited_nodes < 2u * t.size());
+
+    // the planes of the query box with their normals pointing out of it
+    const auto planes = std::vector<plane3d>{
+      plane3d(query.max, vec3d::pos_x()), plane3d(query.min, vec3d::neg_x()),
+      plane3d(query.max, vec3d::pos_y()), plane3d(query.min, vec3d::neg_y()),
+      plane3d(query.max, vec3d::pos_z()), plane3d(query.min, vec3d::neg_z())};
+    auto inFrustum = std::vector<std::size_t>();
+    constTree.find_in_frustum(std::begin(planes), std::end(planes), collect(t, inFrustum));
+    CHECK(sorted(inFrustum) == sorted(found));
+
+    const auto r = ray3d(center, normalize(vec3d(position(rng), position(rng), position(rng))));
+    auto expectedHits = std::vector<std::size_t>();
+    auto expectedFirst = std::size_t(0);
+    auto expectedDistance = nan<double>();
+    for (std::size_t j = 0; j < boxes.size(); ++j) {
+      const auto distance = intersect_ray_bbox(r, boxes[j]);
+      if (present[j] && !is_nan(distance)) {
+        expectedHits.push_back(j);
+        if (is_nan(expectedDistance) || distance < expectedDistance) {
+          expectedFirst = j;
+          expectedDistance = distance;
+        }
+      }
+    }
+
+    auto hits = std::vector<std::size_t>();
+    constTree.find_hits(r, collect(t, hits));
+    auto exactHits = std::vector<std::size_t>();
+    std::copy_if(
+      std::begin(hits), std::end(hits), std::back_inserter(exactHits),
+      [&](const std::size_t j) { return !is_nan(intersect_ray_bbox(r, boxes[j])); });
+    CHECK(sorted(exactHits) == expectedHits);
+
+    const auto [first, distance] = constTree.find_first_hit(r, exact_hit(r));
+    if (is_nan(expectedDistance)) {
+      CHECK(first == tree::null_handle);
+      CHECK(is_nan(distance));
+    } else {
+      CHECK(t.data(first) == expectedFirst);
+      CHECK(distance == approx(expectedDistance));
+    }
+  }
+}
+
+TEST_CASE("aabb_tree.find_first_hit_prunes") {
+  auto t = tree();
+  for (std::size_t i = 0; i < 1000u; ++i) {
+    const auto x = static_cast<double>(i) * 2.0;
+    t.insert(bbox3d(vec3d(x, -1, -1), vec3d(x + 1, 1, 1)), i);
+  }
+
+  const auto r = ray3d(vec3d(-1, 0, 0), vec3d::pos_x());
+  auto stats = traversal_stats();
+  const auto [first, distance] = t.find_first_hit(
+    r, [&](const tree::handle h) { return intersect_ray_bbox(r, t.bounds(h)); }, &stats);
+  CHECK(t.data(first) == 0u);
+  CHECK(distance == approx(1.0));
+  CHECK(stats.visited_nodes < 100u);
+
+  auto allStats = traversal_stats();
+  auto count = std::size_t(0);
+  t.find_hits(r, [&](const tree::handle) { ++count; }, &allStats);
+  CHECK(count == 1000u);
+  CHECK(allStats.visited_leaves == 1000u);
+}
+} // namespace vm
@@ -0,0 +1,133 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/affine.h>
+#include <vecmath/approx.h>
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/mat_io.h>
+#include <vecmath/scalar.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_io.h>
+
+#include "test_utils.h"
+
+#include <tuple>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("affine.size") {
+  CHECK(sizeof(affine3d) == 12u * sizeof(double));
+  CHECK(sizeof(affine3f) == 12u * sizeof(float));
+}
+
+TEST_CASE("affine.constructor_default") {
+  CER_CHECK(affine3d().to_mat() == mat4x4d::identity());
+  CER_CHECK(affine3d() == affine3d::identity());
+}
+
+TEST_CASE("affine.constructor_linear_translation") {
+  constexpr auto l = mat3x3d(1, 2, 3, 4, 5, 6, 7, 8, 9);
+  constexpr auto t = vec3d(10, 11, 12);
+  constexpr auto a = affine3d(l, t);
+  CER_CHECK(a.linear() == l);
+  CER_CHECK(a.translation() == t);
+  CER_CHECK(a.to_mat() == mat4x4d(1, 2, 3, 10, 4, 5, 6, 11, 7, 8, 9, 12, 0, 0, 0, 1));
+  CER_CHECK(affine3d(l).translation() == vec3d::zero());
+}
+
+TEST_CASE("affine.constructor_mat") {
+  constexpr auto m = mat4x4d(1, 2, 3, 10, 4, 5, 6, 11, 7, 8, 9, 12, 0, 0, 0, 1);
+  CER_CHECK(affine3d(m).to_mat() == m);
+  CER_CHECK(
+    affine3d(mat<double, 3, 4>(1, 2, 3, 10, 4, 5, 6, 11, 7, 8, 9, 12)) == affine3d(m));
+}
+
+TEST_CASE("affine.converting_constructor") {
+  constexpr auto a = affine3d(translation_matrix(vec3d(1, 2, 3)));
+  CER_CHECK(affine3f(a) == affine3f(translation_matrix(vec3f(1, 2, 3))));
+}
+
+TEST_CASE("affine.translation_scaling") {
+  CER_CHECK(
+    affine3d::translation(vec3d(1, 2, 3)).to_mat() == translation_matrix(vec3d(1, 2, 3)));
+  CER_CHECK(affine3d::scaling(vec3d(1, 2, 3)).to_mat() == scaling_matrix(vec3d(1, 2, 3)));
+}
+
+TEST_CASE("affine.compose") {
+  const auto m1 = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0)) *
+                  translation_matrix(vec3d(1, 2, 3));
+  const auto m2 = scaling_matrix(vec3d(2, 0.5, 3)) * translation_matrix(vec3d(-3, 7, 1));
+  CHECK((affine3d(m1) * affine3d(m2)).to_mat() == approx(m1 * m2));
+  CHECK((affine3d(m2) * affine3d(m1)).to_mat() == approx(m2 * m1));
+
+  constexpr auto t = translation_matrix(vec3d(1, 2, 3));
+  constexpr auto s = scaling_matrix(vec3d(2, 0.5, 3));
+  CER_CHECK((affine3d(t) * affine3d(s)).to_mat() == t * s);
+}
+
+TEST_CASE("affine.transform_point") {
+  const auto m = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0)) *
+                 translation_matrix(vec3d(1, 2, 3));
+  const auto p = vec3d(-4, 5, 6);
+  CHECK(affine3d(m) * p == approx(m * p));
+
+  constexpr auto c = translation_matrix(vec3d(1, 2, 3)) * scaling_matrix(vec3d(2, 0.5, 3));
+  CER_CHECK(affine3d(c) * vec3d(1, 1, 1) == vec3d(3, 2.5, 6));
+}
+
+TEST_CASE("affine.transform_vector") {
+  const auto m = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0)) *
+                 translation_matrix(vec3d(1, 2, 3));
+  const auto v = vec3d(-4, 5, 6);
+  CHECK(transform_vector(affine3d(m), v) == approx(strip_translation(m) * v));
+
+  constexpr auto c = translation_matrix(vec3d(1, 2, 3)) * scaling_matrix(vec3d(2, 0.5, 3));
+  CER_CHECK(transform_vector(affine3d(c), vec3d(1, 1, 1)) == vec3d(2, 0.5, 3));
+}
+
+TEST_CASE("affine.invert") {
+  const auto m = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0)) *
+                 scaling_matrix(vec3d(2, 0.5, 3)) * translation_matrix(vec3d(1, 2, 3));
+
+  const auto [invertible, inverse] = invert(affine3d(m));
+  CHECK(invertible);
+  CHECK(inverse.to_mat() == approx(std::get<1>(invert(m))));
+  CHECK((inverse * affine3d(m)).to_mat() == approx(mat4x4d::identity()));
+
+  constexpr auto t = translation_matrix(vec3d(1, 2, 3)) * scaling_matrix(vec3d(2, 4, 8));
+  CER_CHECK(
+    std::get<1>(invert(affine3d(t))).to_mat() == approx(std::get<1>(invert(t))));
+
+  constexpr auto singular = affine3d(mat3x3d::zero(), vec3d(1, 2, 3));
+  CER_CHECK_FALSE(std::get<0>(invert(singular)));
+}
+
+TEST_CASE("affine.is_equal") {
+  constexpr auto a = affine3d::translation(vec3d(1, 2, 3));
+  constexpr auto b = affine3d::translation(vec3d(1, 2, 3.05));
+  CER_CHECK(is_equal(a, b, 0.1));
+  CER_CHECK_FALSE(is_equal(a, b, 0.01));
+  CER_CHECK(a != b);
+  CER_CHECK_FALSE(a == b);
+}
+} // namespace vm
@@ -18,10 +18,13 @@
  OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <vecmath/affine.h>
+#include <vecmath/approx.h>
 #include <vecmath/bbox.h>
 #include <vecmath/bbox_io.h>
 #include <vecmath/forward.h>
 #include <vecmath/mat_ext.h>
+#include <vecmath/transformation.h>
 #include <vecmath/vec.h>
 
 #include "test_utils.h"
@@ -112,6 +115,12 @@ TEST_CASE("bbox.volume") {
   CER_CHECK(bbox3d(2.0).volume() == 4.0 * 4.0 * 4.0);
 }
 
+TEST_CASE("bbox.surface_area") {
+  CER_CHECK(bbox3d().surface_area() == 0.0);
+  CER_CHECK(bbox3d(vec3d(0, 0, 0), vec3d(1, 2, 3)).surface_area() == 2.0 * (2.0 + 6.0 + 3.0));
+  CER_CHECK(bbox2f(vec2f(0, 0), vec2f(1, 2)).surface_area() == 6.0f);
+}
+
 TEST_CASE("bbox.contains_point") {
   constexpr auto bounds = bbox3f(vec3f(-12, -3, 4), vec3f(8, 9, 8));
   CER_CHECK(bounds.contains(vec3f(2, 1, 7)));
@@ -225,6 +234,31 @@ TEST_CASE("bbox.transform") {
   CER_CHECK(bounds.transform(transform).max == transformed.max);
 }
 
+TEST_CASE("bbox.transform_affine") {
+  constexpr auto bounds = bbox3d(vec3d(-2, -1, 0), vec3d(10, 4, 5));
+  constexpr auto sm = scaling_matrix(vec3d(0.5, 2, -3));
+  constexpr auto tm = translation_matrix(vec3d(1, 2, 3));
+  CER_CHECK(bounds.transform(affine3d(sm * tm)).min == approx(bounds.transform(sm * tm).min));
+  CER_CHECK(bounds.transform(affine3d(sm * tm)).max == approx(bounds.transform(sm * tm).max));
+
+  const auto m = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0)) * tm;
+  CHECK(bounds.transform(affine3d(m)).min == approx(bounds.transform(m).min));
+  CHECK(bounds.transform(affine3d(m)).max == approx(bounds.transform(m).max));
+}
+
+TEST_CASE("bbox.transform_transformation") {
+  constexpr auto bounds = bbox3d(vec3d(-2, -1, 0), vec3d(10, 4, 5));
+  const auto rm = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0));
+  const auto tm = translation_matrix(vec3d(1, 2, 3));
+  const auto sm = scaling_matrix(vec3d(0.5, 2, -3));
+  const auto pm = mat4x4d(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0.01, 1);
+  for (const auto& m : {mat4x4d::identity(), tm, rm * tm, sm * tm, pm}) {
+    const auto transformed = bounds.transform(transformation3d(m));
+    CHECK(transformed.min == approx(bounds.transform(m).min));
+    CHECK(transformed.max == approx(bounds.transform(m).max));
+  }
+}
+
 TEST_CASE("bbox.operator_equal") {
   constexpr auto min = vec3f(-1, -2, -3);
   constexpr auto max = vec3f(1, 2, 3);
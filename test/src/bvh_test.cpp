@@ -0,0 +1,268 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/approx.h>
+#include <vecmath/bbox.h>
+#include <vecmath/bbox_io.h>
+#include <vecmath/bvh.h>
+#include <vecmath/forward.h>
+#include <vecmath/intersection.h>
+#include <vecmath/parallel.h>
+#include <vecmath/polygon.h>
+#include <vecmath/ray.h>
+#include <vecmath/ray_packet.h>
+#include <vecmath/scalar.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_io.h>
+
+#include "test_utils.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+static std::vector<bbox3d> triangle_bounds(const std::vector<vec3d>& vertices) {
+  auto result = std::vector<bbox3d>();
+  for (std::size_t i = 0; i < vertices.size(); i += 3u) {
+    result.push_back(bbox3d::merge_all(
+      std::next(std::begin(vertices), static_cast<std::ptrdiff_t>(i)),
+      std::next(std::begin(vertices), static_cast<std::ptrdiff_t>(i + 3u))));
+  }
+  return result;
+}
+
+/**
+ * Checks that every primitive is in exactly one leaf and that the bounds of every node contain
+ * the bounds of its children and primitives.
+ */
+static void check_structure(
+  const bvh<double, 3>& tree, const std::vector<bbox3d>& bounds, const std::size_t maxLeafSize) {
+  const auto& nodes = tree.nodes();
+  auto found = std::vector<std::size_t>(bounds.size(), 0u);
+  auto leafCount = std::size_t(0);
+  for (const auto& n : nodes) {
+    if (n.is_leaf()) {
+      ++leafCount;
+      CHECK(n.count <= maxLeafSize);
+      for (auto i = n.first; i < n.first + n.count; ++i) {
+        const auto primitive = tree.primitive_indices()[i];
+        ++found[primitive];
+        CHECK(n.bounds.contains(bounds[primitive]));
+      }
+    } else {
+      CHECK(n.first + 1u < nodes.size());
+      CHECK(n.bounds.contains(nodes[n.first].bounds));
+      CHECK(n.bounds.contains(nodes[n.first + 1u].bounds));
+    }
+  }
+  CHECK(nodes.size() == 2u * leafCount - 1u);
+  CHECK(std::all_of(std::begin(found), std::end(found), [](const auto c) { return c == 1u; }));
+}
+
+TEST_CASE("bvh.empty") {
+  const auto tree = bvh<double, 3>(std::vector<bbox3d>());
+  CHECK(tree.empty());
+  CHECK(tree.size() == 0u);
+  CHECK(tree.sah_cost() == 0.0);
+
+  const auto [index, distance] = tree.find_first_hit(
+    ray3d(vec3d::zero(), vec3d::pos_x()), [](const std::size_t) { return 0.0; });
+  CHECK(index == bvh<double, 3>::null_index);
+  CHECK(is_nan(distance));
+
+  const auto hits = tree.find_first_hit(
+    ray_packet4d(ray3d(vec3d::zero(), vec3d::pos_x())),
+    [](const std::size_t) { return std::array<double, 4>{}; });
+  CHECK(std::get<0>(hits[0]) == bvh<double, 3>::null_index);
+}
+
+TEST_CASE("bvh.single_leaf") {
+  // splitting these boxes would not save any intersections
+  const auto bounds = std::vector<bbox3d>{
+    bbox3d(vec3d(0, 0, 0), vec3d(2, 1, 1)), bbox3d(vec3d(1, 0, 0), vec3d(3, 1, 1))};
+  const auto tree = bvh<double, 3>(bounds);
+  CHECK(tree.size() == 2u);
+  CHECK(tree.nodes().size() == 1u);
+  CHECK(tree.bounds() == bbox3d(vec3d(0, 0, 0), vec3d(3, 1, 1)));
+  CHECK(tree.sah_cost() == approx(2.0));
+
+  // but these are far enough apart
+  const auto apart = std::vector<bbox3d>{
+    bbox3d(vec3d(0, 0, 0), vec3d(1, 1, 1)), bbox3d(vec3d(2, 0, 0), vec3d(3, 1, 1))};
+  CHECK(bvh<double, 3>(apart).nodes().size() == 3u);
+}
+
+TEST_CASE("bvh.build") {
+  const auto vertices = random_triangles<double>(2000u, 1u);
+  const auto bounds = triangle_bounds(vertices);
+  const auto options = bvh_options<double>();
+
+  const auto tree = bvh<double, 3>(bounds, options);
+  CHECK(tree.size() == bounds.size());
+  check_structure(tree, bounds, options.max_leaf_size);
+
+  // a tree with a single leaf costs one intersection per primitive
+  CHECK(tree.sah_cost(options) < static_cast<double>(bounds.size()) / 10.0);
+
+  // the tree does not depend on the executor
+  for (const auto threads : {1u, 2u, 4u}) {
+    const auto policy = parallel_policy<>(thread_executor(threads), 64u);
+    const auto parallelTree = bvh<double, 3>(policy, bounds, options);
+    check_structure(parallelTree, bounds, options.max_leaf_size);
+    CHECK(parallelTree.primitive_indices() == tree.primitive_indices());
+    CHECK(parallelTree.nodes().size() == tree.nodes().size());
+    CHECK(parallelTree.sah_cost(options) == approx(tree.sah_cost(options)));
+  }
+
+  // identical primitives cannot be separated by a split
+  const auto same = std::vector<bbox3d>(100u, bbox3d(vec3d(0, 0, 0), vec3d(1, 1, 1)));
+  check_structure(bvh<double, 3>(same, options), same, options.max_leaf_size);
+}
+
+TEST_CASE("bvh.find_intersectors") {
+  const auto bounds = triangle_bounds(random_triangles<double>(1000u, 2u));
+  const auto tree = bvh<double, 3>(bounds);
+
+  const auto query = bbox3d(vec3d(-20, -20, -20), vec3d(20, 20, 20));
+  auto expected = std::vector<std::size_t>();
+  for (std::size_t i = 0; i < bounds.size(); ++i) {
+    if (bounds[i].intersects(query)) {
+      expected.push_back(i);
+    }
+  }
+
+  auto found = std::vector<std::size_t>();
+  auto stats = traversal_stats();
+  tree.find_intersectors(query, [&](const std::size_t i) { found.push_back(i); }, &stats);
+  std::sort(std::begin(found), std::end(found));
+  CHECK(found == expected);
+  CHECK(stats.visited_nodes < tree.nodes().size());
+}
+
+TEST_CASE("bvh.intersect_ray_triangles") {
+  const auto vertices = random_triangles<double>(1000u, 3u);
+  const auto tree = make_triangle_bvh(parallel_policy<>(thread_executor(2u), 64u), vertices);
+  CHECK(tree.size() == 1000u);
+
+  auto rng = std::mt19937(4u);
+  auto position = std::uniform_real_distribution<double>(-100.0, 100.0);
+  for (std::size_t i = 0; i < 100u; ++i) {
+    const auto origin = vec3d(position(rng), position(rng), position(rng));
+    const auto r = ray3d(origin, normalize(vec3d(position(rng), position(rng), position(rng))));
+
+    auto expectedIndex = bvh<double, 3>::null_index;
+    auto expectedDistance = nan<double>();
+    for (std::size_t j = 0; j < vertices.size() / 3u; ++j) {
+      const auto distance =
+        intersect_ray_triangle(r, vertices[3u * j], vertices[3u * j + 1u], vertices[3u * j + 2u]);
+      if (!is_nan(distance) && (is_nan(expectedDistance) || distance < expectedDistance)) {
+        expectedIndex = j;
+        expectedDistance = distance;
+      }
+    }
+
+    const auto [index, distance] = intersect_ray_triangles(r, tree, vertices);
+    CHECK(index == expectedIndex);
+    if (!is_nan(expectedDistance)) {
+      CHECK(distance == approx(expectedDistance));
+    }
+  }
+}
+
+TEST_CASE("bvh.intersect_ray_triangles_packets") {
+  const auto vertices = random_triangles<double>(1000u, 5u);
+  const auto tree = make_triangle_bvh(vertices);
+
+  // coherent rays from a camera through the pixels of a 30x30 image in scanline order, the last
+  // packet is not full
+  auto rays = std::vector<ray3d>();
+  for (std::size_t y = 0; y < 30u; ++y) {
+    for (std::size_t x = 0; x < 30u; ++x) {
+      const auto target = vec3d(
+        -100.0 + 200.0 * static_cast<double>(x) / 29.0,
+        -100.0 + 200.0 * static_cast<double>(y) / 29.0,
+        0.0);
+      const auto origin = vec3d(0, 0, 300);
+      rays.emplace_back(origin, normalize(target - origin));
+    }
+  }
+
+  auto rayStats = traversal_stats();
+  auto expected = std::vector<std::tuple<std::size_t, double>>();
+  for (const auto& r : rays) {
+    expected.push_back(intersect_ray_triangles(r, tree, vertices, &rayStats));
+  }
+
+  auto packetStats = traversal_stats();
+  auto hits = std::vector<std::tuple<std::size_t, double>>();
+  intersect_ray_triangles<4u>(rays, tree, vertices, hits, &packetStats);
+  REQUIRE(hits.size() == rays.size());
+
+  auto hitCount = std::size_t(0);
+  for (std::size_t i = 0; i < rays.size(); ++i) {
+    const auto [expectedIndex, expectedDistance] = expected[i];
+    const auto [index, distance] = hits[i];
+    CHECK(index == expectedIndex);
+    if (!is_nan(expectedDistance)) {
+      CHECK(distance == approx(expectedDistance));
+      ++hitCount;
+    } else {
+      CHECK(is_nan(distance));
+    }
+  }
+  CHECK(hitCount > 0u);
+
+  // each packet fetches a node once for all of its rays
+  CHECK(packetStats.visited_nodes < rayStats.visited_nodes);
+
+  auto wideHits = std::vector<std::tuple<std::size_t, double>>();
+  intersect_ray_triangles(rays, tree, vertices, wideHits);
+  REQUIRE(wideHits.size() == rays.size());
+  for (std::size_t i = 0; i < rays.size(); ++i) {
+    CHECK(std::get<0>(wideHits[i]) == std::get<0>(hits[i]));
+  }
+}
+
+TEST_CASE("bvh.intersect_ray_polygons") {
+  auto polygons = std::vector<polygon3d>();
+  for (std::size_t i = 0; i < 100u; ++i) {
+    const auto z = static_cast<double>(i);
+    polygons.push_back(polygon3d{
+      vec3d(-1, -1, z), vec3d(1, -1, z), vec3d(1, 1, z), vec3d(-1, 1, z)});
+  }
+  const auto tree = make_polygon_bvh(polygons);
+
+  const auto [index, distance] =
+    intersect_ray_polygons(ray3d(vec3d(0, 0, 50.5), vec3d::pos_z()), tree, polygons);
+  CHECK(index == 51u);
+  CHECK(distance == approx(0.5));
+
+  const auto [missIndex, missDistance] =
+    intersect_ray_polygons(ray3d(vec3d(2, 0, 50.5), vec3d::pos_z()), tree, polygons);
+  CHECK(missIndex == bvh<double, 3>::null_index);
+  CHECK(is_nan(missDistance));
+}
+} // namespace vm
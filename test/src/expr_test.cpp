@@ -0,0 +1,116 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/approx.h>
+#include <vecmath/expr.h>
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/mat_io.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_io.h>
+
+#include "test_utils.h"
+
+#include <type_traits>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("expr.lazy_builds_expression") {
+  constexpr auto a = vec3f(1.0f, 2.0f, 3.0f);
+  constexpr auto b = vec3f(4.0f, 5.0f, 6.0f);
+
+  CHECK_FALSE(std::is_same_v<decltype(lazy(a) + b), vec3f>);
+  CHECK_FALSE(std::is_same_v<decltype(a + lazy(b) * 2.0f), vec3f>);
+  CHECK(std::is_same_v<decltype(eval(lazy(a) + b)), vec3f>);
+  CHECK(std::is_same_v<decltype(a + b), vec3f>);
+}
+
+TEST_CASE("expr.vec_arithmetic") {
+  constexpr auto a = vec3f(1.0f, 2.0f, 3.0f);
+  constexpr auto b = vec3f(4.0f, -5.0f, 6.0f);
+  constexpr auto c = vec3f(-2.0f, 0.5f, 8.0f);
+
+  CER_CHECK(eval(lazy(a) + b) == a + b);
+  CER_CHECK(eval(a + lazy(b)) == a + b);
+  CER_CHECK(eval(lazy(a) - b) == a - b);
+  CER_CHECK(eval(lazy(a) * b) == a * b);
+  CER_CHECK(eval(lazy(a) / b) == a / b);
+  CER_CHECK(eval(-lazy(a)) == -a);
+  CER_CHECK(eval(lazy(a) * 2.0f) == a * 2.0f);
+  CER_CHECK(eval(2.0f * lazy(a)) == 2.0f * a);
+  CER_CHECK(eval(lazy(a) / 2.0f) == a / 2.0f);
+  CER_CHECK(eval(2.0f * lazy(a) + 3.0f * lazy(b) - c / 4.0f) == 2.0f * a + 3.0f * b - c / 4.0f);
+  CER_CHECK(eval((lazy(a) + b) * (lazy(b) - c)) == (a + b) * (b - c));
+}
+
+TEST_CASE("expr.vec_conversion") {
+  constexpr auto a = vec3f(1.0f, 2.0f, 3.0f);
+  constexpr auto b = vec3f(4.0f, -5.0f, 6.0f);
+
+  const vec3f r = lazy(a) * 2.0f + b;
+  CHECK(r == a * 2.0f + b);
+
+  const auto e = lazy(a) + b;
+  CHECK(e[0] == 5.0f);
+  CHECK(e[1] == -3.0f);
+  CHECK(e[2] == 9.0f);
+}
+
+TEST_CASE("expr.mat_arithmetic") {
+  constexpr auto m = mat3x3d(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0);
+  constexpr auto n = mat3x3d(-2.0, 0.0, 1.0, 3.0, 1.0, -1.0, 0.5, 2.0, 4.0);
+
+  CER_CHECK(eval(lazy(m) + n) == m + n);
+  CER_CHECK(eval(m - lazy(n)) == m - n);
+  CER_CHECK(eval(-lazy(m)) == -m);
+  CER_CHECK(eval(lazy(m) * 2.0) == m * 2.0);
+  CER_CHECK(eval(2.0 * lazy(m)) == 2.0 * m);
+  CER_CHECK(eval(lazy(m) / 2.0) == m / 2.0);
+  CER_CHECK(eval(lazy(m) * 2.0 + n - m / 4.0) == m * 2.0 + n - m / 4.0);
+}
+
+TEST_CASE("expr.mat_product") {
+  constexpr auto m = mat3x3d(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0);
+  constexpr auto n = mat3x3d(-2.0, 0.0, 1.0, 3.0, 1.0, -1.0, 0.5, 2.0, 4.0);
+  constexpr auto o = mat<double, 3, 2>(1.0, 2.0, 3.0, 4.0, 5.0, 6.0);
+  constexpr auto v = vec3d(1.0, -1.0, 2.0);
+
+  CER_CHECK(eval(lazy(m) * n) == m * n);
+  CER_CHECK(eval(lazy(m) * n * m) == m * n * m);
+  CER_CHECK(eval(lazy(m) * (lazy(n) + m)) == m * (n + m));
+  CER_CHECK(eval(lazy(m) * o) == m * o);
+  CER_CHECK(eval(lazy(m) * v) == m * v);
+  CER_CHECK(eval(m * (lazy(v) + v)) == m * (v + v));
+  CER_CHECK(eval(lazy(m) * n * v) == m * n * v);
+}
+
+TEST_CASE("expr.mat_chain") {
+  const auto x = rotation_matrix(vec3d::pos_z(), to_radians(30.0)) *
+                 scaling_matrix(vec3d(2.0, 1.0, 0.5));
+  const auto a = vec3d(1.0, 2.0, 3.0);
+  const auto b = vec3d(-4.0, 5.0, 0.0);
+
+  const mat4x4d expected = translation_matrix(a) * x * translation_matrix(-b);
+  const mat4x4d actual = lazy(translation_matrix(a)) * x * translation_matrix(-b);
+  CHECK(actual == approx(expected));
+}
+} // namespace vm
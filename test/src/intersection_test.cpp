@@ -25,11 +25,16 @@
 #include <vecmath/forward.h>
 #include <vecmath/intersection.h>
 #include <vecmath/quat.h>
+#include <vecmath/ray_packet.h>
+#include <vecmath/ray_query.h>
 #include <vecmath/vec.h>
 #include <vecmath/vec_ext.h>
 #include <vecmath/vec_io.h>
 
 #include <array>
+#include <cstddef>
+#include <random>
+#include <tuple>
 
 #include <catch2/catch.hpp>
 
@@ -219,6 +224,129 @@ TEST_CASE("intersection.intersect_ray_bbox") {
   CHECK(intersect_ray_bbox(ray3f(origin, dir), bounds) == approx(length(diff)));
 }
 
+TEST_CASE("intersection.intersect_ray_bbox_query") {
+  constexpr auto bounds = bbox3f(vec3f(-12.0f, -3.0f, 4.0f), vec3f(8.0f, 9.0f, 8.0f));
+
+  const auto [missNear, missFar] =
+    intersect_ray_bbox(ray_query3f(ray3f(vec3f::zero(), vec3f::neg_z())), bounds);
+  CHECK(is_nan(missNear));
+  CHECK(is_nan(missFar));
+
+  const auto [hitNear, hitFar] =
+    intersect_ray_bbox(ray_query3f(ray3f(vec3f::zero(), vec3f::pos_z())), bounds);
+  CHECK(hitNear == approx(4.0f));
+  CHECK(hitFar == approx(8.0f));
+
+  const auto [insideNear, insideFar] =
+    intersect_ray_bbox(ray_query3f(ray3f(vec3f(0.0f, 0.0f, 5.0f), vec3f::pos_x())), bounds);
+  CHECK(insideNear == approx(-12.0f));
+  CHECK(insideFar == approx(8.0f));
+
+  // the origin lies on the min plane of the X slab and the ray is parallel to it
+  const auto [onPlaneNear, onPlaneFar] =
+    intersect_ray_bbox(ray_query3f(ray3f(vec3f(-12.0f, 0.0f, 0.0f), vec3f::pos_z())), bounds);
+  CHECK(onPlaneNear == approx(4.0f));
+  CHECK(onPlaneFar == approx(8.0f));
+
+  const auto [parallelNear, parallelFar] =
+    intersect_ray_bbox(ray_query3f(ray3f(vec3f(-13.0f, 0.0f, 0.0f), vec3f::pos_z())), bounds);
+  CHECK(is_nan(parallelNear));
+  CHECK(is_nan(parallelFar));
+
+  auto rng = std::mt19937(1u);
+  auto dist = std::uniform_real_distribution<double>(-10.0, 10.0);
+  const auto random_vec = [&]() { return vec3d(dist(rng), dist(rng), dist(rng)); };
+  for (std::size_t i = 0; i < 1000u; ++i) {
+    const auto r = ray3d(random_vec(), normalize(random_vec()));
+    const auto c1 = random_vec();
+    const auto c2 = random_vec();
+    const auto b = bbox3d(min(c1, c2), max(c1, c2));
+
+    const auto expected = intersect_ray_bbox(r, b);
+    const auto [tNear, tFar] = intersect_ray_bbox(ray_query3d(r), b);
+    CHECK(is_nan(expected) == is_nan(tNear));
+    if (!is_nan(expected)) {
+      CHECK((tNear >= 0.0 ? tNear : tFar) == approx(expected));
+    }
+  }
+}
+
+/**
+ * Checks that the given packet function computes the same distances as the given ray function for
+ * each lane of packets of random rays.
+ */
+template <typename T, std::size_t W, typename P, typename R>
+static void check_packet_intersection(const P& packet_function, const R& ray_function) {
+  auto rng = std::mt19937(2u);
+  auto dist = std::uniform_real_distribution<T>(-10, 10);
+  const auto random_vec = [&]() { return vec<T, 3>(dist(rng), dist(rng), dist(rng)); };
+  for (std::size_t i = 0; i < 200u; ++i) {
+    auto rays = std::vector<ray<T, 3>>();
+    // also check packets that do not fill all lanes
+    const auto count = i % W + 1u;
+    for (std::size_t j = 0; j < count; ++j) {
+      rays.emplace_back(random_vec(), normalize(random_vec()));
+    }
+
+    const auto packet = ray_packet<T, 3, W>(std::begin(rays), std::end(rays));
+    CHECK(packet.count == count);
+    const auto distances = packet_function(packet);
+    for (std::size_t j = 0; j < W; ++j) {
+      const auto expected = ray_function(rays[std::min(j, count - 1u)]);
+      CHECK(is_nan(distances[j]) == is_nan(expected));
+      if (!is_nan(expected)) {
+        CHECK(distances[j] == approx(expected, static_cast<T>(0.001)));
+      }
+    }
+  }
+}
+
+TEST_CASE("intersection.intersect_ray_packet_plane") {
+  const auto p = plane3d(vec3d(1, 2, 3), normalize(vec3d(1, 1, 0)));
+  check_packet_intersection<double, 4u>(
+    [&](const auto& packet) { return intersect_ray_plane(packet, p); },
+    [&](const auto& r) { return intersect_ray_plane(r, p); });
+
+  const auto pf = plane3f(p);
+  check_packet_intersection<float, 8u>(
+    [&](const auto& packet) { return intersect_ray_plane(packet, pf); },
+    [&](const auto& r) { return intersect_ray_plane(r, pf); });
+}
+
+TEST_CASE("intersection.intersect_ray_packet_triangle") {
+  const auto p1 = vec3d(-8, -6, 1);
+  const auto p2 = vec3d(9, -5, 2);
+  const auto p3 = vec3d(0, 8, -1);
+  check_packet_intersection<double, 4u>(
+    [&](const auto& packet) { return intersect_ray_triangle(packet, p1, p2, p3); },
+    [&](const auto& r) { return intersect_ray_triangle(r, p1, p2, p3); });
+
+  const auto p1f = vec3f(p1), p2f = vec3f(p2), p3f = vec3f(p3);
+  check_packet_intersection<float, 8u>(
+    [&](const auto& packet) { return intersect_ray_triangle(packet, p1f, p2f, p3f); },
+    [&](const auto& r) { return intersect_ray_triangle(r, p1f, p2f, p3f); });
+
+  // a ray parallel to the triangle
+  const auto parallel = ray_packet4d(ray3d(vec3d(0, 0, 10), vec3d::pos_x()));
+  CHECK(is_nan(intersect_ray_triangle(parallel, p1, p2, p3)[0]));
+}
+
+TEST_CASE("intersection.intersect_ray_packet_bbox") {
+  const auto b = bbox3d(vec3d(-3, -2, -1), vec3d(4, 2, 5));
+  check_packet_intersection<double, 4u>(
+    [&](const auto& packet) { return intersect_ray_bbox(packet, b); },
+    [&](const auto& r) { return intersect_ray_bbox(r, b); });
+
+  const auto bf = bbox3f(b);
+  check_packet_intersection<float, 8u>(
+    [&](const auto& packet) { return intersect_ray_bbox(packet, bf); },
+    [&](const auto& r) { return intersect_ray_bbox(r, bf); });
+
+  // the origin lies on the min plane of the X slab and the ray is parallel to it
+  const auto onPlane = ray_packet4d(ray3d(vec3d(-3, 0, -4), vec3d::pos_z()));
+  CHECK(intersect_ray_bbox(onPlane, b)[0] == approx(3.0));
+}
+
 TEST_CASE("intersection.intersect_ray_sphere") {
   const ray3f ray(vec3f::zero(), vec3f::pos_z());
 
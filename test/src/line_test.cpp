@@ -20,6 +20,7 @@
 
 #include "test_utils.h"
 
+#include <vecmath/affine.h>
 #include <vecmath/approx.h>
 #include <vecmath/forward.h>
 #include <vecmath/line.h>
@@ -27,6 +28,7 @@
 #include <vecmath/mat.h>
 #include <vecmath/mat_ext.h>
 #include <vecmath/scalar.h>
+#include <vecmath/transformation.h>
 
 #include <sstream>
 
@@ -86,6 +88,35 @@ TEST_CASE("line.transform_c") {
   CHECK(lt.direction == approx(normalize_c(sm * l.direction)));
 }
 
+TEST_CASE("line.transform_affine") {
+  const auto l = line3d(vec3d::one(), vec3d::pos_z());
+  const auto m = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0)) *
+                 translation_matrix(vec3d::one());
+
+  const auto lt = l.transform(affine3d(m));
+  CHECK(lt.point == approx(l.transform(m).point));
+  CHECK(lt.direction == approx(l.transform(m).direction));
+
+  constexpr auto sm = scaling_matrix(vec3d(2.0, 0.5, -2.0));
+  constexpr auto tm = translation_matrix(vec3d::one());
+  constexpr auto lc = line3d(vec3d::one(), vec3d::pos_z()).transform_c(affine3d(sm * tm));
+  CER_CHECK(lc.point == approx(sm * tm * vec3d::one()));
+  CER_CHECK(lc.direction == approx(vec3d::neg_z()));
+}
+
+TEST_CASE("line.transform_transformation") {
+  const auto l = line3d(vec3d::one(), normalize(vec3d(1, 2, 3)));
+  const auto rm = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0));
+  const auto tm = translation_matrix(vec3d(1, 2, 3));
+  const auto sm = scaling_matrix(vec3d(2.0, 0.5, -2.0));
+  const auto pm = mat4x4d(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0.01, 1);
+  for (const auto& m : {mat4x4d::identity(), tm, rm * tm, sm * tm, pm}) {
+    const auto lt = l.transform(transformation3d(m));
+    CHECK(lt.point == approx(l.transform(m).point));
+    CHECK(lt.direction == approx(l.transform(m).direction));
+  }
+}
+
 TEST_CASE("line.make_canonical") {
   constexpr auto l1 = line3d(vec3d(-10, 0, 10), vec3d::pos_x());
   constexpr auto l2 = line3d(vec3d(+10, 0, 10), vec3d::pos_x());
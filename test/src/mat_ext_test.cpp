@@ -30,6 +30,9 @@
 
 #include <cstdlib>
 #include <ctime>
+#include <iterator>
+#include <list>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -162,6 +165,52 @@ TEST_CASE("mat_ext.operator_multiply_array_left_lower_dimension") {
   CER_CHECK(o[2] == approx(r[2]));
 }
 
+TEST_CASE("mat_ext.multiply_vectors") {
+  // 11 vectors, so that the SIMD loop processes full registers as well as the remaining vectors
+  std::vector<vec3d> points;
+  std::vector<vec4d> vectors;
+  for (std::size_t i = 0u; i < 11u; ++i) {
+    const auto d = static_cast<double>(i);
+    points.emplace_back(d, 2.0 - d, 0.5 * d);
+    vectors.emplace_back(d, 2.0 - d, 0.5 * d, 1.0 + d);
+  }
+
+  constexpr auto m = mat4x4d(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 0.1, 0.2, 0.3, 1);
+
+  std::vector<vec3d> pointResult;
+  std::vector<vec4d> vectorResult;
+  multiply(m, points, pointResult);
+  multiply(m, vectors, vectorResult);
+  REQUIRE(pointResult.size() == points.size());
+  REQUIRE(vectorResult.size() == vectors.size());
+  for (std::size_t i = 0u; i < points.size(); ++i) {
+    CHECK(pointResult[i] == approx(m * points[i]));
+    CHECK(vectorResult[i] == approx(m * vectors[i]));
+  }
+
+  multiply(points, m, pointResult);
+  multiply(vectors, m, vectorResult);
+  for (std::size_t i = 0u; i < points.size(); ++i) {
+    CHECK(pointResult[i] == approx(points[i] * m));
+    CHECK(vectorResult[i] == approx(vectors[i] * m));
+  }
+
+  auto inPlace = points;
+  multiply(m, inPlace, inPlace);
+  for (std::size_t i = 0u; i < points.size(); ++i) {
+    CHECK(inPlace[i] == approx(m * points[i]));
+  }
+
+  // output iterators that are not pointers are written one vector at a time
+  const auto list = std::list<vec3d>(std::begin(points), std::end(points));
+  std::vector<vec3d> appended;
+  multiply(m, std::begin(list), std::end(list), std::back_inserter(appended));
+  REQUIRE(appended.size() == points.size());
+  for (std::size_t i = 0u; i < points.size(); ++i) {
+    CHECK(appended[i] == approx(m * points[i]));
+  }
+}
+
 TEST_CASE("mat_ext.rotation_matrix_with_euler_angles") {
   CHECK(rotation_matrix(to_radians(90.0), 0.0, 0.0) == approx(mat4x4d::rot_90_x_ccw()));
   CHECK(rotation_matrix(0.0, to_radians(90.0), 0.0) == approx(mat4x4d::rot_90_y_ccw()));
@@ -289,6 +338,29 @@ TEST_CASE("mat_ext.shear_matrix") {
   CER_CHECK(shear_matrix(1.0, 1.0, 0.0, 0.0, 0.0, 0.0) * vec3d::zero() == vec3d(0, 0, 0));
 }
 
+TEST_CASE("mat.points_transformation_matrix_4_points") {
+  const vec3d in[4] = {{2.0, 0.0, 0.0}, {4.0, 0.0, 0.0}, {2.0, 2.0, 0.0}, {1.0, 3.0, 5.0}};
+
+  const auto M = translation_matrix(vec3d(100.0, -50.0, 25.0)) *
+                 scaling_matrix(vec3d(2.0, 0.5, 3.0)) *
+                 rotation_matrix(normalize(vec3d(1.0, 2.0, 3.0)), to_radians(35.0)) *
+                 shear_matrix(0.5, 0.0, 0.0, 0.25, 0.0, 0.0);
+
+  vec3d out[4];
+  for (size_t i = 0; i < 4; ++i) {
+    out[i] = M * in[i];
+  }
+
+  const auto M2 =
+    points_transformation_matrix(in[0], in[1], in[2], in[3], out[0], out[1], out[2], out[3]);
+  CHECK(is_equal(M2, M, 1e-9));
+
+  // the input points are coplanar, so there is no unique transformation
+  const auto M3 =
+    points_transformation_matrix(in[0], in[1], in[2], in[0], out[0], out[1], out[2], out[3]);
+  CHECK(is_nan(M3[0][0]));
+}
+
 TEST_CASE("mat.points_transformation_matrix") {
   const vec3d in[3] = {{2.0, 0.0, 0.0}, {4.0, 0.0, 0.0}, {2.0, 2.0, 0.0}};
 
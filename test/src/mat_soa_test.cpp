@@ -0,0 +1,237 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_io.h>
+#include <vecmath/mat_soa.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_io.h>
+#include <vecmath/vec_soa.h>
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+// 11 systems, so that the batch operations process full SIMD registers as well as the remaining
+// elements for every register width; the systems with index 2 and 9 are singular, and the systems
+// with index 1 and 5 require row swaps
+static std::vector<mat3x3d> soa_test_mats() {
+  return {
+    mat3x3d(2.0, 1.0, 0.0, 1.0, 3.0, 1.0, 0.0, 1.0, 4.0),
+    mat3x3d(0.0, 2.0, 1.0, 1.0, 0.0, 3.0, 4.0, 1.0, 0.0),
+    mat3x3d(1.0, 2.0, 3.0, 2.0, 4.0, 6.0, 1.0, 0.0, 1.0),
+    mat3x3d::identity(),
+    mat3x3d(5.0, -1.0, 2.0, 0.5, 3.0, -2.0, 1.0, 1.0, 7.0),
+    mat3x3d(0.0, 0.0, 1.0, 0.0, 1.0, 0.0, 1.0, 0.0, 0.0),
+    mat3x3d(-3.0, 2.0, 1.0, 2.0, -4.0, 0.5, 1.0, 1.0, -6.0),
+    mat3x3d(10.0, 0.0, 0.0, 0.0, 0.1, 0.0, 0.0, 0.0, 100.0),
+    mat3x3d(1.0, 1.0, 1.0, 1.0, 2.0, 4.0, 1.0, 3.0, 9.0),
+    mat3x3d::zero(),
+    mat3x3d(0.25, -8.0, 3.0, 6.0, 1.0, -1.0, 2.0, 2.0, 2.0)};
+}
+
+static std::vector<vec3d> soa_test_rhs() {
+  return {
+    vec3d(1.0, 2.0, 3.0),   vec3d(-1.0, 0.5, 2.0),  vec3d(0.0, 0.0, 1.0),  vec3d(3.0, -4.0, 0.0),
+    vec3d(7.5, 1.25, -2.0), vec3d(-8.0, 6.0, 4.0),  vec3d(0.1, 0.2, 0.3),  vec3d(10.0, 0.0, -1.0),
+    vec3d(2.0, 3.0, 5.0),   vec3d(-0.5, 4.0, 1.5),  vec3d(6.0, -2.0, 9.0)};
+}
+
+// the matrices with index 3 and 8 are singular, and the matrix with index 6 is invertible, but its
+// determinant is too small for the closed form inverse
+static std::vector<mat4x4d> soa_test_mats4() {
+  return {
+    mat4x4d(2.0, 1.0, 0.0, 3.0, 1.0, 3.0, 1.0, -1.0, 0.0, 1.0, 4.0, 2.0, 0.5, 0.0, 1.0, 5.0),
+    mat4x4d::identity(),
+    mat4x4d(0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0),
+    mat4x4d(1.0, 2.0, 3.0, 4.0, 2.0, 4.0, 6.0, 8.0, 0.0, 1.0, 0.0, 1.0, 5.0, 6.0, 7.0, 8.0),
+    mat4x4d(1.0, 0.0, 0.0, 10.0, 0.0, 2.0, 0.0, -5.0, 0.0, 0.0, 0.5, 3.0, 0.0, 0.0, 0.0, 1.0),
+    mat4x4d(-3.0, 2.0, 1.0, 0.0, 2.0, -4.0, 0.5, 1.0, 1.0, 1.0, -6.0, 2.0, 0.0, 3.0, 1.0, 1.0),
+    mat4x4d(
+      1.0e-5, 0.0, 0.0, 0.0, 0.0, 1.0e-5, 0.0, 0.0, 0.0, 0.0, 1.0e-5, 0.0, 0.0, 0.0, 0.0, 1.0e-5),
+    mat4x4d(1.0, 1.0, 1.0, 1.0, 1.0, 2.0, 4.0, 8.0, 1.0, 3.0, 9.0, 27.0, 1.0, 4.0, 16.0, 64.0),
+    mat4x4d::zero(),
+    mat4x4d(0.25, -8.0, 3.0, 1.0, 6.0, 1.0, -1.0, 0.0, 2.0, 2.0, 2.0, 2.0, 0.0, 1.0, 0.0, -1.0),
+    mat4x4d(5.0, -1.0, 2.0, 7.0, 0.5, 3.0, -2.0, 1.0, 1.0, 1.0, 7.0, -3.0, 2.0, 0.0, 1.0, 4.0)};
+}
+
+TEST_CASE("mat_soa.constructor_with_size") {
+  const auto m = mat_soa<float, 2, 3>(4u);
+  CHECK(m.size() == 4u);
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    CHECK(m[i] == mat<float, 2, 3>::zero());
+  }
+}
+
+TEST_CASE("mat_soa.constructor_with_vector") {
+  const auto mats = soa_test_mats();
+  const auto m = mat_soa<double, 3, 3>(mats);
+  CHECK(m.size() == mats.size());
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    CHECK(m[i] == mats[i]);
+    CHECK(m.data(1, 0)[i] == mats[i][1][0]);
+    CHECK(m.data(0, 2)[i] == mats[i][0][2]);
+  }
+  CHECK(m.to_vector() == mats);
+}
+
+TEST_CASE("mat_soa.modifiers") {
+  auto m = mat_soa<double, 3, 3>();
+  CHECK(m.empty());
+  m.push_back(mat3x3d::identity());
+  m.push_back(mat3x3d::zero());
+  CHECK(m.size() == 2u);
+  CHECK(m[0] == mat3x3d::identity());
+
+  m.set(1u, mat3x3d(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0));
+  CHECK(m[1] == mat3x3d(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0));
+
+  m.resize(3u);
+  CHECK(m[2] == mat3x3d::zero());
+
+  CHECK(m == m);
+  CHECK(m != mat_soa<double, 3, 3>());
+
+  m.clear();
+  CHECK(m.empty());
+}
+
+TEST_CASE("mat_soa.lup_solve") {
+  const auto mats = soa_test_mats();
+  const auto rhs = soa_test_rhs();
+
+  vec_soa<double, 3> x;
+  std::vector<bool> success;
+  lup_solve(mat_soa<double, 3, 3>(mats), vec_soa<double, 3>(rhs), x, success);
+  REQUIRE(x.size() == mats.size());
+  REQUIRE(success.size() == mats.size());
+
+  for (std::size_t i = 0; i < mats.size(); ++i) {
+    const auto expected = lup_solve(mats[i], rhs[i]);
+    CHECK(success[i] == std::get<0>(expected));
+    if (success[i]) {
+      CHECK(is_equal(x[i], std::get<1>(expected), 1.0e-12));
+      CHECK(is_equal(mats[i] * x[i], rhs[i], 1.0e-12));
+    }
+  }
+  CHECK_FALSE(success[2]);
+  CHECK_FALSE(success[9]);
+}
+
+TEST_CASE("mat_soa.lup_solve_float") {
+  const auto mats = soa_test_mats();
+  const auto rhs = soa_test_rhs();
+
+  auto matsf = mat_soa<float, 3, 3>();
+  auto rhsf = vec_soa<float, 3>();
+  for (std::size_t i = 0; i < mats.size(); ++i) {
+    matsf.push_back(mat3x3f(mats[i]));
+    rhsf.push_back(vec3f(rhs[i]));
+  }
+
+  const auto [success, x] = lup_solve(matsf, rhsf);
+  REQUIRE(x.size() == mats.size());
+  for (std::size_t i = 0; i < mats.size(); ++i) {
+    const auto expected = lup_solve(matsf[i], rhsf[i]);
+    CHECK(success[i] == std::get<0>(expected));
+    if (success[i]) {
+      CHECK(is_equal(x[i], std::get<1>(expected), 1.0e-5f));
+    }
+  }
+}
+
+TEST_CASE("mat_soa.lup_solve_empty") {
+  const auto [success, x] = lup_solve(mat_soa<double, 4, 4>(), vec_soa<double, 4>());
+  CHECK(success.empty());
+  CHECK(x.empty());
+}
+
+TEST_CASE("mat_soa.invert") {
+  const auto mats = soa_test_mats4();
+
+  mat_soa<double, 4, 4> result;
+  std::vector<bool> invertible;
+  invert(mat_soa<double, 4, 4>(mats), result, invertible);
+  REQUIRE(result.size() == mats.size());
+  REQUIRE(invertible.size() == mats.size());
+
+  for (std::size_t i = 0; i < mats.size(); ++i) {
+    const auto expected = invert(mats[i]);
+    CHECK(invertible[i] == std::get<0>(expected));
+    CHECK(is_equal(result[i], std::get<1>(expected), 1.0e-9));
+  }
+  CHECK_FALSE(invertible[3]);
+  CHECK_FALSE(invertible[8]);
+  CHECK(invertible[6]);
+  CHECK(result[3] == mat4x4d::identity());
+}
+
+TEST_CASE("mat_soa.invert_in_place") {
+  const auto mats = soa_test_mats4();
+
+  auto soa = mat_soa<double, 4, 4>(mats);
+  std::vector<bool> invertible;
+  invert(soa, soa, invertible);
+
+  auto aos = mats;
+  invert(aos, aos, invertible);
+
+  for (std::size_t i = 0; i < mats.size(); ++i) {
+    const auto expected = std::get<1>(invert(mats[i]));
+    CHECK(is_equal(soa[i], expected, 1.0e-9));
+    CHECK(is_equal(aos[i], expected, 1.0e-9));
+  }
+}
+
+TEST_CASE("mat_soa.invert_float_array") {
+  const auto matsd = soa_test_mats4();
+  std::vector<mat4x4f> mats;
+  for (const auto& m : matsd) {
+    mats.push_back(mat4x4f(m));
+  }
+
+  std::vector<mat4x4f> result;
+  std::vector<bool> invertible;
+  invert(mats, result, invertible);
+  REQUIRE(result.size() == mats.size());
+
+  for (std::size_t i = 0; i < mats.size(); ++i) {
+    const auto expected = invert(mats[i]);
+    CHECK(invertible[i] == std::get<0>(expected));
+    CHECK(is_equal(result[i], std::get<1>(expected), 1.0e-3f));
+  }
+}
+
+TEST_CASE("mat_soa.invert_lup") {
+  const auto mats = soa_test_mats();
+  const auto [invertible, result] = invert(mat_soa<double, 3, 3>(mats));
+  REQUIRE(result.size() == mats.size());
+
+  for (std::size_t i = 0; i < mats.size(); ++i) {
+    const auto expected = invert(mats[i]);
+    CHECK(invertible[i] == std::get<0>(expected));
+    CHECK(is_equal(result[i], std::get<1>(expected), 1.0e-12));
+  }
+}
+} // namespace vm
@@ -21,6 +21,7 @@
 #include <vecmath/approx.h>
 #include <vecmath/forward.h>
 #include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
 #include <vecmath/mat_io.h>
 #include <vecmath/vec.h>
 #include <vecmath/vec_io.h>
@@ -28,6 +29,7 @@
 #include "test_utils.h"
 
 #include <sstream>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -391,6 +393,34 @@ TEST_CASE("mat.operator_multiply_vector_left") {
     to_cartesian_coords(exp));
 }
 
+template <typename T> static void check_simd_kernels_match_scalar() {
+  // the constexpr results are computed by the scalar path, the runtime results by the SIMD kernels
+  // if VM_ENABLE_SIMD is defined; all products and sums are exact so that contracting them into
+  // fused multiply-adds cannot change the results
+  constexpr auto a =
+    mat<T, 4, 4>(1.5, -2, 0.25, 4, -0.0, 6, -7, 8, 9, 0.5, 11, -12, 13, 14, -1.5, 16);
+  constexpr auto b = mat<T, 4, 4>(-3, 2, 0, 1, 0.5, -1, 4, 2, 8, 0.75, -2, 3, 1, 0, 5, -0.5);
+  constexpr auto v = vec<T, 4>(T(2), T(-0.5), T(3), T(1));
+  constexpr auto v3 = vec<T, 3>(T(2), T(-0.5), T(3));
+
+  constexpr auto ab = a * b;
+  constexpr auto ba = b * a;
+  constexpr auto av = a * v;
+  constexpr auto bv3 = b * v3;
+  constexpr auto vb = v * b;
+
+  CHECK(a * b == ab);
+  CHECK(b * a == ba);
+  CHECK(a * v == av);
+  CHECK(b * v3 == bv3);
+  CHECK(v * b == vb);
+}
+
+TEST_CASE("mat.simd_kernels_match_scalar") {
+  check_simd_kernels_match_scalar<float>();
+  check_simd_kernels_match_scalar<double>();
+}
+
 TEST_CASE("mat.set") {
   CER_CHECK(
     set(mat4x4d(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16), 0, 0, 0.0) ==
@@ -448,6 +478,60 @@ TEST_CASE("mat.compute_determinant") {
   CER_CHECK(compute_determinant(m3) == approx(-418.0));
 }
 
+TEST_CASE("mat.compute_determinant_lup") {
+  constexpr auto m1 = mat<double, 5, 5>{
+    0, 2, -1, 4, 3, 2, 1, 5, 7, 0, 0, 5, 2, -6, 1, -1, 2, 1, 0, 4, 3, 0, -2, 1, 1};
+  constexpr auto m2 = mat<double, 5, 5>{
+    0, 2, -1, 4, 3, 2, 1, 5, 7, 0, 0, 5, 2, -6, 1, 2, 1, 5, 7, 0, 3, 0, -2, 1, 1};
+  // permutation matrices require row swaps and must yield the sign of the permutation
+  constexpr auto m3 = mat<double, 6, 6>{0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0,
+                                        0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 2};
+  constexpr auto m4 = mat<double, 6, 6>{0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0,
+                                        0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0};
+
+  CER_CHECK(compute_determinant(mat<double, 5, 5>::zero()) == approx(0.0));
+  CER_CHECK(compute_determinant(mat<double, 5, 5>::identity()) == approx(1.0));
+  CER_CHECK(compute_determinant(m1) == approx(-2296.0));
+  CER_CHECK(compute_determinant(m2) == approx(0.0));
+  CER_CHECK(compute_determinant(m3) == approx(-2.0));
+  CER_CHECK(compute_determinant(m4) == approx(-1.0));
+  CER_CHECK(compute_determinant(transpose(m1)) == approx(-2296.0));
+}
+
+TEST_CASE("mat.compute_determinant_small_scale") {
+  // regular matrices with pivots below the threshold of lup_find_decomposition
+  constexpr auto m1 = mat<double, 5, 5>{
+    1e-16, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1};
+  constexpr auto m2 = mat<double, 5, 5>{
+    0, 2, -1, 4, 3, 2, 1, 5, 7, 0, 0, 5, 2, -6, 1, -1, 2, 1, 0, 4, 3, 0, -2, 1, 1};
+
+  CER_CHECK(compute_determinant(m1) == 1e-16);
+  CER_CHECK(compute_determinant(mat<double, 5, 5>::identity() * 1e-4) == approx(1e-20, 1e-30));
+  CER_CHECK(compute_determinant(m2 * 1e-4) / 1e-20 == approx(-2296.0, 1e-9));
+}
+
+TEST_CASE("mat.compute_determinant_matches_laplace") {
+  // expand along the first column and compare with the determinants of the minors
+  const auto laplace = [](const auto& m) {
+    auto result = 0.0;
+    for (std::size_t r = 0; r < 5u; ++r) {
+      const auto f = r % 2 == 0 ? 1.0 : -1.0;
+      result += f * m[0][r] * compute_determinant(extract_minor(m, r, 0));
+    }
+    return result;
+  };
+
+  for (std::size_t i = 1u; i < 10u; ++i) {
+    auto m = mat<double, 5, 5>();
+    for (std::size_t c = 0u; c < 5u; ++c) {
+      for (std::size_t r = 0u; r < 5u; ++r) {
+        m[c][r] = static_cast<double>((i * 7u + c * 5u + r * r * 3u + c * r) % 11u) - 5.0;
+      }
+    }
+    CHECK(compute_determinant(m) == approx(laplace(m), 1e-9));
+  }
+}
+
 TEST_CASE("mat.compute_adjugate") {
   constexpr auto m1 = mat4x4d(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
   constexpr auto m2 = mat4x4d(65, 12, -3, -5, -5, 1, 0, 0, 19, 10, 11, 8, 0, 1, -8, 3);
@@ -494,6 +578,79 @@ TEST_CASE("mat.invert") {
   CER_CHECK_NOT_INVERTIBLE(m1)
 }
 
+TEST_CASE("mat.invert_closed_form") {
+  constexpr auto m2 = mat2x2d(4, 7, 2, 6);
+  constexpr auto r2 = mat2x2d(0.6, -0.7, -0.2, 0.4);
+  constexpr auto m3 = mat3x3d(3, 0, 2, 2, 0, -2, 0, 1, 1);
+  constexpr auto r3 = mat3x3d(0.2, 0.2, 0, -0.2, 0.3, 1, 0.2, -0.3, 0);
+  constexpr auto m4 = mat4x4d(65, 12, -3, -5, -5, 1, 0, 0, 19, 10, 11, 8, 0, 1, -8, 3);
+
+  CER_CHECK_INVERTIBLE(r2, m2)
+  CER_CHECK_INVERTIBLE(r3, m3)
+  CER_CHECK_INVERTIBLE(std::get<1>(detail::invert_lup(m4)), m4)
+  CER_CHECK_NOT_INVERTIBLE(mat2x2d(1, 2, 2, 4))
+  CER_CHECK_NOT_INVERTIBLE(mat3x3d(1, 2, 3, 4, 5, 6, 7, 8, 9))
+
+  // nearly singular matrices are left to the LUP decomposition
+  CER_CHECK_FALSE(std::get<0>(detail::invert_closed_form(mat2x2d(1e-8, 0, 0, 1e-8))))
+  CER_CHECK_INVERTIBLE(mat2x2d(1e8, 0, 0, 1e8), mat2x2d(1e-8, 0, 0, 1e-8))
+}
+
+TEST_CASE("mat.invert_matches_lup") {
+  // non affine matrices
+  const auto matrices = std::vector<mat4x4d>{
+    mat4x4d(3, 2, -1, 4, 2, 1, 5, 7, 0, 5, 2, -6, -1, 2, 1, 0),
+    mat4x4d(1, 0.5, 0.25, 0.125, 0.5, 1, 0.5, 0.25, 0.25, 0.5, 1, 0.5, 0.125, 0.25, 0.5, 1),
+    perspective_matrix(90.0, 1.0, 1000.0, 1024, 768),
+  };
+
+  for (const auto& m : matrices) {
+    const auto expected = detail::invert_lup(m);
+    const auto actual = invert(m);
+    REQUIRE(std::get<0>(expected));
+    CHECK(std::get<0>(actual));
+    CHECK(is_equal(std::get<1>(actual), std::get<1>(expected), 1e-9));
+    CHECK(is_equal(m * std::get<1>(actual), mat4x4d::identity(), 1e-9));
+  }
+}
+
+TEST_CASE("mat.is_affine") {
+  constexpr auto m1 = mat4x4d(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 0, 0, 0, 1);
+  constexpr auto m2 = mat4x4d(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 0, 0, 1, 1);
+  constexpr auto m3 = mat4x4d(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 0, 0, 0, 2);
+
+  CER_CHECK(is_affine(mat4x4d::identity()))
+  CER_CHECK(is_affine(m1))
+  CER_CHECK_FALSE(is_affine(m2))
+  CER_CHECK_FALSE(is_affine(m3))
+  CER_CHECK_FALSE(is_affine(mat4x4d::zero()))
+}
+
+TEST_CASE("mat.invert_affine") {
+  const auto m = translation_matrix(vec3d(1, -2, 3)) *
+                 rotation_matrix(normalize(vec3d(1, 2, 3)), to_radians(30.0)) *
+                 scaling_matrix(vec3d(2, 0.5, 4));
+  REQUIRE(is_affine(m));
+
+  const auto affine = invert_affine(m);
+  const auto lup = detail::invert_lup(m);
+  CHECK(std::get<0>(affine));
+  CHECK(is_equal(std::get<1>(affine), std::get<1>(lup), 1e-12));
+  CHECK(is_equal(m * std::get<1>(affine), mat4x4d::identity(), 1e-12));
+  CHECK(is_affine(std::get<1>(affine)));
+
+  // the scaling is singular
+  const auto singular = translation_matrix(vec3d(1, -2, 3)) * scaling_matrix(vec3d(2, 0, 4));
+  CHECK_FALSE(std::get<0>(invert_affine(singular)));
+  CHECK_FALSE(std::get<0>(invert(singular)));
+
+  constexpr auto m2 = mat3x3d(0, -1, 5, 1, 0, -3, 0, 0, 1);
+  constexpr auto r2 = mat3x3d(0, 1, 3, -1, 0, 5, 0, 0, 1);
+  CER_CHECK(std::get<0>(invert_affine(m2)))
+  CER_CHECK(std::get<1>(invert_affine(m2)) == approx(r2))
+  CER_CHECK_INVERTIBLE(r2, m2)
+}
+
 TEST_CASE("mat.lup_solve") {
   constexpr auto A = mat4x4d(
     0.93629336358419923, -0.27509584731824366, 0.21835066314633442, 87.954817941228995,
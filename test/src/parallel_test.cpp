@@ -0,0 +1,209 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/approx.h>
+#include <vecmath/bbox.h>
+#include <vecmath/bbox_io.h>
+#include <vecmath/convex_hull.h>
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/mat_io.h>
+#include <vecmath/parallel.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_io.h>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+static std::vector<vec3d> random_points(const std::size_t count) {
+  auto rng = std::mt19937(1u);
+  auto dist = std::uniform_real_distribution<double>(-100.0, 100.0);
+
+  std::vector<vec3d> result;
+  for (std::size_t i = 0u; i < count; ++i) {
+    result.emplace_back(dist(rng), dist(rng), dist(rng));
+  }
+  return result;
+}
+
+TEST_CASE("parallel.thread_executor") {
+  const auto executor = thread_executor(4u);
+  CHECK(executor.concurrency() == 4u);
+  CHECK(thread_executor().concurrency() >= 1u);
+
+  std::vector<std::atomic<int>> calls(100u);
+  executor.run(calls.size(), [&](const std::size_t i) { ++calls[i]; });
+  for (const auto& c : calls) {
+    CHECK(c == 1);
+  }
+
+  CHECK_THROWS_AS(
+    executor.run(
+      100u,
+      [](const std::size_t i) {
+        if (i == 42u) {
+          throw std::runtime_error("task failed");
+        }
+      }),
+    std::runtime_error);
+
+  // the executor can be used again after a task has failed
+  executor.run(calls.size(), [&](const std::size_t i) { ++calls[i]; });
+  for (const auto& c : calls) {
+    CHECK(c == 2);
+  }
+}
+
+TEST_CASE("parallel.thread_executor_pool") {
+  const auto executor = thread_executor(4u);
+  const auto copy = executor;
+
+  // the threads are kept between calls and shared by the copies of the executor
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  for (std::size_t i = 0u; i < 50u; ++i) {
+    const auto& e = i % 2u == 0u ? executor : copy;
+    e.run(20u, [&](const std::size_t) {
+      const auto lock = std::lock_guard<std::mutex>(mutex);
+      threads.insert(std::this_thread::get_id());
+    });
+  }
+  CHECK(threads.size() <= executor.concurrency());
+
+  // a call from a task runs on the calling thread
+  std::vector<std::atomic<int>> calls(100u);
+  std::atomic<bool> sameThread(true);
+  executor.run(10u, [&](const std::size_t i) {
+    const auto thread = std::this_thread::get_id();
+    executor.run(10u, [&](const std::size_t j) {
+      if (std::this_thread::get_id() != thread) {
+        sameThread = false;
+      }
+      ++calls[10u * i + j];
+    });
+  });
+  CHECK(sameThread);
+  for (const auto& c : calls) {
+    CHECK(c == 1);
+  }
+}
+
+TEST_CASE("parallel.parallel_policy") {
+  const auto policy = parallel_policy<sequential_executor>(sequential_executor(), 10u);
+  CHECK(policy.chunk_size() == 10u);
+  CHECK(policy.chunk_count(0u) == 0u);
+  CHECK(policy.chunk_count(10u) == 1u);
+  CHECK(policy.chunk_count(11u) == 2u);
+  CHECK(parallel_policy<>().chunk_size() == parallel_policy<>::default_chunk_size);
+}
+
+TEST_CASE("parallel.average") {
+  const auto points = random_points(1000u);
+  const auto serial = average(std::begin(points), std::end(points));
+
+  const auto sequential = average(
+    parallel_policy<sequential_executor>(sequential_executor(), 7u),
+    std::begin(points),
+    std::end(points));
+  CHECK(sequential == approx(serial));
+
+  // the result is bit-identical for every number of threads
+  for (std::size_t threads = 1u; threads <= 4u; ++threads) {
+    const auto policy = parallel_policy<>(thread_executor(threads), 7u);
+    CHECK(average(policy, std::begin(points), std::end(points)) == sequential);
+  }
+
+  // a transformation function is applied to each element
+  const auto doubled = average(
+    parallel_policy<>(thread_executor(4u), 7u),
+    std::begin(points),
+    std::end(points),
+    [](const vec3d& p) { return 2.0 * p; });
+  CHECK(doubled == approx(2.0 * serial));
+}
+
+TEST_CASE("parallel.average_error") {
+  // summing many values of similar magnitude one by one loses precision as the sum grows
+  const auto points = std::vector<vec3f>(1u << 20u, vec3f(1.1f, 2.2f, 3.3f));
+  const auto serial = average(std::begin(points), std::end(points));
+  const auto pairwise = average(parallel_policy<>(), std::begin(points), std::end(points));
+
+  const auto expected = vec3d(vec3f(1.1f, 2.2f, 3.3f));
+  CHECK(squared_length(vec3d(pairwise) - expected) < squared_length(vec3d(serial) - expected));
+  CHECK(is_equal(pairwise, vec3f(1.1f, 2.2f, 3.3f), 1.0e-5f));
+}
+
+TEST_CASE("parallel.merge_all") {
+  const auto points = random_points(1000u);
+  const auto policy = parallel_policy<>(thread_executor(4u), 7u);
+
+  const auto serial = bbox3d::merge_all(std::begin(points), std::end(points));
+  CHECK(merge_all(policy, std::begin(points), std::end(points)) == serial);
+  CHECK(
+    merge_all(policy, points.data(), points.data() + 5u) ==
+    bbox3d::merge_all(points.data(), points.data() + 5u));
+
+  // a transformation function is applied to each element
+  const auto twice = [](const vec3d& p) { return 2.0 * p; };
+  CHECK(
+    merge_all(policy, std::begin(points), std::end(points), twice) ==
+    bbox3d::merge_all(std::begin(points), std::end(points), twice));
+}
+
+TEST_CASE("parallel.multiply") {
+  const auto points = random_points(1000u);
+  const auto m = translation_matrix(vec3d(1, 2, 3)) * scaling_matrix(vec3d(2, 0.5, 3));
+  const auto policy = parallel_policy<>(thread_executor(4u), 7u);
+
+  std::vector<vec3d> serial, result;
+  multiply(m, points, serial);
+  multiply(policy, m, points, result);
+  CHECK(result == serial);
+
+  multiply(points, m, serial);
+  multiply(policy, points, m, result);
+  CHECK(result == serial);
+}
+
+TEST_CASE("parallel.convex_hull") {
+  auto points = random_points(1000u);
+  for (auto& p : points) {
+    p[2] = 0.0;
+  }
+  // a chunk of colinear points has no hull, but its points must still be considered
+  points[21] = vec3d(500, 500, 0);
+  points[22] = vec3d(600, 600, 0);
+  points[23] = vec3d(700, 700, 0);
+
+  const auto serial = convex_hull(points);
+  CHECK(convex_hull(parallel_policy<>(thread_executor(4u), 3u), points) == serial);
+  CHECK(convex_hull(parallel_policy<>(thread_executor(4u), 100u), points) == serial);
+}
+} // namespace vm
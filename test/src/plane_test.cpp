@@ -18,6 +18,7 @@
  OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <vecmath/affine.h>
 #include <vecmath/approx.h>
 #include <vecmath/constexpr_util.h>
 #include <vecmath/forward.h>
@@ -26,6 +27,7 @@
 #include <vecmath/plane.h>
 #include <vecmath/plane_io.h>
 #include <vecmath/scalar.h>
+#include <vecmath/transformation.h>
 #include <vecmath/vec.h>
 #include <vecmath/vec_io.h>
 
@@ -33,6 +35,7 @@
 
 #include <array>
 #include <sstream>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -157,6 +160,78 @@ TEST_CASE("plane.transform_c") {
   CHECK(pt.normal == approx(normalize_c(sm * p.normal)));
 }
 
+TEST_CASE("plane.transform_affine") {
+  const auto p = plane3d(vec3d::one(), vec3d::pos_z());
+  const auto m = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0)) *
+                 translation_matrix(vec3d::one());
+
+  const auto pt = p.transform(affine3d(m));
+  CHECK(pt.normal == approx(p.transform(m).normal));
+  CHECK(pt.distance == approx(p.transform(m).distance));
+
+  constexpr auto c = affine3d(scaling_matrix(vec3d(2.0, 0.5, 3.0)));
+  constexpr auto ptc = plane3d(vec3d::one(), vec3d::pos_z()).transform_c(c);
+  CER_CHECK(ptc.normal == approx(vec3d::pos_z()));
+  CER_CHECK(ptc.distance == approx(3.0));
+}
+
+TEST_CASE("plane.transform_transformation") {
+  const auto p = plane3d(vec3d::one(), normalize(vec3d(1, 2, 3)));
+  const auto rm = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0));
+  const auto tm = translation_matrix(vec3d(1, 2, 3));
+  for (const auto& m : {mat4x4d::identity(), tm, rm * tm}) {
+    const auto pt = p.transform(transformation3d(m));
+    CHECK(pt.normal == approx(p.transform(m).normal));
+    CHECK(pt.distance == approx(p.transform(m).distance));
+  }
+
+  // the points on the plane must remain on the plane even if it is scaled non-uniformly
+  const auto sm = scaling_matrix(vec3d(2.0, 0.5, -3.0)) * tm;
+  const auto ps = p.transform(transformation3d(sm));
+  CHECK(length(ps.normal) == approx(1.0));
+  for (const auto& point : {p.anchor(), p.anchor() + cross(p.normal, vec3d::pos_x())}) {
+    CHECK(ps.point_distance(sm * point) == approx(0.0));
+  }
+}
+
+TEST_CASE("plane.transform_batch") {
+  // 11 planes, so that the batch processes full SIMD registers as well as the remaining planes
+  std::vector<plane3d> planes;
+  for (std::size_t i = 0u; i < 11u; ++i) {
+    const auto d = static_cast<double>(i);
+    planes.emplace_back(vec3d(d, 2.0 - d, 1.0), normalize(vec3d(1.0 + d, -2.0, 0.5 * d)));
+  }
+
+  const auto rm = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0));
+  const auto tm = translation_matrix(vec3d(1, 2, 3));
+  const auto sm = scaling_matrix(vec3d(2.0, 0.5, -3.0));
+  const auto pm = mat4x4d(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0.01, 1);
+  for (const auto& m : {mat4x4d::identity(), tm, rm * tm, sm * rm * tm, pm}) {
+    const auto t = transformation3d(m);
+    const auto result = transform(planes, t);
+    REQUIRE(result.size() == planes.size());
+    for (std::size_t i = 0u; i < planes.size(); ++i) {
+      CHECK(is_equal(result[i], planes[i].transform(t), 1.0e-12));
+    }
+  }
+
+  auto inPlace = planes;
+  transform(inPlace, transformation3d(rm * tm), inPlace);
+  for (std::size_t i = 0u; i < planes.size(); ++i) {
+    CHECK(is_equal(inPlace[i], planes[i].transform(rm * tm), 1.0e-12));
+  }
+
+  std::vector<plane3f> planesf;
+  for (const auto& p : planes) {
+    planesf.emplace_back(static_cast<float>(p.distance), vec3f(p.normal));
+  }
+  const auto tf = transformation3f(mat4x4f(sm * rm * tm));
+  const auto resultf = transform(planesf, tf);
+  for (std::size_t i = 0u; i < planesf.size(); ++i) {
+    CHECK(is_equal(resultf[i], planesf[i].transform(tf), 1.0e-4f));
+  }
+}
+
 TEST_CASE("plane.project_point") {
   CER_CHECK(plane3d(0.0, vec3d::pos_z()).project_point(vec3d(0, 0, 10)) == approx(vec3d(0, 0, 0)));
   CER_CHECK(plane3d(0.0, vec3d::pos_z()).project_point(vec3d(1, 2, 10)) == approx(vec3d(1, 2, 0)));
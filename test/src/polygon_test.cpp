@@ -18,12 +18,14 @@
  OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <vecmath/affine.h>
 #include <vecmath/approx.h>
 #include <vecmath/forward.h>
 #include <vecmath/mat.h>
 #include <vecmath/mat_ext.h>
 #include <vecmath/mat_io.h>
 #include <vecmath/polygon.h>
+#include <vecmath/transformation.h>
 #include <vecmath/vec.h>
 #include <vecmath/vec_ext.h>
 #include <vecmath/vec_io.h>
@@ -136,6 +138,34 @@ TEST_CASE("polygon.transform") {
   CHECK_THAT(p.transform(t).vertices(), Equals(exp.vertices()));
 }
 
+TEST_CASE("polygon.transform_affine") {
+  const auto p =
+    polygon3d({vec3d(+1, +1, 0), vec3d(+1, -1, 0), vec3d(-1, -1, 0), vec3d(-1, +1, 0)});
+  const auto t = rotation_matrix(to_radians(14.0), to_radians(13.0), to_radians(44.0)) *
+                 translation_matrix(vec3d(1, 2, 3));
+  const auto expected = p.transform(t).vertices();
+  const auto actual = p.transform(affine3d(t)).vertices();
+  REQUIRE(actual.size() == expected.size());
+  for (std::size_t i = 0u; i < actual.size(); ++i) {
+    CHECK(actual[i] == approx(expected[i]));
+  }
+}
+
+TEST_CASE("polygon.transform_transformation") {
+  const auto p =
+    polygon3d({vec3d(+1, +1, 0), vec3d(+1, -1, 0), vec3d(-1, -1, 0), vec3d(-1, +1, 0)});
+  const auto rm = rotation_matrix(to_radians(14.0), to_radians(13.0), to_radians(44.0));
+  const auto tm = translation_matrix(vec3d(1, 2, 3));
+  for (const auto& m : {mat4x4d::identity(), tm, rm * tm}) {
+    const auto expected = p.transform(m).vertices();
+    const auto actual = p.transform(transformation3d(m)).vertices();
+    REQUIRE(actual.size() == expected.size());
+    for (std::size_t i = 0u; i < actual.size(); ++i) {
+      CHECK(actual[i] == approx(expected[i]));
+    }
+  }
+}
+
 TEST_CASE("polygon.get_vertices") {
   using Catch::Matchers::Equals;
 
@@ -0,0 +1,247 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/approx.h>
+#include <vecmath/bbox.h>
+#include <vecmath/bbox_io.h>
+#include <vecmath/bvh.h>
+#include <vecmath/forward.h>
+#include <vecmath/quantized_bvh.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_io.h>
+
+#include "test_utils.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+/**
+ * Checks that every primitive is in exactly one leaf, that the dequantized bounds of every leaf
+ * contain its triangles, and that the first inner child of every node directly follows it.
+ */
+template <typename T, typename Q>
+static void check_structure(
+  const quantized_bvh_view<T, 3, Q>& tree, const std::vector<vec<T, 3>>& vertices) {
+  using view_type = quantized_bvh_view<T, 3, Q>;
+
+  auto foundPrimitives = std::vector<std::size_t>(tree.size(), 0u);
+  auto foundNodes = std::vector<std::size_t>(tree.node_count(), 0u);
+  auto pending = std::vector<std::tuple<std::uint32_t, bbox<T, 3>>>{{0u, tree.bounds()}};
+  foundNodes[0] = 1u;
+  while (!pending.empty()) {
+    const auto [index, bounds] = pending.back();
+    pending.pop_back();
+
+    const auto& n = tree.nodes()[index];
+    auto firstInner = true;
+    for (std::size_t i = 0; i < 2u; ++i) {
+      if (n.first[i] == view_type::empty_child) {
+        continue;
+      }
+
+      const auto childBounds = view_type::child_bounds(bounds, n, i);
+      CHECK(bounds.contains(childBounds));
+      if (n.count[i] > 0u) {
+        for (auto j = n.first[i]; j < n.first[i] + n.count[i]; ++j) {
+          const auto primitive = tree.primitive_indices()[j];
+          ++foundPrimitives[primitive];
+          for (std::size_t k = 0; k < 3u; ++k) {
+            CHECK(childBounds.contains(vertices[3u * primitive + k]));
+          }
+        }
+      } else {
+        if (firstInner) {
+          CHECK(n.first[i] == index + 1u);
+          firstInner = false;
+        }
+        ++foundNodes[n.first[i]];
+        pending.emplace_back(n.first[i], childBounds);
+      }
+    }
+  }
+
+  const auto once = [](const auto c) { return c == 1u; };
+  CHECK(std::all_of(std::begin(foundPrimitives), std::end(foundPrimitives), once));
+  CHECK(std::all_of(std::begin(foundNodes), std::end(foundNodes), once));
+}
+
+TEST_CASE("quantized_bvh.empty") {
+  const auto tree = quantized_bvh16d();
+  const auto view = tree.view();
+  CHECK(view.empty());
+  CHECK(view.size() == 0u);
+  CHECK(view.node_count() == 0u);
+
+  const auto [index, distance] = view.find_first_hit(
+    ray3d(vec3d::zero(), vec3d::pos_x()), [](const std::size_t) { return 0.0; });
+  CHECK(index == quantized_bvh16d::view_type::null_index);
+  CHECK(is_nan(distance));
+
+  CHECK(quantized_bvh16d::view_type::from_bytes(tree.data().data(), tree.data().size()));
+  CHECK(quantized_bvh16d::from_bvh(bvh<double, 3>(std::vector<bbox3d>()))->data() == tree.data());
+}
+
+TEST_CASE("quantized_bvh.single_leaf") {
+  const auto bounds = std::vector<bbox3d>{
+    bbox3d(vec3d(0, 0, 0), vec3d(2, 1, 1)), bbox3d(vec3d(1, 0, 0), vec3d(3, 1, 1))};
+  const auto tree = *quantized_bvh8d::from_bvh(bvh<double, 3>(bounds));
+  const auto view = tree.view();
+  CHECK(view.size() == 2u);
+  CHECK(view.bounds() == bbox3d(vec3d(0, 0, 0), vec3d(3, 1, 1)));
+  REQUIRE(view.node_count() == 1u);
+
+  const auto& root = view.nodes()[0];
+  CHECK(root.first[0] == 0u);
+  CHECK(root.count[0] == 2u);
+  CHECK(quantized_bvh8d::view_type::child_bounds(view.bounds(), root, 0u) == view.bounds());
+  CHECK(root.first[1] == quantized_bvh8d::view_type::empty_child);
+
+  auto found = std::vector<std::size_t>();
+  view.find_intersectors(
+    bbox3d(vec3d(2.5, 0, 0), vec3d(4, 1, 1)), [&](const std::size_t i) { found.push_back(i); });
+  std::sort(std::begin(found), std::end(found));
+  CHECK(found == std::vector<std::size_t>{0u, 1u});
+}
+
+TEST_CASE("quantized_bvh.build") {
+  const auto vertices = random_triangles<double>(2000u, 1u);
+  const auto binary = make_triangle_bvh(vertices);
+  const auto innerNodes = static_cast<std::size_t>(std::count_if(
+    std::begin(binary.nodes()), std::end(binary.nodes()), [](const auto& n) {
+      return !n.is_leaf();
+    }));
+
+  const auto tree8 = *quantized_bvh8d::from_bvh(binary);
+  CHECK(tree8.view().size() == binary.size());
+  CHECK(tree8.view().node_count() == innerNodes);
+  CHECK(tree8.view().bounds() == binary.bounds());
+  check_structure(tree8.view(), vertices);
+
+  const auto tree16 = *quantized_bvh16d::from_bvh(binary);
+  check_structure(tree16.view(), vertices);
+
+  const auto binarySize = binary.nodes().size() * sizeof(bvh<double, 3>::node) +
+                          binary.primitive_indices().size() * sizeof(std::size_t);
+  CHECK(tree8.data().size() < tree16.data().size());
+  CHECK(tree16.data().size() < binarySize);
+}
+
+TEST_CASE("quantized_bvh.find_intersectors") {
+  const auto vertices = random_triangles<double>(1000u, 2u);
+  const auto binary = make_triangle_bvh(vertices);
+  const auto tree = *quantized_bvh8d::from_bvh(binary);
+
+  const auto query = bbox3d(vec3d(-20, -20, -20), vec3d(20, 20, 20));
+  auto expected = std::vector<std::size_t>();
+  binary.find_intersectors(query, [&](const std::size_t i) { expected.push_back(i); });
+  std::sort(std::begin(expected), std::end(expected));
+
+  // the quantized boxes can be larger, so more leaves can intersect the query
+  auto found = std::vector<std::size_t>();
+  tree.view().find_intersectors(query, [&](const std::size_t i) { found.push_back(i); });
+  std::sort(std::begin(found), std::end(found));
+  CHECK(
+    std::includes(std::begin(found), std::end(found), std::begin(expected), std::end(expected)));
+}
+
+TEST_CASE("quantized_bvh.intersect_ray_triangles") {
+  const auto verticesd = random_triangles<double>(1000u, 3u);
+  const auto binaryd = make_triangle_bvh(verticesd);
+  check_same_first_hits(quantized_bvh8d::from_bvh(binaryd)->view(), binaryd, verticesd);
+  check_same_first_hits(quantized_bvh16d::from_bvh(binaryd)->view(), binaryd, verticesd);
+
+  const auto verticesf = random_triangles<float>(1000u, 3u);
+  const auto binaryf = make_triangle_bvh(verticesf);
+  check_same_first_hits(quantized_bvh8f::from_bvh(binaryf)->view(), binaryf, verticesf);
+  check_same_first_hits(quantized_bvh16f::from_bvh(binaryf)->view(), binaryf, verticesf);
+}
+
+TEST_CASE("quantized_bvh.serialization") {
+  const auto vertices = random_triangles<float>(500u, 5u);
+  const auto binary = make_triangle_bvh(vertices);
+  const auto tree = *quantized_bvh16f::from_bvh(binary);
+
+  auto str = std::stringstream();
+  tree.write(str);
+  const auto bytes = str.str();
+  CHECK(bytes.size() == tree.data().size());
+
+  const auto read = quantized_bvh16f::read(str);
+  REQUIRE(read);
+  CHECK(read->data() == tree.data());
+  check_same_first_hits(read->view(), binary, vertices);
+
+  // use the bytes in place, as if they were mapped into memory
+  auto block = std::vector<std::uint64_t>(bytes.size() / sizeof(std::uint64_t) + 1u);
+  std::memcpy(block.data(), bytes.data(), bytes.size());
+  const auto view = quantized_bvh16f::view_type::from_bytes(block.data(), bytes.size());
+  REQUIRE(view);
+  check_same_first_hits(*view, binary, vertices);
+
+  // truncated, misaligned or read with a different format
+  CHECK_FALSE(quantized_bvh16f::view_type::from_bytes(block.data(), bytes.size() - 1u));
+  CHECK_FALSE(quantized_bvh8f::view_type::from_bytes(block.data(), bytes.size()));
+  CHECK_FALSE(quantized_bvh16d::view_type::from_bytes(block.data(), bytes.size()));
+  std::memmove(reinterpret_cast<char*>(block.data()) + 1, block.data(), bytes.size());
+  CHECK_FALSE(quantized_bvh16f::view_type::from_bytes(
+    reinterpret_cast<char*>(block.data()) + 1, bytes.size()));
+
+  // a newer version
+  auto newer = bytes;
+  newer[4] = static_cast<char>(newer[4] + 1);
+  auto newerStr = std::stringstream(newer);
+  CHECK_FALSE(quantized_bvh16f::read(newerStr));
+
+  // a child that refers to a node outside of the tree
+  std::memcpy(block.data(), bytes.data(), bytes.size());
+  auto* nodes = reinterpret_cast<quantized_bvh16f::node*>(
+    reinterpret_cast<char*>(block.data()) + sizeof(quantized_bvh16f::header));
+  nodes[0].first[0] = static_cast<std::uint32_t>(tree.view().node_count());
+  nodes[0].count[0] = 0u;
+  CHECK_FALSE(quantized_bvh16f::view_type::from_bytes(block.data(), bytes.size()));
+
+  // a node that is the child of two nodes
+  REQUIRE(tree.view().node_count() > 1u);
+  std::memcpy(block.data(), bytes.data(), bytes.size());
+  nodes[0].first[1] = 1u;
+  nodes[0].count[1] = 0u;
+  CHECK_FALSE(quantized_bvh16f::view_type::from_bytes(block.data(), bytes.size()));
+
+  // a primitive index that is not less than the number of primitives
+  std::memcpy(block.data(), bytes.data(), bytes.size());
+  const auto primitiveCount = static_cast<std::uint32_t>(tree.view().size());
+  std::memcpy(
+    reinterpret_cast<char*>(nodes + tree.view().node_count()) + sizeof(std::uint32_t),
+    &primitiveCount,
+    sizeof(primitiveCount));
+  CHECK_FALSE(quantized_bvh16f::view_type::from_bytes(block.data(), bytes.size()));
+}
+} // namespace vm
@@ -18,6 +18,7 @@
  OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <vecmath/affine.h>
 #include <vecmath/approx.h>
 #include <vecmath/forward.h>
 #include <vecmath/mat.h>
@@ -26,6 +27,7 @@
 #include <vecmath/ray.h>
 #include <vecmath/ray_io.h>
 #include <vecmath/scalar.h>
+#include <vecmath/transformation.h>
 #include <vecmath/util.h>
 #include <vecmath/vec.h>
 #include <vecmath/vec_io.h>
@@ -88,6 +90,35 @@ TEST_CASE("ray.transform_c") {
   CER_CHECK(rt.direction == approx(normalize_c(sm * r.direction)));
 }
 
+TEST_CASE("ray.transform_affine") {
+  const auto r = ray3d(vec3d::one(), vec3d::pos_z());
+  const auto m = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0)) *
+                 translation_matrix(vec3d::one());
+
+  const auto rt = r.transform(affine3d(m));
+  CHECK(rt.origin == approx(r.transform(m).origin));
+  CHECK(rt.direction == approx(r.transform(m).direction));
+
+  constexpr auto sm = scaling_matrix(vec3d(2.0, 0.5, -2.0));
+  constexpr auto tm = translation_matrix(vec3d::one());
+  constexpr auto rc = ray3d(vec3d::one(), vec3d::pos_z()).transform_c(affine3d(sm * tm));
+  CER_CHECK(rc.origin == approx(sm * tm * vec3d::one()));
+  CER_CHECK(rc.direction == approx(vec3d::neg_z()));
+}
+
+TEST_CASE("ray.transform_transformation") {
+  const auto r = ray3d(vec3d::one(), normalize(vec3d(1, 2, 3)));
+  const auto rm = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0));
+  const auto tm = translation_matrix(vec3d(1, 2, 3));
+  const auto sm = scaling_matrix(vec3d(2.0, 0.5, -2.0));
+  const auto pm = mat4x4d(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0.01, 1);
+  for (const auto& m : {mat4x4d::identity(), tm, rm * tm, sm * tm, pm}) {
+    const auto rt = r.transform(transformation3d(m));
+    CHECK(rt.origin == approx(r.transform(m).origin));
+    CHECK(rt.direction == approx(r.transform(m).direction));
+  }
+}
+
 TEST_CASE("ray.point_status") {
   constexpr auto ray = ray3f(vec3f::zero(), vec3f::pos_z());
   CER_CHECK(ray.point_status(vec3f(0.0f, 0.0f, 1.0f)) == plane_status::above);
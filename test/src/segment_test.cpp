@@ -18,6 +18,7 @@
  OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <vecmath/affine.h>
 #include <vecmath/approx.h>
 #include <vecmath/constants.h>
 #include <vecmath/forward.h>
@@ -26,6 +27,7 @@
 #include <vecmath/mat_io.h>
 #include <vecmath/scalar.h>
 #include <vecmath/segment.h>
+#include <vecmath/transformation.h>
 #include <vecmath/vec.h>
 #include <vecmath/vec_io.h>
 
@@ -117,6 +119,28 @@ TEST_CASE("segment.transform") {
   CER_CHECK(st.end() == approx(sm * tm * s.end()));
 }
 
+TEST_CASE("segment.transform_affine") {
+  constexpr auto s = segment3d(vec3d(0, 0, 0), vec3d(4, 0, 0));
+  constexpr auto sm = scaling_matrix(vec3d(2, 0.5, 3));
+  constexpr auto tm = translation_matrix(vec3d::one());
+
+  constexpr auto st = s.transform(affine3d(sm * tm));
+  CER_CHECK(st.start() == approx(sm * tm * s.start()));
+  CER_CHECK(st.end() == approx(sm * tm * s.end()));
+}
+
+TEST_CASE("segment.transform_transformation") {
+  const auto s = segment3d(vec3d(0, 0, 0), vec3d(4, 1, 0));
+  const auto rm = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0));
+  const auto tm = translation_matrix(vec3d(1, 2, 3));
+  const auto sm = scaling_matrix(vec3d(2, 0.5, 3));
+  for (const auto& m : {mat4x4d::identity(), tm, rm * tm, sm * tm}) {
+    const auto st = s.transform(transformation3d(m));
+    CHECK(st.start() == approx(m * s.start()));
+    CHECK(st.end() == approx(m * s.end()));
+  }
+}
+
 TEST_CASE("segment.translate") {
   constexpr auto s = segment3d(vec3d(0, 0, 0), vec3d(4, 0, 0));
   constexpr auto st = s.translate(vec3d::one());
@@ -0,0 +1,160 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/approx.h>
+#include <vecmath/bbox.h>
+#include <vecmath/forward.h>
+#include <vecmath/intersection.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+#include <vecmath/simd_dispatch.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_soa.h>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+// not a multiple of any register width, so that every kernel also processes remaining elements
+constexpr auto dispatch_test_count = std::size_t(103);
+
+template <typename T>
+static std::vector<vec<T, 3>> dispatch_test_vecs(const T min, const T max, const unsigned seed) {
+  auto rng = std::mt19937(seed);
+  auto dist = std::uniform_real_distribution<T>(min, max);
+  std::vector<vec<T, 3>> result;
+  for (std::size_t i = 0; i < dispatch_test_count; ++i) {
+    result.emplace_back(dist(rng), dist(rng), dist(rng));
+  }
+  return result;
+}
+
+/*
+ * The compiler may contract a multiplication and an addition into a fused multiply-add differently
+ * for each instruction set, so the results are compared with a tolerance. Both results must agree
+ * on whether there is an intersection.
+ */
+template <typename T> static bool same_result(const T lhs, const T rhs) {
+  if (is_nan(lhs) || is_nan(rhs)) {
+    return is_nan(lhs) && is_nan(rhs);
+  }
+  return is_equal(lhs, rhs, T(0.0001) * max(T(1), abs(rhs)));
+}
+
+template <typename T> static std::vector<simd_isa> dispatch_test_isas() {
+  std::vector<simd_isa> result;
+  for (const auto isa : {simd_isa::scalar, simd_isa::sse2, simd_isa::avx2, simd_isa::avx512}) {
+    if (isa <= supported_simd_isa()) {
+      result.push_back(isa);
+    }
+  }
+  return result;
+}
+
+/*
+ * Runs every batch kernel with every supported instruction set, and checks that the results match
+ * those of the scalar functions for each element.
+ */
+template <typename T> static void check_batch_kernels() {
+  const auto lhs = dispatch_test_vecs<T>(T(-10), T(10), 1u);
+  const auto rhs = dispatch_test_vecs<T>(T(-10), T(10), 2u);
+  const auto lhsSoa = vec_soa<T, 3>(lhs);
+  const auto rhsSoa = vec_soa<T, 3>(rhs);
+
+  const auto transform = translation_matrix(vec<T, 3>(T(12), T(-4), T(128))) *
+                         rotation_matrix(normalize(vec<T, 3>(T(1), T(2), T(3))), T(0.5));
+
+  // boxes and triangles around the ray, so that it hits some of them and misses others
+  const auto r =
+    ray<T, 3>(vec<T, 3>(T(0), T(0), T(-5)), normalize(vec<T, 3>(T(0.1), T(0.2), T(1))));
+  const auto mins = dispatch_test_vecs<T>(T(-6), T(2), 3u);
+  const auto sizes = dispatch_test_vecs<T>(T(0.5), T(6), 4u);
+  auto maxs = mins;
+  for (std::size_t i = 0; i < maxs.size(); ++i) {
+    maxs[i] = mins[i] + sizes[i];
+  }
+  const auto p1s = dispatch_test_vecs<T>(T(-2), T(2), 5u);
+  const auto p2s = dispatch_test_vecs<T>(T(-2), T(2), 6u);
+  const auto p3s = dispatch_test_vecs<T>(T(-2), T(2), 7u);
+
+  auto bboxHits = std::size_t(0);
+  auto triangleHits = std::size_t(0);
+  for (const auto isa : dispatch_test_isas<T>()) {
+    CAPTURE(static_cast<int>(isa));
+    CHECK(select_simd_isa(isa) == isa);
+
+    const auto dots = dot(lhsSoa, rhsSoa);
+    const auto vecDots = dot(lhsSoa, rhs[0]);
+    const auto normalized = normalize(lhsSoa);
+    const auto transformed = transform * lhsSoa;
+    std::vector<T> bboxDistances, triangleDistances;
+    intersect_ray_bbox(r, vec_soa<T, 3>(mins), vec_soa<T, 3>(maxs), bboxDistances);
+    intersect_ray_triangle(
+      r, vec_soa<T, 3>(p1s), vec_soa<T, 3>(p2s), vec_soa<T, 3>(p3s), triangleDistances);
+
+    for (std::size_t i = 0; i < dispatch_test_count; ++i) {
+      CHECK(same_result(dots[i], dot(lhs[i], rhs[i])));
+      CHECK(same_result(vecDots[i], dot(lhs[i], rhs[0])));
+      CHECK(is_equal(normalized[i], normalize(lhs[i]), T(0.0001)));
+      CHECK(is_equal(transformed[i], transform * lhs[i], T(0.0001)));
+
+      const auto bboxDistance = intersect_ray_bbox(r, bbox<T, 3>(mins[i], maxs[i]));
+      const auto triangleDistance = intersect_ray_triangle(r, p1s[i], p2s[i], p3s[i]);
+      CHECK(same_result(bboxDistances[i], bboxDistance));
+      CHECK(same_result(triangleDistances[i], triangleDistance));
+      bboxHits += is_nan(bboxDistance) ? 0u : 1u;
+      triangleHits += is_nan(triangleDistance) ? 0u : 1u;
+    }
+  }
+
+  // the test data must cover hits as well as misses
+  const auto runs = dispatch_test_isas<T>().size();
+  CHECK(bboxHits > 0u);
+  CHECK(bboxHits < runs * dispatch_test_count);
+  CHECK(triangleHits > 0u);
+  CHECK(triangleHits < runs * dispatch_test_count);
+
+  select_simd_isa(supported_simd_isa());
+}
+
+TEST_CASE("simd_dispatch.select_simd_isa") {
+  const auto supported = supported_simd_isa();
+  CHECK(selected_simd_isa() == supported);
+
+  for (const auto isa : {simd_isa::scalar, simd_isa::sse2, simd_isa::avx2, simd_isa::avx512}) {
+    const auto expected = isa <= supported ? isa : supported;
+    CHECK(select_simd_isa(isa) == expected);
+    CHECK(selected_simd_isa() == expected);
+  }
+
+  select_simd_isa(supported);
+  CHECK(selected_simd_isa() == supported);
+}
+
+TEST_CASE("simd_dispatch.batch_kernels") {
+  check_batch_kernels<float>();
+  check_batch_kernels<double>();
+}
+} // namespace vm
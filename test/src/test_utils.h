@@ -20,7 +20,18 @@
 
 #pragma once
 
+#include <vecmath/approx.h>
 #include <vecmath/forward.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+#include <vecmath/traversal.h>
+#include <vecmath/vec.h>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
 
 #define CE_CHECK(expr)                                                                             \
   {                                                                                                \
@@ -39,3 +50,55 @@
 #define CER_CHECK_FALSE(expr)                                                                      \
   CHECK_FALSE(expr);                                                                               \
   CE_CHECK_FALSE(expr);
+
+namespace vm {
+/**
+ * Returns the vertices of the given number of small random triangles, three per triangle.
+ */
+template <typename T>
+std::vector<vec<T, 3>> random_triangles(const std::size_t count, const unsigned int seed) {
+  auto rng = std::mt19937(seed);
+  auto position = std::uniform_real_distribution<T>(-100, 100);
+  auto offset = std::uniform_real_distribution<T>(-5, 5);
+
+  auto result = std::vector<vec<T, 3>>();
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto p = vec<T, 3>(position(rng), position(rng), position(rng));
+    result.push_back(p);
+    result.push_back(p + vec<T, 3>(offset(rng), offset(rng), offset(rng)));
+    result.push_back(p + vec<T, 3>(offset(rng), offset(rng), offset(rng)));
+  }
+  return result;
+}
+
+/**
+ * Checks that the given tree finds the same first hits of random rays with the given triangles as
+ * the bvh that it was built from. The visited nodes of both trees are added to the given stats
+ * unless they are null.
+ */
+template <typename Tree, typename Binary, typename T>
+void check_same_first_hits(
+  const Tree& tree,
+  const Binary& binary,
+  const std::vector<vec<T, 3>>& vertices,
+  traversal_stats* treeStats = nullptr,
+  traversal_stats* binaryStats = nullptr) {
+  auto rng = std::mt19937(4u);
+  auto position = std::uniform_real_distribution<T>(-100, 100);
+  for (std::size_t i = 0; i < 200u; ++i) {
+    const auto origin = vec<T, 3>(position(rng), position(rng), position(rng));
+    const auto r =
+      ray<T, 3>(origin, normalize(vec<T, 3>(position(rng), position(rng), position(rng))));
+
+    const auto [expectedIndex, expectedDistance] =
+      intersect_ray_triangles(r, binary, vertices, binaryStats);
+    const auto [index, distance] = intersect_ray_triangles(r, tree, vertices, treeStats);
+    CHECK(index == expectedIndex);
+    if (!is_nan(expectedDistance)) {
+      CHECK(distance == approx(expectedDistance));
+    } else {
+      CHECK(is_nan(distance));
+    }
+  }
+}
+} // namespace vm
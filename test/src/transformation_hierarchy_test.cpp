@@ -0,0 +1,108 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/mat_io.h>
+#include <vecmath/scalar.h>
+#include <vecmath/transformation.h>
+#include <vecmath/transformation_hierarchy.h>
+#include <vecmath/vec.h>
+
+#include <cstddef>
+#include <tuple>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("transformation_hierarchy.add_node") {
+  auto h = transformation_hierarchy<double, 3>();
+  CHECK(h.size() == 0u);
+
+  const auto root = h.add_node(translation_matrix(vec3d(1, 2, 3)));
+  const auto child = h.add_node(scaling_matrix(vec3d(2, 2, 2)), root);
+  const auto other = h.add_node(mat4x4d::identity());
+
+  CHECK(h.size() == 3u);
+  CHECK(h.parent(root) == transformation_hierarchy<double, 3>::no_parent);
+  CHECK(h.parent(child) == root);
+  CHECK(h.children(root) == std::vector<std::size_t>{child});
+  CHECK(h.children(other).empty());
+  CHECK(h.local(child).matrix() == scaling_matrix(vec3d(2, 2, 2)));
+}
+
+TEST_CASE("transformation_hierarchy.world") {
+  const auto m0 = translation_matrix(vec3d(1, 2, 3));
+  const auto m1 = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0));
+  const auto m2 = scaling_matrix(vec3d(2, 0.5, 3));
+
+  auto h = transformation_hierarchy<double, 3>();
+  const auto n0 = h.add_node(m0);
+  const auto n1 = h.add_node(m1, n0);
+  const auto n2 = h.add_node(m2, n1);
+  const auto n3 = h.add_node(m2, n0);
+
+  CHECK(h.dirty(n2));
+  CHECK(h.world(n2).matrix() == m0 * m1 * m2);
+  CHECK(is_equal(h.world(n2).inverse(), std::get<1>(invert(m0 * m1 * m2)), 1.0e-12));
+  CHECK_FALSE(h.dirty(n0));
+  CHECK_FALSE(h.dirty(n1));
+  CHECK_FALSE(h.dirty(n2));
+  CHECK(h.dirty(n3));
+
+  CHECK(h.world(n0).matrix() == m0);
+  CHECK(h.world(n3).matrix() == m0 * m2);
+}
+
+TEST_CASE("transformation_hierarchy.set_local") {
+  const auto m0 = translation_matrix(vec3d(1, 2, 3));
+  const auto m1 = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0));
+  const auto m2 = scaling_matrix(vec3d(2, 0.5, 3));
+
+  auto h = transformation_hierarchy<double, 3>();
+  const auto n0 = h.add_node(m0);
+  const auto n1 = h.add_node(m1, n0);
+  const auto n2 = h.add_node(m2, n1);
+  const auto n3 = h.add_node(m2, n0);
+  h.update();
+  CHECK_FALSE(h.dirty(n3));
+
+  // only the subtree of the changed node becomes dirty
+  h.set_local(n1, m2);
+  CHECK_FALSE(h.dirty(n0));
+  CHECK(h.dirty(n1));
+  CHECK(h.dirty(n2));
+  CHECK_FALSE(h.dirty(n3));
+  CHECK(h.world(n2).matrix() == m0 * m2 * m2);
+
+  // changing a node below a dirty node keeps the descendants dirty
+  h.set_local(n0, m1);
+  h.set_local(n1, m1);
+  CHECK(h.dirty(n2));
+  CHECK(h.world(n2).matrix() == m1 * m1 * m2);
+  CHECK(h.world(n3).matrix() == m1 * m2);
+
+  h.set_local(n2, transformation3d::translation(vec3d(1, 0, 0)));
+  h.update();
+  CHECK_FALSE(h.dirty(n2));
+  CHECK(h.world(n2).matrix() == m1 * m1 * translation_matrix(vec3d(1, 0, 0)));
+}
+} // namespace vm
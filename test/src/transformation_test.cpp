@@ -0,0 +1,179 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/affine.h>
+#include <vecmath/approx.h>
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/mat_io.h>
+#include <vecmath/scalar.h>
+#include <vecmath/transformation.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_io.h>
+
+#include "test_utils.h"
+
+#include <tuple>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+TEST_CASE("transformation.constructor_default") {
+  constexpr auto t = transformation3d();
+  CER_CHECK(t.matrix() == mat4x4d::identity());
+  CER_CHECK(t.inverse() == mat4x4d::identity());
+  CER_CHECK(t.kind() == transformation_kind::identity);
+  CER_CHECK(t.invertible());
+  CER_CHECK(t == transformation3d::identity());
+}
+
+TEST_CASE("transformation.classify") {
+  CER_CHECK(transformation3d(mat4x4d::identity()).kind() == transformation_kind::identity);
+  CER_CHECK(
+    transformation3d(translation_matrix(vec3d(1, 2, 3))).kind() ==
+    transformation_kind::translation);
+  CER_CHECK(
+    transformation3d(mat4x4d::rot_90_x_ccw()).kind() == transformation_kind::rigid);
+  CER_CHECK(transformation3d(mat4x4d::mirror_y()).kind() == transformation_kind::rigid);
+  CER_CHECK(
+    transformation3d(scaling_matrix(vec3d(2, 2, 2))).kind() == transformation_kind::affine);
+  CER_CHECK(
+    transformation3d(mat4x4d(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0)).kind() ==
+    transformation_kind::projective);
+
+  const auto rotation = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0));
+  CHECK(
+    transformation3d(translation_matrix(vec3d(1, 2, 3)) * rotation).kind() ==
+    transformation_kind::rigid);
+  CHECK(
+    transformation3f(mat4x4f(rotation)).kind() == transformation_kind::rigid);
+
+  // nearly orthonormal matrices are only rigid if they are orthonormal to the precision of T
+  CHECK(
+    transformation3d(scaling_matrix(vec3d(1.0 + 1.0e-15, 1, 1))).kind() ==
+    transformation_kind::rigid);
+  CHECK(
+    transformation3d(scaling_matrix(vec3d(1.0 + 4.0e-7, 1, 1))).kind() ==
+    transformation_kind::affine);
+  CHECK(
+    transformation3f(scaling_matrix(vec3f(1.0f + 4.0e-7f, 1, 1))).kind() ==
+    transformation_kind::rigid);
+}
+
+TEST_CASE("transformation.inverse_nearly_rigid") {
+  const auto m =
+    scaling_matrix(vec3d(1.0 + 4.0e-7, 1, 1)) * translation_matrix(vec3d(1, 2, 3));
+  const auto t = transformation3d(m);
+  const auto p = vec3d(1000, -1000, 500);
+  CHECK(is_equal(t.inverse() * (t.matrix() * p), p, 1.0e-9));
+  CHECK(is_equal(t.inverse(), std::get<1>(invert(m)), 1.0e-12));
+}
+
+TEST_CASE("transformation.constructor_affine") {
+  const auto a = affine3d(scaling_matrix(vec3d(1, 2, 3)) * translation_matrix(vec3d(3, 2, 1)));
+  const auto t = transformation3d(a);
+  CHECK(t.matrix() == a.to_mat());
+  CHECK(t.kind() == transformation_kind::affine);
+}
+
+TEST_CASE("transformation.translation") {
+  constexpr auto t = transformation3d::translation(vec3d(1, 2, 3));
+  CER_CHECK(t.matrix() == translation_matrix(vec3d(1, 2, 3)));
+  CER_CHECK(t.inverse() == translation_matrix(vec3d(-1, -2, -3)));
+  CER_CHECK(t.kind() == transformation_kind::translation);
+  CER_CHECK(t.translation() == vec3d(1, 2, 3));
+  CER_CHECK(t == transformation3d(translation_matrix(vec3d(1, 2, 3))));
+}
+
+TEST_CASE("transformation.inverse") {
+  const auto rigid = translation_matrix(vec3d(1, 2, 3)) *
+                     rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0));
+  const auto affine = scaling_matrix(vec3d(2, 0.5, 3)) * rigid;
+  const auto projective = mat4x4d(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0.5, 1) * affine;
+
+  for (const auto& m : {translation_matrix(vec3d(1, 2, 3)), rigid, affine, projective}) {
+    const auto t = transformation3d(m);
+    CHECK(t.invertible());
+    CHECK(is_equal(t.inverse(), std::get<1>(invert(m)), 1.0e-12));
+    CHECK(t.inverse_transpose() == transpose(t.inverse()));
+
+    const auto [invertible, inverse] = invert(t);
+    CHECK(invertible);
+    CHECK(inverse.matrix() == t.inverse());
+    CHECK(inverse.inverse() == t.matrix());
+    CHECK(inverse.kind() == t.kind());
+  }
+
+  const auto singular = transformation3d(scaling_matrix(vec3d(1, 0, 1)));
+  CHECK_FALSE(singular.invertible());
+  CHECK(singular.inverse() == mat4x4d::identity());
+  CHECK_FALSE(std::get<0>(invert(singular)));
+}
+
+TEST_CASE("transformation.compose") {
+  const auto m1 = rotation_matrix(to_radians(15.0), to_radians(20.0), to_radians(-12.0)) *
+                  translation_matrix(vec3d(1, 2, 3));
+  const auto m2 = scaling_matrix(vec3d(2, 0.5, 3)) * translation_matrix(vec3d(-3, 7, 1));
+  const auto t1 = transformation3d(m1);
+  const auto t2 = transformation3d(m2);
+
+  const auto t = t1 * t2;
+  CHECK(t.matrix() == m1 * m2);
+  CHECK(is_equal(t.inverse(), std::get<1>(invert(m1 * m2)), 1.0e-12));
+  CHECK(t.kind() == transformation_kind::affine);
+  CHECK((t1 * t1).kind() == transformation_kind::rigid);
+  CHECK(
+    (transformation3d::translation(vec3d(1, 2, 3)) * transformation3d::translation(vec3d(-1, 0, 0)))
+      .kind() == transformation_kind::translation);
+
+  const auto projective = transformation3d(mat4x4d(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1));
+  CHECK((projective * std::get<1>(invert(projective))).kind() == transformation_kind::identity);
+}
+
+TEST_CASE("transformation.transform_point") {
+  const auto p = vec3d(1, -2, 3);
+  for (const auto& m :
+       {mat4x4d::identity(),
+        translation_matrix(vec3d(1, 2, 3)),
+        mat4x4d::rot_90_z_cw(),
+        scaling_matrix(vec3d(2, 0.5, 3)) * translation_matrix(vec3d(-3, 7, 1))}) {
+    const auto t = transformation3d(m);
+    CHECK(t * p == approx(m * p));
+    CHECK(transform_vector(t, p) == approx(strip_translation(m) * p));
+  }
+
+  const auto projective = mat4x4d(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0.5, 1);
+  const auto t = transformation3d(projective);
+  CHECK(t * p == approx(projective * p));
+  CHECK(transform_vector(t, p) == approx(p));
+}
+
+TEST_CASE("transformation.transform_normal") {
+  // the plane x = y is mapped to the plane x = 2y by scaling x by 2, whose normal is not the scaled
+  // normal of the original plane
+  const auto t = transformation3d(scaling_matrix(vec3d(2, 1, 1)));
+  const auto n = transform_normal(t, normalize(vec3d(1, -1, 0)));
+  CHECK(n == approx(normalize(vec3d(1, -2, 0))));
+
+  const auto r = transformation3d(mat4x4d::rot_90_z_ccw());
+  CHECK(transform_normal(r, vec3d::pos_x()) == approx(vec3d::pos_y()));
+}
+} // namespace vm
@@ -0,0 +1,94 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/bbox.h>
+#include <vecmath/bbox_io.h>
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/mat_io.h>
+#include <vecmath/quat.h>
+#include <vecmath/uninitialized.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec3a.h>
+#include <vecmath/vec_io.h>
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+static_assert(std::is_constructible_v<vec3f, uninitialized_t>);
+static_assert(std::is_constructible_v<mat4x4d, uninitialized_t>);
+static_assert(std::is_constructible_v<quatd, uninitialized_t>);
+static_assert(std::is_constructible_v<bbox2f, uninitialized_t>);
+static_assert(!std::is_convertible_v<uninitialized_t, vec3f>);
+static_assert(!std::is_convertible_v<uninitialized_t, mat4x4d>);
+
+TEST_CASE("uninitialized.constructors") {
+  auto v = vec3f(uninitialized);
+  v = vec3f(1, 2, 3);
+  CHECK(v == vec3f(1, 2, 3));
+
+  auto va = vec3fa(uninitialized);
+  va = vec3f(1, 2, 3);
+  CHECK(va == vec3f(1, 2, 3));
+
+  auto m = mat4x4d(uninitialized);
+  m = mat4x4d::identity();
+  CHECK(m == mat4x4d::identity());
+
+  auto q = quatd(uninitialized);
+  q = quatd(vec3d::pos_z(), 1.0);
+  CHECK(q == quatd(vec3d::pos_z(), 1.0));
+
+  auto b = bbox3d(uninitialized);
+  b = bbox3d(vec3d(-1, -1, -1), vec3d(1, 1, 1));
+  CHECK(b == bbox3d(vec3d(-1, -1, -1), vec3d(1, 1, 1)));
+}
+
+TEST_CASE("uninitialized.allocator") {
+  using allocator = uninitialized_allocator<mat4x4d>;
+
+  auto mats = std::vector<mat4x4d, allocator>(16);
+  CHECK(mats.size() == 16u);
+
+  const auto source = std::vector<mat4x4d>(16, translation_matrix(vec3d(1, 2, 3)));
+  std::memcpy(mats.data(), source.data(), source.size() * sizeof(mat4x4d));
+  for (const auto& m : mats) {
+    CHECK(m == translation_matrix(vec3d(1, 2, 3)));
+  }
+
+  // constructors with arguments are forwarded
+  mats.push_back(mat4x4d::zero());
+  mats.emplace_back(mat4x4d::identity());
+  mats.resize(20, mat4x4d::identity());
+  CHECK(mats[16] == mat4x4d::zero());
+  CHECK(mats[17] == mat4x4d::identity());
+  CHECK(mats[19] == mat4x4d::identity());
+
+  // types without an uninitialized constructor are default initialized
+  auto values = std::vector<float, uninitialized_allocator<float>>(8);
+  values.assign(8, 1.0f);
+  CHECK(values == std::vector<float, uninitialized_allocator<float>>(8, 1.0f));
+}
+} // namespace vm
@@ -0,0 +1,186 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/approx.h>
+#include <vecmath/bbox.h>
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec3a.h>
+#include <vecmath/vec_ext.h>
+#include <vecmath/vec_io.h>
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+// 19 vectors, so that the batch operations process full SIMD registers as well as the remaining
+// elements for every register width
+static std::vector<vec3f> vec3a_test_vecs() {
+  std::vector<vec3f> result;
+  for (std::size_t i = 0; i < 19u; ++i) {
+    const auto f = static_cast<float>(i);
+    result.emplace_back(f - 9.0f, 2.0f * f + 0.5f, 3.0f - 0.25f * f);
+  }
+  return result;
+}
+
+static bool has_zero_padding(const vec3fa& v) {
+  float components[4];
+  std::memcpy(components, &v, sizeof(components));
+  return components[3] == 0.0f;
+}
+
+TEST_CASE("vec3a.layout") {
+  CHECK(sizeof(vec3fa) == 4u * sizeof(float));
+  CHECK(alignof(vec3fa) == 4u * sizeof(float));
+  CHECK(sizeof(vec3da) == 4u * sizeof(double));
+  CHECK(alignof(vec3da) == 4u * sizeof(double));
+  CHECK(std::is_trivially_copyable_v<vec3fa>);
+  CHECK(std::is_base_of_v<vec3f, vec3fa>);
+
+  const auto vecs = std::vector<vec3fa>(3u);
+  CHECK(reinterpret_cast<const char*>(&vecs[1]) - reinterpret_cast<const char*>(&vecs[0]) == 16);
+}
+
+TEST_CASE("vec3a.constructors") {
+  CHECK(vec3fa() == vec3f::zero());
+  CHECK(has_zero_padding(vec3fa()));
+
+  const auto a = vec3fa(1.0f, 2.0f, 3.0f);
+  CHECK(a == vec3f(1.0f, 2.0f, 3.0f));
+  CHECK(has_zero_padding(a));
+
+  const vec3fa b = vec3f(4.0f, 5.0f, 6.0f);
+  CHECK(b == vec3f(4.0f, 5.0f, 6.0f));
+  CHECK(has_zero_padding(b));
+}
+
+TEST_CASE("vec3a.conversions") {
+  const auto a = vec3fa(1.0f, 2.0f, 3.0f);
+
+  const vec3f copied = a;
+  CHECK(copied == vec3f(1.0f, 2.0f, 3.0f));
+  CHECK(vec3f(a) == vec3f(1.0f, 2.0f, 3.0f));
+  CHECK(vec3d(a) == vec3d(1.0, 2.0, 3.0));
+  CHECK(vec4f(a, 4.0f) == vec4f(1.0f, 2.0f, 3.0f, 4.0f));
+  CHECK(vec3fa(vec3f(vec3da(1.0, 2.0, 3.0))) == a);
+}
+
+TEST_CASE("vec3a.free_functions") {
+  const auto a = vec3fa(1.0f, 2.0f, 3.0f);
+  const auto b = vec3fa(-2.0f, 0.5f, 4.0f);
+  const auto af = vec3f(a);
+  const auto bf = vec3f(b);
+
+  CHECK(a + b == af + bf);
+  CHECK(a - bf == af - bf);
+  CHECK(a * 2.0f == af * 2.0f);
+  CHECK(dot(a, b) == dot(af, bf));
+  CHECK(cross(a, b) == cross(af, bf));
+  CHECK(length(a) == length(af));
+  CHECK(normalize(a) == normalize(af));
+  CHECK(squared_distance(a, b) == squared_distance(af, bf));
+  CHECK(min(a, b) == min(af, bf));
+  CHECK(max(a, b, a) == max(af, bf, af));
+  CHECK(abs(b) == abs(bf));
+  CHECK(floor(b) == floor(bf));
+  CHECK(clamp(b, a, a) == clamp(bf, af, af));
+  CHECK_FALSE(is_nan(a));
+  CHECK(is_equal(a, af, 0.0f));
+  CHECK(a != b);
+  CHECK((a < b) == (af < bf));
+
+  const auto transform = translation_matrix(vec3f(1.0f, 2.0f, 3.0f));
+  CHECK(transform * a == transform * af);
+  CHECK(bbox3f(min(a, b), max(a, b)).contains(a));
+
+  vec3fa sum = a;
+  sum = sum + b;
+  CHECK(sum == af + bf);
+  CHECK(has_zero_padding(sum));
+}
+
+TEST_CASE("vec3a.batch_transform") {
+  const auto packed = vec3a_test_vecs();
+  const auto padded = std::vector<vec3fa>(std::begin(packed), std::end(packed));
+  const auto transform = translation_matrix(vec3f(12.0f, -4.0f, 128.0f)) *
+                         rotation_matrix(normalize(vec3f(1.0f, 2.0f, 3.0f)), 0.5f);
+  const auto linear = mat3x3f(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f);
+  const auto count = padded.size();
+
+  auto packedOut = std::vector<vec3f>(count);
+  auto paddedOut = std::vector<vec3fa>(count);
+
+  // points
+  multiply(transform, packed.data(), packed.data() + count, packedOut.data());
+  multiply(transform, padded.data(), padded.data() + count, paddedOut.data());
+  for (std::size_t i = 0; i < count; ++i) {
+    CHECK(paddedOut[i] == packedOut[i]);
+    CHECK(has_zero_padding(paddedOut[i]));
+  }
+
+  // linear transformations, from both sides and in place
+  multiply(linear, packed.data(), packed.data() + count, packedOut.data());
+  multiply(linear, padded.data(), padded.data() + count, paddedOut.data());
+  for (std::size_t i = 0; i < count; ++i) {
+    CHECK(paddedOut[i] == packedOut[i]);
+  }
+
+  multiply(packed.data(), packed.data() + count, linear, packedOut.data());
+  multiply(padded.data(), padded.data() + count, linear, paddedOut.data());
+  for (std::size_t i = 0; i < count; ++i) {
+    CHECK(paddedOut[i] == packedOut[i]);
+  }
+
+  // non-pointer iterators use the scalar path
+  multiply(transform, packed.data(), packed.data() + count, packedOut.data());
+  auto inPlace = padded;
+  multiply(transform, inPlace.data(), inPlace.data() + count, inPlace.data());
+  multiply(transform, std::begin(padded), std::end(padded), std::begin(paddedOut));
+  for (std::size_t i = 0; i < count; ++i) {
+    CHECK(inPlace[i] == packedOut[i]);
+    CHECK(paddedOut[i] == packedOut[i]);
+  }
+}
+
+TEST_CASE("vec3a.batch_add_multiply") {
+  const auto packed = vec3a_test_vecs();
+  const auto padded = std::vector<vec3fa>(std::begin(packed), std::end(packed));
+  const auto count = padded.size();
+  auto out = std::vector<vec3fa>(count);
+
+  add(padded.data(), padded.data() + count, vec3f(1.0f, -2.0f, 0.5f), out.data());
+  for (std::size_t i = 0; i < count; ++i) {
+    CHECK(out[i] == packed[i] + vec3f(1.0f, -2.0f, 0.5f));
+    CHECK(has_zero_padding(out[i]));
+  }
+
+  multiply(padded.data(), padded.data() + count, 3.0f, out.data());
+  for (std::size_t i = 0; i < count; ++i) {
+    CHECK(out[i] == packed[i] * 3.0f);
+  }
+}
+} // namespace vm
@@ -25,6 +25,7 @@
 
 #include "test_utils.h"
 
+#include <algorithm>
 #include <array>
 #include <vector>
 
@@ -49,6 +50,46 @@ TEST_CASE("vec_ext.operator_plus_array") {
   CHECK(vec3f(-1, +1, -2) + in == exp);
 }
 
+TEST_CASE("vec_ext.add") {
+  std::vector<vec3f> in;
+  for (std::size_t i = 0u; i < 11u; ++i) {
+    in.emplace_back(static_cast<float>(i), 1.0f, -static_cast<float>(i));
+  }
+
+  std::vector<vec3f> out;
+  add(in, vec3f(-1, +1, -2), out);
+  REQUIRE(out.size() == in.size());
+  for (std::size_t i = 0u; i < in.size(); ++i) {
+    CHECK(out[i] == in[i] + vec3f(-1, +1, -2));
+  }
+
+  auto inPlace = in;
+  add(inPlace, vec3f(-1, +1, -2), inPlace);
+  CHECK(inPlace == out);
+
+  std::array<vec3f, 11> array;
+  CHECK(add(std::begin(in), std::end(in), vec3f(-1, +1, -2), std::begin(array)) == std::end(array));
+  CHECK(std::equal(std::begin(array), std::end(array), std::begin(out)));
+}
+
+TEST_CASE("vec_ext.multiply") {
+  std::vector<vec3f> in;
+  for (std::size_t i = 0u; i < 11u; ++i) {
+    in.emplace_back(static_cast<float>(i), 1.0f, -static_cast<float>(i));
+  }
+
+  std::vector<vec3f> out;
+  multiply(in, 3.0f, out);
+  REQUIRE(out.size() == in.size());
+  for (std::size_t i = 0u; i < in.size(); ++i) {
+    CHECK(out[i] == in[i] * 3.0f);
+  }
+
+  auto inPlace = in;
+  multiply(inPlace.data(), inPlace.data() + inPlace.size(), 3.0f, inPlace.data());
+  CHECK(inPlace == out);
+}
+
 TEST_CASE("vec_ext.operator_multiply_vector") {
   using Catch::Matchers::Equals;
 
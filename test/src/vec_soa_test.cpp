@@ -0,0 +1,231 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/approx.h>
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_io.h>
+#include <vecmath/vec_soa.h>
+
+#include <cstddef>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+// 11 vectors, so that the batch operations process full SIMD registers as well as the remaining
+// elements for every register width
+static std::vector<vec3f> soa_test_vecs() {
+  return {
+    vec3f(1.0f, 2.0f, 3.0f),    vec3f(-1.0f, 0.5f, 2.0f),  vec3f(0.0f, 0.0f, 1.0f),
+    vec3f(3.0f, -4.0f, 0.0f),   vec3f(7.5f, 1.25f, -2.0f), vec3f(-8.0f, -8.0f, -8.0f),
+    vec3f(0.1f, 0.2f, 0.3f),    vec3f(10.0f, 0.0f, -1.0f), vec3f(2.0f, 3.0f, 5.0f),
+    vec3f(-0.5f, 4.0f, 1.5f),   vec3f(6.0f, -2.0f, 9.0f)};
+}
+
+static std::vector<vec3f> soa_test_other_vecs() {
+  return {
+    vec3f(0.0f, 1.0f, 0.0f),    vec3f(2.0f, 2.0f, -2.0f),  vec3f(-3.0f, 1.0f, 4.0f),
+    vec3f(1.0f, 1.0f, 1.0f),    vec3f(-7.5f, 2.0f, 0.5f),  vec3f(8.0f, -9.0f, 8.0f),
+    vec3f(0.3f, 0.2f, 0.1f),    vec3f(-1.0f, 5.0f, 2.0f),  vec3f(2.0f, 3.0f, 5.0f),
+    vec3f(4.0f, -0.5f, -1.5f),  vec3f(-6.0f, 2.0f, 3.0f)};
+}
+
+TEST_CASE("vec_soa.constructor_default") {
+  const auto v = vec_soa<float, 3>();
+  CHECK(v.empty());
+  CHECK(v.size() == 0u);
+}
+
+TEST_CASE("vec_soa.constructor_with_size") {
+  const auto v = vec_soa<float, 3>(4u);
+  CHECK(v.size() == 4u);
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    CHECK(v[i] == vec3f::zero());
+  }
+}
+
+TEST_CASE("vec_soa.constructor_with_vector") {
+  const auto vecs = soa_test_vecs();
+  const auto v = vec_soa<float, 3>(vecs);
+  CHECK(v.size() == vecs.size());
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    CHECK(v[i] == vecs[i]);
+    CHECK(v.data(0)[i] == vecs[i].x());
+    CHECK(v.data(1)[i] == vecs[i].y());
+    CHECK(v.data(2)[i] == vecs[i].z());
+  }
+  CHECK(v.to_vector() == vecs);
+}
+
+TEST_CASE("vec_soa.constructor_with_range") {
+  const auto vecs = soa_test_vecs();
+  const auto v =
+    vec_soa<float, 2>(std::begin(vecs), std::end(vecs), [](const vec3f& x) { return x.xy(); });
+  CHECK(v.size() == vecs.size());
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    CHECK(v[i] == vecs[i].xy());
+  }
+}
+
+TEST_CASE("vec_soa.modifiers") {
+  auto v = vec_soa<float, 3>();
+  v.push_back(vec3f(1.0f, 2.0f, 3.0f));
+  v.push_back(vec3f(4.0f, 5.0f, 6.0f));
+  CHECK(v.size() == 2u);
+  CHECK(v[1] == vec3f(4.0f, 5.0f, 6.0f));
+
+  v.set(0u, vec3f(7.0f, 8.0f, 9.0f));
+  CHECK(v[0] == vec3f(7.0f, 8.0f, 9.0f));
+
+  v.resize(3u);
+  CHECK(v.size() == 3u);
+  CHECK(v[2] == vec3f::zero());
+
+  CHECK(v == v);
+  CHECK(v != vec_soa<float, 3>());
+
+  v.clear();
+  CHECK(v.empty());
+}
+
+TEST_CASE("vec_soa.dot") {
+  const auto lhs = soa_test_vecs();
+  const auto rhs = soa_test_other_vecs();
+  const auto result = dot(vec_soa<float, 3>(lhs), vec_soa<float, 3>(rhs));
+  REQUIRE(result.size() == lhs.size());
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    CHECK(result[i] == approx(dot(lhs[i], rhs[i])));
+  }
+
+  const auto withVec = dot(vec_soa<float, 3>(lhs), vec3f(1.0f, -2.0f, 3.0f));
+  REQUIRE(withVec.size() == lhs.size());
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    CHECK(withVec[i] == approx(dot(lhs[i], vec3f(1.0f, -2.0f, 3.0f))));
+  }
+}
+
+TEST_CASE("vec_soa.cross") {
+  const auto lhs = soa_test_vecs();
+  const auto rhs = soa_test_other_vecs();
+  const auto result = cross(vec_soa<float, 3>(lhs), vec_soa<float, 3>(rhs));
+  REQUIRE(result.size() == lhs.size());
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    CHECK(result[i] == approx(cross(lhs[i], rhs[i])));
+  }
+}
+
+TEST_CASE("vec_soa.squared_length") {
+  const auto vecs = soa_test_vecs();
+  const auto result = squared_length(vec_soa<float, 3>(vecs));
+  REQUIRE(result.size() == vecs.size());
+  for (std::size_t i = 0; i < vecs.size(); ++i) {
+    CHECK(result[i] == approx(squared_length(vecs[i])));
+  }
+}
+
+TEST_CASE("vec_soa.normalize") {
+  const auto vecs = soa_test_vecs();
+  const auto result = normalize(vec_soa<float, 3>(vecs));
+  REQUIRE(result.size() == vecs.size());
+  for (std::size_t i = 0; i < vecs.size(); ++i) {
+    CHECK(result[i] == approx(normalize(vecs[i])));
+  }
+}
+
+TEST_CASE("vec_soa.squared_distance") {
+  const auto lhs = soa_test_vecs();
+  const auto rhs = soa_test_other_vecs();
+  const auto result = squared_distance(vec_soa<float, 3>(lhs), vec_soa<float, 3>(rhs));
+  REQUIRE(result.size() == lhs.size());
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    CHECK(result[i] == approx(squared_distance(lhs[i], rhs[i])));
+  }
+
+  const auto toPoint = squared_distance(vec_soa<float, 3>(lhs), vec3f(1.0f, 1.0f, 1.0f));
+  REQUIRE(toPoint.size() == lhs.size());
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    CHECK(toPoint[i] == approx(squared_distance(lhs[i], vec3f(1.0f, 1.0f, 1.0f))));
+  }
+}
+
+TEST_CASE("vec_soa.min_max") {
+  const auto lhs = soa_test_vecs();
+  const auto rhs = soa_test_other_vecs();
+  const auto minResult = min(vec_soa<float, 3>(lhs), vec_soa<float, 3>(rhs));
+  const auto maxResult = max(vec_soa<float, 3>(lhs), vec_soa<float, 3>(rhs));
+  REQUIRE(minResult.size() == lhs.size());
+  REQUIRE(maxResult.size() == lhs.size());
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    CHECK(minResult[i] == min(lhs[i], rhs[i]));
+    CHECK(maxResult[i] == max(lhs[i], rhs[i]));
+  }
+}
+
+TEST_CASE("vec_soa.multiply_matrix") {
+  const auto vecs = soa_test_vecs();
+  const auto m = mat3x3f(1.0f, 2.0f, 3.0f, -4.0f, 5.0f, 6.0f, 7.0f, 8.0f, -9.0f);
+  const auto result = m * vec_soa<float, 3>(vecs);
+  REQUIRE(result.size() == vecs.size());
+  for (std::size_t i = 0; i < vecs.size(); ++i) {
+    CHECK(result[i] == approx(m * vecs[i]));
+  }
+}
+
+TEST_CASE("vec_soa.in_place") {
+  const auto vecs = soa_test_vecs();
+  const auto m = translation_matrix(vec3f(1.0f, -2.0f, 3.0f));
+
+  auto v = vec_soa<float, 3>(vecs);
+  normalize(v, v);
+  multiply(m, v, v);
+  for (std::size_t i = 0; i < vecs.size(); ++i) {
+    CHECK(v[i] == approx(m * normalize(vecs[i])));
+  }
+
+  // the output is resized to the size of the input
+  auto result = std::vector<float>(3u);
+  squared_length(v, result);
+  CHECK(result.size() == vecs.size());
+}
+
+TEST_CASE("vec_soa.multiply_matrix_homogeneous") {
+  const auto vecs = soa_test_vecs();
+  const auto m = translation_matrix(vec3f(1.0f, -2.0f, 3.0f)) *
+                 rotation_matrix(vec3f::pos_z(), to_radians(30.0f)) *
+                 scaling_matrix(vec3f(2.0f, 2.0f, 0.5f));
+  const auto result = m * vec_soa<float, 3>(vecs);
+  REQUIRE(result.size() == vecs.size());
+  for (std::size_t i = 0; i < vecs.size(); ++i) {
+    CHECK(result[i] == approx(m * vecs[i]));
+  }
+
+  // the last row is not (0, 0, 0, 1), so the points must be divided by w
+  const auto p = mat4x4f(
+    1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.125f, 0.0f, 0.0f,
+    2.0f);
+  const auto projected = p * vec_soa<float, 3>(vecs);
+  for (std::size_t i = 0; i < vecs.size(); ++i) {
+    CHECK(projected[i] == approx(p * vecs[i]));
+  }
+}
+} // namespace vm
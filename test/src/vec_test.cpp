@@ -28,6 +28,7 @@
 #include "test_utils.h"
 
 #include <array>
+#include <cstring>
 #include <limits>
 
 #include <catch2/catch.hpp>
@@ -774,6 +775,55 @@ TEST_CASE("vec.average") {
   CER_CHECK(average(std::begin(vecs), std::end(vecs)) == vec3f(4.0 / 3.0, 4.0 / 3.0, 4.0 / 3.0));
 }
 
+template <typename T, std::size_t S>
+static bool is_bitwise_equal(const vec<T, S>& lhs, const vec<T, S>& rhs) {
+  return std::memcmp(lhs.v, rhs.v, sizeof(T) * S) == 0;
+}
+
+template <typename T, std::size_t S> static void check_simd_kernels_match_scalar() {
+  // the constexpr results are computed by the scalar path, the runtime results by the SIMD kernels
+  // if VM_ENABLE_SIMD is defined
+  constexpr auto n = std::numeric_limits<T>::quiet_NaN();
+  constexpr auto a = vec<T, S>(vec<T, 4>(T(1.5), T(-0.0), T(-3.25), n));
+  constexpr auto b = vec<T, S>(vec<T, 4>(T(-2.0), T(0.5), T(7.0), T(4.0)));
+
+  constexpr auto neg = -a;
+  constexpr auto add = a + b;
+  constexpr auto sub = a - b;
+  constexpr auto mul = a * b;
+  constexpr auto muls = a * T(3.0);
+  constexpr auto div = a / b;
+  constexpr auto divs = a / T(3.0);
+  constexpr auto sdiv = T(3.0) / b;
+  constexpr auto mn = min(a, b);
+  constexpr auto mn2 = min(b, a);
+  constexpr auto mx = max(a, b);
+  constexpr auto mx2 = max(b, a);
+  constexpr auto ab = abs(a);
+  constexpr auto dt = dot(b, b);
+
+  CHECK(is_bitwise_equal(-a, neg));
+  CHECK(is_bitwise_equal(a + b, add));
+  CHECK(is_bitwise_equal(a - b, sub));
+  CHECK(is_bitwise_equal(a * b, mul));
+  CHECK(is_bitwise_equal(a * T(3.0), muls));
+  CHECK(is_bitwise_equal(a / b, div));
+  CHECK(is_bitwise_equal(a / T(3.0), divs));
+  CHECK(is_bitwise_equal(T(3.0) / b, sdiv));
+  CHECK(is_bitwise_equal(min(a, b), mn));
+  CHECK(is_bitwise_equal(max(a, b), mx));
+  CHECK(is_bitwise_equal(min(b, a), mn2));
+  CHECK(is_bitwise_equal(max(b, a), mx2));
+  CHECK(is_bitwise_equal(abs(a), ab));
+  CHECK(dot(b, b) == dt);
+}
+
+TEST_CASE("vec.simd_kernels_match_scalar") {
+  check_simd_kernels_match_scalar<float, 3>();
+  check_simd_kernels_match_scalar<float, 4>();
+  check_simd_kernels_match_scalar<double, 4>();
+}
+
 /**
  * rotates vec3f::pos_x() by the given number of degrees CCW wrt the positive Z axis
  */
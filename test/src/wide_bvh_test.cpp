@@ -0,0 +1,245 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+ Copyright 2015-2019 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vecmath/approx.h>
+#include <vecmath/bbox.h>
+#include <vecmath/bbox_io.h>
+#include <vecmath/bvh.h>
+#include <vecmath/forward.h>
+#include <vecmath/intersection.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_io.h>
+#include <vecmath/wide_bvh.h>
+
+#include "test_utils.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace vm {
+/**
+ * Checks that every primitive of the given binary tree is in exactly one leaf of the given wide
+ * tree, that every node is referenced once and that the order of every node is a permutation.
+ */
+template <typename T, std::size_t W>
+static void check_structure(const wide_bvh<T, 3, W>& tree, const bvh<T, 3>& binary) {
+  using tree_type = wide_bvh<T, 3, W>;
+
+  const auto& nodes = tree.nodes();
+  auto foundPrimitives = std::vector<std::size_t>(binary.size(), 0u);
+  auto foundNodes = std::vector<std::size_t>(nodes.size(), 0u);
+  foundNodes[0] = 1u;
+  auto identity = std::vector<std::uint8_t>(W);
+  std::iota(std::begin(identity), std::end(identity), std::uint8_t(0));
+  for (const auto& n : nodes) {
+    for (std::size_t i = 0; i < W; ++i) {
+      if (n.first[i] == tree_type::null_index) {
+        CHECK(n.count[i] == 0u);
+      } else if (n.count[i] > 0u) {
+        for (auto j = n.first[i]; j < n.first[i] + n.count[i]; ++j) {
+          const auto primitive = tree.primitive_indices()[j];
+          ++foundPrimitives[primitive];
+        }
+      } else {
+        ++foundNodes[n.first[i]];
+        const auto& child = nodes[n.first[i]];
+        for (std::size_t j = 0; j < W; ++j) {
+          if (child.first[j] != tree_type::null_index) {
+            CHECK(n.child_bounds(i).contains(child.child_bounds(j)));
+          }
+        }
+      }
+    }
+
+    for (const auto& order : n.order) {
+      CHECK(std::is_permutation(std::begin(order), std::end(order), std::begin(identity)));
+    }
+  }
+
+  const auto once = [](const auto c) { return c == 1u; };
+  CHECK(std::all_of(std::begin(foundPrimitives), std::end(foundPrimitives), once));
+  CHECK(std::all_of(std::begin(foundNodes), std::end(foundNodes), once));
+}
+
+/**
+ * Checks that the given wide tree finds the same first hits as the binary tree that it was
+ * collapsed from, and that it visits fewer nodes.
+ */
+template <typename T, std::size_t W>
+static void check_first_hits(
+  const wide_bvh<T, 3, W>& tree,
+  const bvh<T, 3>& binary,
+  const std::vector<vec<T, 3>>& vertices) {
+  auto binaryStats = traversal_stats();
+  auto wideStats = traversal_stats();
+  check_same_first_hits(tree, binary, vertices, &wideStats, &binaryStats);
+
+  // each wide node replaces several binary nodes
+  CHECK(wideStats.visited_nodes < binaryStats.visited_nodes);
+}
+
+TEST_CASE("wide_bvh.empty") {
+  const auto tree = bvh4d(bvh<double, 3>(std::vector<bbox3d>()));
+  CHECK(tree.empty());
+  CHECK(tree.size() == 0u);
+
+  const auto [index, distance] = tree.find_first_hit(
+    ray3d(vec3d::zero(), vec3d::pos_x()), [](const std::size_t) { return 0.0; });
+  CHECK(index == bvh4d::null_index);
+  CHECK(is_nan(distance));
+}
+
+TEST_CASE("wide_bvh.single_leaf") {
+  const auto bounds = std::vector<bbox3d>{
+    bbox3d(vec3d(0, 0, 0), vec3d(2, 1, 1)), bbox3d(vec3d(1, 0, 0), vec3d(3, 1, 1))};
+  const auto tree = bvh4d(bvh<double, 3>(bounds));
+  CHECK(tree.size() == 2u);
+  REQUIRE(tree.nodes().size() == 1u);
+
+  const auto& root = tree.nodes().front();
+  CHECK(root.first[0] == 0u);
+  CHECK(root.count[0] == 2u);
+  CHECK(root.child_bounds(0) == bbox3d(vec3d(0, 0, 0), vec3d(3, 1, 1)));
+  for (std::size_t i = 1; i < 4u; ++i) {
+    CHECK(root.first[i] == bvh4d::null_index);
+  }
+
+  auto found = std::vector<std::size_t>();
+  tree.find_intersectors(
+    bbox3d(vec3d(2.5, 0, 0), vec3d(4, 1, 1)), [&](const std::size_t i) { found.push_back(i); });
+  std::sort(std::begin(found), std::end(found));
+  CHECK(found == std::vector<std::size_t>{0u, 1u});
+
+  const auto [index, distance] = tree.find_first_hit(
+    ray3d(vec3d(-1, 0.5, 0.5), vec3d::pos_x()), [](const std::size_t i) { return double(i); });
+  CHECK(index == 0u);
+  CHECK(distance == 0.0);
+}
+
+TEST_CASE("wide_bvh.order") {
+  // four boxes along the x axis, collapsed into the root
+  auto bounds = std::vector<bbox3d>();
+  for (std::size_t i = 0; i < 4u; ++i) {
+    const auto x = 2.0 * static_cast<double>(i);
+    bounds.push_back(bbox3d(vec3d(x, 0, 0), vec3d(x + 1, 1, 1)));
+  }
+  const auto options = bvh_options<double>{1u, 1.0, 1.0};
+  const auto tree = bvh4d(bvh<double, 3>(bounds, options));
+  REQUIRE(tree.nodes().size() == 1u);
+
+  const auto& root = tree.nodes().front();
+  const auto child_x = [&](const std::size_t octant, const std::size_t i) {
+    return root.child_bounds(root.order[octant][i]).min.x();
+  };
+  for (std::size_t i = 0; i + 1u < 4u; ++i) {
+    // positive x direction
+    CHECK(child_x(0u, i) < child_x(0u, i + 1u));
+    // negative x direction
+    CHECK(child_x(1u, i) > child_x(1u, i + 1u));
+  }
+
+  // the nearest box is visited first, so no other leaf needs to be visited
+  const auto primitive_distance = [&](const ray3d& r) {
+    return [&, r](const std::size_t i) { return intersect_ray_bbox(r, bounds[i]); };
+  };
+  const auto forward = ray3d(vec3d(-1, 0.5, 0.5), vec3d::pos_x());
+  auto stats = traversal_stats();
+  CHECK(std::get<0>(tree.find_first_hit(forward, primitive_distance(forward), &stats)) == 0u);
+  CHECK(stats.visited_leaves == 1u);
+
+  const auto backward = ray3d(vec3d(10, 0.5, 0.5), vec3d::neg_x());
+  stats = traversal_stats();
+  CHECK(std::get<0>(tree.find_first_hit(backward, primitive_distance(backward), &stats)) == 3u);
+  CHECK(stats.visited_leaves == 1u);
+}
+
+TEST_CASE("wide_bvh.build") {
+  const auto vertices = random_triangles<double>(2000u, 1u);
+  const auto binary = make_triangle_bvh(vertices);
+
+  const auto tree4 = bvh4d(binary);
+  CHECK(tree4.size() == binary.size());
+  CHECK(tree4.primitive_indices() == binary.primitive_indices());
+  check_structure(tree4, binary);
+
+  const auto tree8 = bvh8d(binary);
+  check_structure(tree8, binary);
+  CHECK(tree8.nodes().size() < tree4.nodes().size());
+  CHECK(tree4.nodes().size() < binary.nodes().size());
+}
+
+TEST_CASE("wide_bvh.find_intersectors") {
+  const auto vertices = random_triangles<double>(1000u, 2u);
+  const auto binary = make_triangle_bvh(vertices);
+  const auto tree = bvh8d(binary);
+
+  const auto query = bbox3d(vec3d(-20, -20, -20), vec3d(20, 20, 20));
+  auto expected = std::vector<std::size_t>();
+  binary.find_intersectors(query, [&](const std::size_t i) { expected.push_back(i); });
+  std::sort(std::begin(expected), std::end(expected));
+
+  auto found = std::vector<std::size_t>();
+  tree.find_intersectors(query, [&](const std::size_t i) { found.push_back(i); });
+  std::sort(std::begin(found), std::end(found));
+  CHECK(found == expected);
+}
+
+TEST_CASE("wide_bvh.find_intersectors_infinite") {
+  auto bounds = std::vector<bbox3d>();
+  for (std::size_t i = 0; i < 20u; ++i) {
+    const auto x = 2.0 * static_cast<double>(i);
+    bounds.push_back(bbox3d(vec3d(x, 0, 0), vec3d(x + 1, 1, 1)));
+  }
+  const auto options = bvh_options<double>{1u, 1.0, 1.0};
+  const auto tree = bvh4d(bvh<double, 3>(bounds, options));
+
+  // the empty slots of the nodes must not be hit by a box that reaches infinity
+  const auto inf = std::numeric_limits<double>::infinity();
+  auto found = std::vector<std::size_t>();
+  tree.find_intersectors(
+    bbox3d(vec3d::fill(-inf), vec3d::fill(inf)), [&](const std::size_t i) { found.push_back(i); });
+  std::sort(std::begin(found), std::end(found));
+
+  auto expected = std::vector<std::size_t>(bounds.size());
+  std::iota(std::begin(expected), std::end(expected), std::size_t(0));
+  CHECK(found == expected);
+}
+
+TEST_CASE("wide_bvh.intersect_ray_triangles") {
+  const auto verticesd = random_triangles<double>(1000u, 3u);
+  const auto binaryd = make_triangle_bvh(verticesd);
+  check_first_hits(bvh4d(binaryd), binaryd, verticesd);
+  check_first_hits(bvh8d(binaryd), binaryd, verticesd);
+
+  const auto verticesf = random_triangles<float>(1000u, 3u);
+  const auto binaryf = make_triangle_bvh(verticesf);
+  check_first_hits(bvh4f(binaryf), binaryf, verticesf);
+  check_first_hits(bvh8f(binaryf), binaryf, verticesf);
+}
+} // namespace vm